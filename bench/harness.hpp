@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+namespace bench {
+
+#if defined(__GNUC__) || defined(__clang__)
+
+template <class T>
+inline void doNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <class T>
+inline void doNotOptimize(T& value)
+{
+    asm volatile("" : "+m"(value) : : "memory");
+}
+
+inline void clobberMemory()
+{
+    asm volatile("" : : : "memory");
+}
+
+#else
+
+void useCharPointer(const volatile char*);
+
+template <class T>
+inline void doNotOptimize(const T& value)
+{
+    useCharPointer(&reinterpret_cast<const volatile char&>(value));
+    _ReadWriteBarrier();
+}
+
+inline void clobberMemory()
+{
+    _ReadWriteBarrier();
+}
+
+#endif
+
+struct Benchmark {
+    std::string name;
+    std::string type;
+    size_t n = 0;
+    std::string variant;
+    size_t itemsPerRun = 0;
+    std::function<void()> run;
+};
+
+struct Result {
+    const Benchmark* benchmark = nullptr;
+    size_t runs = 0;
+    double nsPerItem = 0;
+};
+
+class Registry {
+public:
+    void add(Benchmark benchmark);
+
+    template <class F>
+    void add(
+        std::string name,
+        std::string type,
+        size_t n,
+        std::string variant,
+        size_t itemsPerRun,
+        F&& run)
+    {
+        add(Benchmark{
+            std::move(name),
+            std::move(type),
+            n,
+            std::move(variant),
+            itemsPerRun,
+            std::forward<F>(run)});
+    }
+
+    const std::vector<Benchmark>& benchmarks() const
+    {
+        return _benchmarks;
+    }
+
+private:
+    std::vector<Benchmark> _benchmarks;
+};
+
+Result measure(const Benchmark& benchmark, std::chrono::duration<double> minTime);
+
+} // namespace bench
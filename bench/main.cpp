@@ -0,0 +1,162 @@
+#include "harness.hpp"
+
+#include <ve/dispatch.hpp>
+#include <ve/instrumentation.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace bench {
+
+void registerVectorBenchmarks(Registry& registry);
+
+#if !defined(__GNUC__) && !defined(__clang__)
+void useCharPointer(const volatile char*) { }
+#endif
+
+void Registry::add(Benchmark benchmark)
+{
+    _benchmarks.push_back(std::move(benchmark));
+}
+
+Result measure(const Benchmark& benchmark, std::chrono::duration<double> minTime)
+{
+    using Clock = std::chrono::steady_clock;
+
+    benchmark.run();
+
+    size_t runs = 1;
+    for (;;) {
+        auto start = Clock::now();
+        for (size_t i = 0; i < runs; i++) {
+            benchmark.run();
+        }
+        auto elapsed = std::chrono::duration<double>(Clock::now() - start);
+        if (elapsed >= minTime / 5) {
+            break;
+        }
+        runs *= 2;
+    }
+
+    auto best = std::chrono::duration<double>::max();
+    for (int sample = 0; sample < 5; sample++) {
+        auto start = Clock::now();
+        for (size_t i = 0; i < runs; i++) {
+            benchmark.run();
+        }
+        best = std::min(
+            best, std::chrono::duration<double>(Clock::now() - start));
+    }
+
+    auto items = static_cast<double>(runs * benchmark.itemsPerRun);
+    return Result{&benchmark, runs, best.count() * 1e9 / items};
+}
+
+} // namespace bench
+
+namespace {
+
+void printJson(std::ostream& output, const std::vector<bench::Result>& results)
+{
+    output << "{\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& b = *results[i].benchmark;
+        output << (i == 0 ? "\n" : ",\n") <<
+            "    {\"name\": \"" << b.name << "\", " <<
+            "\"type\": \"" << b.type << "\", " <<
+            "\"n\": " << b.n << ", " <<
+            "\"variant\": \"" << b.variant << "\", " <<
+            "\"runs\": " << results[i].runs << ", " <<
+            "\"items_per_run\": " << b.itemsPerRun << ", " <<
+            "\"ns_per_item\": " << results[i].nsPerItem << "}";
+    }
+    output << "\n  ]\n}\n";
+}
+
+void printCsv(std::ostream& output, const std::vector<bench::Result>& results)
+{
+    output << "name,type,n,variant,runs,items_per_run,ns_per_item\n";
+    for (const auto& result : results) {
+        const auto& b = *result.benchmark;
+        output << b.name << "," << b.type << "," << b.n << "," <<
+            b.variant << "," << result.runs << "," << b.itemsPerRun << "," <<
+            result.nsPerItem << "\n";
+    }
+}
+
+void printUsage(std::ostream& output)
+{
+    output <<
+        "usage: ve_bench [--format=json|csv] [--filter=SUBSTRING] "
+        "[--min-time=SECONDS] [--isa=baseline|avx2|avx512] [--list]\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto format = std::string{"json"};
+    auto filter = std::string{};
+    auto minTime = std::chrono::duration<double>{0.1};
+    bool list = false;
+
+    for (int i = 1; i < argc; i++) {
+        auto arg = std::string_view{argv[i]};
+        if (arg.starts_with("--format=")) {
+            format = arg.substr(9);
+        } else if (arg.starts_with("--filter=")) {
+            filter = arg.substr(9);
+        } else if (arg.starts_with("--min-time=")) {
+            minTime = std::chrono::duration<double>{
+                std::strtod(std::string{arg.substr(11)}.c_str(), nullptr)};
+        } else if (arg.starts_with("--isa=")) {
+            auto isa = ve::internal::parseIsa(arg.substr(6));
+            if (!isa || ve::setIsa(*isa) != *isa) {
+                std::cerr << "unsupported instruction set " << arg.substr(6) << "\n";
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--list") {
+            list = true;
+        } else {
+            printUsage(std::cerr);
+            return arg == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (format != "json" && format != "csv") {
+        printUsage(std::cerr);
+        return EXIT_FAILURE;
+    }
+
+    bench::Registry registry;
+    bench::registerVectorBenchmarks(registry);
+
+    std::vector<bench::Result> results;
+    for (const auto& benchmark : registry.benchmarks()) {
+        auto id = benchmark.name + "/" + benchmark.type + "/" +
+            std::to_string(benchmark.n) + "/" + benchmark.variant;
+        if (id.find(filter) == std::string::npos) {
+            continue;
+        }
+        if (list) {
+            std::cout << id << "\n";
+            continue;
+        }
+        std::cerr << id << "\n";
+        results.push_back(bench::measure(benchmark, minTime));
+    }
+
+    if (!list) {
+        if (format == "json") {
+            printJson(std::cout, results);
+        } else {
+            printCsv(std::cout, results);
+        }
+        if (ve::instrumentationEnabled) {
+            std::cerr << ve::instrumentationReport();
+        }
+    }
+}
@@ -0,0 +1,763 @@
+#include "harness.hpp"
+
+#include <ve.hpp>
+#include <ve/aggregated_values.hpp>
+#include <ve/algorithms.hpp>
+#include <ve/compact.hpp>
+#include <ve/kmeans.hpp>
+#include <ve/pairwise.hpp>
+#include <ve/point_cloud.hpp>
+#include <ve/point_codec.hpp>
+#include <ve/ring_buffer.hpp>
+#include <ve/spatial_sort.hpp>
+#include <ve/text.hpp>
+#include <ve/transform.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr size_t bulkSize = 4096;
+constexpr size_t scalarIterations = 1024;
+
+template <class T> struct XYModel {
+    T x;
+    T y;
+};
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+
+template <class T> struct XYZWModel {
+    T x;
+    T y;
+    T z;
+    T w;
+};
+
+template <class V>
+std::vector<V> makeValues(size_t count, std::uint32_t seed)
+{
+    std::vector<V> values(count);
+    for (auto& value : values) {
+        for (size_t c = 0; c < ve::internal::VectorTraits<V>::size; c++) {
+            seed = seed * 1664525u + 1013904223u;
+            value[c] = static_cast<std::remove_reference_t<decltype(value[c])>>(
+                1 + (seed >> 24) % 8);
+        }
+    }
+    return values;
+}
+
+template <class P>
+std::vector<P> makePoints(size_t count, std::uint32_t seed)
+{
+    using V = typename ve::internal::PointTraits<P>::vector_type;
+    auto vectors = makeValues<V>(count, seed);
+    std::vector<P> points(count);
+    for (size_t i = 0; i < count; i++) {
+        for (size_t c = 0; c < ve::internal::PointTraits<P>::size; c++) {
+            points[i][c] = vectors[i][c];
+        }
+    }
+    return points;
+}
+
+template <class R>
+using Stored = std::conditional_t<std::is_same_v<R, bool>, unsigned char, R>;
+
+struct Tag {
+    std::string name;
+    std::string type;
+    size_t n;
+};
+
+template <class A, class B, class Op>
+void addBinary(
+    bench::Registry& registry,
+    const Tag& tag,
+    const std::vector<A>& lhs,
+    const std::vector<B>& rhs,
+    Op op)
+{
+    registry.add(tag.name, tag.type, tag.n, "scalar", scalarIterations,
+        [l = lhs.front(), r = rhs.front(), op] () mutable {
+            for (size_t i = 0; i < scalarIterations; i++) {
+                bench::doNotOptimize(l);
+                bench::doNotOptimize(r);
+                auto result = op(l, r);
+                bench::doNotOptimize(result);
+            }
+        });
+
+    using R = Stored<decltype(op(lhs.front(), rhs.front()))>;
+    registry.add(tag.name, tag.type, tag.n, "bulk", bulkSize,
+        [lhs, rhs, out = std::vector<R>(bulkSize), op] () mutable {
+            for (size_t i = 0; i < bulkSize; i++) {
+                out[i] = op(lhs[i], rhs[i]);
+            }
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+}
+
+template <class A, class Op>
+void addUnary(
+    bench::Registry& registry,
+    const Tag& tag,
+    const std::vector<A>& values,
+    Op op)
+{
+    registry.add(tag.name, tag.type, tag.n, "scalar", scalarIterations,
+        [value = values.front(), op] () mutable {
+            for (size_t i = 0; i < scalarIterations; i++) {
+                bench::doNotOptimize(value);
+                auto result = op(value);
+                bench::doNotOptimize(result);
+            }
+        });
+
+    using R = Stored<decltype(op(values.front()))>;
+    registry.add(tag.name, tag.type, tag.n, "bulk", bulkSize,
+        [values, out = std::vector<R>(bulkSize), op] () mutable {
+            for (size_t i = 0; i < bulkSize; i++) {
+                out[i] = op(values[i]);
+            }
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+}
+
+template <template <class> class M, class U, class V>
+void registerBinaryOps(bench::Registry& registry, const std::string& type)
+{
+    using A = ve::Vector<M, U>;
+    using B = ve::Vector<M, V>;
+    using P = ve::Point<M, U>;
+    using Q = ve::Point<M, V>;
+    using R = decltype(std::declval<U>() + std::declval<V>());
+    constexpr size_t n = ve::internal::VectorTraits<A>::size;
+
+    auto a = makeValues<A>(bulkSize, 1);
+    auto b = makeValues<B>(bulkSize, 2);
+    auto p = makePoints<P>(bulkSize, 3);
+    auto q = makePoints<Q>(bulkSize, 4);
+    auto s = std::vector<V>(bulkSize, V{3});
+
+    addBinary(registry, {"vector.add", type, n}, a, b,
+        [] (const auto& x, const auto& y) { return x + y; });
+    addBinary(registry, {"vector.sub", type, n}, a, b,
+        [] (const auto& x, const auto& y) { return x - y; });
+    addBinary(registry, {"vector.mul", type, n}, a, s,
+        [] (const auto& x, const auto& y) { return x * y; });
+    addBinary(registry, {"vector.div", type, n}, a, s,
+        [] (const auto& x, const auto& y) { return x / y; });
+    addBinary(registry, {"vector.eq", type, n}, a, b,
+        [] (const auto& x, const auto& y) { return x == y; });
+    addBinary(registry, {"vector.lt", type, n}, a, b,
+        [] (const auto& x, const auto& y) { return x < y; });
+    addBinary(registry, {"point.add", type, n}, p, b,
+        [] (const auto& x, const auto& y) { return x + y; });
+    addBinary(registry, {"point.sub", type, n}, p, q,
+        [] (const auto& x, const auto& y) { return x - y; });
+    addBinary(registry, {"point.eq", type, n}, p, q,
+        [] (const auto& x, const auto& y) { return x == y; });
+    addBinary(registry, {"point.distance", type, n}, p, q,
+        [] (const auto& x, const auto& y) { return ve::distance(x, y); });
+    if constexpr (!std::is_same_v<U, V>) {
+        addUnary(registry, {"vector.convert", type, n}, a,
+            [] (const auto& x) { return ve::Vector<M, V>{x}; });
+    }
+
+    registry.add("vector.add", type, n, "soa", bulkSize,
+        [acc = ve::VectorArray<M, R>(bulkSize, ve::Vector<M, R>{}),
+                rhs = ve::VectorArray<M, V>(bulkSize, b.front())] () mutable {
+            acc += rhs;
+            bench::doNotOptimize(acc.data(0));
+            bench::clobberMemory();
+        });
+    registry.add("vector.mul", type, n, "soa", bulkSize,
+        [acc = ve::VectorArray<M, R>(bulkSize, a.front())] () mutable {
+            auto one = R{1};
+            bench::doNotOptimize(one);
+            acc *= one;
+            bench::doNotOptimize(acc.data(0));
+            bench::clobberMemory();
+        });
+    registry.add("point.add", type, n, "soa", bulkSize,
+        [points = ve::PointArray<M, R>(bulkSize, p.front()),
+                shift = b.front()] () mutable {
+            bench::doNotOptimize(shift);
+            points += shift;
+            points -= shift;
+            bench::doNotOptimize(points.data(0));
+            bench::clobberMemory();
+        });
+    registry.add("point.sub", type, n, "soa", bulkSize,
+        [lhs = ve::PointArray<M, U>(bulkSize, p.front()),
+                rhs = ve::PointArray<M, V>(bulkSize, q.front())] () mutable {
+            auto result = lhs - rhs;
+            bench::doNotOptimize(result.data(0));
+            bench::clobberMemory();
+        });
+}
+
+template <template <class> class M, class T>
+void registerUnaryOps(bench::Registry& registry, const std::string& type)
+{
+    using A = ve::Vector<M, T>;
+    using P = ve::Point<M, T>;
+    using R = decltype(ve::length(std::declval<A>()));
+    constexpr size_t n = ve::internal::VectorTraits<A>::size;
+
+    auto a = makeValues<A>(bulkSize, 5);
+    auto p = makePoints<P>(bulkSize, 6);
+    auto q = makePoints<P>(bulkSize, 7);
+
+    addUnary(registry, {"vector.neg", type, n}, a,
+        [] (const auto& x) { return -x; });
+    addUnary(registry, {"vector.length", type, n}, a,
+        [] (const auto& x) { return ve::length(x); });
+    addUnary(registry, {"vector.unit", type, n}, a,
+        [] (const auto& x) { return ve::unit(x); });
+
+    registry.add("vector.length", type, n, "batch", bulkSize,
+        [a, out = std::vector<R>(bulkSize)] () mutable {
+            ve::lengths(a, out);
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+    registry.add("vector.length", type, n, "batch-fast", bulkSize,
+        [a, out = std::vector<R>(bulkSize)] () mutable {
+            ve::lengths(a, out, ve::Precision::Fast);
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+    registry.add("vector.unit", type, n, "batch", bulkSize,
+        [a, out = std::vector<ve::Vector<M, R>>(bulkSize)] () mutable {
+            ve::normalize(a, out);
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+    registry.add("vector.unit", type, n, "batch-fast", bulkSize,
+        [a, out = std::vector<ve::Vector<M, R>>(bulkSize)] () mutable {
+            ve::normalize(a, out, ve::Precision::Fast);
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+    registry.add("point.distance", type, n, "batch", bulkSize,
+        [p, q, out = std::vector<R>(bulkSize)] () mutable {
+            ve::distances(p, q, out);
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+
+    auto rotation = ve::Matrix<M, T, ve::internal::VectorTraits<A>::size>{};
+    for (size_t i = 0; i < n; i++) {
+        rotation((i + 1) % n, i) = T{1};
+    }
+    const auto t = ve::Transform<M, T>{rotation, {}} *
+        ve::Transform<M, T>::scale(T{2});
+    addUnary(registry, {"point.transform", type, n}, p,
+        [t] (const auto& x) { return t(x); });
+    registry.add("point.transform", type, n, "batch", bulkSize,
+        [t, p, out = std::vector<P>(bulkSize)] () mutable {
+            ve::transform(t, p, out);
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+    registry.add("point.transform", type, n, "soa", bulkSize,
+        [t, in = ve::PointArray<M, T>(bulkSize, p.front()),
+                out = ve::PointArray<M, T>(bulkSize, p.front())] () mutable {
+            ve::transform(t, in, out);
+            bench::doNotOptimize(out.data(0));
+            bench::clobberMemory();
+        });
+    registry.add("point.transform-bounds", type, n, "bulk", bulkSize,
+        [t, p, out = std::vector<P>(bulkSize)] () mutable {
+            auto box = ve::AABB<M, T>{};
+            for (size_t i = 0; i < bulkSize; i++) {
+                out[i] = t(p[i]);
+                box.extend(out[i]);
+            }
+            bench::doNotOptimize(box);
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+    registry.add("point.transform-bounds", type, n, "batch", bulkSize,
+        [t, p, out = std::vector<P>(bulkSize)] () mutable {
+            auto box = ve::transformWithBounds(t, p, out);
+            bench::doNotOptimize(box);
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+
+    registry.add("vector.ostream", type, n, "scalar", scalarIterations,
+        [value = a.front()] {
+            std::ostringstream stream;
+            for (size_t i = 0; i < scalarIterations; i++) {
+                stream << value;
+            }
+            bench::doNotOptimize(stream);
+        });
+    registry.add("vector.ostream", type, n, "bulk", bulkSize,
+        [a] {
+            std::ostringstream stream;
+            for (const auto& value : a) {
+                stream << value << "\n";
+            }
+            bench::doNotOptimize(stream);
+        });
+    registry.add("vector.tochars", type, n, "scalar", scalarIterations,
+        [value = a.front()] {
+            std::string text;
+            for (size_t i = 0; i < scalarIterations; i++) {
+                ve::appendText(text, value);
+            }
+            bench::doNotOptimize(text);
+        });
+    registry.add("vector.tochars", type, n, "bulk", bulkSize,
+        [a] {
+            std::string text;
+            for (const auto& value : a) {
+                ve::appendText(text, value);
+                text += '\n';
+            }
+            bench::doNotOptimize(text);
+        });
+
+    std::string pointText;
+    for (const auto& point : p) {
+        ve::appendText(pointText, point);
+        pointText += '\n';
+    }
+    registry.add("point.parse", type, n, "bulk", bulkSize,
+        [pointText, out = std::vector<P>{}] () mutable {
+            out.clear();
+            ve::fromChars(std::string_view{pointText}, out);
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+}
+
+template <template <class> class M, class C>
+void registerCompactOps(bench::Registry& registry, const std::string& type)
+{
+    using P = ve::Point<M, float>;
+    using Q = ve::Point<M, C>;
+    constexpr size_t n = ve::internal::PointTraits<P>::size;
+
+    auto p = makePoints<P>(bulkSize, 8);
+    auto q = std::vector<Q>(bulkSize);
+    ve::quantize(p, q);
+
+    addUnary(registry, {"point.quantize", type, n}, p,
+        [] (const auto& x) { return Q{x}; });
+    addUnary(registry, {"point.dequantize", type, n}, q,
+        [] (const auto& x) { return P{x}; });
+    registry.add("point.quantize", type, n, "batch", bulkSize,
+        [p, out = std::vector<Q>(bulkSize)] () mutable {
+            ve::quantize(p, out);
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+    registry.add("point.dequantize", type, n, "batch", bulkSize,
+        [q, out = std::vector<P>(bulkSize)] () mutable {
+            ve::dequantize(q, out);
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+}
+
+template <template <class> class M, class T>
+void registerSpatialOps(bench::Registry& registry, const std::string& type)
+{
+    using P = ve::Point<M, T>;
+    constexpr size_t n = ve::internal::PointTraits<P>::size;
+
+    auto p = makePoints<P>(bulkSize, 9);
+    const auto box = ve::bounds(p);
+
+    registry.add("point.morton-key", type, n, "bulk", bulkSize,
+        [p, box, out = std::vector<std::uint64_t>(bulkSize)] () mutable {
+            for (size_t i = 0; i < bulkSize; i++) {
+                out[i] = ve::mortonKey(p[i], box);
+            }
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+    registry.add("point.morton-key", type, n, "batch", bulkSize,
+        [p, box, out = std::vector<std::uint64_t>(bulkSize)] () mutable {
+            ve::mortonKeys(p, box, out);
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+    registry.add("point.hilbert-key", type, n, "batch", bulkSize,
+        [p, box, out = std::vector<std::uint64_t>(bulkSize)] () mutable {
+            ve::hilbertKeys(p, box, out);
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+
+    std::vector<std::uint64_t> keys(bulkSize);
+    ve::hilbertKeys(p, box, keys);
+    registry.add("point.sort-by-key", type, n, "bulk", bulkSize,
+        [p, keys, order = std::vector<size_t>(bulkSize),
+                out = std::vector<P>(bulkSize)] () mutable {
+            for (size_t i = 0; i < bulkSize; i++) {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(),
+                [&] (size_t a, size_t b) { return keys[a] < keys[b]; });
+            for (size_t i = 0; i < bulkSize; i++) {
+                out[i] = p[order[i]];
+            }
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+    registry.add("point.sort-by-key", type, n, "batch", bulkSize,
+        [p, keys, k = keys, out = p] () mutable {
+            std::copy(keys.begin(), keys.end(), k.begin());
+            std::copy(p.begin(), p.end(), out.begin());
+            ve::sortByKeys(k, out);
+            bench::doNotOptimize(out.data());
+            bench::clobberMemory();
+        });
+}
+
+template <template <class> class M, class T>
+void registerContainerOps(bench::Registry& registry, const std::string& type)
+{
+    using P = ve::Point<M, T>;
+    constexpr size_t n = ve::internal::PointTraits<P>::size;
+    constexpr size_t count = 1 << 18;
+
+    auto p = makePoints<P>(bulkSize, 10);
+
+    registry.add("point.append", type, n, "vector", count,
+        [p] {
+            std::vector<P> points;
+            for (size_t i = 0; i < count; i++) {
+                points.push_back(p[i % bulkSize]);
+            }
+            bench::doNotOptimize(points.data());
+            bench::clobberMemory();
+        });
+    registry.add("point.append", type, n, "cloud", count,
+        [p] {
+            ve::PointCloud<M, T> points;
+            for (size_t i = 0; i < count; i++) {
+                points.push_back(p[i % bulkSize]);
+            }
+            bench::doNotOptimize(&points[0]);
+            bench::clobberMemory();
+        });
+}
+
+template <template <class> class M>
+void registerReductionOps(bench::Registry& registry)
+{
+    using V = ve::Vector<M, float>;
+    using D = ve::Vector<M, double>;
+    constexpr size_t n = ve::internal::VectorTraits<V>::size;
+    constexpr size_t count = 1 << 20;
+
+    // One thread, so the numbers are the throughput of the kernels.
+    static auto pool = ve::ThreadPool{1};
+    auto values = makeValues<V>(count, 11);
+    const auto modes = {
+        std::pair{"naive", ve::Summation::Naive},
+        std::pair{"pairwise", ve::Summation::Pairwise},
+        std::pair{"kahan", ve::Summation::Kahan},
+        std::pair{"double", ve::Summation::Double},
+    };
+    for (const auto& [variant, summation] : modes) {
+        registry.add("vector.sum", "float", n, variant, count,
+            [values, summation] {
+                auto result = ve::sum(values, summation, pool);
+                bench::doNotOptimize(result);
+            });
+    }
+    registry.add("vector.sum", "double", n, "naive", count,
+        [values = std::vector<D>(values.begin(), values.end())] {
+            auto result = ve::sum(values, ve::Summation::Naive, pool);
+            bench::doNotOptimize(result);
+        });
+}
+
+template <template <class> class M>
+void registerClusteringOps(bench::Registry& registry)
+{
+    using P = ve::Point<M, float>;
+    constexpr size_t n = ve::internal::PointTraits<P>::size;
+    constexpr size_t count = 1 << 16;
+    constexpr size_t k = 64;
+
+    static auto pool = ve::ThreadPool{1};
+    auto p = makePoints<P>(count, 12);
+    for (size_t i = 0; i < count; i++) {
+        p[i][0] += static_cast<float>(i % 97);
+    }
+    const auto centers = ve::kmeansPlusPlus(p, k, 0, pool);
+
+    registry.add("point.nearest-center", "float", n, "naive", count,
+        [p, centers, labels = std::vector<std::uint32_t>(count)] () mutable {
+            for (size_t i = 0; i < count; i++) {
+                size_t best = 0;
+                float bestDistance = ve::distance(p[i], centers[0]);
+                for (size_t j = 1; j < k; j++) {
+                    float d = ve::distance(p[i], centers[j]);
+                    if (d < bestDistance) {
+                        best = j;
+                        bestDistance = d;
+                    }
+                }
+                labels[i] = static_cast<std::uint32_t>(best);
+            }
+            bench::doNotOptimize(labels.data());
+            bench::clobberMemory();
+        });
+    registry.add("point.nearest-center", "float", n, "batch", count,
+        [p, centers, labels = std::vector<std::uint32_t>(count)] () mutable {
+            ve::nearestCenters(p, centers, labels, pool);
+            bench::doNotOptimize(labels.data());
+            bench::clobberMemory();
+        });
+    registry.add("point.kmeans", "float", n, "hamerly", count,
+        [p, centers] {
+            auto result = ve::kmeans(p, centers, {.maxIterations = 20}, pool);
+            bench::doNotOptimize(result.inertia);
+        });
+}
+
+template <template <class> class M>
+void registerPairwiseOps(bench::Registry& registry)
+{
+    using P = ve::Point<M, float>;
+    constexpr size_t n = ve::internal::PointTraits<P>::size;
+    constexpr size_t rows = 256;
+    constexpr size_t columns = 4096;
+
+    static auto pool = ve::ThreadPool{1};
+    const auto lhs = makePoints<P>(rows, 13);
+    const auto rhs = makePoints<P>(columns, 14);
+
+    registry.add("point.pairwise-distances", "float", n, "naive", rows * columns,
+        [lhs, rhs, matrix = std::vector<float>(rows * columns)] () mutable {
+            for (size_t i = 0; i < rows; i++) {
+                for (size_t j = 0; j < columns; j++) {
+                    matrix[i * columns + j] = ve::distance(lhs[i], rhs[j]);
+                }
+            }
+            bench::doNotOptimize(matrix.data());
+            bench::clobberMemory();
+        });
+    registry.add("point.pairwise-distances", "float", n, "tiled", rows * columns,
+        [lhs, rhs, matrix = std::vector<float>(rows * columns)] () mutable {
+            ve::pairwiseDistances(lhs, rhs, matrix, ve::Precision::Exact, pool);
+            bench::doNotOptimize(matrix.data());
+            bench::clobberMemory();
+        });
+
+    // The coordinates are integers from 1 to 8, so a radius of 1 keeps 7%,
+    // 1.3% and 0.2% of the pairs in 2, 3 and 4 dimensions.
+    const float radius = 1;
+    registry.add("point.pairs-within-radius", "float", n, "naive", rows * columns,
+        [lhs, rhs, radius, pairs = std::vector<std::pair<size_t, size_t>>()] () mutable {
+            pairs.clear();
+            for (size_t i = 0; i < rows; i++) {
+                for (size_t j = 0; j < columns; j++) {
+                    if (ve::distance(lhs[i], rhs[j]) <= radius) {
+                        pairs.emplace_back(i, j);
+                    }
+                }
+            }
+            bench::doNotOptimize(pairs.data());
+            bench::clobberMemory();
+        });
+    registry.add("point.pairs-within-radius", "float", n, "tiled", rows * columns,
+        [lhs, rhs, radius, pairs = std::vector<std::pair<size_t, size_t>>(
+                rows * columns / 10)] () mutable {
+            auto found = ve::pairsWithinRadius(lhs, rhs, radius, pairs, pool);
+            bench::doNotOptimize(found);
+            bench::clobberMemory();
+        });
+}
+
+// One point changes between reads of the bounds and centroid.
+template <template <class> class M>
+void registerAggregateOps(bench::Registry& registry)
+{
+    using P = ve::Point<M, float>;
+    constexpr size_t n = ve::internal::PointTraits<P>::size;
+    constexpr size_t count = 1 << 16;
+    constexpr size_t updates = 64;
+
+    static auto pool = ve::ThreadPool{1};
+    const auto p = makePoints<P>(count, 15);
+    const auto moved = makePoints<P>(updates, 16);
+
+    registry.add("point.aggregates", "float", n, "recompute", updates,
+        [points = p, moved] () mutable {
+            for (size_t i = 0; i < updates; i++) {
+                points[i * 997 % count] = moved[i];
+                auto box = ve::bounds(points, pool);
+                auto center = ve::centroid(points, pool);
+                bench::doNotOptimize(box);
+                bench::doNotOptimize(center);
+            }
+        });
+    registry.add("point.aggregates", "float", n, "incremental", updates,
+        [values = ve::AggregatedValues<P>{p}, moved] () mutable {
+            for (size_t i = 0; i < updates; i++) {
+                values.update(i * 997 % count, moved[i]);
+                auto box = values.bounds();
+                auto center = values.centroid();
+                bench::doNotOptimize(box);
+                bench::doNotOptimize(center);
+            }
+        });
+}
+
+// Batches of samples handed from a producer to a consumer. This measures
+// the cost of the handoff itself; contention needs several cores.
+template <template <class> class M>
+void registerIngestionOps(bench::Registry& registry)
+{
+    using P = ve::Point<M, float>;
+    constexpr size_t n = ve::internal::PointTraits<P>::size;
+    constexpr size_t batchSize = 64;
+    constexpr size_t batches = 64;
+
+    const auto batch = makePoints<P>(batchSize, 17);
+
+    registry.add("point.ingest", "float", n, "mutex", batchSize * batches,
+        [batch, shared = std::vector<P>(), drained = std::vector<P>()] () mutable {
+            static std::mutex mutex;
+            for (size_t b = 0; b < batches; b++) {
+                auto lock = std::lock_guard{mutex};
+                shared.insert(shared.end(), batch.begin(), batch.end());
+            }
+            {
+                auto lock = std::lock_guard{mutex};
+                drained.swap(shared);
+            }
+            bench::doNotOptimize(drained.data());
+            drained.clear();
+        });
+    registry.add("point.ingest", "float", n, "ring-buffer", batchSize * batches,
+        [batch, drained = std::vector<P>(batchSize * batches)] () mutable {
+            static auto buffer = ve::RingBuffer<P>{batchSize * batches};
+            for (size_t b = 0; b < batches; b++) {
+                buffer.push(std::span<const P>{batch});
+            }
+            drained.clear();
+            buffer.drain(drained);
+            bench::doNotOptimize(drained.data());
+        });
+}
+
+template <template <class> class M>
+void registerCodecOps(bench::Registry& registry)
+{
+    using P = ve::Point<M, float>;
+    constexpr size_t n = ve::internal::PointTraits<P>::size;
+    constexpr size_t count = 4096;
+    constexpr double precision = 1e-3;
+
+    // A trajectory with steps of up to a few hundredths.
+    auto points = makePoints<P>(count, 19);
+    for (size_t i = 1; i < count; i++) {
+        for (size_t c = 0; c < n; c++) {
+            points[i][c] = points[i - 1][c] + (points[i][c] - 4.5f) * 0.01f;
+        }
+    }
+
+    registry.add("point.decode", "float", n, "raw", count,
+        [raw = std::vector<P>(points), out = std::vector<P>(count)] () mutable {
+            std::memcpy(out.data(), raw.data(), count * sizeof(P));
+            bench::doNotOptimize(out.data());
+        });
+    for (auto encoding : {ve::DeltaEncoding::Varint, ve::DeltaEncoding::BitPacked}) {
+        std::ostringstream output;
+        auto encoder = ve::PointEncoder<M, float>{output, precision, {encoding}};
+        encoder.write(points);
+        encoder.finish();
+        const auto text = output.str();
+        const auto* bytes = reinterpret_cast<const std::byte*>(text.data());
+        const auto name = encoding == ve::DeltaEncoding::Varint ? "varint" : "bit-packed";
+
+        registry.add("point.decode", "float", n, name, count,
+            [data = std::vector(bytes, bytes + text.size()),
+                out = std::vector<P>(count)] () mutable {
+                auto decoder = ve::PointDecoder<M, float>{data};
+                decoder.decode(0, out);
+                bench::doNotOptimize(out.data());
+            });
+        registry.add("point.encode", "float", n, name, count,
+            [points, encoding] {
+                std::ostringstream output;
+                auto encoder = ve::PointEncoder<M, float>{output, precision, {encoding}};
+                encoder.write(points);
+                encoder.finish();
+                bench::doNotOptimize(output);
+            });
+    }
+}
+
+template <template <class> class M>
+void registerModel(bench::Registry& registry)
+{
+    registerBinaryOps<M, int, int>(registry, "int");
+    registerBinaryOps<M, float, float>(registry, "float");
+    registerBinaryOps<M, double, double>(registry, "double");
+    registerBinaryOps<M, int, double>(registry, "int+double");
+    registerBinaryOps<M, float, double>(registry, "float+double");
+
+    registerUnaryOps<M, int>(registry, "int");
+    registerUnaryOps<M, float>(registry, "float");
+    registerUnaryOps<M, double>(registry, "double");
+
+    registerCompactOps<M, ve::Half>(registry, "half");
+    registerCompactOps<M, ve::BFloat16>(registry, "bfloat16");
+    registerCompactOps<M, ve::Fixed<std::int16_t, 1000>>(registry, "fixed16");
+
+    registerContainerOps<M, float>(registry, "float");
+    registerReductionOps<M>(registry);
+    registerClusteringOps<M>(registry);
+    registerPairwiseOps<M>(registry);
+    registerAggregateOps<M>(registry);
+    registerIngestionOps<M>(registry);
+    registerCodecOps<M>(registry);
+
+    if constexpr (ve::internal::CurveDimension<
+            ve::internal::componentCount<M<float>, float>()>) {
+        registerSpatialOps<M, float>(registry, "float");
+    }
+}
+
+} // namespace
+
+namespace bench {
+
+void registerVectorBenchmarks(Registry& registry)
+{
+    registerModel<XYModel>(registry);
+    registerModel<XYZModel>(registry);
+    registerModel<XYZWModel>(registry);
+}
+
+} // namespace bench
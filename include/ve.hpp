@@ -1,4 +1,8 @@
 #pragma once
 
+#include "ve/aabb.hpp"
+#include "ve/batch.hpp"
+#include "ve/expression.hpp"
 #include "ve/point.hpp"
+#include "ve/soa.hpp"
 #include "ve/vector.hpp"
@@ -0,0 +1,216 @@
+#pragma once
+
+#include "ve/internal/simd.hpp"
+#include "ve/internal/unroll.hpp"
+#include "ve/point.hpp"
+#include "ve/vector.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+namespace ve {
+
+namespace internal {
+
+// Componentwise minimum and maximum with the semantics of a < b ? a : b and
+// b < a ? a : b, which is also what the SIMD instructions do with NaN.
+template <template <class> class M, class T, size_t N>
+VE_FORCE_INLINE constexpr Point<M, T, N> componentMin(
+    const Point<M, T, N>& a, const Point<M, T, N>& b)
+{
+    using Simd = simd::Kernel<M, T, N>;
+    Point<M, T, N> result;
+    if constexpr (Simd::enabled) {
+        if (!constantEvaluated()) {
+            Simd::min(data<N>(result), data<N>(a), data<N>(b));
+            return result;
+        }
+    }
+    unroll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+        get<I, N>(result) = get<I, N>(a) < get<I, N>(b) ? get<I, N>(a) : get<I, N>(b);
+    });
+    return result;
+}
+
+template <template <class> class M, class T, size_t N>
+VE_FORCE_INLINE constexpr Point<M, T, N> componentMax(
+    const Point<M, T, N>& a, const Point<M, T, N>& b)
+{
+    using Simd = simd::Kernel<M, T, N>;
+    Point<M, T, N> result;
+    if constexpr (Simd::enabled) {
+        if (!constantEvaluated()) {
+            Simd::max(data<N>(result), data<N>(a), data<N>(b));
+            return result;
+        }
+    }
+    unroll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+        get<I, N>(result) = get<I, N>(b) < get<I, N>(a) ? get<I, N>(a) : get<I, N>(b);
+    });
+    return result;
+}
+
+// Whether a[i] <= b[i] for every component; false if any is NaN.
+template <template <class> class M, class T, size_t N>
+VE_FORCE_INLINE constexpr bool componentsLessEqual(
+    const Point<M, T, N>& a, const Point<M, T, N>& b)
+{
+    using Simd = simd::Kernel<M, T, N>;
+    if constexpr (Simd::enabled) {
+        if (!constantEvaluated()) {
+            return Simd::lessEqual(data<N>(a), data<N>(b));
+        }
+    }
+    return unrollAll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+        return get<I, N>(a) <= get<I, N>(b);
+    });
+}
+
+} // namespace internal
+
+// A closed axis-aligned box between two corner points. The default box is
+// empty: its minimum is above its maximum, so extending it by anything
+// yields that thing. Operations between boxes of the same type work on whole
+// points, which are single SIMD instructions for register-sized models.
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+class AABB {
+public:
+    constexpr AABB()
+    {
+        for (size_t i = 0; i < N; i++) {
+            min[i] = std::numeric_limits<T>::max();
+            max[i] = std::numeric_limits<T>::lowest();
+        }
+    }
+
+    constexpr AABB(const Point<M, T, N>& a, const Point<M, T, N>& b)
+        : min(internal::componentMin(a, b))
+        , max(internal::componentMax(b, a))
+    { }
+
+    constexpr bool empty() const
+    {
+        for (size_t i = 0; i < N; i++) {
+            if (max[i] < min[i]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <class U>
+    constexpr bool contains(const Point<M, U, N>& point) const
+    {
+        if constexpr (std::is_same_v<U, T>) {
+            return internal::componentsLessEqual(min, point) &&
+                internal::componentsLessEqual(point, max);
+        } else {
+            for (size_t i = 0; i < N; i++) {
+                if (!(min[i] <= point[i] && point[i] <= max[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    // Every box contains the empty box.
+    constexpr bool contains(const AABB& box) const
+    {
+        return internal::componentsLessEqual(min, box.min) &&
+            internal::componentsLessEqual(box.max, max);
+    }
+
+    // Whether the boxes share at least one point; touching boxes overlap.
+    constexpr bool overlaps(const AABB& box) const
+    {
+        return internal::componentsLessEqual(min, box.max) &&
+            internal::componentsLessEqual(box.min, max);
+    }
+
+    template <class U> requires std::is_convertible_v<U, T>
+    constexpr AABB& extend(const Point<M, U, N>& point)
+    {
+        if constexpr (std::is_same_v<U, T>) {
+            min = internal::componentMin(point, min);
+            max = internal::componentMax(point, max);
+        } else {
+            for (size_t i = 0; i < N; i++) {
+                if (point[i] < min[i]) {
+                    min[i] = point[i];
+                }
+                if (max[i] < point[i]) {
+                    max[i] = point[i];
+                }
+            }
+        }
+        return *this;
+    }
+
+    constexpr AABB& extend(const AABB& box)
+    {
+        min = internal::componentMin(box.min, min);
+        max = internal::componentMax(box.max, max);
+        return *this;
+    }
+
+    // Size along each axis; only meaningful for boxes that are not empty.
+    constexpr Vector<M, T, N> extent() const
+    {
+        return max - min;
+    }
+
+    constexpr Point<M, T, N> center() const
+    {
+        auto result = min;
+        for (size_t i = 0; i < N; i++) {
+            result[i] += (max[i] - min[i]) / 2;
+        }
+        return result;
+    }
+
+    Point<M, T, N> min;
+    Point<M, T, N> max;
+};
+
+// The smallest box containing both boxes.
+template <template <class> class M, class T, size_t N>
+constexpr AABB<M, T, N> merge(const AABB<M, T, N>& a, const AABB<M, T, N>& b)
+{
+    auto result = a;
+    return result.extend(b);
+}
+
+// The box of points in both boxes, which is empty() if they do not overlap.
+template <template <class> class M, class T, size_t N>
+constexpr AABB<M, T, N> intersection(
+    const AABB<M, T, N>& a, const AABB<M, T, N>& b)
+{
+    auto result = AABB<M, T, N>{};
+    result.min = internal::componentMax(a.min, b.min);
+    result.max = internal::componentMin(a.max, b.max);
+    return result;
+}
+
+template <template <class> class M, class U, class V, size_t N>
+constexpr bool operator==(const AABB<M, U, N>& lhs, const AABB<M, V, N>& rhs)
+{
+    return lhs.min == rhs.min && lhs.max == rhs.max;
+}
+
+template <template <class> class M, class U, class V, size_t N>
+constexpr bool operator!=(const AABB<M, U, N>& lhs, const AABB<M, V, N>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <template <class> class M, class T, size_t N>
+std::ostream& operator<<(std::ostream& output, const AABB<M, T, N>& box)
+{
+    return output << "{" << box.min << ", " << box.max << "}";
+}
+
+} // namespace ve
@@ -0,0 +1,238 @@
+#pragma once
+
+#include "ve/aabb.hpp"
+#include "ve/algorithms.hpp"
+#include "ve/internal/element.hpp"
+#include "ve/internal/traits.hpp"
+#include "ve/point.hpp"
+#include "ve/vector.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace ve {
+
+// A sequence of points or vectors that keeps its sum, mean and bounding box
+// up to date as values are inserted, erased and updated, so that reading
+// them takes constant time instead of a pass over every value.
+//
+// The values are stored contiguously, in blocks of leafSize that are the
+// leaves of a segment tree. Each node of the tree holds the sum and the box
+// of the values below it, so a change recomputes one leaf from its values
+// and the nodes on the way to the root, which holds the aggregates. Nodes
+// are recomputed from their children rather than adjusted by the change,
+// so sums do not drift however many changes are made: they only depend on
+// the current values and their order.
+//
+// Sums are accumulated in the element type for floating-point values and
+// in double for integer values, like centroid().
+template <class V>
+class AggregatedValues {
+    using Traits = internal::ValueTraits<V>;
+    using T = typename Traits::value_type;
+    static constexpr size_t n = Traits::size;
+
+public:
+    using value_type = V;
+    using scalar_type = internal::MeanType<internal::PromotedType<T>>;
+    using sum_type = typename internal::ValueTraits<
+        typename Traits::template rebindKind<Vector>>::template rebind<scalar_type>;
+    using mean_type = typename Traits::template rebind<scalar_type>;
+    using box_type = typename Traits::template rebindKind<AABB>;
+
+    static constexpr size_t leafSize = 16;
+
+    AggregatedValues()
+        : _nodes(2)
+    { }
+
+    template <class R>
+    requires internal::ContiguousRange<R> &&
+        std::is_same_v<internal::RangeValue<R>, V>
+    explicit AggregatedValues(const R& values)
+        : _values(std::ranges::begin(values), std::ranges::end(values))
+    {
+        rebuild(leavesFor(_values.size()));
+    }
+
+    size_t size() const
+    {
+        return _values.size();
+    }
+
+    bool empty() const
+    {
+        return _values.empty();
+    }
+
+    const V& operator[](size_t index) const
+    {
+        return _values[index];
+    }
+
+    std::span<const V> values() const
+    {
+        return _values;
+    }
+
+    void reserve(size_t count)
+    {
+        _values.reserve(count);
+        if (leavesFor(count) > leafCount()) {
+            rebuild(leavesFor(count));
+        }
+    }
+
+    void clear()
+    {
+        _values.clear();
+        rebuild(1);
+    }
+
+    // Appends a value and returns its index.
+    size_t insert(const V& value)
+    {
+        const size_t index = _values.size();
+        _values.push_back(value);
+        if (_values.size() > leafCount() * leafSize) {
+            rebuild(2 * leafCount());
+        } else {
+            refresh(index / leafSize);
+        }
+        return index;
+    }
+
+    // Removes the value at the index by moving the last value into its
+    // place, so only the index of the last value changes.
+    void erase(size_t index)
+    {
+        assert(index < _values.size());
+        const size_t last = _values.size() - 1;
+        _values[index] = _values[last];
+        _values.pop_back();
+        refresh(index / leafSize);
+        if (last / leafSize != index / leafSize) {
+            refresh(last / leafSize);
+        }
+    }
+
+    void update(size_t index, const V& value)
+    {
+        assert(index < _values.size());
+        _values[index] = value;
+        refresh(index / leafSize);
+    }
+
+    // The zero vector when there are no values.
+    const sum_type& sum() const
+    {
+        return _nodes[1].sum;
+    }
+
+    // The mean of the values, which is zero when there are none.
+    mean_type mean() const
+    {
+        auto result = mean_type{};
+        if (!_values.empty()) {
+            for (size_t c = 0; c < n; c++) {
+                result[c] = sum()[c] / static_cast<scalar_type>(_values.size());
+            }
+        }
+        return result;
+    }
+
+    // The centroid of the points, which is the origin when there are none.
+    mean_type centroid() const requires internal::PointTraits<V>::isPoint
+    {
+        return mean();
+    }
+
+    // The smallest box containing the values, taken as points. The box is
+    // empty when there are no values.
+    const box_type& bounds() const
+    {
+        return _nodes[1].box;
+    }
+
+private:
+    struct Node {
+        sum_type sum = {};
+        box_type box;
+    };
+
+    static size_t leavesFor(size_t count)
+    {
+        return std::bit_ceil(std::max<size_t>(1, (count + leafSize - 1) / leafSize));
+    }
+
+    // Leaves are the nodes from leafCount() to 2 * leafCount(), and node i
+    // has children 2i and 2i + 1.
+    size_t leafCount() const
+    {
+        return _nodes.size() / 2;
+    }
+
+    static Node combine(const Node& left, const Node& right)
+    {
+        auto result = left;
+        result.sum += right.sum;
+        result.box.extend(right.box);
+        return result;
+    }
+
+    Node leaf(size_t index) const
+    {
+        auto result = Node{};
+        const size_t first = std::min(_values.size(), index * leafSize);
+        const size_t last = std::min(_values.size(), first + leafSize);
+        for (size_t i = first; i < last; i++) {
+            if constexpr (internal::PointTraits<V>::isPoint) {
+                typename Traits::template rebindKind<Vector> vector;
+                for (size_t c = 0; c < n; c++) {
+                    vector[c] = _values[i][c];
+                }
+                result.sum += vector;
+                result.box.extend(_values[i]);
+            } else {
+                typename Traits::template rebindKind<Point> point;
+                for (size_t c = 0; c < n; c++) {
+                    point[c] = _values[i][c];
+                }
+                result.sum += _values[i];
+                result.box.extend(point);
+            }
+        }
+        return result;
+    }
+
+    void refresh(size_t index)
+    {
+        size_t node = leafCount() + index;
+        _nodes[node] = leaf(index);
+        for (node /= 2; node > 0; node /= 2) {
+            _nodes[node] = combine(_nodes[2 * node], _nodes[2 * node + 1]);
+        }
+    }
+
+    void rebuild(size_t leaves)
+    {
+        _nodes.assign(2 * leaves, Node{});
+        for (size_t i = 0; i * leafSize < _values.size(); i++) {
+            _nodes[leaves + i] = leaf(i);
+        }
+        for (size_t node = leaves - 1; node > 0; node--) {
+            _nodes[node] = combine(_nodes[2 * node], _nodes[2 * node + 1]);
+        }
+    }
+
+    std::vector<V> _values;
+    std::vector<Node> _nodes;
+};
+
+} // namespace ve
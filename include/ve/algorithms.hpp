@@ -0,0 +1,534 @@
+#pragma once
+
+#include "ve/aabb.hpp"
+#include "ve/batch.hpp"
+#include "ve/internal/traits.hpp"
+#include "ve/point.hpp"
+#include "ve/thread_pool.hpp"
+#include "ve/vector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace ve {
+
+namespace internal {
+
+// Ranges are reduced in blocks of a fixed size, independent of the number
+// of threads. Each block produces a partial result, and partial results are
+// combined in block order, so floating-point results do not depend on how
+// the work was scheduled.
+constexpr size_t reductionBlockSize = 16384;
+
+// Partial results of the blocks of a range, in block order.
+template <class Partial, class T, class Reduce>
+std::vector<Partial> blockPartials(
+    std::span<const T> values,
+    ThreadPool& pool,
+    const Partial& initial,
+    Reduce reduce)
+{
+    const size_t blocks =
+        (values.size() + reductionBlockSize - 1) / reductionBlockSize;
+    std::vector<Partial> partials(blocks, initial);
+    pool.run(blocks, [&] (size_t block) {
+        const size_t begin = block * reductionBlockSize;
+        const size_t count = std::min(reductionBlockSize, values.size() - begin);
+        partials[block] = reduce(values.subspan(begin, count));
+    });
+    return partials;
+}
+
+template <class Partial, class T, class Reduce, class Combine>
+Partial reduceBlocks(
+    std::span<const T> values,
+    ThreadPool& pool,
+    Partial initial,
+    Reduce reduce,
+    Combine combine)
+{
+    auto result = initial;
+    for (const auto& partial : blockPartials(values, pool, initial, reduce)) {
+        combine(result, partial);
+    }
+    return result;
+}
+
+template <class V>
+constexpr auto component(const V& value, size_t index)
+{
+    if constexpr (std::is_arithmetic_v<V>) {
+        return value;
+    } else {
+        return value[index];
+    }
+}
+
+// Sums components into a fixed number of interleaved lanes, which lets the
+// compiler vectorize the loop without reassociating floating-point
+// additions, and then folds the lanes in a fixed order.
+template <class Acc, size_t N, class V>
+std::array<Acc, N> sumComponents(std::span<const V> values)
+{
+    constexpr size_t lanes = 8;
+    Acc acc[lanes * N] = {};
+
+    size_t i = 0;
+    for (; i + lanes <= values.size(); i += lanes) {
+        for (size_t j = 0; j < lanes; j++) {
+            for (size_t c = 0; c < N; c++) {
+                acc[j * N + c] += static_cast<Acc>(component(values[i + j], c));
+            }
+        }
+    }
+    for (size_t j = 0; i < values.size(); i++, j++) {
+        for (size_t c = 0; c < N; c++) {
+            acc[j * N + c] += static_cast<Acc>(component(values[i], c));
+        }
+    }
+
+    for (size_t width = lanes / 2; width > 0; width /= 2) {
+        for (size_t j = 0; j < width; j++) {
+            for (size_t c = 0; c < N; c++) {
+                acc[j * N + c] += acc[(j + width) * N + c];
+            }
+        }
+    }
+
+    std::array<Acc, N> result;
+    std::copy(acc, acc + N, result.begin());
+    return result;
+}
+
+template <class Acc, size_t N>
+void addComponents(std::array<Acc, N>& result, const std::array<Acc, N>& partial)
+{
+    for (size_t c = 0; c < N; c++) {
+        result[c] += partial[c];
+    }
+}
+
+template <class T>
+using MeanType = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+
+template <class T>
+concept FloatingElement = std::is_floating_point_v<PromotedType<T>>;
+
+// Values below this count are summed directly by pairwiseSum(). A multiple
+// of the lane count of sumComponents(), and small enough that the error of
+// the direct sum stays within a few ulps.
+constexpr size_t pairwiseLeafSize = 256;
+
+template <class Acc, size_t N, class V>
+std::array<Acc, N> pairwiseSum(std::span<const V> values)
+{
+    if (values.size() <= pairwiseLeafSize) {
+        return sumComponents<Acc, N, V>(values);
+    }
+    const size_t half =
+        (values.size() / 2 + pairwiseLeafSize - 1) / pairwiseLeafSize *
+        pairwiseLeafSize;
+    auto result = pairwiseSum<Acc, N>(values.first(half));
+    addComponents(result, pairwiseSum<Acc, N>(values.subspan(half)));
+    return result;
+}
+
+// Adds the partial sums in a balanced tree, like pairwiseSum().
+template <class Acc, size_t N>
+std::array<Acc, N> pairwiseCombine(std::span<const std::array<Acc, N>> partials)
+{
+    if (partials.size() <= 1) {
+        return partials.empty() ? std::array<Acc, N>{} : partials[0];
+    }
+    const size_t half = partials.size() / 2;
+    auto result = pairwiseCombine<Acc, N>(partials.first(half));
+    addComponents(result, pairwiseCombine<Acc, N>(partials.subspan(half)));
+    return result;
+}
+
+// A sum with the rounding errors of its additions, which are added to the
+// sum once at the end.
+template <class Acc, size_t N>
+struct CompensatedSum {
+    std::array<Acc, N> sum = {};
+    std::array<Acc, N> compensation = {};
+};
+
+// Kahan-Neumaier summation: the rounding error of every addition is kept
+// in the compensation. The error is computed with Knuth's TwoSum, which is
+// exact whichever operand is larger and needs no comparison, so the lane
+// loops below vectorize. Compilers must not reassociate floating-point
+// additions (no -ffast-math or -fassociative-math), or the compensation is
+// optimized away.
+template <class Acc>
+VE_FORCE_INLINE void compensatedAdd(Acc& sum, Acc& compensation, Acc value)
+{
+    const Acc total = sum + value;
+    const Acc rounded = total - sum;
+    compensation += (sum - (total - rounded)) + (value - rounded);
+    sum = total;
+}
+
+template <class Acc, size_t N, class V>
+CompensatedSum<Acc, N> compensatedSum(std::span<const V> values)
+{
+    using T = typename ValueTraits<V>::value_type;
+    constexpr size_t lanes = 8;
+    Acc sum[lanes * N] = {};
+    Acc compensation[lanes * N] = {};
+
+    if constexpr (sizeof(V) == N * sizeof(T)) {
+        // Packed values are one flat array of components, and a single
+        // loop over it is what the compiler vectorizes.
+        const auto* flat = reinterpret_cast<const T*>(values.data());
+        const size_t total = values.size() * N;
+        size_t i = 0;
+        for (; i + lanes * N <= total; i += lanes * N) {
+            for (size_t k = 0; k < lanes * N; k++) {
+                compensatedAdd(
+                    sum[k], compensation[k], static_cast<Acc>(flat[i + k]));
+            }
+        }
+        for (size_t k = 0; i < total; i++, k++) {
+            compensatedAdd(sum[k], compensation[k], static_cast<Acc>(flat[i]));
+        }
+    } else {
+        size_t i = 0;
+        for (; i + lanes <= values.size(); i += lanes) {
+            for (size_t j = 0; j < lanes; j++) {
+                for (size_t c = 0; c < N; c++) {
+                    compensatedAdd(sum[j * N + c], compensation[j * N + c],
+                        static_cast<Acc>(values[i + j][c]));
+                }
+            }
+        }
+        for (size_t j = 0; i < values.size(); i++, j++) {
+            for (size_t c = 0; c < N; c++) {
+                compensatedAdd(sum[j * N + c], compensation[j * N + c],
+                    static_cast<Acc>(values[i][c]));
+            }
+        }
+    }
+
+    for (size_t width = lanes / 2; width > 0; width /= 2) {
+        for (size_t j = 0; j < width; j++) {
+            for (size_t c = 0; c < N; c++) {
+                compensatedAdd(sum[j * N + c], compensation[j * N + c],
+                    sum[(j + width) * N + c]);
+                compensation[j * N + c] += compensation[(j + width) * N + c];
+            }
+        }
+    }
+
+    auto result = CompensatedSum<Acc, N>{};
+    std::copy(sum, sum + N, result.sum.begin());
+    std::copy(compensation, compensation + N, result.compensation.begin());
+    return result;
+}
+
+template <class Acc, size_t N>
+void addCompensated(CompensatedSum<Acc, N>& result, const CompensatedSum<Acc, N>& partial)
+{
+    for (size_t c = 0; c < N; c++) {
+        compensatedAdd(result.sum[c], result.compensation[c], partial.sum[c]);
+        result.compensation[c] += partial.compensation[c];
+    }
+}
+
+} // namespace internal
+
+// How sums of floating-point values are accumulated. The error bounds are
+// for the relative error of a sum of n positive values.
+enum class Summation {
+    // Adds in the element type; the error grows linearly with n. Fastest.
+    Naive,
+    // Adds in a balanced tree of direct sums, with O(log n) error growth,
+    // at nearly the speed of Naive.
+    Pairwise,
+    // Compensated (Kahan-Neumaier) summation in the element type. The
+    // error is about one ulp, independent of n, at two to three times the
+    // cost of Naive.
+    Kahan,
+    // Accumulates in double and rounds the result to the element type.
+    // Exact to the element type for float sums below about 2^29 values.
+    Double,
+};
+
+namespace internal {
+
+template <class A, size_t N, class V>
+std::array<A, N> accumulate(
+    std::span<const V> values, Summation summation, ThreadPool& pool)
+{
+    switch (summation) {
+    case Summation::Pairwise:
+        return pairwiseCombine<A, N>(blockPartials(
+            values, pool, std::array<A, N>{}, pairwiseSum<A, N, V>));
+    case Summation::Kahan: {
+        const auto total = reduceBlocks(values, pool, CompensatedSum<A, N>{},
+            compensatedSum<A, N, V>, addCompensated<A, N>);
+        auto result = total.sum;
+        for (size_t c = 0; c < N; c++) {
+            result[c] += total.compensation[c];
+        }
+        return result;
+    }
+    default:
+        return reduceBlocks(values, pool, std::array<A, N>{},
+            sumComponents<A, N, V>, addComponents<A, N>);
+    }
+}
+
+// Components of the sum of the values divided by the divisor, accumulated
+// as the summation selects and rounded to R at the end.
+template <class R, size_t N, class V>
+std::array<R, N> summedComponents(
+    std::span<const V> values,
+    Summation summation,
+    ThreadPool& pool,
+    size_t divisor = 1)
+{
+    auto finish = [divisor] (const auto& total) {
+        using A = typename std::remove_cvref_t<decltype(total)>::value_type;
+        std::array<R, N> result;
+        for (size_t c = 0; c < N; c++) {
+            result[c] = static_cast<R>(total[c] / static_cast<A>(divisor));
+        }
+        return result;
+    };
+    if (summation == Summation::Double) {
+        return finish(accumulate<double, N>(values, summation, pool));
+    }
+    return finish(accumulate<R, N>(values, summation, pool));
+}
+
+} // namespace internal
+
+template <internal::VectorRange R>
+auto sum(const R& vectors, ThreadPool& pool = defaultThreadPool())
+{
+    using V = internal::RangeValue<R>;
+    using T = typename internal::VectorTraits<V>::value_type;
+    constexpr size_t n = internal::VectorTraits<V>::size;
+
+    auto components = internal::reduceBlocks(
+        std::span<const V>{internal::asSpan(vectors)},
+        pool,
+        std::array<T, n>{},
+        internal::sumComponents<T, n, V>,
+        internal::addComponents<T, n>);
+
+    V result;
+    for (size_t c = 0; c < n; c++) {
+        result[c] = components[c];
+    }
+    return result;
+}
+
+// The centroid is accumulated in the element type for floating-point points
+// and in double for integer points.
+template <internal::PointRange R>
+auto centroid(const R& points, ThreadPool& pool = defaultThreadPool())
+{
+    using P = internal::RangeValue<R>;
+    using A = internal::MeanType<typename internal::PointTraits<P>::value_type>;
+    constexpr size_t n = internal::PointTraits<P>::size;
+
+    auto input = std::span<const P>{internal::asSpan(points)};
+    auto components = internal::reduceBlocks(
+        input,
+        pool,
+        std::array<A, n>{},
+        internal::sumComponents<A, n, P>,
+        internal::addComponents<A, n>);
+
+    typename internal::PointTraits<P>::template rebind<A> result;
+    if (!input.empty()) {
+        for (size_t c = 0; c < n; c++) {
+            result[c] = components[c] / static_cast<A>(input.size());
+        }
+    }
+    return result;
+}
+
+// Sum of floating-point vectors, accumulated as selected. The result has
+// the element type of the input.
+template <internal::VectorRange R>
+requires internal::FloatingElement<
+    typename internal::VectorTraits<internal::RangeValue<R>>::value_type>
+auto sum(
+    const R& vectors,
+    Summation summation,
+    ThreadPool& pool = defaultThreadPool())
+{
+    using V = internal::RangeValue<R>;
+    using T = typename internal::VectorTraits<V>::value_type;
+    constexpr size_t n = internal::VectorTraits<V>::size;
+
+    auto components = internal::summedComponents<internal::PromotedType<T>, n>(
+        std::span<const V>{internal::asSpan(vectors)}, summation, pool);
+
+    V result;
+    for (size_t c = 0; c < n; c++) {
+        result[c] = components[c];
+    }
+    return result;
+}
+
+// Mean of floating-point vectors or points, accumulated as selected. The
+// result has the promoted element type, e.g. float for Half elements. The
+// mean of an empty range is zero.
+template <class R>
+requires (internal::VectorRange<R> || internal::PointRange<R>) &&
+    internal::FloatingElement<
+        typename internal::ValueTraits<internal::RangeValue<R>>::value_type>
+auto mean(
+    const R& values,
+    Summation summation = Summation::Pairwise,
+    ThreadPool& pool = defaultThreadPool())
+{
+    using V = internal::RangeValue<R>;
+    using T = internal::PromotedType<typename internal::ValueTraits<V>::value_type>;
+    constexpr size_t n = internal::ValueTraits<V>::size;
+
+    auto input = std::span<const V>{internal::asSpan(values)};
+    auto result = typename internal::ValueTraits<V>::template rebind<T>{};
+    if (input.empty()) {
+        return result;
+    }
+    auto components =
+        internal::summedComponents<T, n>(input, summation, pool, input.size());
+    for (size_t c = 0; c < n; c++) {
+        result[c] = components[c];
+    }
+    return result;
+}
+
+template <internal::PointRange R>
+requires internal::FloatingElement<
+    typename internal::PointTraits<internal::RangeValue<R>>::value_type>
+auto centroid(
+    const R& points, Summation summation, ThreadPool& pool = defaultThreadPool())
+{
+    return mean(points, summation, pool);
+}
+
+template <internal::PointRange R>
+auto bounds(const R& points, ThreadPool& pool = defaultThreadPool())
+{
+    using P = internal::RangeValue<R>;
+    using Box = typename internal::ValueTraits<P>::template rebindKind<AABB>;
+
+    return internal::reduceBlocks(
+        std::span<const P>{internal::asSpan(points)},
+        pool,
+        Box{},
+        [] (std::span<const P> block) {
+            auto box = Box{};
+            for (const auto& point : block) {
+                box.extend(point);
+            }
+            return box;
+        },
+        [] (Box& result, const Box& partial) {
+            if (!partial.empty()) {
+                result.extend(partial.min).extend(partial.max);
+            }
+        });
+}
+
+// Component-wise minimum and maximum. The result of an empty range holds
+// the largest (for componentMin) or lowest (for componentMax) value of the
+// element type.
+template <class R>
+requires internal::VectorRange<R> || internal::PointRange<R>
+auto componentMin(const R& values, ThreadPool& pool = defaultThreadPool())
+{
+    using V = internal::RangeValue<R>;
+    using T = typename internal::ValueTraits<V>::value_type;
+    constexpr size_t n = internal::ValueTraits<V>::size;
+
+    auto initial = V{};
+    for (size_t c = 0; c < n; c++) {
+        initial[c] = std::numeric_limits<T>::max();
+    }
+    return internal::reduceBlocks(
+        std::span<const V>{internal::asSpan(values)},
+        pool,
+        initial,
+        [initial] (std::span<const V> block) {
+            auto result = initial;
+            for (const auto& value : block) {
+                for (size_t c = 0; c < n; c++) {
+                    result[c] = std::min(result[c], value[c]);
+                }
+            }
+            return result;
+        },
+        [] (V& result, const V& partial) {
+            for (size_t c = 0; c < n; c++) {
+                result[c] = std::min(result[c], partial[c]);
+            }
+        });
+}
+
+template <class R>
+requires internal::VectorRange<R> || internal::PointRange<R>
+auto componentMax(const R& values, ThreadPool& pool = defaultThreadPool())
+{
+    using V = internal::RangeValue<R>;
+    using T = typename internal::ValueTraits<V>::value_type;
+    constexpr size_t n = internal::ValueTraits<V>::size;
+
+    auto initial = V{};
+    for (size_t c = 0; c < n; c++) {
+        initial[c] = std::numeric_limits<T>::lowest();
+    }
+    return internal::reduceBlocks(
+        std::span<const V>{internal::asSpan(values)},
+        pool,
+        initial,
+        [initial] (std::span<const V> block) {
+            auto result = initial;
+            for (const auto& value : block) {
+                for (size_t c = 0; c < n; c++) {
+                    result[c] = std::max(result[c], value[c]);
+                }
+            }
+            return result;
+        },
+        [] (V& result, const V& partial) {
+            for (size_t c = 0; c < n; c++) {
+                result[c] = std::max(result[c], partial[c]);
+            }
+        });
+}
+
+template <internal::VectorRange R>
+auto meanLength(const R& vectors, ThreadPool& pool = defaultThreadPool())
+{
+    using V = internal::RangeValue<R>;
+    using A = internal::MeanType<typename internal::VectorTraits<V>::value_type>;
+
+    auto input = std::span<const V>{internal::asSpan(vectors)};
+    auto total = internal::reduceBlocks(
+        input,
+        pool,
+        std::array<A, 1>{},
+        [] (std::span<const V> block) {
+            std::vector<A> norms(block.size());
+            lengths(block, norms);
+            return internal::sumComponents<A, 1>(std::span<const A>{norms});
+        },
+        internal::addComponents<A, 1>);
+
+    return input.empty() ? A{0} : total[0] / static_cast<A>(input.size());
+}
+
+} // namespace ve
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "ve/dispatch.hpp"
+#include "ve/internal/instrument.hpp"
+#include "ve/internal/kernels.hpp"
+#include "ve/internal/traits.hpp"
+#include "ve/point.hpp"
+#include "ve/vector.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <ranges>
+#include <type_traits>
+
+namespace ve {
+
+// Fast precision trades exactness for speed where the hardware allows it:
+// float square roots are computed from a refined reciprocal square root
+// estimate, with a relative error below 2^-21.
+enum class Precision {
+    Exact,
+    Fast,
+};
+
+template <internal::VectorRange In, internal::ScalarOutputRange Out>
+void squaredLengths(const In& vectors, Out&& squares)
+{
+    VE_TIME_KERNEL(SquaredLengths, std::ranges::size(vectors));
+    using R = std::ranges::range_value_t<Out>;
+    constexpr size_t n = internal::VectorTraits<internal::RangeValue<In>>::size;
+
+    auto in = internal::asSpan(vectors);
+    auto out = internal::asSpan(squares);
+    assert(in.size() == out.size());
+    internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+        for (size_t i = 0; i < in.size(); i++) {
+            auto sum = R{0};
+            for (size_t c = 0; c < n; c++) {
+                sum += static_cast<R>(in[i][c]) * static_cast<R>(in[i][c]);
+            }
+            out[i] = sum;
+        }
+    });
+}
+
+template <internal::VectorRange In, internal::ScalarOutputRange Out>
+void lengths(
+    const In& vectors, Out&& norms, Precision precision = Precision::Exact)
+{
+    VE_TIME_KERNEL(Lengths, std::ranges::size(vectors));
+    squaredLengths(vectors, norms);
+    auto out = internal::asSpan(norms);
+    internal::sqrtInPlace(out.data(), out.size(), precision == Precision::Fast);
+}
+
+template <internal::VectorRange A, internal::VectorRange B,
+    internal::ScalarOutputRange Out>
+void dots(const A& lhs, const B& rhs, Out&& products)
+{
+    VE_TIME_KERNEL(Dots, std::ranges::size(lhs));
+    using R = std::ranges::range_value_t<Out>;
+    constexpr size_t n = internal::VectorTraits<internal::RangeValue<A>>::size;
+
+    auto l = internal::asSpan(lhs);
+    auto r = internal::asSpan(rhs);
+    auto out = internal::asSpan(products);
+    assert(l.size() == r.size() && l.size() == out.size());
+    internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+        for (size_t i = 0; i < l.size(); i++) {
+            auto sum = R{0};
+            for (size_t c = 0; c < n; c++) {
+                sum += static_cast<R>(l[i][c]) * static_cast<R>(r[i][c]);
+            }
+            out[i] = sum;
+        }
+    });
+}
+
+template <internal::PointRange A, internal::PointRange B,
+    internal::ScalarOutputRange Out>
+void squaredDistances(const A& lhs, const B& rhs, Out&& squares)
+{
+    VE_TIME_KERNEL(SquaredDistances, std::ranges::size(lhs));
+    using R = std::ranges::range_value_t<Out>;
+    constexpr size_t n = internal::PointTraits<internal::RangeValue<A>>::size;
+
+    auto l = internal::asSpan(lhs);
+    auto r = internal::asSpan(rhs);
+    auto out = internal::asSpan(squares);
+    assert(l.size() == r.size() && l.size() == out.size());
+    internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+        for (size_t i = 0; i < l.size(); i++) {
+            auto sum = R{0};
+            for (size_t c = 0; c < n; c++) {
+                auto d = static_cast<R>(l[i][c]) - static_cast<R>(r[i][c]);
+                sum += d * d;
+            }
+            out[i] = sum;
+        }
+    });
+}
+
+template <internal::PointRange A, internal::PointRange B,
+    internal::ScalarOutputRange Out>
+void distances(
+    const A& lhs,
+    const B& rhs,
+    Out&& result,
+    Precision precision = Precision::Exact)
+{
+    VE_TIME_KERNEL(Distances, std::ranges::size(lhs));
+    squaredDistances(lhs, rhs, result);
+    auto out = internal::asSpan(result);
+    internal::sqrtInPlace(out.data(), out.size(), precision == Precision::Fast);
+}
+
+// Zero vectors stay zero, like in unit().
+template <internal::VectorRange In, internal::VectorOutputRange Out>
+void normalize(
+    const In& vectors, Out&& units, Precision precision = Precision::Exact)
+{
+    VE_TIME_KERNEL(Normalize, std::ranges::size(vectors));
+    using V = std::ranges::range_value_t<Out>;
+    using R = typename internal::VectorTraits<V>::value_type;
+    constexpr size_t n = internal::VectorTraits<V>::size;
+    constexpr size_t blockSize = 256;
+
+    auto in = internal::asSpan(vectors);
+    auto out = internal::asSpan(units);
+    assert(in.size() == out.size());
+
+    R scales[blockSize];
+    for (size_t start = 0; start < in.size(); start += blockSize) {
+        const size_t count = std::min(blockSize, in.size() - start);
+        squaredLengths(in.subspan(start, count), std::span{scales, count});
+        internal::inverseSqrtInPlace(
+            scales, count, precision == Precision::Fast);
+        internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+            for (size_t i = 0; i < count; i++) {
+                for (size_t c = 0; c < n; c++) {
+                    out[start + i][c] =
+                        static_cast<R>(in[start + i][c]) * scales[i];
+                }
+            }
+        });
+    }
+}
+
+namespace internal {
+
+template <class A, class B, class Out>
+concept AddableRanges = VectorRange<B> &&
+    ((VectorRange<A> && VectorOutputRange<Out>) ||
+        (PointRange<A> && PointOutputRange<Out>));
+
+} // namespace internal
+
+// Adds vectors to vectors, or translates points by vectors. Computation is
+// done in the component type of the output, which may alias an input.
+template <class A, class B, class Out>
+requires internal::AddableRanges<A, B, Out>
+void add(const A& lhs, const B& rhs, Out&& sums)
+{
+    VE_TIME_KERNEL(Add, std::ranges::size(lhs));
+    using R = typename internal::ValueTraits<
+        std::ranges::range_value_t<Out>>::value_type;
+    constexpr size_t n = internal::VectorTraits<internal::RangeValue<B>>::size;
+
+    auto l = internal::asSpan(lhs);
+    auto r = internal::asSpan(rhs);
+    auto out = internal::asSpan(sums);
+    assert(l.size() == r.size() && l.size() == out.size());
+    internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+        for (size_t i = 0; i < l.size(); i++) {
+            for (size_t c = 0; c < n; c++) {
+                out[i][c] = static_cast<R>(l[i][c]) + static_cast<R>(r[i][c]);
+            }
+        }
+    });
+}
+
+// Multiplies vectors by a scalar, in the component type of the output, which
+// may alias the input.
+template <internal::VectorRange In, class S, internal::VectorOutputRange Out>
+requires std::is_arithmetic_v<S>
+void scale(const In& vectors, S factor, Out&& scaled)
+{
+    VE_TIME_KERNEL(Scale, std::ranges::size(vectors));
+    using R = typename internal::VectorTraits<
+        std::ranges::range_value_t<Out>>::value_type;
+    constexpr size_t n = internal::VectorTraits<internal::RangeValue<In>>::size;
+
+    auto in = internal::asSpan(vectors);
+    auto out = internal::asSpan(scaled);
+    assert(in.size() == out.size());
+    const auto f = static_cast<R>(factor);
+    internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+        for (size_t i = 0; i < in.size(); i++) {
+            for (size_t c = 0; c < n; c++) {
+                out[i][c] = static_cast<R>(in[i][c]) * f;
+            }
+        }
+    });
+}
+
+} // namespace ve
@@ -0,0 +1,692 @@
+#pragma once
+
+#include "ve/aabb.hpp"
+#include "ve/internal/traits.hpp"
+#include "ve/point.hpp"
+#include "ve/thread_pool.hpp"
+#include "ve/vector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ve {
+
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+struct Ray {
+    Point<M, T, N> origin;
+    Vector<M, T, N> direction;
+};
+
+struct BvhOptions {
+    // Nodes with at most this many boxes become leaves when splitting them
+    // does not pay off by the surface area heuristic; larger ones always
+    // split.
+    size_t leafSize = 4;
+    // Candidate split planes per axis are the boundaries between this many
+    // bins of box centers.
+    size_t binCount = 16;
+    // Builds independent subtrees on the pool; null builds on the calling
+    // thread.
+    ThreadPool* pool = nullptr;
+};
+
+// A bounding volume hierarchy over a set of boxes, for finding boxes that
+// overlap a query box or are hit by a ray. Like KdTree, the tree keeps its
+// own copy of the boxes in leaf order and stores nodes in a flat array in
+// depth-first order (the left child of a node immediately follows it).
+// Results refer to indices in the original set of boxes.
+//
+// The builder splits nodes at the best of binCount candidate planes per axis
+// by the surface area heuristic, so the cost of a query is close to that of
+// an exhaustive SAH build at a fraction of the build time. refit() updates
+// the boxes without changing the tree, which is cheaper than a rebuild for
+// objects that move a little between queries.
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+requires std::floating_point<T>
+class Bvh {
+public:
+    using box_type = AABB<M, T, N>;
+    using ray_type = Ray<M, T, N>;
+
+    // Interior nodes have count == 0 and their right child at index first.
+    // Leaves hold boxes first to first + count of the tree's own order.
+    struct Node {
+        box_type box;
+        std::uint32_t first;
+        std::uint32_t count;
+
+        bool leaf() const
+        {
+            return count != 0;
+        }
+    };
+
+    struct Hit {
+        size_t index;
+        // Distance along the ray, in multiples of its direction.
+        T distance;
+    };
+
+    Bvh() = default;
+
+    template <class Range>
+    requires std::is_same_v<internal::RangeValue<Range>, box_type>
+    explicit Bvh(const Range& boxes, const BvhOptions& options = {})
+    {
+        auto input = internal::asSpan(boxes);
+        assert(input.size() < std::numeric_limits<std::uint32_t>::max());
+        _indices.resize(input.size());
+        std::iota(_indices.begin(), _indices.end(), std::uint32_t{0});
+        if (!input.empty()) {
+            Builder{input, options, _indices}.build(_nodes);
+        }
+        _boxes.resize(input.size());
+        for (size_t i = 0; i < input.size(); i++) {
+            _boxes[i] = input[_indices[i]];
+        }
+    }
+
+    size_t size() const
+    {
+        return _boxes.size();
+    }
+
+    bool empty() const
+    {
+        return _boxes.empty();
+    }
+
+    std::span<const Node> nodes() const
+    {
+        return _nodes;
+    }
+
+    // Replaces the boxes, which must be as many as the tree was built with,
+    // and recomputes the node boxes bottom up.
+    template <class Range>
+    requires std::is_same_v<internal::RangeValue<Range>, box_type>
+    void refit(const Range& boxes)
+    {
+        auto input = internal::asSpan(boxes);
+        assert(input.size() == _boxes.size());
+        for (size_t i = 0; i < input.size(); i++) {
+            _boxes[i] = input[_indices[i]];
+        }
+        // Children follow their parent, so a backward pass sees them first.
+        for (size_t i = _nodes.size(); i-- > 0;) {
+            auto& node = _nodes[i];
+            if (node.leaf()) {
+                node.box = box_type{};
+                for (auto j = node.first; j < node.first + node.count; j++) {
+                    node.box.extend(_boxes[j]);
+                }
+            } else {
+                node.box = merge(_nodes[i + 1].box, _nodes[node.first].box);
+            }
+        }
+    }
+
+    // Appends indices of all boxes that overlap the query box.
+    void overlapping(const box_type& box, std::vector<size_t>& result) const
+    {
+        visitOverlapping(box, [&result] (size_t index) {
+            result.push_back(index);
+        });
+    }
+
+    std::vector<size_t> overlapping(const box_type& box) const
+    {
+        std::vector<size_t> result;
+        overlapping(box, result);
+        return result;
+    }
+
+    template <class Range>
+    requires std::is_same_v<internal::RangeValue<Range>, box_type>
+    std::vector<std::vector<size_t>> overlapping(
+        const Range& boxes, ThreadPool& pool = defaultThreadPool()) const
+    {
+        auto input = internal::asSpan(boxes);
+        std::vector<std::vector<size_t>> result(input.size());
+        parallelFor(pool, input.size(), 64, [&] (size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                overlapping(input[i], result[i]);
+            }
+        });
+        return result;
+    }
+
+    // All pairs (i, j) with i < j of boxes that overlap each other, sorted.
+    // This is the broad phase of collision detection.
+    std::vector<std::pair<size_t, size_t>> overlappingPairs(
+        ThreadPool& pool = defaultThreadPool()) const
+    {
+        using Pairs = std::vector<std::pair<size_t, size_t>>;
+        const size_t grainSize = 256;
+        std::vector<Pairs> chunks((size() + grainSize - 1) / grainSize);
+        pool.run(chunks.size(), [&] (size_t chunk) {
+            const size_t end = std::min(size(), (chunk + 1) * grainSize);
+            for (size_t i = chunk * grainSize; i < end; i++) {
+                const size_t index = _indices[i];
+                visitOverlapping(_boxes[i], [&] (size_t other) {
+                    if (index < other) {
+                        chunks[chunk].emplace_back(index, other);
+                    }
+                });
+            }
+        });
+
+        Pairs result;
+        size_t total = 0;
+        for (const auto& pairs : chunks) {
+            total += pairs.size();
+        }
+        result.reserve(total);
+        for (const auto& pairs : chunks) {
+            result.insert(result.end(), pairs.begin(), pairs.end());
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    // The box closest to the ray origin that the ray hits within
+    // maxDistance. A ray starting inside a box hits it at distance 0.
+    std::optional<Hit> raycast(
+        const ray_type& ray,
+        T maxDistance = std::numeric_limits<T>::infinity()) const
+    {
+        return raycast(ray, maxDistance,
+            [] (size_t, T entry, T) { return std::optional<T>{entry}; });
+    }
+
+    // Like raycast(), but the objects in the boxes decide whether they are
+    // hit: intersect(index, entry, maxDistance) is called for each box the
+    // ray enters at distance entry before the closest hit so far, and
+    // returns the distance of the hit, if any.
+    template <class Intersect>
+    std::optional<Hit> raycast(
+        const ray_type& ray, T maxDistance, Intersect&& intersect) const
+    {
+        std::optional<Hit> closest;
+        if (empty()) {
+            return closest;
+        }
+        const auto inverse = RaySlabs{ray};
+        std::array<std::pair<std::uint32_t, T>, maxDepth> stack;
+        size_t top = 0;
+        if (auto entry = inverse.entry(_nodes[0].box, maxDistance)) {
+            stack[top++] = {0, *entry};
+        }
+        while (top > 0) {
+            const auto [index, entry] = stack[--top];
+            if (entry > maxDistance) {
+                continue;
+            }
+            const auto& node = _nodes[index];
+            if (node.leaf()) {
+                for (auto i = node.first; i < node.first + node.count; i++) {
+                    auto boxEntry = inverse.entry(_boxes[i], maxDistance);
+                    if (!boxEntry) {
+                        continue;
+                    }
+                    auto distance = intersect(size_t{_indices[i]}, *boxEntry, maxDistance);
+                    if (distance && *distance <= maxDistance) {
+                        maxDistance = *distance;
+                        closest = Hit{_indices[i], *distance};
+                    }
+                }
+                continue;
+            }
+            // Visits the nearer child first, so that its hits prune the
+            // other one.
+            auto left = inverse.entry(_nodes[index + 1].box, maxDistance);
+            auto right = inverse.entry(_nodes[node.first].box, maxDistance);
+            if (left && right && *right < *left) {
+                stack[top++] = {index + 1, *left};
+                stack[top++] = {node.first, *right};
+            } else {
+                if (right) {
+                    stack[top++] = {node.first, *right};
+                }
+                if (left) {
+                    stack[top++] = {index + 1, *left};
+                }
+            }
+        }
+        return closest;
+    }
+
+    template <class Range>
+    requires std::is_same_v<internal::RangeValue<Range>, ray_type>
+    std::vector<std::optional<Hit>> raycast(
+        const Range& rays,
+        T maxDistance = std::numeric_limits<T>::infinity(),
+        ThreadPool& pool = defaultThreadPool()) const
+    {
+        auto input = internal::asSpan(rays);
+        std::vector<std::optional<Hit>> result(input.size());
+        parallelFor(pool, input.size(), 64, [&] (size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                result[i] = raycast(input[i], maxDistance);
+            }
+        });
+        return result;
+    }
+
+private:
+    // The builder switches to median splits below this depth of SAH splits,
+    // which bounds the depth of the tree by that plus log2 of its size.
+    static constexpr size_t maxSahDepth = 48;
+    static constexpr size_t maxDepth = maxSahDepth + 34;
+
+    // Ray traversal with the inverse of the direction. Components of the
+    // direction that are zero give infinite or NaN slab distances; NaN
+    // compares false and leaves the interval unchanged, so a ray parallel
+    // to a slab is inside it exactly when its origin is.
+    struct RaySlabs {
+        explicit RaySlabs(const ray_type& ray)
+            : origin(ray.origin)
+        {
+            for (size_t i = 0; i < N; i++) {
+                inverse[i] = T{1} / ray.direction[i];
+            }
+        }
+
+        // Distance at which the ray enters the box, if it does so before
+        // maxDistance.
+        std::optional<T> entry(const box_type& box, T maxDistance) const
+        {
+            T near = 0;
+            T far = maxDistance;
+            for (size_t i = 0; i < N; i++) {
+                const T a = (box.min[i] - origin[i]) * inverse[i];
+                const T b = (box.max[i] - origin[i]) * inverse[i];
+                const T low = b < a ? b : a;
+                const T high = b < a ? a : b;
+                near = low > near ? low : near;
+                far = high < far ? high : far;
+            }
+            if (near <= far) {
+                return near;
+            }
+            return std::nullopt;
+        }
+
+        Point<M, T, N> origin;
+        T inverse[N];
+    };
+
+    template <class Visit>
+    void visitOverlapping(const box_type& box, Visit&& visit) const
+    {
+        if (empty()) {
+            return;
+        }
+        std::array<std::uint32_t, maxDepth> stack;
+        size_t top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const auto& node = _nodes[stack[--top]];
+            if (!node.box.overlaps(box)) {
+                continue;
+            }
+            if (node.leaf()) {
+                for (auto i = node.first; i < node.first + node.count; i++) {
+                    if (_boxes[i].overlaps(box)) {
+                        visit(size_t{_indices[i]});
+                    }
+                }
+                continue;
+            }
+            const auto left = static_cast<std::uint32_t>(&node - _nodes.data()) + 1;
+            stack[top++] = node.first;
+            stack[top++] = left;
+        }
+    }
+
+    // Top-down binned SAH builder. With a pool, the top of the tree is split
+    // on the calling thread until there are enough subtrees for the pool,
+    // the subtrees are built in parallel into their own node arrays, and the
+    // arrays are then spliced into place.
+    class Builder {
+    public:
+        Builder(
+            std::span<const box_type> boxes,
+            const BvhOptions& options,
+            std::vector<std::uint32_t>& indices)
+            : _boxes(boxes)
+            , _indices(indices)
+            , _leafSize(std::max<size_t>(options.leafSize, 1))
+            , _binCount(std::clamp<size_t>(options.binCount, 2, maxBinCount))
+            , _pool(options.pool)
+        {
+            _centers.resize(boxes.size());
+            auto center = [this] (size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    _centers[i] = _boxes[i].center();
+                }
+            };
+            if (_pool) {
+                parallelFor(*_pool, boxes.size(), 4096, center);
+            } else {
+                center(0, boxes.size());
+            }
+        }
+
+        void build(std::vector<Node>& nodes)
+        {
+            const auto count = static_cast<std::uint32_t>(_indices.size());
+            if (!_pool || _pool->size() == 1) {
+                nodes.reserve(2 * (count / _leafSize) + 1);
+                buildSubtree(nodes, 0, count, 0);
+                return;
+            }
+
+            // Subtrees below this size are left to a single thread.
+            const size_t taskSize = std::max<size_t>(
+                count / (_pool->size() * 8), 4096);
+            std::vector<Task> tasks;
+            buildTop(nodes, 0, count, 0, taskSize, tasks);
+            _pool->run(tasks.size(), [&] (size_t i) {
+                auto& task = tasks[i];
+                buildSubtree(task.nodes, task.begin, task.end, task.depth);
+            });
+
+            // Splices each subtree in place of its placeholder leaf, in
+            // depth-first order: a node's right child index moves by the
+            // size of the subtrees spliced before it.
+            std::vector<Node> result;
+            result.reserve(nodes.size() + [&] {
+                size_t total = 0;
+                for (const auto& task : tasks) {
+                    total += task.nodes.size();
+                }
+                return total;
+            }());
+            std::vector<std::uint32_t> position(nodes.size());
+            size_t taskIndex = 0;
+            for (size_t i = 0; i < nodes.size(); i++) {
+                position[i] = static_cast<std::uint32_t>(result.size());
+                if (taskIndex < tasks.size() && tasks[taskIndex].node == i) {
+                    const auto base = static_cast<std::uint32_t>(result.size());
+                    for (auto node : tasks[taskIndex].nodes) {
+                        if (!node.leaf()) {
+                            node.first += base;
+                        }
+                        result.push_back(node);
+                    }
+                    taskIndex++;
+                } else {
+                    result.push_back(nodes[i]);
+                }
+            }
+            for (size_t i = 0; i < nodes.size(); i++) {
+                if (!nodes[i].leaf()) {
+                    result[position[i]].first = position[nodes[i].first];
+                }
+            }
+            nodes = std::move(result);
+        }
+
+    private:
+        static constexpr size_t maxBinCount = 64;
+
+        struct Task {
+            size_t node;
+            std::uint32_t begin;
+            std::uint32_t end;
+            size_t depth;
+            std::vector<Node> nodes;
+        };
+
+        // The left child gets the boxes whose centers are in bins up to and
+        // including bin.
+        struct Split {
+            size_t axis;
+            size_t bin;
+            T low;
+            T scale;
+        };
+
+        box_type bounds(std::uint32_t begin, std::uint32_t end) const
+        {
+            auto box = box_type{};
+            for (auto i = begin; i < end; i++) {
+                box.extend(_boxes[_indices[i]]);
+            }
+            return box;
+        }
+
+        // Splits the top of the tree on the calling thread. Subtrees small
+        // enough for one task get a placeholder leaf that build() replaces.
+        void buildTop(
+            std::vector<Node>& nodes,
+            std::uint32_t begin,
+            std::uint32_t end,
+            size_t depth,
+            size_t taskSize,
+            std::vector<Task>& tasks)
+        {
+            if (end - begin <= taskSize) {
+                tasks.push_back(Task{nodes.size(), begin, end, depth, {}});
+                nodes.push_back(Node{box_type{}, begin, end - begin});
+                return;
+            }
+            const auto index = nodes.size();
+            nodes.push_back(Node{bounds(begin, end), 0, 0});
+            const auto middle = partition(nodes[index].box, begin, end, depth);
+            if (middle == begin) {
+                nodes[index].first = begin;
+                nodes[index].count = end - begin;
+                return;
+            }
+            buildTop(nodes, begin, middle, depth + 1, taskSize, tasks);
+            nodes[index].first = static_cast<std::uint32_t>(nodes.size());
+            buildTop(nodes, middle, end, depth + 1, taskSize, tasks);
+        }
+
+        void buildSubtree(
+            std::vector<Node>& nodes,
+            std::uint32_t begin,
+            std::uint32_t end,
+            size_t depth)
+        {
+            const auto index = nodes.size();
+            nodes.push_back(Node{bounds(begin, end), begin, end - begin});
+            const auto middle = partition(nodes[index].box, begin, end, depth);
+            if (middle == begin) {
+                return;
+            }
+            nodes[index].count = 0;
+            buildSubtree(nodes, begin, middle, depth + 1);
+            nodes[index].first = static_cast<std::uint32_t>(nodes.size());
+            buildSubtree(nodes, middle, end, depth + 1);
+        }
+
+        // Reorders the indices of a node with the given bounds so that the
+        // left child gets [begin, middle) and returns middle, or begin if
+        // the node should be a leaf.
+        std::uint32_t partition(
+            const box_type& box,
+            std::uint32_t begin,
+            std::uint32_t end,
+            size_t depth)
+        {
+            const size_t count = end - begin;
+            if (count <= 1) {
+                return begin;
+            }
+
+            auto centers = box_type{};
+            for (auto i = begin; i < end; i++) {
+                centers.extend(_centers[_indices[i]]);
+            }
+
+            if (depth < maxSahDepth) {
+                if (auto split = bestSplit(box, centers, begin, end, count)) {
+                    auto middle = std::partition(
+                        _indices.begin() + begin, _indices.begin() + end,
+                        [&] (std::uint32_t i) {
+                            return binIndex(_centers[i][split->axis],
+                                split->low, split->scale) <= split->bin;
+                        });
+                    return static_cast<std::uint32_t>(middle - _indices.begin());
+                }
+                if (count <= _leafSize) {
+                    return begin;
+                }
+            } else if (count <= _leafSize) {
+                return begin;
+            }
+
+            // Median split along the widest axis of the centers, for nodes
+            // whose centers cannot be separated by planes (all equal) or
+            // that are too deep.
+            size_t axis = 0;
+            for (size_t i = 1; i < N; i++) {
+                if (centers.max[i] - centers.min[i] >
+                        centers.max[axis] - centers.min[axis]) {
+                    axis = i;
+                }
+            }
+            const auto middle = begin + static_cast<std::uint32_t>(count / 2);
+            std::nth_element(
+                _indices.begin() + begin,
+                _indices.begin() + middle,
+                _indices.begin() + end,
+                [this, axis] (std::uint32_t a, std::uint32_t b) {
+                    return _centers[a][axis] < _centers[b][axis];
+                });
+            return middle;
+        }
+
+        // The split plane with the lowest SAH cost, if there is one that
+        // beats a leaf or the node is too large for a leaf. Nodes with no
+        // area have no useful split planes.
+        std::optional<Split> bestSplit(
+            const box_type& box,
+            const box_type& centers,
+            std::uint32_t begin,
+            std::uint32_t end,
+            size_t count) const
+        {
+            struct Bin {
+                box_type box;
+                size_t count = 0;
+            };
+
+            // Costs relative to the node: a leaf costs one per box, an
+            // interior node one for its own box test plus its children,
+            // weighted by the probability of a ray or query hitting them.
+            const T area = halfArea(box);
+            if (!(area > 0)) {
+                return std::nullopt;
+            }
+            auto bestCost = count <= _leafSize ?
+                static_cast<T>(count) : std::numeric_limits<T>::max();
+            std::optional<Split> best;
+
+            std::array<Bin, maxBinCount> bins;
+            std::array<T, maxBinCount> rightCosts;
+            for (size_t axis = 0; axis < N; axis++) {
+                const T low = centers.min[axis];
+                const T extent = centers.max[axis] - low;
+                if (!(extent > 0)) {
+                    continue;
+                }
+                const T scale = static_cast<T>(_binCount) / extent;
+                std::fill(bins.begin(), bins.begin() + _binCount, Bin{});
+                for (auto i = begin; i < end; i++) {
+                    const auto index = _indices[i];
+                    auto& bin = bins[binIndex(_centers[index][axis], low, scale)];
+                    bin.box.extend(_boxes[index]);
+                    bin.count++;
+                }
+
+                // Right-hand costs of the planes after each bin, then a
+                // sweep from the left.
+                auto rightBox = box_type{};
+                size_t rightCount = 0;
+                for (size_t b = _binCount - 1; b > 0; b--) {
+                    rightBox.extend(bins[b].box);
+                    rightCount += bins[b].count;
+                    rightCosts[b - 1] = rightCount == 0 ?
+                        T{0} : halfArea(rightBox) * static_cast<T>(rightCount);
+                }
+                auto leftBox = box_type{};
+                size_t leftCount = 0;
+                for (size_t b = 0; b + 1 < _binCount; b++) {
+                    leftBox.extend(bins[b].box);
+                    leftCount += bins[b].count;
+                    if (leftCount == 0 || leftCount == count) {
+                        continue;
+                    }
+                    const T cost = 1 + (halfArea(leftBox) *
+                        static_cast<T>(leftCount) + rightCosts[b]) / area;
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        best = Split{axis, b, low, scale};
+                    }
+                }
+            }
+            return best;
+        }
+
+        size_t binIndex(T center, T low, T scale) const
+        {
+            const auto bin = static_cast<size_t>((center - low) * scale);
+            return std::min(bin, _binCount - 1);
+        }
+
+        // Half the surface area of the box (the sum of the areas of the
+        // faces meeting at one corner), or the sum of its extents for N < 3.
+        static T halfArea(const box_type& box)
+        {
+            if (box.empty()) {
+                return 0;
+            }
+            const auto extent = box.extent();
+            if constexpr (N < 3) {
+                T sum = 0;
+                for (size_t i = 0; i < N; i++) {
+                    sum += extent[i];
+                }
+                return sum;
+            } else {
+                T sum = 0;
+                for (size_t i = 0; i < N; i++) {
+                    for (size_t j = i + 1; j < N; j++) {
+                        sum += extent[i] * extent[j];
+                    }
+                }
+                return sum;
+            }
+        }
+
+        std::span<const box_type> _boxes;
+        std::vector<std::uint32_t>& _indices;
+        std::vector<Point<M, T, N>> _centers;
+        size_t _leafSize;
+        size_t _binCount;
+        ThreadPool* _pool;
+    };
+
+    std::vector<box_type> _boxes;
+    std::vector<std::uint32_t> _indices;
+    std::vector<Node> _nodes;
+};
+
+} // namespace ve
@@ -0,0 +1,426 @@
+#pragma once
+
+#include "ve/internal/element.hpp"
+#include "ve/internal/simd.hpp"
+#include "ve/internal/traits.hpp"
+#include "ve/point.hpp"
+#include "ve/vector.hpp"
+
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+// Compact element types for Vector and Point: IEEE 754 half precision
+// (Half), bfloat16 (BFloat16) and integer fixed point with a compile-time
+// scale (Fixed). They are meant for storage: values convert implicitly to
+// and from float, and all arithmetic on them is done in float, so
+// Vector<M, Half> + Vector<M, Half> is a Vector<M, float>. Fixed with a
+// 32-bit representation converts to and computes in double instead, which
+// holds every one of its values exactly.
+
+namespace ve {
+
+namespace internal {
+
+// Round-to-nearest-even conversions between float and half precision bits,
+// after F. Giesen, "float->half variants". Overflow gives infinity, NaN stays
+// NaN (quiet). All cases are computed and then combined with bit masks, so
+// loops over these conversions vectorize.
+constexpr std::uint32_t select(bool condition, std::uint32_t a, std::uint32_t b)
+{
+    const std::uint32_t mask = 0u - static_cast<std::uint32_t>(condition);
+    return (a & mask) | (b & ~mask);
+}
+
+constexpr std::uint16_t floatToHalf(float value)
+{
+    constexpr std::uint32_t infinity = 255u << 23;
+    constexpr std::uint32_t halfOverflow = (127u + 16) << 23;
+    constexpr std::uint32_t halfNormal = (127u - 14) << 23;
+    constexpr std::uint32_t denormalMagic = ((127u - 15) + (23 - 10) + 1) << 23;
+
+    auto bits = std::bit_cast<std::uint32_t>(value);
+    const std::uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    const std::uint32_t special = select(bits > infinity, 0x7e00, 0x7c00);
+    const std::uint32_t subnormal = std::bit_cast<std::uint32_t>(
+        std::bit_cast<float>(bits) + std::bit_cast<float>(denormalMagic)) - denormalMagic;
+    const std::uint32_t normal =
+        (bits + ((15u - 127) << 23) + 0xfff + ((bits >> 13) & 1)) >> 13;
+
+    const std::uint32_t result = select(bits >= halfOverflow, special,
+        select(bits < halfNormal, subnormal, normal));
+    return static_cast<std::uint16_t>(result | (sign >> 16));
+}
+
+constexpr float halfToFloat(std::uint16_t half)
+{
+    constexpr std::uint32_t exponentMask = 0x7c00u << 13;
+    constexpr float magic = std::bit_cast<float>(113u << 23);
+
+    const std::uint32_t shifted = (half & 0x7fffu) << 13;
+    const std::uint32_t exponent = shifted & exponentMask;
+    const std::uint32_t normal = shifted + ((127u - 15) << 23);
+    const std::uint32_t special = normal + ((128u - 16) << 23);
+    const std::uint32_t subnormal = std::bit_cast<std::uint32_t>(
+        std::bit_cast<float>(normal + (1u << 23)) - magic);
+
+    const std::uint32_t bits = select(exponent == exponentMask, special,
+        select(exponent == 0, subnormal, normal));
+    return std::bit_cast<float>(bits | (std::uint32_t{half} & 0x8000u) << 16);
+}
+
+constexpr std::uint16_t floatToBFloat16(float value)
+{
+    const auto bits = std::bit_cast<std::uint32_t>(value);
+    const std::uint32_t nan = (bits >> 16) | 0x40;
+    const std::uint32_t rounded = (bits + 0x7fff + ((bits >> 16) & 1)) >> 16;
+    return static_cast<std::uint16_t>(
+        select((bits & 0x7fffffffu) > 0x7f800000u, nan, rounded));
+}
+
+constexpr float bfloat16ToFloat(std::uint16_t bfloat)
+{
+    return std::bit_cast<float>(std::uint32_t{bfloat} << 16);
+}
+
+// Compound assignment for compact types: the operation is done in the
+// promoted types and the result is converted back.
+template <class Derived>
+class CompactArithmetic {
+public:
+    template <Arithmetic U>
+    constexpr Derived& operator+=(const U& rhs)
+    {
+        return self() = static_cast<PromotedType<Derived>>(self()) +
+            static_cast<PromotedType<U>>(rhs);
+    }
+
+    template <Arithmetic U>
+    constexpr Derived& operator-=(const U& rhs)
+    {
+        return self() = static_cast<PromotedType<Derived>>(self()) -
+            static_cast<PromotedType<U>>(rhs);
+    }
+
+    template <Arithmetic U>
+    constexpr Derived& operator*=(const U& rhs)
+    {
+        return self() = static_cast<PromotedType<Derived>>(self()) *
+            static_cast<PromotedType<U>>(rhs);
+    }
+
+    template <Arithmetic U>
+    constexpr Derived& operator/=(const U& rhs)
+    {
+        return self() = static_cast<PromotedType<Derived>>(self()) /
+            static_cast<PromotedType<U>>(rhs);
+    }
+
+private:
+    constexpr Derived& self()
+    {
+        return static_cast<Derived&>(*this);
+    }
+};
+
+} // namespace internal
+
+class Half : public internal::CompactArithmetic<Half> {
+public:
+    Half() = default;
+
+    template <class U> requires std::is_arithmetic_v<U>
+    constexpr Half(U value)
+        : _bits(internal::floatToHalf(static_cast<float>(value)))
+    { }
+
+    static constexpr Half fromBits(std::uint16_t bits)
+    {
+        Half half;
+        half._bits = bits;
+        return half;
+    }
+
+    constexpr std::uint16_t bits() const
+    {
+        return _bits;
+    }
+
+    constexpr operator float() const
+    {
+        return internal::halfToFloat(_bits);
+    }
+
+private:
+    std::uint16_t _bits;
+};
+
+class BFloat16 : public internal::CompactArithmetic<BFloat16> {
+public:
+    BFloat16() = default;
+
+    template <class U> requires std::is_arithmetic_v<U>
+    constexpr BFloat16(U value)
+        : _bits(internal::floatToBFloat16(static_cast<float>(value)))
+    { }
+
+    static constexpr BFloat16 fromBits(std::uint16_t bits)
+    {
+        BFloat16 bfloat;
+        bfloat._bits = bits;
+        return bfloat;
+    }
+
+    constexpr std::uint16_t bits() const
+    {
+        return _bits;
+    }
+
+    constexpr operator float() const
+    {
+        return internal::bfloat16ToFloat(_bits);
+    }
+
+private:
+    std::uint16_t _bits;
+};
+
+// A fixed-point number stored as round(value * Scale) in Rep. Values outside
+// the representable range saturate, and NaN is stored as zero.
+template <std::integral Rep, std::uint32_t Scale>
+class Fixed : public internal::CompactArithmetic<Fixed<Rep, Scale>> {
+    static_assert(Scale > 0);
+    static_assert(sizeof(Rep) <= 4);
+
+    // 32-bit representations convert through double so that every
+    // representable value round-trips. This is also their promoted type.
+    using Compute = std::conditional_t<sizeof(Rep) <= 2, float, double>;
+    friend struct internal::Promoted<Fixed>;
+
+public:
+    using rep = Rep;
+    static constexpr std::uint32_t scale = Scale;
+
+    Fixed() = default;
+
+    template <class U> requires std::is_arithmetic_v<U>
+    constexpr Fixed(U value)
+        : _raw(quantize(static_cast<Compute>(value)))
+    { }
+
+    static constexpr Fixed fromRaw(Rep raw)
+    {
+        Fixed fixed;
+        fixed._raw = raw;
+        return fixed;
+    }
+
+    constexpr Rep raw() const
+    {
+        return _raw;
+    }
+
+    constexpr operator Compute() const
+    {
+        return static_cast<Compute>(_raw) / Scale;
+    }
+
+private:
+    static constexpr Rep quantize(Compute value)
+    {
+        constexpr auto lowest = static_cast<Compute>(std::numeric_limits<Rep>::lowest());
+        constexpr auto highest = static_cast<Compute>(std::numeric_limits<Rep>::max());
+        // Rounding before clamping keeps the loops in quantize() branch-free.
+        value *= Scale;
+        value += value < 0 ? Compute{-0.5} : Compute{0.5};
+        value = value == value ? value : Compute{0};
+        value = value < lowest ? lowest : value;
+        value = value > highest ? highest : value;
+        return static_cast<Rep>(value);
+    }
+
+    Rep _raw;
+};
+
+namespace internal {
+
+template <>
+struct Promoted<Half> {
+    using type = float;
+};
+
+template <>
+struct Promoted<BFloat16> {
+    using type = float;
+};
+
+template <class Rep, std::uint32_t Scale>
+struct Promoted<Fixed<Rep, Scale>> {
+    using type = typename Fixed<Rep, Scale>::Compute;
+};
+
+template <class T>
+concept Compact = Arithmetic<T> && !std::is_arithmetic_v<T>;
+
+// Component type and count of the values in a range of scalars, vectors or
+// points.
+template <class V>
+struct Components {
+    using type = V;
+    static constexpr size_t size = 1;
+};
+
+template <class V> requires VectorTraits<V>::isVector || PointTraits<V>::isPoint
+struct Components<V> {
+    using type = typename ValueTraits<V>::value_type;
+    static constexpr size_t size = ValueTraits<V>::size;
+};
+
+template <class From, class To>
+void convertComponents(const From* in, To* out, size_t count)
+{
+    size_t i = 0;
+#ifdef VE_SIMD_F16C
+    if constexpr (std::is_same_v<From, float> && std::is_same_v<To, Half>) {
+        for (; i + 8 <= count; i += 8) {
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(out + i),
+                _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+        }
+    }
+    if constexpr (std::is_same_v<From, Half> && std::is_same_v<To, float>) {
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = static_cast<To>(static_cast<PromotedType<From>>(in[i]));
+    }
+}
+
+template <class In, class Out>
+concept ConvertibleRanges =
+    ContiguousRange<In> && OutputRange<Out> &&
+    Components<RangeValue<In>>::size == Components<std::ranges::range_value_t<Out>>::size &&
+    (VectorTraits<RangeValue<In>>::isVector ==
+        VectorTraits<std::ranges::range_value_t<Out>>::isVector) &&
+    (PointTraits<RangeValue<In>>::isPoint ==
+        PointTraits<std::ranges::range_value_t<Out>>::isPoint);
+
+template <class In, class Out>
+void convertValues(const In& input, Out&& output)
+{
+    using V = RangeValue<In>;
+    using W = std::ranges::range_value_t<Out>;
+    using From = typename Components<V>::type;
+    using To = typename Components<W>::type;
+    constexpr size_t n = Components<V>::size;
+
+    auto in = asSpan(input);
+    auto out = asSpan(output);
+    assert(in.size() == out.size());
+    if constexpr (sizeof(V) == n * sizeof(From) && sizeof(W) == n * sizeof(To)) {
+        convertComponents(
+            reinterpret_cast<const From*>(in.data()),
+            reinterpret_cast<To*>(out.data()),
+            in.size() * n);
+    } else {
+        for (size_t i = 0; i < in.size(); i++) {
+            convertComponents(&in[i][0], &out[i][0], n);
+        }
+    }
+}
+
+} // namespace internal
+
+// Converts a contiguous range of scalars, vectors or points with built-in
+// element types into one with compact element types. Padded layouts are
+// converted element by element; packed ones are converted as one flat array
+// of components.
+template <class In, class Out>
+requires internal::ConvertibleRanges<In, Out> &&
+    std::is_arithmetic_v<typename internal::Components<internal::RangeValue<In>>::type> &&
+    internal::Compact<typename internal::Components<std::ranges::range_value_t<Out>>::type>
+void quantize(const In& input, Out&& output)
+{
+    internal::convertValues(input, output);
+}
+
+// The inverse of quantize().
+template <class In, class Out>
+requires internal::ConvertibleRanges<In, Out> &&
+    internal::Compact<typename internal::Components<internal::RangeValue<In>>::type> &&
+    std::is_arithmetic_v<typename internal::Components<std::ranges::range_value_t<Out>>::type>
+void dequantize(const In& input, Out&& output)
+{
+    internal::convertValues(input, output);
+}
+
+} // namespace ve
+
+template <>
+class std::numeric_limits<ve::Half> {
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = false;
+    static constexpr bool has_infinity = true;
+    static constexpr bool has_quiet_NaN = true;
+    static constexpr int digits = 11;
+
+    static constexpr ve::Half min() { return ve::Half::fromBits(0x0400); }
+    static constexpr ve::Half max() { return ve::Half::fromBits(0x7bff); }
+    static constexpr ve::Half lowest() { return ve::Half::fromBits(0xfbff); }
+    static constexpr ve::Half epsilon() { return ve::Half::fromBits(0x1400); }
+    static constexpr ve::Half infinity() { return ve::Half::fromBits(0x7c00); }
+    static constexpr ve::Half quiet_NaN() { return ve::Half::fromBits(0x7e00); }
+};
+
+template <>
+class std::numeric_limits<ve::BFloat16> {
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = false;
+    static constexpr bool has_infinity = true;
+    static constexpr bool has_quiet_NaN = true;
+    static constexpr int digits = 8;
+
+    static constexpr ve::BFloat16 min() { return ve::BFloat16::fromBits(0x0080); }
+    static constexpr ve::BFloat16 max() { return ve::BFloat16::fromBits(0x7f7f); }
+    static constexpr ve::BFloat16 lowest() { return ve::BFloat16::fromBits(0xff7f); }
+    static constexpr ve::BFloat16 epsilon() { return ve::BFloat16::fromBits(0x3c00); }
+    static constexpr ve::BFloat16 infinity() { return ve::BFloat16::fromBits(0x7f80); }
+    static constexpr ve::BFloat16 quiet_NaN() { return ve::BFloat16::fromBits(0x7fc0); }
+};
+
+template <class Rep, std::uint32_t Scale>
+class std::numeric_limits<ve::Fixed<Rep, Scale>> {
+    using Fixed = ve::Fixed<Rep, Scale>;
+
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = std::numeric_limits<Rep>::is_signed;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = true;
+    static constexpr bool has_infinity = false;
+    static constexpr bool has_quiet_NaN = false;
+    static constexpr int digits = std::numeric_limits<Rep>::digits;
+
+    static constexpr Fixed min() { return Fixed::fromRaw(1); }
+    static constexpr Fixed max() { return Fixed::fromRaw(std::numeric_limits<Rep>::max()); }
+    static constexpr Fixed lowest() { return Fixed::fromRaw(std::numeric_limits<Rep>::lowest()); }
+    static constexpr Fixed epsilon() { return Fixed::fromRaw(1); }
+};
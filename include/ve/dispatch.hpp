@@ -0,0 +1,209 @@
+#pragma once
+
+#include "ve/internal/simd.hpp"
+#include "ve/internal/unroll.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+// The batch functions are compiled once for the instruction set of the
+// program and, with GCC and Clang on x86, once more for AVX2 and for
+// AVX-512. The version that runs is picked on first use from what the CPU
+// supports. The VE_ISA environment variable (baseline, sse2, avx2 or avx512)
+// or setIsa() can lower it, for instance to test every version on one
+// machine. Other compilers and targets always run the baseline version.
+//
+// VE_TARGET_AVX is defined when functions using AVX intrinsics can be
+// compiled, either because the whole program uses AVX or for dispatch.
+//
+// Multiplications and additions are not fused in the AVX2 and AVX-512
+// versions, so exact results are the same as with the baseline version and
+// the functions on single values; only Precision::Fast results depend on the
+// version. (Clang fuses them in the AVX-512 version, where AVX-512 implies
+// FMA and contraction cannot be turned off for a single function.)
+#if defined(VE_SIMD_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#   define VE_DISPATCH
+#   include <immintrin.h>
+#   ifdef VE_SIMD_AVX
+#       define VE_TARGET_AVX
+#   else
+#       define VE_TARGET_AVX __attribute__((target("avx")))
+#   endif
+#   define VE_TARGET_AVX2 __attribute__((target("avx2")))
+#   define VE_TARGET_AVX512 \
+        __attribute__((target("avx2,avx512f,avx512vl,avx512bw,avx512dq")))
+    // Below -O3, GCC does not unroll the loops over the components of each
+    // value before vectorizing, and leaves the loops over values scalar.
+    // The AVX2 and AVX-512 versions exist to be vectorized, so optimized
+    // builds compile them with the options of -O3, which vectorizes them
+    // from -O2 up. Options from two optimize attributes do not add up, so
+    // they are given together.
+#   if defined(__clang__)
+#       define VE_OPTIMIZE_DISPATCH
+#       define VE_OPTIMIZE_DISPATCH_NO_CONTRACT
+#   elif defined(__OPTIMIZE__)
+#       define VE_OPTIMIZE_DISPATCH __attribute__((optimize("O3")))
+#       define VE_OPTIMIZE_DISPATCH_NO_CONTRACT \
+            __attribute__((optimize("O3", "fp-contract=off")))
+#   else
+#       define VE_OPTIMIZE_DISPATCH
+#       define VE_OPTIMIZE_DISPATCH_NO_CONTRACT \
+            __attribute__((optimize("fp-contract=off")))
+#   endif
+#elif defined(VE_SIMD_AVX)
+#   define VE_TARGET_AVX
+#endif
+
+namespace ve {
+
+// Instruction sets with their own version of the batch functions, in
+// increasing order. Baseline is what the program was compiled for: SSE2 on
+// a default x86-64 build.
+enum class Isa {
+    Baseline,
+    Avx2,
+    Avx512,
+};
+
+constexpr std::string_view name(Isa isa)
+{
+    switch (isa) {
+    case Isa::Avx2:
+        return "avx2";
+    case Isa::Avx512:
+        return "avx512";
+    case Isa::Baseline:
+        break;
+    }
+    return "baseline";
+}
+
+namespace internal {
+
+inline Isa detectIsa()
+{
+#ifdef VE_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") &&
+            __builtin_cpu_supports("avx512bw") &&
+            __builtin_cpu_supports("avx512dq")) {
+        return Isa::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Isa::Avx2;
+    }
+#endif
+    return Isa::Baseline;
+}
+
+inline std::optional<Isa> parseIsa(std::string_view text)
+{
+    if (text == "baseline" || text == "sse2") {
+        return Isa::Baseline;
+    }
+    if (text == "avx2") {
+        return Isa::Avx2;
+    }
+    if (text == "avx512") {
+        return Isa::Avx512;
+    }
+    return std::nullopt;
+}
+
+struct IsaState {
+    IsaState()
+        : supported(detectIsa())
+        , active(supported)
+    {
+        // Unknown names are ignored rather than failing in a static
+        // initializer.
+        if (const char* value = std::getenv("VE_ISA")) {
+            if (auto requested = parseIsa(value)) {
+                active = std::min(*requested, supported);
+            }
+        }
+    }
+
+    const Isa supported;
+    std::atomic<Isa> active;
+};
+
+inline IsaState& isaState()
+{
+    static IsaState state;
+    return state;
+}
+
+template <Isa I>
+using IsaConstant = std::integral_constant<Isa, I>;
+
+#ifdef VE_DISPATCH
+
+// Flattening inlines the whole kernel, including the functions it calls,
+// so that all of it is compiled for the target. AVX-512 has fused
+// multiply-adds of its own, which are turned off like in the baseline.
+template <class Kernel>
+[[gnu::flatten]] VE_TARGET_AVX2 VE_OPTIMIZE_DISPATCH void runAvx2(Kernel& kernel)
+{
+    kernel(IsaConstant<Isa::Avx2>{});
+}
+
+template <class Kernel>
+[[gnu::flatten]] VE_TARGET_AVX512 VE_OPTIMIZE_DISPATCH_NO_CONTRACT
+void runAvx512(Kernel& kernel)
+{
+    kernel(IsaConstant<Isa::Avx512>{});
+}
+
+#endif
+
+// Runs kernel(IsaConstant<isa>) compiled for the active instruction set.
+// The kernel is a generic lambda, so that each instruction set gets its
+// own instantiation, and should be force inlined.
+template <class Kernel>
+VE_FORCE_INLINE void dispatch(Kernel&& kernel)
+{
+#ifdef VE_DISPATCH
+    switch (isaState().active.load(std::memory_order_relaxed)) {
+    case Isa::Avx512:
+        runAvx512(kernel);
+        return;
+    case Isa::Avx2:
+        runAvx2(kernel);
+        return;
+    case Isa::Baseline:
+        break;
+    }
+#endif
+    kernel(IsaConstant<Isa::Baseline>{});
+}
+
+} // namespace internal
+
+// The best instruction set this CPU supports.
+inline Isa supportedIsa()
+{
+    return internal::isaState().supported;
+}
+
+// The instruction set the batch functions currently run with.
+inline Isa activeIsa()
+{
+    return internal::isaState().active.load(std::memory_order_relaxed);
+}
+
+// Makes the batch functions run with the given instruction set, or the best
+// supported one if the CPU lacks it, and returns the one that is used.
+// Calls running in other threads finish with the previous one.
+inline Isa setIsa(Isa isa)
+{
+    const auto active = std::min(isa, supportedIsa());
+    internal::isaState().active.store(active, std::memory_order_relaxed);
+    return active;
+}
+
+} // namespace ve
@@ -0,0 +1,285 @@
+#pragma once
+
+#include "ve/point.hpp"
+#include "ve/vector.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace ve {
+
+// A lazily evaluated Vector or Point. Arithmetic on expressions only builds
+// a new expression; components are computed in a single pass when the
+// expression is converted to a Vector/Point (by assignment, initialization
+// or eval()). Expressions refer to their Vector/Point leaves, so they must
+// be evaluated while those are alive.
+template <
+    template <template <class> class, class, size_t> class Kind,
+    template <class> class M,
+    class T,
+    size_t N,
+    class F>
+class Expression {
+public:
+    using value_type = T;
+
+    constexpr explicit Expression(F f)
+        : _f(std::move(f))
+    { }
+
+    constexpr T operator[](size_t i) const
+    {
+        return _f(i);
+    }
+
+    template <class U> requires std::is_convertible_v<T, U>
+    constexpr operator Kind<M, U, N>() const
+    {
+        Kind<M, U, N> result;
+        for (size_t i = 0; i < N; i++) {
+            result[i] = static_cast<U>(_f(i));
+        }
+        return result;
+    }
+
+private:
+    F _f;
+};
+
+namespace internal {
+
+template <template <class> class M, size_t N>
+struct ExpressionModel {
+    template <
+        template <template <class> class, class, size_t> class Kind,
+        class F>
+    static constexpr auto make(F f)
+    {
+        using T = decltype(f(size_t{}));
+        return Expression<Kind, M, T, N, F>{std::move(f)};
+    }
+};
+
+template <class E>
+struct Operand {
+    static constexpr bool valid = false;
+};
+
+template <template <class> class M, class T, size_t N>
+struct Operand<Vector<M, T, N>> {
+    static constexpr bool valid = true;
+    static constexpr bool lazy = false;
+    static constexpr bool point = false;
+    using Model = ExpressionModel<M, N>;
+};
+
+template <template <class> class M, class T, size_t N>
+struct Operand<Point<M, T, N>> {
+    static constexpr bool valid = true;
+    static constexpr bool lazy = false;
+    static constexpr bool point = true;
+    using Model = ExpressionModel<M, N>;
+};
+
+template <
+    template <template <class> class, class, size_t> class Kind,
+    template <class> class M,
+    class T,
+    size_t N,
+    class F>
+struct Operand<Expression<Kind, M, T, N, F>> {
+    static constexpr bool valid = true;
+    static constexpr bool lazy = true;
+    static constexpr bool point = std::is_same_v<Kind<M, T, N>, Point<M, T, N>>;
+    using Model = ExpressionModel<M, N>;
+};
+
+template <class E>
+concept VectorOperand = Operand<E>::valid && !Operand<E>::point;
+
+template <class E>
+concept PointOperand = Operand<E>::valid && Operand<E>::point;
+
+template <class E>
+concept LazyVector = VectorOperand<E> && Operand<E>::lazy;
+
+template <class L, class R>
+concept LazyOperands = Operand<L>::valid && Operand<R>::valid &&
+    (Operand<L>::lazy || Operand<R>::lazy) &&
+    std::same_as<typename Operand<L>::Model, typename Operand<R>::Model>;
+
+template <class E>
+constexpr auto reference(const E& operand)
+{
+    if constexpr (Operand<E>::lazy) {
+        return operand;
+    } else if constexpr (Operand<E>::point) {
+        return Operand<E>::Model::template make<Point>(
+            [&operand] (size_t i) { return operand[i]; });
+    } else {
+        return Operand<E>::Model::template make<Vector>(
+            [&operand] (size_t i) { return operand[i]; });
+    }
+}
+
+template <
+    template <template <class> class, class, size_t> class Kind,
+    class L,
+    class R,
+    class Op>
+constexpr auto combine(const L& lhs, const R& rhs, Op op)
+{
+    return Operand<L>::Model::template make<Kind>(
+        [l = reference(lhs), r = reference(rhs), op] (size_t i) {
+            return op(l[i], r[i]);
+        });
+}
+
+} // namespace internal
+
+template <template <class> class M, class T, size_t N>
+constexpr auto lazy(const Vector<M, T, N>& vector)
+{
+    return internal::reference(vector);
+}
+
+template <template <class> class M, class T, size_t N>
+constexpr auto lazy(const Point<M, T, N>& point)
+{
+    return internal::reference(point);
+}
+
+template <
+    template <template <class> class, class, size_t> class Kind,
+    template <class> class M,
+    class T,
+    size_t N,
+    class F>
+constexpr Kind<M, T, N> eval(const Expression<Kind, M, T, N, F>& expression)
+{
+    return expression;
+}
+
+template <class L, class R>
+requires internal::LazyOperands<L, R> &&
+    internal::VectorOperand<L> && internal::VectorOperand<R>
+constexpr auto operator+(const L& lhs, const R& rhs)
+{
+    return internal::combine<Vector>(
+        lhs, rhs, [] (const auto& a, const auto& b) { return a + b; });
+}
+
+template <class L, class R>
+requires internal::LazyOperands<L, R> &&
+    internal::PointOperand<L> && internal::VectorOperand<R>
+constexpr auto operator+(const L& lhs, const R& rhs)
+{
+    return internal::combine<Point>(
+        lhs, rhs, [] (const auto& a, const auto& b) { return a + b; });
+}
+
+template <class L, class R>
+requires internal::LazyOperands<L, R> &&
+    internal::VectorOperand<L> && internal::VectorOperand<R>
+constexpr auto operator-(const L& lhs, const R& rhs)
+{
+    return internal::combine<Vector>(
+        lhs, rhs, [] (const auto& a, const auto& b) { return a - b; });
+}
+
+template <class L, class R>
+requires internal::LazyOperands<L, R> &&
+    internal::PointOperand<L> && internal::VectorOperand<R>
+constexpr auto operator-(const L& lhs, const R& rhs)
+{
+    return internal::combine<Point>(
+        lhs, rhs, [] (const auto& a, const auto& b) { return a - b; });
+}
+
+template <class L, class R>
+requires internal::LazyOperands<L, R> &&
+    internal::PointOperand<L> && internal::PointOperand<R>
+constexpr auto operator-(const L& lhs, const R& rhs)
+{
+    return internal::combine<Vector>(
+        lhs, rhs, [] (const auto& a, const auto& b) { return a - b; });
+}
+
+template <internal::LazyVector E>
+constexpr auto operator-(const E& expression)
+{
+    using T = typename E::value_type;
+    return internal::Operand<E>::Model::template make<Vector>(
+        [expression] (size_t i) { return static_cast<T>(-expression[i]); });
+}
+
+template <internal::LazyVector E, class S>
+requires (!internal::Operand<S>::valid)
+constexpr auto operator*(const E& expression, const S& scalar)
+{
+    return internal::Operand<E>::Model::template make<Vector>(
+        [expression, scalar] (size_t i) { return expression[i] * scalar; });
+}
+
+template <internal::LazyVector E, class S>
+requires (!internal::Operand<S>::valid)
+constexpr auto operator*(const S& scalar, const E& expression)
+{
+    return expression * scalar;
+}
+
+template <internal::LazyVector E, class S>
+requires (!internal::Operand<S>::valid)
+constexpr auto operator/(const E& expression, const S& scalar)
+{
+    return internal::Operand<E>::Model::template make<Vector>(
+        [expression, scalar] (size_t i) { return expression[i] / scalar; });
+}
+
+template <template <class> class M, class T, size_t N, class U, class F>
+requires std::is_convertible_v<U, T>
+constexpr Vector<M, T, N>& operator+=(
+    Vector<M, T, N>& vector, const Expression<Vector, M, U, N, F>& expression)
+{
+    for (size_t i = 0; i < N; i++) {
+        vector[i] += expression[i];
+    }
+    return vector;
+}
+
+template <template <class> class M, class T, size_t N, class U, class F>
+requires std::is_convertible_v<U, T>
+constexpr Vector<M, T, N>& operator-=(
+    Vector<M, T, N>& vector, const Expression<Vector, M, U, N, F>& expression)
+{
+    for (size_t i = 0; i < N; i++) {
+        vector[i] -= expression[i];
+    }
+    return vector;
+}
+
+template <template <class> class M, class T, size_t N, class U, class F>
+requires std::is_convertible_v<U, T>
+constexpr Point<M, T, N>& operator+=(
+    Point<M, T, N>& point, const Expression<Vector, M, U, N, F>& expression)
+{
+    for (size_t i = 0; i < N; i++) {
+        point[i] += expression[i];
+    }
+    return point;
+}
+
+template <template <class> class M, class T, size_t N, class U, class F>
+requires std::is_convertible_v<U, T>
+constexpr Point<M, T, N>& operator-=(
+    Point<M, T, N>& point, const Expression<Vector, M, U, N, F>& expression)
+{
+    for (size_t i = 0; i < N; i++) {
+        point[i] -= expression[i];
+    }
+    return point;
+}
+
+} // namespace ve
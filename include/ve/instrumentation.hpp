@@ -0,0 +1,180 @@
+#pragma once
+
+#include "ve/internal/instrument.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ostream>
+#include <string_view>
+
+#ifdef VE_ENABLE_INSTRUMENTATION
+    #include <mutex>
+#endif
+
+namespace ve {
+
+// Hot-path instrumentation. Defining VE_ENABLE_INSTRUMENTATION for the whole
+// program makes the operators and functions of vector.hpp and point.hpp
+// count what they do, and the batch kernels of batch.hpp time themselves.
+// Every thread counts into its own counters; instrumentationReport() adds
+// them up. Without the macro the instrumentation points compile to nothing,
+// and reports are all zero.
+#ifdef VE_ENABLE_INSTRUMENTATION
+constexpr bool instrumentationEnabled = true;
+#else
+constexpr bool instrumentationEnabled = false;
+#endif
+
+struct KernelStats {
+    std::uint64_t calls = 0;
+    // Sum of the batch sizes of all calls.
+    std::uint64_t items = 0;
+    // Wall time, including kernels called by this one.
+    std::chrono::nanoseconds time{0};
+};
+
+struct InstrumentationReport {
+    std::uint64_t operator[](Operation operation) const
+    {
+        return operations[static_cast<size_t>(operation)];
+    }
+
+    const KernelStats& operator[](Kernel kernel) const
+    {
+        return kernels[static_cast<size_t>(kernel)];
+    }
+
+    std::array<std::uint64_t, operationCount> operations = {};
+    std::array<KernelStats, kernelCount> kernels = {};
+};
+
+constexpr std::string_view name(Operation operation)
+{
+    constexpr std::string_view names[] = {
+        "vector.add",
+        "vector.subtract",
+        "vector.negate",
+        "vector.multiply",
+        "vector.divide",
+        "vector.compare",
+        "vector.order",
+        "dot",
+        "squared-length",
+        "length",
+        "unit",
+        "point.translate",
+        "point.difference",
+        "point.compare",
+        "squared-distance",
+        "distance",
+        "sqrt",
+        "conversion",
+        "temporary",
+    };
+    static_assert(std::size(names) == operationCount);
+    return names[static_cast<size_t>(operation)];
+}
+
+constexpr std::string_view name(Kernel kernel)
+{
+    constexpr std::string_view names[] = {
+        "squared-lengths",
+        "lengths",
+        "dots",
+        "squared-distances",
+        "distances",
+        "normalize",
+        "add",
+        "scale",
+        "pairwise-squared-distances",
+        "pairwise-distances",
+        "pairs-within-radius",
+    };
+    static_assert(std::size(names) == kernelCount);
+    return names[static_cast<size_t>(kernel)];
+}
+
+// Counts of all threads since the start of the program or the last
+// resetInstrumentation(). Counts of running threads are read while they
+// may still change, so they are exact only for threads that are idle.
+inline InstrumentationReport instrumentationReport()
+{
+    auto report = InstrumentationReport{};
+#ifdef VE_ENABLE_INSTRUMENTATION
+    auto& registry = internal::instrumentationRegistry();
+    auto lock = std::lock_guard{registry.mutex};
+    auto counts = registry.retired;
+    for (const auto* thread : registry.threads) {
+        thread->addTo(counts);
+    }
+    for (size_t i = 0; i < operationCount; i++) {
+        report.operations[i] =
+            counts.operations[i] - registry.baseline.operations[i];
+    }
+    for (size_t i = 0; i < kernelCount; i++) {
+        const auto& total = counts.kernels[i];
+        const auto& baseline = registry.baseline.kernels[i];
+        report.kernels[i] = {
+            total.calls - baseline.calls,
+            total.items - baseline.items,
+            std::chrono::nanoseconds{
+                static_cast<std::int64_t>(total.nanoseconds - baseline.nanoseconds)},
+        };
+    }
+#endif
+    return report;
+}
+
+// Starts counting from zero. Threads keep counting into their own counters,
+// so this is safe while other threads are running.
+inline void resetInstrumentation()
+{
+#ifdef VE_ENABLE_INSTRUMENTATION
+    auto& registry = internal::instrumentationRegistry();
+    auto lock = std::lock_guard{registry.mutex};
+    auto counts = registry.retired;
+    for (const auto* thread : registry.threads) {
+        thread->addTo(counts);
+    }
+    registry.baseline = counts;
+#endif
+}
+
+namespace internal {
+
+inline void writeReportName(std::ostream& output, std::string_view name)
+{
+    constexpr size_t width = 20;
+    output << name;
+    for (size_t i = name.size(); i < width; i++) {
+        output.put(' ');
+    }
+}
+
+} // namespace internal
+
+// One line per operation or kernel that was used.
+inline std::ostream& operator<<(
+    std::ostream& output, const InstrumentationReport& report)
+{
+    for (size_t i = 0; i < operationCount; i++) {
+        if (report.operations[i] > 0) {
+            internal::writeReportName(output, name(static_cast<Operation>(i)));
+            output << report.operations[i] << "\n";
+        }
+    }
+    for (size_t i = 0; i < kernelCount; i++) {
+        const auto& kernel = report.kernels[i];
+        if (kernel.calls > 0) {
+            internal::writeReportName(output, name(static_cast<Kernel>(i)));
+            output << kernel.calls << " calls, " << kernel.items << " items, " <<
+                kernel.time.count() << " ns\n";
+        }
+    }
+    return output;
+}
+
+} // namespace ve
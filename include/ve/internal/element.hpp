@@ -0,0 +1,21 @@
+#pragma once
+
+#include <type_traits>
+
+namespace ve::internal {
+
+// Element types that are not built-in arithmetic types (such as the compact
+// storage types in ve/compact.hpp) specialize Promoted to name the built-in
+// type their values convert to and are computed in.
+template <class T>
+struct Promoted {
+    using type = T;
+};
+
+template <class T>
+using PromotedType = typename Promoted<T>::type;
+
+template <class T>
+concept Arithmetic = std::is_arithmetic_v<PromotedType<T>>;
+
+} // namespace ve::internal
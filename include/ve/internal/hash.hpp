@@ -0,0 +1,59 @@
+#pragma once
+
+#include "ve/internal/element.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace ve::internal {
+
+// Bits of a component for hashing. Values that compare equal give equal
+// bits: -0.0 and +0.0 are folded together, and compact element types are
+// hashed by their promoted value.
+template <class T>
+constexpr std::uint64_t hashBits(const T& value)
+{
+    if constexpr (!std::is_arithmetic_v<T>) {
+        return hashBits(static_cast<PromotedType<T>>(value));
+    } else if constexpr (std::is_same_v<T, float>) {
+        return std::bit_cast<std::uint32_t>(value == 0 ? 0.f : value);
+    } else if constexpr (std::is_same_v<T, double>) {
+        return std::bit_cast<std::uint64_t>(value == 0 ? 0.0 : value);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return hashBits(static_cast<double>(value));
+    } else {
+        return static_cast<std::uint64_t>(value);
+    }
+}
+
+// Multiply-xorshift mixing of one 64-bit word into a running hash, with the
+// murmur3 finalizer applied at the end.
+constexpr std::uint64_t hashCombine(std::uint64_t seed, std::uint64_t bits)
+{
+    seed = (seed ^ bits) * 0x9e3779b97f4a7c15u;
+    return seed ^ (seed >> 29);
+}
+
+constexpr std::uint64_t hashFinish(std::uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdu;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53u;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+template <size_t N, class V>
+constexpr size_t hashComponents(const V& value)
+{
+    std::uint64_t hash = N;
+    for (size_t i = 0; i < N; i++) {
+        hash = hashCombine(hash, hashBits(value[i]));
+    }
+    return static_cast<size_t>(hashFinish(hash));
+}
+
+} // namespace ve::internal
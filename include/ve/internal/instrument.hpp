@@ -0,0 +1,233 @@
+#pragma once
+
+#include "ve/internal/unroll.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef VE_ENABLE_INSTRUMENTATION
+    #include <array>
+    #include <atomic>
+    #include <chrono>
+    #include <mutex>
+    #include <vector>
+#endif
+
+namespace ve {
+
+// Operations counted when VE_ENABLE_INSTRUMENTATION is defined. Each value
+// operation is counted once where it is done, so a + b counts one
+// VectorAdd (in +=) and one Temporary for the result; operators defined in
+// terms of others, like != or <, count the operations they are made of.
+enum class Operation : std::uint8_t {
+    VectorAdd,
+    VectorSubtract,
+    VectorNegate,
+    VectorMultiply,
+    VectorDivide,
+    VectorCompare,
+    VectorOrder,
+    Dot,
+    SquaredLength,
+    Length,
+    Unit,
+    PointTranslate,
+    PointDifference,
+    PointCompare,
+    SquaredDistance,
+    Distance,
+    // Square roots, from length() and the batch kernels.
+    Sqrt,
+    // Copies between values with different element types.
+    Conversion,
+    // New values returned by the binary and unary operators.
+    Temporary,
+};
+
+constexpr size_t operationCount = static_cast<size_t>(Operation::Temporary) + 1;
+
+// Batch kernels timed when VE_ENABLE_INSTRUMENTATION is defined.
+enum class Kernel : std::uint8_t {
+    SquaredLengths,
+    Lengths,
+    Dots,
+    SquaredDistances,
+    Distances,
+    Normalize,
+    Add,
+    Scale,
+    PairwiseSquaredDistances,
+    PairwiseDistances,
+    PairsWithinRadius,
+};
+
+constexpr size_t kernelCount = static_cast<size_t>(Kernel::PairsWithinRadius) + 1;
+
+} // namespace ve
+
+// VE_COUNT(Operation), VE_COUNT_N(Operation, n) and VE_TIME_KERNEL(Kernel,
+// items) are the instrumentation points. Without VE_ENABLE_INSTRUMENTATION
+// they expand to nothing. The macro changes inline functions, so it must
+// be defined the same way in every translation unit of a program.
+#ifdef VE_ENABLE_INSTRUMENTATION
+    #define VE_COUNT(operation) \
+        ::ve::internal::countOperation(::ve::Operation::operation, 1)
+    #define VE_COUNT_N(operation, n) \
+        ::ve::internal::countOperation(::ve::Operation::operation, (n))
+    #define VE_TIME_KERNEL(kernel, items) \
+        const auto veKernelTimer = \
+            ::ve::internal::KernelTimer{::ve::Kernel::kernel, (items)}
+#else
+    #define VE_COUNT(operation) static_cast<void>(0)
+    #define VE_COUNT_N(operation, n) static_cast<void>(0)
+    #define VE_TIME_KERNEL(kernel, items) static_cast<void>(0)
+#endif
+
+#ifdef VE_ENABLE_INSTRUMENTATION
+
+namespace ve::internal {
+
+struct KernelCounts {
+    std::uint64_t calls = 0;
+    std::uint64_t items = 0;
+    std::uint64_t nanoseconds = 0;
+};
+
+struct InstrumentationCounts {
+    std::array<std::uint64_t, operationCount> operations = {};
+    std::array<KernelCounts, kernelCount> kernels = {};
+};
+
+class ThreadCounters;
+
+// Counters of all threads. Live threads are read through their atomics;
+// counts of finished threads are kept in `retired`.
+struct InstrumentationRegistry {
+    std::mutex mutex;
+    std::vector<const ThreadCounters*> threads;
+    InstrumentationCounts retired;
+    // Totals at the last reset, subtracted from the report.
+    InstrumentationCounts baseline;
+};
+
+inline InstrumentationRegistry& instrumentationRegistry()
+{
+    static InstrumentationRegistry registry;
+    return registry;
+}
+
+// Counters written by one thread only, so increments are a relaxed load and
+// store rather than a locked read-modify-write; the atomics only make
+// reports from other threads well defined.
+class ThreadCounters {
+public:
+    ThreadCounters()
+    {
+        auto& registry = instrumentationRegistry();
+        auto lock = std::lock_guard{registry.mutex};
+        registry.threads.push_back(this);
+    }
+
+    ThreadCounters(const ThreadCounters&) = delete;
+    ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+    ~ThreadCounters()
+    {
+        auto& registry = instrumentationRegistry();
+        auto lock = std::lock_guard{registry.mutex};
+        addTo(registry.retired);
+        std::erase(registry.threads, this);
+    }
+
+    void count(Operation operation, std::uint64_t n)
+    {
+        add(_operations[static_cast<size_t>(operation)], n);
+    }
+
+    void time(Kernel kernel, std::uint64_t items, std::uint64_t nanoseconds)
+    {
+        auto& counters = _kernels[static_cast<size_t>(kernel)];
+        add(counters.calls, 1);
+        add(counters.items, items);
+        add(counters.nanoseconds, nanoseconds);
+    }
+
+    void addTo(InstrumentationCounts& counts) const
+    {
+        for (size_t i = 0; i < operationCount; i++) {
+            counts.operations[i] += _operations[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < kernelCount; i++) {
+            counts.kernels[i].calls +=
+                _kernels[i].calls.load(std::memory_order_relaxed);
+            counts.kernels[i].items +=
+                _kernels[i].items.load(std::memory_order_relaxed);
+            counts.kernels[i].nanoseconds +=
+                _kernels[i].nanoseconds.load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    using Counter = std::atomic<std::uint64_t>;
+
+    struct KernelCounters {
+        Counter calls = 0;
+        Counter items = 0;
+        Counter nanoseconds = 0;
+    };
+
+    static void add(Counter& counter, std::uint64_t n)
+    {
+        counter.store(
+            counter.load(std::memory_order_relaxed) + n,
+            std::memory_order_relaxed);
+    }
+
+    std::array<Counter, operationCount> _operations = {};
+    std::array<KernelCounters, kernelCount> _kernels = {};
+};
+
+inline ThreadCounters& threadCounters()
+{
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+VE_FORCE_INLINE constexpr void countOperation(Operation operation, std::uint64_t n)
+{
+    if (!constantEvaluated()) {
+        threadCounters().count(operation, n);
+    }
+}
+
+// Adds the time from construction to destruction to the kernel's counters.
+class KernelTimer {
+public:
+    KernelTimer(Kernel kernel, size_t items)
+        : _kernel(kernel)
+        , _items(items)
+        , _start(Clock::now())
+    { }
+
+    KernelTimer(const KernelTimer&) = delete;
+    KernelTimer& operator=(const KernelTimer&) = delete;
+
+    ~KernelTimer()
+    {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - _start);
+        threadCounters().time(
+            _kernel, _items, static_cast<std::uint64_t>(elapsed.count()));
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Kernel _kernel;
+    size_t _items;
+    Clock::time_point _start;
+};
+
+} // namespace ve::internal
+
+#endif
@@ -0,0 +1,318 @@
+#pragma once
+
+#include "ve/dispatch.hpp"
+#include "ve/internal/instrument.hpp"
+#include "ve/internal/simd.hpp"
+
+#include <cmath>
+#include <cstddef>
+
+namespace ve::internal {
+
+// Kernels over flat arrays of scalars, used by the batch functions.
+//
+// The fast float paths refine the hardware reciprocal square root estimate
+// (relative error below 1.5 * 2^-12) with one Newton-Raphson step. The
+// result has a relative error below 2^-21 (about 4.8e-7) for all positive
+// normal inputs. Double precision has no estimate instruction, so fast mode
+// falls back to exact computation for doubles. The float and double kernels
+// run their widest loops with the active instruction set (see dispatch.hpp).
+
+#ifdef VE_SIMD_SSE2
+
+inline __m128 rsqrtEstimate(__m128 x)
+{
+    auto y = _mm_rsqrt_ps(x);
+    auto xyy = _mm_mul_ps(_mm_mul_ps(x, y), y);
+    return _mm_mul_ps(
+        _mm_mul_ps(_mm_set1_ps(0.5f), y), _mm_sub_ps(_mm_set1_ps(3.f), xyy));
+}
+
+#endif
+
+#ifdef VE_TARGET_AVX
+
+VE_TARGET_AVX inline __m256 rsqrtEstimate(__m256 x)
+{
+    auto y = _mm256_rsqrt_ps(x);
+    auto xyy = _mm256_mul_ps(_mm256_mul_ps(x, y), y);
+    return _mm256_mul_ps(
+        _mm256_mul_ps(_mm256_set1_ps(0.5f), y),
+        _mm256_sub_ps(_mm256_set1_ps(3.f), xyy));
+}
+
+// The wide loops do whole registers and return how many values they did;
+// the rest is left to the SSE2 and scalar loops.
+
+VE_TARGET_AVX inline size_t sqrtAvx(float* values, size_t count, bool fast)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto x = _mm256_loadu_ps(values + i);
+        if (fast) {
+            auto positive = _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GT_OQ);
+            auto r = _mm256_mul_ps(x, rsqrtEstimate(x));
+            _mm256_storeu_ps(values + i, _mm256_and_ps(r, positive));
+        } else {
+            _mm256_storeu_ps(values + i, _mm256_sqrt_ps(x));
+        }
+    }
+    return i;
+}
+
+VE_TARGET_AVX inline size_t inverseSqrtAvx(float* values, size_t count, bool fast)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto x = _mm256_loadu_ps(values + i);
+        auto positive = _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GT_OQ);
+        auto r = fast ?
+            rsqrtEstimate(x) :
+            _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_sqrt_ps(x));
+        _mm256_storeu_ps(values + i, _mm256_and_ps(r, positive));
+    }
+    return i;
+}
+
+VE_TARGET_AVX inline size_t sqrtAvx(double* values, size_t count, bool /*fast*/)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm256_storeu_pd(values + i, _mm256_sqrt_pd(_mm256_loadu_pd(values + i)));
+    }
+    return i;
+}
+
+VE_TARGET_AVX inline size_t inverseSqrtAvx(
+    double* values, size_t count, bool /*fast*/)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto x = _mm256_loadu_pd(values + i);
+        auto positive = _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_GT_OQ);
+        auto r = _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_sqrt_pd(x));
+        _mm256_storeu_pd(values + i, _mm256_and_pd(r, positive));
+    }
+    return i;
+}
+
+#endif
+
+#ifdef VE_DISPATCH
+
+// GCC 12 warns about the undefined source operand inside its own AVX-512
+// intrinsics.
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// The AVX-512 estimate has a relative error below 2^-14 before refinement.
+VE_TARGET_AVX512 inline __m512 rsqrtEstimate(__m512 x)
+{
+    auto y = _mm512_rsqrt14_ps(x);
+    auto xyy = _mm512_mul_ps(_mm512_mul_ps(x, y), y);
+    return _mm512_mul_ps(
+        _mm512_mul_ps(_mm512_set1_ps(0.5f), y),
+        _mm512_sub_ps(_mm512_set1_ps(3.f), xyy));
+}
+
+VE_TARGET_AVX512 inline size_t sqrtAvx512(float* values, size_t count, bool fast)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        auto x = _mm512_loadu_ps(values + i);
+        if (fast) {
+            auto positive = _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_GT_OQ);
+            auto r = _mm512_mul_ps(x, rsqrtEstimate(x));
+            _mm512_storeu_ps(values + i, _mm512_maskz_mov_ps(positive, r));
+        } else {
+            _mm512_storeu_ps(values + i, _mm512_sqrt_ps(x));
+        }
+    }
+    return i;
+}
+
+VE_TARGET_AVX512 inline size_t inverseSqrtAvx512(
+    float* values, size_t count, bool fast)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        auto x = _mm512_loadu_ps(values + i);
+        auto positive = _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_GT_OQ);
+        auto r = fast ?
+            rsqrtEstimate(x) :
+            _mm512_div_ps(_mm512_set1_ps(1.f), _mm512_sqrt_ps(x));
+        _mm512_storeu_ps(values + i, _mm512_maskz_mov_ps(positive, r));
+    }
+    return i;
+}
+
+VE_TARGET_AVX512 inline size_t sqrtAvx512(
+    double* values, size_t count, bool /*fast*/)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm512_storeu_pd(values + i, _mm512_sqrt_pd(_mm512_loadu_pd(values + i)));
+    }
+    return i;
+}
+
+VE_TARGET_AVX512 inline size_t inverseSqrtAvx512(
+    double* values, size_t count, bool /*fast*/)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto x = _mm512_loadu_pd(values + i);
+        auto positive = _mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_GT_OQ);
+        auto r = _mm512_div_pd(_mm512_set1_pd(1.0), _mm512_sqrt_pd(x));
+        _mm512_storeu_pd(values + i, _mm512_maskz_mov_pd(positive, r));
+    }
+    return i;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic pop
+#endif
+
+#endif
+
+// Runs the widest loop of the active instruction set.
+template <class T>
+size_t sqrtWide(T* values, size_t count, bool fast)
+{
+#ifdef VE_DISPATCH
+    switch (activeIsa()) {
+    case Isa::Avx512:
+        return sqrtAvx512(values, count, fast);
+    case Isa::Avx2:
+        return sqrtAvx(values, count, fast);
+    case Isa::Baseline:
+        break;
+    }
+#endif
+#ifdef VE_SIMD_AVX
+    return sqrtAvx(values, count, fast);
+#else
+    static_cast<void>(values);
+    static_cast<void>(count);
+    static_cast<void>(fast);
+    return 0;
+#endif
+}
+
+template <class T>
+size_t inverseSqrtWide(T* values, size_t count, bool fast)
+{
+#ifdef VE_DISPATCH
+    switch (activeIsa()) {
+    case Isa::Avx512:
+        return inverseSqrtAvx512(values, count, fast);
+    case Isa::Avx2:
+        return inverseSqrtAvx(values, count, fast);
+    case Isa::Baseline:
+        break;
+    }
+#endif
+#ifdef VE_SIMD_AVX
+    return inverseSqrtAvx(values, count, fast);
+#else
+    static_cast<void>(values);
+    static_cast<void>(count);
+    static_cast<void>(fast);
+    return 0;
+#endif
+}
+
+template <class T>
+void sqrtInPlace(T* values, size_t count, bool /*fast*/ = false)
+{
+    VE_COUNT_N(Sqrt, count);
+    for (size_t i = 0; i < count; i++) {
+        values[i] = static_cast<T>(std::sqrt(values[i]));
+    }
+}
+
+template <class T>
+void inverseSqrtInPlace(T* values, size_t count, bool /*fast*/ = false)
+{
+    VE_COUNT_N(Sqrt, count);
+    for (size_t i = 0; i < count; i++) {
+        values[i] = values[i] > 0 ? T{1} / std::sqrt(values[i]) : T{0};
+    }
+}
+
+inline void sqrtInPlace(
+    float* values, size_t count, [[maybe_unused]] bool fast = false)
+{
+    VE_COUNT_N(Sqrt, count);
+    size_t i = sqrtWide(values, count, fast);
+#ifdef VE_SIMD_SSE2
+    for (; i + 4 <= count; i += 4) {
+        auto x = _mm_loadu_ps(values + i);
+        if (fast) {
+            auto positive = _mm_cmpgt_ps(x, _mm_setzero_ps());
+            auto r = _mm_mul_ps(x, rsqrtEstimate(x));
+            _mm_storeu_ps(values + i, _mm_and_ps(r, positive));
+        } else {
+            _mm_storeu_ps(values + i, _mm_sqrt_ps(x));
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        values[i] = std::sqrt(values[i]);
+    }
+}
+
+inline void inverseSqrtInPlace(
+    float* values, size_t count, [[maybe_unused]] bool fast = false)
+{
+    VE_COUNT_N(Sqrt, count);
+    size_t i = inverseSqrtWide(values, count, fast);
+#ifdef VE_SIMD_SSE2
+    for (; i + 4 <= count; i += 4) {
+        auto x = _mm_loadu_ps(values + i);
+        auto positive = _mm_cmpgt_ps(x, _mm_setzero_ps());
+        auto r = fast ?
+            rsqrtEstimate(x) :
+            _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(x));
+        _mm_storeu_ps(values + i, _mm_and_ps(r, positive));
+    }
+#endif
+    for (; i < count; i++) {
+        values[i] = values[i] > 0 ? 1.f / std::sqrt(values[i]) : 0.f;
+    }
+}
+
+inline void sqrtInPlace(double* values, size_t count, bool /*fast*/ = false)
+{
+    VE_COUNT_N(Sqrt, count);
+    size_t i = sqrtWide(values, count, false);
+#ifdef VE_SIMD_SSE2
+    for (; i + 2 <= count; i += 2) {
+        _mm_storeu_pd(values + i, _mm_sqrt_pd(_mm_loadu_pd(values + i)));
+    }
+#endif
+    for (; i < count; i++) {
+        values[i] = std::sqrt(values[i]);
+    }
+}
+
+inline void inverseSqrtInPlace(double* values, size_t count, bool /*fast*/ = false)
+{
+    VE_COUNT_N(Sqrt, count);
+    size_t i = inverseSqrtWide(values, count, false);
+#ifdef VE_SIMD_SSE2
+    for (; i + 2 <= count; i += 2) {
+        auto x = _mm_loadu_pd(values + i);
+        auto positive = _mm_cmpgt_pd(x, _mm_setzero_pd());
+        auto r = _mm_div_pd(_mm_set1_pd(1.0), _mm_sqrt_pd(x));
+        _mm_storeu_pd(values + i, _mm_and_pd(r, positive));
+    }
+#endif
+    for (; i < count; i++) {
+        values[i] = values[i] > 0 ? 1.0 / std::sqrt(values[i]) : 0.0;
+    }
+}
+
+} // namespace ve::internal
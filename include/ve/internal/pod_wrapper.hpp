@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ve/internal/unroll.hpp"
+
 #include <cstddef>
 #include <initializer_list>
 #include <type_traits>
@@ -7,22 +9,52 @@
 
 namespace ve::internal {
 
+template <class Pod, class T, size_t... Is>
+constexpr bool isInitializableWith(std::index_sequence<Is...>)
+{
+    return requires { Pod{((void)Is, std::declval<T>())...}; };
+}
+
+template <class Pod, class T, size_t K = sizeof(Pod) / sizeof(T)>
+constexpr size_t componentCount()
+{
+    if constexpr (K == 0 ||
+            isInitializableWith<Pod, T>(std::make_index_sequence<K>{})) {
+        return K;
+    } else {
+        return componentCount<Pod, T, K - 1>();
+    }
+}
+
+// Models are either tightly packed, or over-aligned with alignas() so that
+// the components are followed by padding up to the alignment boundary
+// (e.g. three floats padded to 16 bytes).
+template <class Pod, class T, size_t N>
+constexpr bool hasValidLayout()
+{
+    constexpr size_t packed = N * sizeof(T);
+    constexpr size_t padded =
+        (packed + alignof(Pod) - 1) / alignof(Pod) * alignof(Pod);
+    return sizeof(Pod) == packed ||
+        (alignof(Pod) > alignof(T) && sizeof(Pod) == padded);
+}
+
 template <template <class> class Pod, class T, size_t N>
 class PodWrapper : public Pod<T> {
 public:
-    constexpr PodWrapper(std::initializer_list<T> l)
+    VE_FORCE_INLINE constexpr PodWrapper(std::initializer_list<T> l)
         : Pod<T>{createPod(l, std::make_index_sequence<N>{})}
     { }
 
     template <class... Ts>
-    constexpr PodWrapper(Ts&&... args)
+    VE_FORCE_INLINE constexpr PodWrapper(Ts&&... args)
     requires std::conjunction_v<std::is_convertible<Ts, T>...>
         : Pod<T>{static_cast<T&&>(args)...}
     { }
 
 private:
     template <size_t... Is>
-    constexpr Pod<T> createPod(
+    VE_FORCE_INLINE constexpr Pod<T> createPod(
         std::initializer_list<T> l, std::index_sequence<Is...>)
     {
         return Pod<T>{*(l.begin() + Is)...};
@@ -0,0 +1,366 @@
+#pragma once
+
+#include "ve/internal/unroll.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if !defined(VE_DISABLE_SIMD)
+#   if defined(__SSE2__) || defined(_M_X64) || \
+        (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#       define VE_SIMD_SSE2
+#       include <emmintrin.h>
+#   endif
+#   if defined(VE_SIMD_SSE2) && (defined(__SSE4_1__) || defined(__AVX__))
+#       define VE_SIMD_SSE41
+#       include <smmintrin.h>
+#   endif
+#   if defined(VE_SIMD_SSE2) && defined(__AVX__)
+#       define VE_SIMD_AVX
+#       include <immintrin.h>
+#   endif
+#   if defined(VE_SIMD_AVX) && defined(__AVX2__)
+#       define VE_SIMD_AVX2
+#   endif
+#   if defined(VE_SIMD_AVX) && defined(__F16C__)
+#       define VE_SIMD_F16C
+#   endif
+#   if defined(VE_SIMD_SSE2) && defined(__BMI2__) && \
+        (defined(__x86_64__) || defined(_M_X64))
+#       define VE_SIMD_BMI2
+#       include <immintrin.h>
+#   endif
+#endif
+
+namespace ve::internal::simd {
+
+// A Register<T, Bytes> describes how to keep a whole model of Bytes bytes
+// (including padding) in one SIMD register. Lanes past the model's component
+// count hold padding and are ignored by equal() and squaredSum().
+template <class T, size_t Bytes>
+struct Register {
+    static constexpr bool enabled = false;
+};
+
+#ifdef VE_SIMD_SSE2
+
+template <>
+struct Register<float, 16> {
+    using Type = __m128;
+    static constexpr bool enabled = true;
+    static constexpr bool multiplies = true;
+    static constexpr bool divides = true;
+
+    VE_FORCE_INLINE static Type load(const float* p) { return _mm_loadu_ps(p); }
+    VE_FORCE_INLINE static void store(float* p, Type v) { _mm_storeu_ps(p, v); }
+    VE_FORCE_INLINE static Type broadcast(float s) { return _mm_set1_ps(s); }
+    VE_FORCE_INLINE static Type add(Type a, Type b) { return _mm_add_ps(a, b); }
+    VE_FORCE_INLINE static Type sub(Type a, Type b) { return _mm_sub_ps(a, b); }
+    VE_FORCE_INLINE static Type mul(Type a, Type b) { return _mm_mul_ps(a, b); }
+    VE_FORCE_INLINE static Type div(Type a, Type b) { return _mm_div_ps(a, b); }
+    VE_FORCE_INLINE static Type neg(Type a)
+    {
+        return _mm_xor_ps(a, _mm_set1_ps(-0.f));
+    }
+
+    VE_FORCE_INLINE static Type min(Type a, Type b) { return _mm_min_ps(a, b); }
+    VE_FORCE_INLINE static Type max(Type a, Type b) { return _mm_max_ps(a, b); }
+
+    VE_FORCE_INLINE static int equal(Type a, Type b)
+    {
+        return _mm_movemask_ps(_mm_cmpeq_ps(a, b));
+    }
+
+    VE_FORCE_INLINE static int lessEqual(Type a, Type b)
+    {
+        return _mm_movemask_ps(_mm_cmple_ps(a, b));
+    }
+
+    template <size_t N>
+    VE_FORCE_INLINE static float squaredSum(Type a)
+    {
+        auto mask = _mm_castsi128_ps(_mm_set_epi32(
+            N > 3 ? -1 : 0, N > 2 ? -1 : 0, N > 1 ? -1 : 0, -1));
+        auto v = _mm_and_ps(_mm_mul_ps(a, a), mask);
+        v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+        return _mm_cvtss_f32(v);
+    }
+};
+
+template <>
+struct Register<float, 8> : Register<float, 16> {
+    VE_FORCE_INLINE static Type load(const float* p)
+    {
+        return _mm_castsi128_ps(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    }
+
+    VE_FORCE_INLINE static void store(float* p, Type v)
+    {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_castps_si128(v));
+    }
+};
+
+template <>
+struct Register<double, 16> {
+    using Type = __m128d;
+    static constexpr bool enabled = true;
+    static constexpr bool multiplies = true;
+    static constexpr bool divides = true;
+
+    VE_FORCE_INLINE static Type load(const double* p) { return _mm_loadu_pd(p); }
+    VE_FORCE_INLINE static void store(double* p, Type v) { _mm_storeu_pd(p, v); }
+    VE_FORCE_INLINE static Type broadcast(double s) { return _mm_set1_pd(s); }
+    VE_FORCE_INLINE static Type add(Type a, Type b) { return _mm_add_pd(a, b); }
+    VE_FORCE_INLINE static Type sub(Type a, Type b) { return _mm_sub_pd(a, b); }
+    VE_FORCE_INLINE static Type mul(Type a, Type b) { return _mm_mul_pd(a, b); }
+    VE_FORCE_INLINE static Type div(Type a, Type b) { return _mm_div_pd(a, b); }
+    VE_FORCE_INLINE static Type neg(Type a)
+    {
+        return _mm_xor_pd(a, _mm_set1_pd(-0.0));
+    }
+
+    VE_FORCE_INLINE static Type min(Type a, Type b) { return _mm_min_pd(a, b); }
+    VE_FORCE_INLINE static Type max(Type a, Type b) { return _mm_max_pd(a, b); }
+
+    VE_FORCE_INLINE static int equal(Type a, Type b)
+    {
+        return _mm_movemask_pd(_mm_cmpeq_pd(a, b));
+    }
+
+    VE_FORCE_INLINE static int lessEqual(Type a, Type b)
+    {
+        return _mm_movemask_pd(_mm_cmple_pd(a, b));
+    }
+
+    template <size_t N>
+    VE_FORCE_INLINE static double squaredSum(Type a)
+    {
+        auto v = _mm_mul_pd(a, a);
+        if constexpr (N > 1) {
+            v = _mm_add_sd(v, _mm_unpackhi_pd(v, v));
+        }
+        return _mm_cvtsd_f64(v);
+    }
+};
+
+template <>
+struct Register<std::int32_t, 16> {
+    using Type = __m128i;
+    static constexpr bool enabled = true;
+#ifdef VE_SIMD_SSE41
+    static constexpr bool multiplies = true;
+#else
+    static constexpr bool multiplies = false;
+#endif
+    static constexpr bool divides = false;
+
+    VE_FORCE_INLINE static Type load(const std::int32_t* p)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    }
+
+    VE_FORCE_INLINE static void store(std::int32_t* p, Type v)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+    }
+
+    VE_FORCE_INLINE static Type broadcast(std::int32_t s)
+    {
+        return _mm_set1_epi32(s);
+    }
+    VE_FORCE_INLINE static Type add(Type a, Type b) { return _mm_add_epi32(a, b); }
+    VE_FORCE_INLINE static Type sub(Type a, Type b) { return _mm_sub_epi32(a, b); }
+    VE_FORCE_INLINE static Type neg(Type a)
+    {
+        return _mm_sub_epi32(_mm_setzero_si128(), a);
+    }
+
+#ifdef VE_SIMD_SSE41
+    VE_FORCE_INLINE static Type mul(Type a, Type b)
+    {
+        return _mm_mullo_epi32(a, b);
+    }
+#endif
+
+    VE_FORCE_INLINE static Type min(Type a, Type b)
+    {
+#ifdef VE_SIMD_SSE41
+        return _mm_min_epi32(a, b);
+#else
+        auto less = _mm_cmplt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(less, a), _mm_andnot_si128(less, b));
+#endif
+    }
+
+    VE_FORCE_INLINE static Type max(Type a, Type b)
+    {
+#ifdef VE_SIMD_SSE41
+        return _mm_max_epi32(a, b);
+#else
+        auto greater = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(
+            _mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+#endif
+    }
+
+    VE_FORCE_INLINE static int equal(Type a, Type b)
+    {
+        return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)));
+    }
+
+    VE_FORCE_INLINE static int lessEqual(Type a, Type b)
+    {
+        return ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(a, b))) & 0xf;
+    }
+};
+
+template <>
+struct Register<std::int32_t, 8> : Register<std::int32_t, 16> {
+    VE_FORCE_INLINE static Type load(const std::int32_t* p)
+    {
+        return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    }
+
+    VE_FORCE_INLINE static void store(std::int32_t* p, Type v)
+    {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p), v);
+    }
+};
+
+#endif // VE_SIMD_SSE2
+
+#ifdef VE_SIMD_AVX
+
+template <>
+struct Register<double, 32> {
+    using Type = __m256d;
+    static constexpr bool enabled = true;
+    static constexpr bool multiplies = true;
+    static constexpr bool divides = true;
+
+    VE_FORCE_INLINE static Type load(const double* p) { return _mm256_loadu_pd(p); }
+    VE_FORCE_INLINE static void store(double* p, Type v) { _mm256_storeu_pd(p, v); }
+    VE_FORCE_INLINE static Type broadcast(double s) { return _mm256_set1_pd(s); }
+    VE_FORCE_INLINE static Type add(Type a, Type b) { return _mm256_add_pd(a, b); }
+    VE_FORCE_INLINE static Type sub(Type a, Type b) { return _mm256_sub_pd(a, b); }
+    VE_FORCE_INLINE static Type mul(Type a, Type b) { return _mm256_mul_pd(a, b); }
+    VE_FORCE_INLINE static Type div(Type a, Type b) { return _mm256_div_pd(a, b); }
+    VE_FORCE_INLINE static Type neg(Type a)
+    {
+        return _mm256_xor_pd(a, _mm256_set1_pd(-0.0));
+    }
+
+    VE_FORCE_INLINE static Type min(Type a, Type b) { return _mm256_min_pd(a, b); }
+    VE_FORCE_INLINE static Type max(Type a, Type b) { return _mm256_max_pd(a, b); }
+
+    VE_FORCE_INLINE static int equal(Type a, Type b)
+    {
+        return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ));
+    }
+
+    VE_FORCE_INLINE static int lessEqual(Type a, Type b)
+    {
+        return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LE_OQ));
+    }
+
+    template <size_t N>
+    VE_FORCE_INLINE static double squaredSum(Type a)
+    {
+        auto mask = _mm256_castsi256_pd(_mm256_set_epi64x(
+            N > 3 ? -1 : 0, N > 2 ? -1 : 0, N > 1 ? -1 : 0, -1));
+        auto v = _mm256_and_pd(_mm256_mul_pd(a, a), mask);
+        auto h = _mm_add_pd(
+            _mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(h, _mm_unpackhi_pd(h, h)));
+    }
+};
+
+#endif // VE_SIMD_AVX
+
+template <template <class> class M, class T, size_t N>
+struct Kernel {
+    using R = Register<T, sizeof(M<T>)>;
+
+    static constexpr bool enabled = R::enabled && N * sizeof(T) <= sizeof(M<T>);
+
+    static constexpr bool multiplies = [] {
+        if constexpr (enabled) {
+            return R::multiplies;
+        } else {
+            return false;
+        }
+    }();
+
+    static constexpr bool divides = [] {
+        if constexpr (enabled) {
+            return R::divides;
+        } else {
+            return false;
+        }
+    }();
+
+    static constexpr bool measures = std::is_floating_point_v<T> && enabled;
+
+    VE_FORCE_INLINE static void add(T* lhs, const T* rhs)
+    {
+        R::store(lhs, R::add(R::load(lhs), R::load(rhs)));
+    }
+
+    VE_FORCE_INLINE static void sub(T* lhs, const T* rhs)
+    {
+        R::store(lhs, R::sub(R::load(lhs), R::load(rhs)));
+    }
+
+    VE_FORCE_INLINE static void sub(T* result, const T* lhs, const T* rhs)
+    {
+        R::store(result, R::sub(R::load(lhs), R::load(rhs)));
+    }
+
+    VE_FORCE_INLINE static void mul(T* lhs, T scalar)
+    {
+        R::store(lhs, R::mul(R::load(lhs), R::broadcast(scalar)));
+    }
+
+    VE_FORCE_INLINE static void div(T* lhs, T scalar)
+    {
+        R::store(lhs, R::div(R::load(lhs), R::broadcast(scalar)));
+    }
+
+    VE_FORCE_INLINE static void neg(T* value)
+    {
+        R::store(value, R::neg(R::load(value)));
+    }
+
+    VE_FORCE_INLINE static void min(T* result, const T* lhs, const T* rhs)
+    {
+        R::store(result, R::min(R::load(lhs), R::load(rhs)));
+    }
+
+    VE_FORCE_INLINE static void max(T* result, const T* lhs, const T* rhs)
+    {
+        R::store(result, R::max(R::load(lhs), R::load(rhs)));
+    }
+
+    VE_FORCE_INLINE static bool equal(const T* lhs, const T* rhs)
+    {
+        constexpr int mask = (1 << N) - 1;
+        return (R::equal(R::load(lhs), R::load(rhs)) & mask) == mask;
+    }
+
+    // Whether every component of lhs is less than or equal to rhs.
+    VE_FORCE_INLINE static bool lessEqual(const T* lhs, const T* rhs)
+    {
+        constexpr int mask = (1 << N) - 1;
+        return (R::lessEqual(R::load(lhs), R::load(rhs)) & mask) == mask;
+    }
+
+    VE_FORCE_INLINE static T squaredSum(const T* value)
+    {
+        return R::template squaredSum<N>(R::load(value));
+    }
+};
+
+} // namespace ve::internal::simd
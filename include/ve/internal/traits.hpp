@@ -0,0 +1,90 @@
+#pragma once
+
+#include "ve/point.hpp"
+#include "ve/vector.hpp"
+
+#include <cstddef>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+namespace ve::internal {
+
+template <class V>
+struct VectorTraits {
+    static constexpr bool isVector = false;
+};
+
+template <template <class> class M, class T, size_t N>
+struct VectorTraits<Vector<M, T, N>> {
+    static constexpr bool isVector = true;
+    static constexpr size_t size = N;
+    using value_type = T;
+    template <class U> using rebind = Vector<M, U, N>;
+};
+
+template <class P>
+struct PointTraits {
+    static constexpr bool isPoint = false;
+};
+
+template <template <class> class M, class T, size_t N>
+struct PointTraits<Point<M, T, N>> {
+    static constexpr bool isPoint = true;
+    static constexpr size_t size = N;
+    using value_type = T;
+    template <class U> using rebind = Point<M, U, N>;
+    using vector_type = Vector<M, T, N>;
+};
+
+template <class V>
+struct ValueTraits;
+
+template <template <class> class M, class T, size_t N>
+struct ValueTraits<Vector<M, T, N>> : VectorTraits<Vector<M, T, N>> {
+    template <template <template <class> class, class, size_t> class Kind>
+    using rebindKind = Kind<M, T, N>;
+};
+
+template <template <class> class M, class T, size_t N>
+struct ValueTraits<Point<M, T, N>> : PointTraits<Point<M, T, N>> {
+    template <template <template <class> class, class, size_t> class Kind>
+    using rebindKind = Kind<M, T, N>;
+};
+
+template <class R>
+using RangeValue = std::remove_cv_t<std::ranges::range_value_t<R>>;
+
+template <class R>
+concept ContiguousRange =
+    std::ranges::contiguous_range<R> && std::ranges::sized_range<R>;
+
+template <class R>
+concept VectorRange = ContiguousRange<R> && VectorTraits<RangeValue<R>>::isVector;
+
+template <class R>
+concept PointRange = ContiguousRange<R> && PointTraits<RangeValue<R>>::isPoint;
+
+template <class R>
+concept OutputRange = ContiguousRange<R> &&
+    std::ranges::output_range<R, std::ranges::range_value_t<R>>;
+
+template <class R>
+concept ScalarOutputRange =
+    OutputRange<R> && std::is_arithmetic_v<std::ranges::range_value_t<R>>;
+
+template <class R>
+concept VectorOutputRange =
+    OutputRange<R> && VectorTraits<std::ranges::range_value_t<R>>::isVector;
+
+template <class R>
+concept PointOutputRange =
+    OutputRange<R> && PointTraits<std::ranges::range_value_t<R>>::isPoint;
+
+template <ContiguousRange R>
+constexpr auto asSpan(R&& range)
+{
+    return std::span{std::ranges::data(range), std::ranges::size(range)};
+}
+
+} // namespace ve::internal
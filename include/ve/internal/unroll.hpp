@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Per-component kernels are small enough that a call costs more than the
+// work itself, and unoptimized builds would otherwise emit a call for every
+// operator, accessor and loop body. VE_FORCE_INLINE makes the compiler
+// inline them at every optimization level.
+#if defined(__GNUC__) || defined(__clang__)
+#   define VE_FORCE_INLINE [[gnu::always_inline]] inline
+#   define VE_FORCE_INLINE_LAMBDA __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#   define VE_FORCE_INLINE __forceinline
+#   define VE_FORCE_INLINE_LAMBDA
+#else
+#   define VE_FORCE_INLINE inline
+#   define VE_FORCE_INLINE_LAMBDA
+#endif
+
+namespace ve::internal {
+
+// std::is_constant_evaluated() is an ordinary function, which unoptimized
+// builds call at run time.
+VE_FORCE_INLINE constexpr bool constantEvaluated() noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_is_constant_evaluated();
+#else
+    return std::is_constant_evaluated();
+#endif
+}
+
+// Calls f.template operator()<I>() for I = 0 .. N - 1, in order. The calls
+// are expanded at compile time, so f is usually a lambda with an explicit
+// template parameter list: [&] <size_t I> () VE_FORCE_INLINE_LAMBDA { ... }.
+template <size_t N, class F>
+VE_FORCE_INLINE constexpr void unroll(F&& f)
+{
+    [&] <size_t... Is> (std::index_sequence<Is...>) VE_FORCE_INLINE_LAMBDA {
+        (f.template operator()<Is>(), ...);
+    }(std::make_index_sequence<N>{});
+}
+
+// True if f<I>() is true for all I, evaluated in order and stopping at the
+// first false result.
+template <size_t N, class F>
+VE_FORCE_INLINE constexpr bool unrollAll(F&& f)
+{
+    return [&] <size_t... Is> (std::index_sequence<Is...>) VE_FORCE_INLINE_LAMBDA {
+        return (f.template operator()<Is>() && ...);
+    }(std::make_index_sequence<N>{});
+}
+
+// init + f<0>() + f<1>() + ..., added left to right like the equivalent loop.
+template <size_t N, class R, class F>
+VE_FORCE_INLINE constexpr R unrollSum(R init, F&& f)
+{
+    return [&] <size_t... Is> (std::index_sequence<Is...>) VE_FORCE_INLINE_LAMBDA {
+        return (init + ... + static_cast<R>(f.template operator()<Is>()));
+    }(std::make_index_sequence<N>{});
+}
+
+template <size_t I, class First, class... Rest>
+VE_FORCE_INLINE constexpr auto& select(First& first, Rest&... rest)
+{
+    if constexpr (I == 0) {
+        return first;
+    } else {
+        return select<I - 1>(rest...);
+    }
+}
+
+// Largest number of components that get() and componentAt() reach through
+// structured bindings.
+constexpr size_t maxBoundComponents = 8;
+
+// True if Pod declares its N components as separate members of type T, so
+// that a structured binding names each of them. A model with an array
+// member, such as struct { T v[3]; }, has one member however many
+// components it holds.
+template <class Pod, class T, size_t N>
+constexpr bool hasBoundComponents()
+{
+    if constexpr (N > maxBoundComponents) {
+        return false;
+    } else {
+        return [] <size_t... Is> (std::index_sequence<Is...>) {
+            return requires { Pod{{((void)Is, std::declval<T>())}...}; };
+        }(std::make_index_sequence<N>{});
+    }
+}
+
+template <template <class> class Pod, class T, size_t N>
+class PodWrapper;
+
+// Same for the model of a Vector or Point, which derive from PodWrapper.
+template <template <class> class Pod, class T, size_t N>
+constexpr bool hasBoundComponents(const PodWrapper<Pod, T, N>*)
+{
+    return hasBoundComponents<Pod<T>, T, N>();
+}
+
+// Component I of a Vector or Point with N components. Components are named
+// by structured binding, which needs no pointer arithmetic on the model, so
+// this works in constant evaluation and compiles to a plain member access
+// at any optimization level. Models with more than maxBoundComponents
+// members, or whose components are not separate members, fall back to
+// operator[].
+template <size_t I, size_t N, class V>
+VE_FORCE_INLINE constexpr auto& get(V& value)
+{
+    if constexpr (!hasBoundComponents(static_cast<V*>(nullptr))) {
+        return value[I];
+    } else if constexpr (N == 1) {
+        auto& [a] = value;
+        return select<I>(a);
+    } else if constexpr (N == 2) {
+        auto& [a, b] = value;
+        return select<I>(a, b);
+    } else if constexpr (N == 3) {
+        auto& [a, b, c] = value;
+        return select<I>(a, b, c);
+    } else if constexpr (N == 4) {
+        auto& [a, b, c, d] = value;
+        return select<I>(a, b, c, d);
+    } else if constexpr (N == 5) {
+        auto& [a, b, c, d, e] = value;
+        return select<I>(a, b, c, d, e);
+    } else if constexpr (N == 6) {
+        auto& [a, b, c, d, e, f] = value;
+        return select<I>(a, b, c, d, e, f);
+    } else if constexpr (N == 7) {
+        auto& [a, b, c, d, e, f, g] = value;
+        return select<I>(a, b, c, d, e, f, g);
+    } else {
+        auto& [a, b, c, d, e, f, g, h] = value;
+        return select<I>(a, b, c, d, e, f, g, h);
+    }
+}
+
+template <size_t N, class V>
+VE_FORCE_INLINE constexpr auto* data(V& value)
+{
+    return &get<0, N>(value);
+}
+
+// Component i of a Vector or Point with a run-time index, for constant
+// evaluation, which does not allow reading the components through a T*.
+template <class T, size_t N, class V>
+constexpr T& componentAt(V& value, size_t i)
+{
+    static_assert(hasBoundComponents(static_cast<V*>(nullptr)));
+    return [&] <size_t... Is> (std::index_sequence<Is...>) -> T& {
+        T* pointers[] = {&get<Is, N>(value)...};
+        return *pointers[i];
+    }(std::make_index_sequence<N>{});
+}
+
+} // namespace ve::internal
@@ -0,0 +1,361 @@
+#pragma once
+
+#include "ve/aabb.hpp"
+#include "ve/internal/traits.hpp"
+#include "ve/point.hpp"
+#include "ve/thread_pool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace ve {
+
+// A static k-d tree over a set of points. The tree keeps its own copy of the
+// points, reordered so that every node covers a contiguous range, and stores
+// the nodes in a flat array in depth-first order (the left child of a node
+// immediately follows it). Query results refer to indices in the original
+// point set. Distances are compared squared and reported squared.
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+class KdTree {
+public:
+    using point_type = Point<M, T, N>;
+    using box_type = AABB<M, T, N>;
+    using scalar_type = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+
+    struct Neighbor {
+        size_t index;
+        scalar_type squaredDistance;
+    };
+
+    KdTree() = default;
+
+    template <internal::PointRange R>
+    requires std::is_same_v<internal::RangeValue<R>, point_type>
+    explicit KdTree(const R& points, size_t leafSize = 16)
+    {
+        auto input = internal::asSpan(points);
+        assert(input.size() < std::numeric_limits<std::uint32_t>::max());
+
+        _indices.resize(input.size());
+        std::iota(_indices.begin(), _indices.end(), std::uint32_t{0});
+        if (!input.empty()) {
+            leafSize = std::max<size_t>(leafSize, 1);
+            _nodes.reserve(2 * (input.size() / leafSize) + 1);
+            build(input, 0, static_cast<std::uint32_t>(input.size()), leafSize);
+        }
+
+        _points.resize(input.size());
+        for (size_t i = 0; i < input.size(); i++) {
+            _points[i] = input[_indices[i]];
+        }
+    }
+
+    size_t size() const
+    {
+        return _points.size();
+    }
+
+    bool empty() const
+    {
+        return _points.empty();
+    }
+
+    // Appends up to k nearest neighbors of the query to the result, ordered
+    // by increasing distance.
+    void nearest(
+        const point_type& query, size_t k, std::vector<Neighbor>& result) const
+    {
+        const size_t start = result.size();
+        if (k == 0 || empty()) {
+            return;
+        }
+        Heap heap{result, start, k};
+        searchNearest(0, query, heap);
+        std::sort_heap(result.begin() + start, result.end(), closer);
+    }
+
+    std::vector<Neighbor> nearest(const point_type& query, size_t k) const
+    {
+        std::vector<Neighbor> result;
+        result.reserve(k);
+        nearest(query, k, result);
+        return result;
+    }
+
+    // Answers a k-nearest query for every point in queries. Neighbors of
+    // query i are written to result[i * k, (i + 1) * k); unused slots (when
+    // the tree holds fewer than k points) get index size().
+    template <internal::PointRange R>
+    void nearest(
+        const R& queries,
+        size_t k,
+        std::span<Neighbor> result,
+        ThreadPool& pool = defaultThreadPool()) const
+    {
+        auto input = internal::asSpan(queries);
+        assert(result.size() == input.size() * k);
+        parallelFor(pool, input.size(), 64, [&] (size_t begin, size_t end) {
+            std::vector<Neighbor> neighbors;
+            neighbors.reserve(k);
+            for (size_t i = begin; i < end; i++) {
+                neighbors.clear();
+                nearest(input[i], k, neighbors);
+                auto out = result.subspan(i * k, k);
+                std::copy(neighbors.begin(), neighbors.end(), out.begin());
+                std::fill(out.begin() + neighbors.size(), out.end(),
+                    Neighbor{size(), std::numeric_limits<scalar_type>::max()});
+            }
+        });
+    }
+
+    // Appends indices of all points within the given (non-squared) radius.
+    // A negative or NaN radius finds nothing.
+    void withinRadius(
+        const point_type& center,
+        scalar_type radius,
+        std::vector<size_t>& result) const
+    {
+        if (!empty() && radius >= 0) {
+            searchRadius(0, center, radius * radius, result);
+        }
+    }
+
+    std::vector<size_t> withinRadius(
+        const point_type& center, scalar_type radius) const
+    {
+        std::vector<size_t> result;
+        withinRadius(center, radius, result);
+        return result;
+    }
+
+    template <internal::PointRange R>
+    std::vector<std::vector<size_t>> withinRadius(
+        const R& centers,
+        scalar_type radius,
+        ThreadPool& pool = defaultThreadPool()) const
+    {
+        auto input = internal::asSpan(centers);
+        std::vector<std::vector<size_t>> result(input.size());
+        if (!(radius >= 0)) {
+            return result;
+        }
+        parallelFor(pool, input.size(), 64, [&] (size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                withinRadius(input[i], radius, result[i]);
+            }
+        });
+        return result;
+    }
+
+    // Appends indices of all points inside the box, boundary included.
+    void withinBox(const box_type& box, std::vector<size_t>& result) const
+    {
+        if (!empty()) {
+            searchBox(0, box, result);
+        }
+    }
+
+    std::vector<size_t> withinBox(const box_type& box) const
+    {
+        std::vector<size_t> result;
+        withinBox(box, result);
+        return result;
+    }
+
+    template <class Range>
+    requires std::is_same_v<internal::RangeValue<Range>, box_type>
+    std::vector<std::vector<size_t>> withinBox(
+        const Range& boxes, ThreadPool& pool = defaultThreadPool()) const
+    {
+        auto input = internal::asSpan(boxes);
+        std::vector<std::vector<size_t>> result(input.size());
+        parallelFor(pool, input.size(), 64, [&] (size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                withinBox(input[i], result[i]);
+            }
+        });
+        return result;
+    }
+
+private:
+    struct Node {
+        T split;
+        std::uint32_t begin;
+        std::uint32_t end;
+        std::uint32_t right;
+        std::uint32_t axis;
+
+        bool leaf() const
+        {
+            return right == 0;
+        }
+    };
+
+    struct Heap {
+        std::vector<Neighbor>& items;
+        size_t start;
+        size_t capacity;
+
+        size_t size() const
+        {
+            return items.size() - start;
+        }
+
+        scalar_type worst() const
+        {
+            return size() < capacity ?
+                std::numeric_limits<scalar_type>::max() :
+                items[start].squaredDistance;
+        }
+
+        void push(const Neighbor& neighbor)
+        {
+            if (size() < capacity) {
+                items.push_back(neighbor);
+                std::push_heap(items.begin() + start, items.end(), closer);
+            } else if (neighbor.squaredDistance < worst()) {
+                std::pop_heap(items.begin() + start, items.end(), closer);
+                items.back() = neighbor;
+                std::push_heap(items.begin() + start, items.end(), closer);
+            }
+        }
+    };
+
+    static bool closer(const Neighbor& lhs, const Neighbor& rhs)
+    {
+        return lhs.squaredDistance < rhs.squaredDistance;
+    }
+
+    static scalar_type squaredDistance(const point_type& a, const point_type& b)
+    {
+        auto sum = scalar_type{0};
+        for (size_t i = 0; i < N; i++) {
+            auto d = static_cast<scalar_type>(a[i]) - static_cast<scalar_type>(b[i]);
+            sum += d * d;
+        }
+        return sum;
+    }
+
+    void build(
+        std::span<const point_type> points,
+        std::uint32_t begin,
+        std::uint32_t end,
+        size_t leafSize)
+    {
+        const auto index = static_cast<std::uint32_t>(_nodes.size());
+        _nodes.push_back(Node{T{}, begin, end, 0, 0});
+        if (end - begin <= leafSize) {
+            return;
+        }
+
+        auto bounds = box_type{};
+        for (auto i = begin; i < end; i++) {
+            bounds.extend(points[_indices[i]]);
+        }
+        std::uint32_t axis = 0;
+        for (std::uint32_t i = 1; i < N; i++) {
+            if (bounds.max[i] - bounds.min[i] > bounds.max[axis] - bounds.min[axis]) {
+                axis = i;
+            }
+        }
+
+        const auto middle = begin + (end - begin) / 2;
+        std::nth_element(
+            _indices.begin() + begin,
+            _indices.begin() + middle,
+            _indices.begin() + end,
+            [&points, axis] (std::uint32_t a, std::uint32_t b) {
+                return points[a][axis] < points[b][axis];
+            });
+
+        _nodes[index].split = points[_indices[middle]][axis];
+        _nodes[index].axis = axis;
+        build(points, begin, middle, leafSize);
+        _nodes[index].right = static_cast<std::uint32_t>(_nodes.size());
+        build(points, middle, end, leafSize);
+    }
+
+    void searchNearest(
+        std::uint32_t nodeIndex, const point_type& query, Heap& heap) const
+    {
+        const auto& node = _nodes[nodeIndex];
+        if (node.leaf()) {
+            for (auto i = node.begin; i < node.end; i++) {
+                heap.push(Neighbor{_indices[i], squaredDistance(_points[i], query)});
+            }
+            return;
+        }
+
+        const auto diff = static_cast<scalar_type>(query[node.axis]) -
+            static_cast<scalar_type>(node.split);
+        const auto nearChild = diff < 0 ? nodeIndex + 1 : node.right;
+        const auto farChild = diff < 0 ? node.right : nodeIndex + 1;
+        searchNearest(nearChild, query, heap);
+        if (diff * diff < heap.worst()) {
+            searchNearest(farChild, query, heap);
+        }
+    }
+
+    void searchRadius(
+        std::uint32_t nodeIndex,
+        const point_type& center,
+        scalar_type squaredRadius,
+        std::vector<size_t>& result) const
+    {
+        const auto& node = _nodes[nodeIndex];
+        if (node.leaf()) {
+            for (auto i = node.begin; i < node.end; i++) {
+                if (squaredDistance(_points[i], center) <= squaredRadius) {
+                    result.push_back(_indices[i]);
+                }
+            }
+            return;
+        }
+
+        const auto diff = static_cast<scalar_type>(center[node.axis]) -
+            static_cast<scalar_type>(node.split);
+        if (diff <= 0 || diff * diff <= squaredRadius) {
+            searchRadius(nodeIndex + 1, center, squaredRadius, result);
+        }
+        if (diff >= 0 || diff * diff <= squaredRadius) {
+            searchRadius(node.right, center, squaredRadius, result);
+        }
+    }
+
+    void searchBox(
+        std::uint32_t nodeIndex,
+        const box_type& box,
+        std::vector<size_t>& result) const
+    {
+        const auto& node = _nodes[nodeIndex];
+        if (node.leaf()) {
+            for (auto i = node.begin; i < node.end; i++) {
+                if (box.contains(_points[i])) {
+                    result.push_back(_indices[i]);
+                }
+            }
+            return;
+        }
+
+        if (!(node.split < box.min[node.axis])) {
+            searchBox(nodeIndex + 1, box, result);
+        }
+        if (!(box.max[node.axis] < node.split)) {
+            searchBox(node.right, box, result);
+        }
+    }
+
+    std::vector<point_type> _points;
+    std::vector<std::uint32_t> _indices;
+    std::vector<Node> _nodes;
+};
+
+} // namespace ve
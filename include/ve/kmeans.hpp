@@ -0,0 +1,784 @@
+#pragma once
+
+#include "ve/algorithms.hpp"
+#include "ve/dispatch.hpp"
+#include "ve/internal/simd.hpp"
+#include "ve/internal/traits.hpp"
+#include "ve/point.hpp"
+#include "ve/thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace ve {
+
+// k-means clustering of points into k clusters, each represented by the
+// mean of its points (its center).
+//
+// kmeans() runs Lloyd's iterations with Hamerly's bounds: every point keeps
+// an upper bound on the distance to its center and a lower bound on the
+// distance to any other center, and the triangle inequality lets most points
+// skip the distance computations once the centers settle. The points that do
+// need them are compared with all centers, stored axis by axis in chunks
+// that vectorize.
+//
+// Results depend only on the input, the options and the seed, not on the
+// thread pool: sums are taken in fixed blocks combined in block order, like
+// the reductions in algorithms.hpp, and ties go to the lowest center index.
+
+enum class KMeansInit {
+    // Each center is drawn with probability proportional to the squared
+    // distance to the nearest center drawn before it (k-means++).
+    PlusPlus,
+    // Centers are drawn uniformly among the points, without replacement.
+    Random,
+};
+
+struct KMeansOptions {
+    KMeansInit init = KMeansInit::PlusPlus;
+    std::uint64_t seed = 0;
+    // Most center updates to run.
+    size_t maxIterations = 300;
+    // Iterations stop once no point changes cluster, or once no center moves
+    // further than this distance.
+    double tolerance = 0;
+};
+
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+struct KMeansResult {
+    std::vector<Point<M, T, N>> centers;
+    // Index of the nearest center of each point.
+    std::vector<std::uint32_t> labels;
+    // Sum of squared distances from the points to their centers.
+    double inertia = 0;
+    // Center updates run.
+    size_t iterations = 0;
+    bool converged = false;
+};
+
+namespace internal {
+
+// Random draws from the seed alone: mt19937_64 is fully specified, unlike
+// the standard distributions.
+class KMeansRandom {
+public:
+    explicit KMeansRandom(std::uint64_t seed)
+        : _engine(seed)
+    { }
+
+    // Uniform in [0, 1).
+    double uniform()
+    {
+        return static_cast<double>(_engine() >> 11) * 0x1.0p-53;
+    }
+
+    // Uniform in [0, count).
+    size_t below(size_t count)
+    {
+        return std::min(count - 1, static_cast<size_t>(uniform() * count));
+    }
+
+private:
+    std::mt19937_64 _engine;
+};
+
+template <class P, class Q>
+VE_FORCE_INLINE auto squaredDistanceTo(const P& point, const Q& center)
+{
+    using T = typename PointTraits<P>::value_type;
+    auto sum = T{0};
+    for (size_t c = 0; c < PointTraits<P>::size; c++) {
+        const T d = point[c] - center[c];
+        sum += d * d;
+    }
+    return sum;
+}
+
+template <class T>
+struct NearestCenters {
+    std::uint32_t index;
+    // Squared distances to the nearest center and to the second nearest.
+    T first;
+    T second;
+};
+
+// Centers stored axis by axis in chunks of a fixed size, padded with
+// infinity, so that the distances from a point to a chunk of centers fill
+// whole SIMD registers.
+template <class T, size_t N>
+class CenterTable {
+public:
+    static constexpr size_t chunkSize = 16;
+
+    template <class P>
+    void assign(std::span<const P> centers)
+    {
+        _count = centers.size();
+        _stride = (_count + chunkSize - 1) / chunkSize * chunkSize;
+        _coordinates.assign(N * _stride, std::numeric_limits<T>::infinity());
+        for (size_t j = 0; j < _count; j++) {
+            for (size_t c = 0; c < N; c++) {
+                _coordinates[c * _stride + j] = centers[j][c];
+            }
+        }
+    }
+
+    size_t size() const
+    {
+        return _count;
+    }
+
+    // Distances are summed in the same order as squaredDistanceTo(), so
+    // both give the same result for the same center.
+    template <class P>
+    VE_FORCE_INLINE NearestCenters<T> nearest(const P& point) const
+    {
+        if constexpr (simd::Register<T, 16>::enabled) {
+            return nearestSimd(point);
+        } else {
+            return nearestScalar(point);
+        }
+    }
+
+private:
+    static constexpr T infinity = std::numeric_limits<T>::infinity();
+
+    // Every lane keeps the two smallest distances it has seen, without
+    // branches or compares: second = min(second, max(first, d)) and
+    // first = min(first, d). The lanes are merged at the end, and a second
+    // pass finds the first center at the smallest distance, which usually
+    // stops well before the end.
+    template <class P>
+    VE_FORCE_INLINE NearestCenters<T> nearestSimd(const P& point) const
+    {
+        using R = simd::Register<T, 16>;
+        constexpr size_t lanes = 16 / sizeof(T);
+        constexpr size_t registers = chunkSize / lanes;
+
+        typename R::Type first[registers];
+        typename R::Type second[registers];
+        for (size_t r = 0; r < registers; r++) {
+            first[r] = R::broadcast(infinity);
+            second[r] = first[r];
+        }
+        for (size_t start = 0; start < _stride; start += chunkSize) {
+            for (size_t r = 0; r < registers; r++) {
+                auto square = squares<R>(point, start + r * lanes);
+                second[r] = R::min(second[r], R::max(first[r], square));
+                first[r] = R::min(first[r], square);
+            }
+        }
+
+        for (size_t r = 1; r < registers; r++) {
+            second[0] = R::min(
+                R::min(second[0], second[r]), R::max(first[0], first[r]));
+            first[0] = R::min(first[0], first[r]);
+        }
+        T firsts[lanes];
+        T seconds[lanes];
+        R::store(firsts, first[0]);
+        R::store(seconds, second[0]);
+        auto result = NearestCenters<T>{0, firsts[0], seconds[0]};
+        for (size_t j = 1; j < lanes; j++) {
+            const T larger = result.first < firsts[j] ? firsts[j] : result.first;
+            result.second = seconds[j] < result.second ? seconds[j] : result.second;
+            result.second = larger < result.second ? larger : result.second;
+            result.first = firsts[j] < result.first ? firsts[j] : result.first;
+        }
+
+        const auto nearest = R::broadcast(result.first);
+        for (size_t start = 0; start < _stride; start += lanes) {
+            if (int mask = R::equal(squares<R>(point, start), nearest)) {
+                result.index = static_cast<std::uint32_t>(
+                    start + std::countr_zero(static_cast<unsigned>(mask)));
+                break;
+            }
+        }
+        return result;
+    }
+
+    template <class R, class P>
+    VE_FORCE_INLINE typename R::Type squares(const P& point, size_t start) const
+    {
+        auto sum = R::broadcast(T{0});
+        for (size_t c = 0; c < N; c++) {
+            auto d = R::sub(
+                R::broadcast(point[c]),
+                R::load(_coordinates.data() + c * _stride + start));
+            sum = R::add(sum, R::mul(d, d));
+        }
+        return sum;
+    }
+
+    template <class P>
+    NearestCenters<T> nearestScalar(const P& point) const
+    {
+        auto result = NearestCenters<T>{0, infinity, infinity};
+        for (size_t j = 0; j < _count; j++) {
+            auto square = T{0};
+            for (size_t c = 0; c < N; c++) {
+                const T d = point[c] - _coordinates[c * _stride + j];
+                square += d * d;
+            }
+            if (square < result.first) {
+                result.second = result.first;
+                result.first = square;
+                result.index = static_cast<std::uint32_t>(j);
+            } else if (square < result.second) {
+                result.second = square;
+            }
+        }
+        return result;
+    }
+
+    std::vector<T> _coordinates;
+    size_t _count = 0;
+    size_t _stride = 0;
+};
+
+// Calls f(i, nearest centers of point i) for every point, in parallel.
+template <class P, class T, size_t N, class F>
+void forEachNearest(
+    std::span<const P> points,
+    const CenterTable<T, N>& table,
+    ThreadPool& pool,
+    F&& f)
+{
+    parallelFor(pool, points.size(), 1024, [&] (size_t begin, size_t end) {
+        dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+            for (size_t i = begin; i < end; i++) {
+                f(i, table.nearest(points[i]));
+            }
+        });
+    });
+}
+
+template <class P>
+std::vector<P> randomCenters(
+    std::span<const P> points, size_t k, std::uint64_t seed)
+{
+    // Selection sampling keeps the centers in input order.
+    auto random = KMeansRandom{seed};
+    std::vector<P> centers;
+    centers.reserve(k);
+    for (size_t i = 0; i < points.size() && centers.size() < k; i++) {
+        if (random.uniform() * static_cast<double>(points.size() - i) <
+                static_cast<double>(k - centers.size())) {
+            centers.push_back(points[i]);
+        }
+    }
+    return centers;
+}
+
+template <class P>
+std::vector<P> plusPlusCenters(
+    std::span<const P> points, size_t k, std::uint64_t seed, ThreadPool& pool)
+{
+    using T = typename PointTraits<P>::value_type;
+
+    auto random = KMeansRandom{seed};
+    std::vector<P> centers;
+    centers.reserve(k);
+    centers.push_back(points[random.below(points.size())]);
+
+    std::vector<T> squares(points.size(), std::numeric_limits<T>::infinity());
+    while (centers.size() < k) {
+        const auto center = centers.back();
+        const auto partials = blockPartials(points, pool, 0.0,
+            [&] (std::span<const P> block) {
+                const size_t offset = static_cast<size_t>(block.data() - points.data());
+                double sum = 0;
+                for (size_t i = 0; i < block.size(); i++) {
+                    auto& square = squares[offset + i];
+                    square = std::min(square, squaredDistanceTo(block[i], center));
+                    sum += square;
+                }
+                return sum;
+            });
+        double total = 0;
+        for (double partial : partials) {
+            total += partial;
+        }
+        if (!(total > 0)) {
+            // Every point coincides with a center.
+            centers.push_back(points[random.below(points.size())]);
+            continue;
+        }
+
+        // Finds the point where the running sum of squares passes the
+        // target, or the last point with a nonzero weight when rounding
+        // leaves the target beyond the end.
+        double target = random.uniform() * total;
+        size_t chosen = points.size();
+        size_t lastBlock = 0;
+        for (size_t b = 0; b < partials.size() && chosen == points.size(); b++) {
+            if (partials[b] > 0) {
+                lastBlock = b;
+            }
+            if (target >= partials[b]) {
+                target -= partials[b];
+                continue;
+            }
+            const size_t end = std::min(points.size(), (b + 1) * reductionBlockSize);
+            for (size_t i = b * reductionBlockSize; i < end; i++) {
+                if (squares[i] > 0) {
+                    chosen = i;
+                    if (target < squares[i]) {
+                        break;
+                    }
+                    target -= squares[i];
+                }
+            }
+        }
+        if (chosen == points.size()) {
+            const size_t end =
+                std::min(points.size(), (lastBlock + 1) * reductionBlockSize);
+            for (size_t i = lastBlock * reductionBlockSize; i < end; i++) {
+                if (squares[i] > 0) {
+                    chosen = i;
+                }
+            }
+        }
+        centers.push_back(points[chosen]);
+    }
+    return centers;
+}
+
+// Lloyd's iterations with Hamerly's bounds. Bounds are true distances, not
+// squared ones, for the triangle inequality.
+template <template <class> class M, class T, size_t N>
+class KMeansSolver {
+public:
+    using point_type = Point<M, T, N>;
+
+    KMeansSolver(
+        std::span<const point_type> points,
+        std::vector<point_type> centers,
+        ThreadPool& pool)
+        : _points(points)
+        , _pool(pool)
+        , _centers(std::move(centers))
+        , _labels(points.size())
+        , _upper(points.size())
+        , _lower(points.size())
+        , _separation(_centers.size())
+        , _movement(_centers.size())
+    {
+        _table.assign(std::span<const point_type>{_centers});
+    }
+
+    KMeansResult<M, T, N> run(const KMeansOptions& options)
+    {
+        auto result = KMeansResult<M, T, N>{};
+        assignAll();
+        while (result.iterations < options.maxIterations) {
+            const T largest = updateCenters();
+            result.iterations++;
+            if (largest <= options.tolerance) {
+                if (largest > 0) {
+                    updateSeparation();
+                    assignPruned();
+                }
+                result.converged = true;
+                break;
+            }
+            updateSeparation();
+            if (assignPruned() == 0) {
+                result.converged = true;
+                break;
+            }
+        }
+
+        result.inertia = inertia();
+        result.centers = std::move(_centers);
+        result.labels = std::move(_labels);
+        return result;
+    }
+
+private:
+    static constexpr T infinity = std::numeric_limits<T>::infinity();
+
+    void assignAll()
+    {
+        forEachNearest(_points, _table, _pool,
+            [this] (size_t i, const NearestCenters<T>& nearest) {
+                _labels[i] = nearest.index;
+                _upper[i] = std::sqrt(nearest.first);
+                _lower[i] = std::sqrt(nearest.second);
+            });
+    }
+
+    // Moves the bounds by how far the centers moved, and recomputes the
+    // nearest center of the points whose bounds no longer rule out a
+    // change. Returns how many points changed cluster.
+    size_t assignPruned()
+    {
+        std::atomic<size_t> changed = 0;
+        parallelFor(_pool, _points.size(), 1024, [&] (size_t begin, size_t end) {
+            size_t count = 0;
+            dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+                for (size_t i = begin; i < end; i++) {
+                    const auto label = _labels[i];
+                    _upper[i] += _movement[label];
+                    _lower[i] -= label == _farthest ? _secondMovement : _largestMovement;
+                    const T bound = std::max(_separation[label], _lower[i]);
+                    if (_upper[i] <= bound) {
+                        continue;
+                    }
+                    _upper[i] = std::sqrt(squaredDistanceTo(_points[i], _centers[label]));
+                    if (_upper[i] <= bound) {
+                        continue;
+                    }
+                    const auto nearest = _table.nearest(_points[i]);
+                    count += nearest.index != label;
+                    _labels[i] = nearest.index;
+                    _upper[i] = std::sqrt(nearest.first);
+                    _lower[i] = std::sqrt(nearest.second);
+                }
+            });
+            changed.fetch_add(count, std::memory_order_relaxed);
+        });
+        return changed;
+    }
+
+    // Moves every center to the mean of its points, leaving centers without
+    // points in place, and returns the largest distance moved.
+    T updateCenters()
+    {
+        // Partial sums and counts per block of points. Blocks are fewer and
+        // larger when there are many centers, to bound the memory.
+        const size_t k = _centers.size();
+        const size_t stride = k * (N + 1);
+        const size_t maxBlocks = std::max<size_t>(1, (size_t{1} << 22) / stride);
+        const size_t blockSize = std::max(
+            reductionBlockSize, (_points.size() + maxBlocks - 1) / maxBlocks);
+        const size_t blocks = (_points.size() + blockSize - 1) / blockSize;
+        _partials.assign(blocks * stride, 0.0);
+        _pool.run(blocks, [&] (size_t block) {
+            double* sums = _partials.data() + block * stride;
+            const size_t end = std::min(_points.size(), (block + 1) * blockSize);
+            for (size_t i = block * blockSize; i < end; i++) {
+                double* sum = sums + _labels[i] * (N + 1);
+                for (size_t c = 0; c < N; c++) {
+                    sum[c] += static_cast<double>(_points[i][c]);
+                }
+                sum[N] += 1;
+            }
+        });
+        for (size_t block = 1; block < blocks; block++) {
+            for (size_t j = 0; j < stride; j++) {
+                _partials[j] += _partials[block * stride + j];
+            }
+        }
+
+        _largestMovement = 0;
+        _secondMovement = 0;
+        _farthest = 0;
+        for (size_t j = 0; j < k; j++) {
+            const double* sum = _partials.data() + j * (N + 1);
+            _movement[j] = 0;
+            if (sum[N] == 0) {
+                continue;
+            }
+            auto center = point_type{};
+            for (size_t c = 0; c < N; c++) {
+                center[c] = static_cast<T>(sum[c] / sum[N]);
+            }
+            _movement[j] = std::sqrt(squaredDistanceTo(center, _centers[j]));
+            _centers[j] = center;
+            if (_movement[j] > _largestMovement) {
+                _secondMovement = _largestMovement;
+                _largestMovement = _movement[j];
+                _farthest = static_cast<std::uint32_t>(j);
+            } else if (_movement[j] > _secondMovement) {
+                _secondMovement = _movement[j];
+            }
+        }
+        _table.assign(std::span<const point_type>{_centers});
+        return _largestMovement;
+    }
+
+    // Half the distance from each center to the nearest other center: a
+    // point closer than that to its center cannot be closer to another.
+    void updateSeparation()
+    {
+        const size_t k = _centers.size();
+        parallelFor(_pool, k, 16, [&] (size_t begin, size_t end) {
+            for (size_t j = begin; j < end; j++) {
+                auto closest = infinity;
+                for (size_t other = 0; other < k; other++) {
+                    if (other != j) {
+                        closest = std::min(
+                            closest, squaredDistanceTo(_centers[j], _centers[other]));
+                    }
+                }
+                _separation[j] = std::sqrt(closest) / 2;
+            }
+        });
+    }
+
+    double inertia() const
+    {
+        const auto partials = blockPartials(_points, _pool, 0.0,
+            [this] (std::span<const point_type> block) {
+                const size_t offset = static_cast<size_t>(block.data() - _points.data());
+                double sum = 0;
+                for (size_t i = 0; i < block.size(); i++) {
+                    sum += static_cast<double>(squaredDistanceTo(
+                        block[i], _centers[_labels[offset + i]]));
+                }
+                return sum;
+            });
+        double total = 0;
+        for (double partial : partials) {
+            total += partial;
+        }
+        return total;
+    }
+
+    std::span<const point_type> _points;
+    ThreadPool& _pool;
+    std::vector<point_type> _centers;
+    CenterTable<T, N> _table;
+    std::vector<std::uint32_t> _labels;
+    std::vector<T> _upper;
+    std::vector<T> _lower;
+    std::vector<T> _separation;
+    std::vector<T> _movement;
+    T _largestMovement = 0;
+    T _secondMovement = 0;
+    std::uint32_t _farthest = 0;
+    std::vector<double> _partials;
+};
+
+template <class R>
+concept FloatingPointRange = PointRange<R> &&
+    std::floating_point<typename PointTraits<RangeValue<R>>::value_type>;
+
+} // namespace internal
+
+// Draws k initial centers among the points, as KMeansInit::PlusPlus does.
+template <internal::FloatingPointRange R>
+auto kmeansPlusPlus(
+    const R& points,
+    size_t k,
+    std::uint64_t seed = 0,
+    ThreadPool& pool = defaultThreadPool())
+{
+    using P = internal::RangeValue<R>;
+    auto input = std::span<const P>{internal::asSpan(points)};
+    assert(k > 0 && k <= input.size());
+    return internal::plusPlusCenters(input, k, seed, pool);
+}
+
+// Clusters the points starting from the given centers, of which there must
+// be fewer than 2^32.
+template <internal::FloatingPointRange R, internal::FloatingPointRange C>
+requires std::is_same_v<internal::RangeValue<R>, internal::RangeValue<C>>
+auto kmeans(
+    const R& points,
+    const C& initialCenters,
+    const KMeansOptions& options = {},
+    ThreadPool& pool = defaultThreadPool())
+{
+    using P = internal::RangeValue<R>;
+    using Solver = typename internal::ValueTraits<P>::template
+        rebindKind<internal::KMeansSolver>;
+
+    auto centers = internal::asSpan(initialCenters);
+    assert(!centers.empty() &&
+        centers.size() <= std::numeric_limits<std::uint32_t>::max());
+    auto solver = Solver{
+        internal::asSpan(points),
+        std::vector<P>(centers.begin(), centers.end()),
+        pool};
+    return solver.run(options);
+}
+
+// Clusters the points into k clusters, with 0 < k <= the number of points.
+template <internal::FloatingPointRange R>
+auto kmeans(
+    const R& points,
+    size_t k,
+    const KMeansOptions& options = {},
+    ThreadPool& pool = defaultThreadPool())
+{
+    using P = internal::RangeValue<R>;
+    auto input = std::span<const P>{internal::asSpan(points)};
+    assert(k > 0 && k <= input.size());
+    auto centers = options.init == KMeansInit::Random ?
+        internal::randomCenters(input, k, options.seed) :
+        internal::plusPlusCenters(input, k, options.seed, pool);
+    return kmeans(input, centers, options, pool);
+}
+
+// Writes the index of the nearest center of each point to labels; ties go
+// to the lowest index.
+template <internal::FloatingPointRange R, internal::FloatingPointRange C>
+requires std::is_same_v<internal::RangeValue<R>, internal::RangeValue<C>>
+void nearestCenters(
+    const R& points,
+    const C& centers,
+    std::span<std::uint32_t> labels,
+    ThreadPool& pool = defaultThreadPool())
+{
+    using P = internal::RangeValue<R>;
+    using T = typename internal::PointTraits<P>::value_type;
+    constexpr size_t n = internal::PointTraits<P>::size;
+
+    auto input = std::span<const P>{internal::asSpan(points)};
+    assert(labels.size() == input.size());
+    auto table = internal::CenterTable<T, n>{};
+    table.assign(std::span<const P>{internal::asSpan(centers)});
+    if (table.size() == 0) {
+        return;
+    }
+    internal::forEachNearest(input, table, pool,
+        [labels] (size_t i, const internal::NearestCenters<T>& nearest) {
+            labels[i] = nearest.index;
+        });
+}
+
+// Mini-batch k-means, for points that arrive in batches rather than being
+// held in memory at once. Each batch is assigned to the nearest centers, and
+// every center then moves to the mean of all points assigned to it so far,
+// so its learning rate decreases as 1 / count (Sculley, "Web-scale k-means
+// clustering").
+//
+// Unless initial centers are given, the first points are kept until there
+// are 3k of them and the centers are drawn from those by k-means++. finish()
+// draws them from what has arrived when the input ends before that. The
+// updates depend on the batches, but not on the thread pool.
+//
+// write() makes this a sink for StreamPipeline.
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+requires std::floating_point<T>
+class MiniBatchKMeans {
+public:
+    using point_type = Point<M, T, N>;
+
+    explicit MiniBatchKMeans(
+        size_t k, std::uint64_t seed = 0, ThreadPool& pool = defaultThreadPool())
+        : _k(k)
+        , _seed(seed)
+        , _pool(&pool)
+    {
+        assert(k > 0 && k <= std::numeric_limits<std::uint32_t>::max());
+    }
+
+    explicit MiniBatchKMeans(
+        std::vector<point_type> centers, ThreadPool& pool = defaultThreadPool())
+        : _k(centers.size())
+        , _pool(&pool)
+    {
+        assert(_k > 0 && _k <= std::numeric_limits<std::uint32_t>::max());
+        seed(std::move(centers));
+    }
+
+    void update(std::span<const point_type> batch)
+    {
+        if (_centers.empty()) {
+            _pending.insert(_pending.end(), batch.begin(), batch.end());
+            if (_pending.size() >= 3 * _k) {
+                finish();
+            }
+            return;
+        }
+
+        _labels.resize(batch.size());
+        internal::forEachNearest(batch, _table, *_pool,
+            [this] (size_t i, const internal::NearestCenters<T>& nearest) {
+                _labels[i] = nearest.index;
+            });
+
+        _sums.assign(_k * N, 0.0);
+        _batchCounts.assign(_k, 0);
+        for (size_t i = 0; i < batch.size(); i++) {
+            for (size_t c = 0; c < N; c++) {
+                _sums[_labels[i] * N + c] += static_cast<double>(batch[i][c]);
+            }
+            _batchCounts[_labels[i]]++;
+        }
+        for (size_t j = 0; j < _k; j++) {
+            if (_batchCounts[j] == 0) {
+                continue;
+            }
+            const auto previous = static_cast<double>(_counts[j]);
+            _counts[j] += _batchCounts[j];
+            const auto total = static_cast<double>(_counts[j]);
+            for (size_t c = 0; c < N; c++) {
+                _centers[j][c] = static_cast<T>(
+                    (static_cast<double>(_centers[j][c]) * previous + _sums[j * N + c]) /
+                    total);
+            }
+        }
+        _table.assign(std::span<const point_type>{_centers});
+    }
+
+    void write(std::span<const point_type> batch)
+    {
+        update(batch);
+    }
+
+    // Draws the centers from the points kept so far, if not done yet. There
+    // are fewer than k centers if fewer points have arrived.
+    void finish()
+    {
+        if (!_centers.empty() || _pending.empty()) {
+            return;
+        }
+        auto pending = std::move(_pending);
+        _pending = {};
+        const size_t k = std::min(_k, pending.size());
+        seed(internal::plusPlusCenters(
+            std::span<const point_type>{pending}, k, _seed, *_pool));
+        update(pending);
+    }
+
+    // Empty until the centers are drawn.
+    const std::vector<point_type>& centers() const
+    {
+        return _centers;
+    }
+
+    // Points assigned to each center so far.
+    const std::vector<std::uint64_t>& counts() const
+    {
+        return _counts;
+    }
+
+private:
+    void seed(std::vector<point_type> centers)
+    {
+        _centers = std::move(centers);
+        _k = _centers.size();
+        _counts.assign(_k, 0);
+        _table.assign(std::span<const point_type>{_centers});
+    }
+
+    size_t _k;
+    std::uint64_t _seed = 0;
+    ThreadPool* _pool;
+    std::vector<point_type> _centers;
+    std::vector<std::uint64_t> _counts;
+    internal::CenterTable<T, N> _table;
+    std::vector<point_type> _pending;
+    std::vector<std::uint32_t> _labels;
+    std::vector<double> _sums;
+    std::vector<std::uint64_t> _batchCounts;
+};
+
+} // namespace ve
@@ -0,0 +1,341 @@
+#pragma once
+
+#include "ve/batch.hpp"
+#include "ve/dispatch.hpp"
+#include "ve/internal/element.hpp"
+#include "ve/internal/instrument.hpp"
+#include "ve/internal/kernels.hpp"
+#include "ve/internal/traits.hpp"
+#include "ve/thread_pool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ve {
+
+// Functions over all pairs of points from two sets: dense distance matrices
+// and the pairs that lie within a radius of each other.
+//
+// The second set is copied axis by axis, so that the distances from one
+// point to many are computed by vectorized loops. The first set is split
+// across the pool in blocks of rows, and within a block the columns are
+// taken one tile at a time. A tile stays in L1 while every row of the block
+// is compared with it, and the output of the block for the tile stays in
+// L2. The distances are the same as those of squaredDistances() and
+// distances() in batch.hpp, bit for bit.
+
+namespace internal {
+
+// 512 columns of float xyz take 6 KiB, and a block's output for one tile
+// takes 64 KiB.
+constexpr size_t pairwiseBlockRows = 32;
+constexpr size_t pairwiseTileSize = 512;
+
+// Coordinates of points stored axis by axis, converted to R.
+template <class R, size_t N>
+class Columns {
+public:
+    template <class P>
+    explicit Columns(std::span<const P> points)
+        : _count(points.size())
+        , _coordinates(N * points.size())
+    {
+        for (size_t j = 0; j < _count; j++) {
+            for (size_t c = 0; c < N; c++) {
+                _coordinates[c * _count + j] = static_cast<R>(points[j][c]);
+            }
+        }
+    }
+
+    size_t size() const
+    {
+        return _count;
+    }
+
+    // Squared distances from the point to columns begin to begin + count.
+    template <class P>
+    VE_FORCE_INLINE void squares(
+        const P& point, size_t begin, size_t count, R* out) const
+    {
+        R x[N];
+        const R* axes[N];
+        for (size_t c = 0; c < N; c++) {
+            x[c] = static_cast<R>(point[c]);
+            axes[c] = _coordinates.data() + c * _count + begin;
+        }
+        for (size_t j = 0; j < count; j++) {
+            auto sum = R{0};
+            for (size_t c = 0; c < N; c++) {
+                const R d = x[c] - axes[c][j];
+                sum += d * d;
+            }
+            out[j] = sum;
+        }
+    }
+
+private:
+    size_t _count;
+    std::vector<R> _coordinates;
+};
+
+// Calls f(first, last, begin, count) for every block of rows [first, last)
+// and every tile of columns [begin, begin + count), with blocks split
+// across the pool and the tiles of a block in order.
+template <class F>
+void forEachTile(size_t rows, size_t columns, ThreadPool& pool, F&& f)
+{
+    const size_t blocks = (rows + pairwiseBlockRows - 1) / pairwiseBlockRows;
+    pool.run(columns == 0 ? 0 : blocks, [&] (size_t block) {
+        const size_t first = block * pairwiseBlockRows;
+        const size_t last = std::min(rows, first + pairwiseBlockRows);
+        for (size_t begin = 0; begin < columns; begin += pairwiseTileSize) {
+            f(first, last, begin, std::min(pairwiseTileSize, columns - begin));
+        }
+    });
+}
+
+template <class A, class B>
+concept PairablePoints = PointRange<A> && PointRange<B> &&
+    PointTraits<RangeValue<A>>::size == PointTraits<RangeValue<B>>::size;
+
+// The type distances between points are compared in: floating-point
+// components as they are, others as double, like KdTree.
+template <class R>
+using PairScalar = std::conditional_t<
+    std::is_floating_point_v<PromotedType<typename PointTraits<RangeValue<R>>::value_type>>,
+    PromotedType<typename PointTraits<RangeValue<R>>::value_type>,
+    double>;
+
+// Number of the squares that are at most the squared radius.
+template <class S>
+VE_FORCE_INLINE size_t countWithin(const S* squares, size_t count, S squaredRadius)
+{
+    size_t found = 0;
+    for (size_t j = 0; j < count; j++) {
+        found += squares[j] <= squaredRadius;
+    }
+    return found;
+}
+
+// Writes (i, begin + j) for the squares that are at most the squared radius
+// to pairs from offset on, as far as pairs reaches, and returns how many
+// there are. Whether a pair is near is as good as random, so the indices
+// are gathered without branches first.
+template <class S>
+VE_FORCE_INLINE size_t writeWithin(
+    std::span<std::pair<size_t, size_t>> pairs,
+    size_t offset,
+    size_t i,
+    size_t begin,
+    const S* squares,
+    size_t count,
+    S squaredRadius)
+{
+    std::uint32_t near[pairwiseTileSize];
+    size_t found = 0;
+    for (size_t j = 0; j < count; j++) {
+        near[found] = static_cast<std::uint32_t>(j);
+        found += squares[j] <= squaredRadius;
+    }
+    const size_t stored =
+        offset < pairs.size() ? std::min(found, pairs.size() - offset) : 0;
+    for (size_t k = 0; k < stored; k++) {
+        pairs[offset + k] = {i, begin + near[k]};
+    }
+    return found;
+}
+
+// Finds the pairs of pairsWithinRadius(). rowSquares(i, begin, count,
+// squares) computes the squared distances from row i to the columns of the
+// tile [begin, begin + count) that the row is paired with, and returns the
+// first of those columns and how many there are.
+//
+// A first pass counts the pairs of each row, so that the second writes them
+// straight to their place in the output. Rows whose pairs all lie past the
+// end of the output are skipped by the second pass.
+template <class S, class F>
+size_t findPairs(
+    size_t rows,
+    size_t columns,
+    S squaredRadius,
+    std::span<std::pair<size_t, size_t>> pairs,
+    ThreadPool& pool,
+    F&& rowSquares)
+{
+    std::vector<size_t> counts(rows);
+    forEachTile(rows, columns, pool,
+        [&] (size_t first, size_t last, size_t begin, size_t count) {
+            S squares[pairwiseTileSize];
+            for (size_t i = first; i < last; i++) {
+                dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+                    const auto [start, size] = rowSquares(i, begin, count, squares);
+                    counts[i] += countWithin(squares, size, squaredRadius);
+                });
+            }
+        });
+    std::vector<size_t> offsets(rows);
+    std::exclusive_scan(counts.begin(), counts.end(), offsets.begin(), size_t{0});
+    const size_t total = rows == 0 ? 0 : offsets.back() + counts.back();
+    if (total == 0 || pairs.empty()) {
+        return total;
+    }
+
+    // Each row moves its own offset on, and counts down its own pairs, as
+    // its tiles are written.
+    forEachTile(rows, columns, pool,
+        [&] (size_t first, size_t last, size_t begin, size_t count) {
+            S squares[pairwiseTileSize];
+            for (size_t i = first; i < last; i++) {
+                if (counts[i] == 0 || offsets[i] >= pairs.size()) {
+                    continue;
+                }
+                dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+                    const auto [start, size] = rowSquares(i, begin, count, squares);
+                    const size_t found = writeWithin(
+                        pairs, offsets[i], i, start, squares, size, squaredRadius);
+                    offsets[i] += found;
+                    counts[i] -= found;
+                });
+            }
+        });
+    return total;
+}
+
+} // namespace internal
+
+// Writes the squared distance between lhs[i] and rhs[j] to
+// matrix[i * rhs.size() + j], computed in the component type of the matrix.
+template <internal::PointRange A, internal::PointRange B,
+    internal::ScalarOutputRange Out>
+requires internal::PairablePoints<A, B>
+void pairwiseSquaredDistances(
+    const A& lhs,
+    const B& rhs,
+    Out&& matrix,
+    ThreadPool& pool = defaultThreadPool())
+{
+    VE_TIME_KERNEL(PairwiseSquaredDistances,
+        std::ranges::size(lhs) * std::ranges::size(rhs));
+    using R = std::ranges::range_value_t<Out>;
+    constexpr size_t n = internal::PointTraits<internal::RangeValue<A>>::size;
+
+    auto l = internal::asSpan(lhs);
+    auto out = internal::asSpan(matrix);
+    const auto columns = internal::Columns<R, n>{internal::asSpan(rhs)};
+    const size_t m = columns.size();
+    assert(out.size() == l.size() * m);
+    internal::forEachTile(l.size(), m, pool,
+        [&] (size_t first, size_t last, size_t begin, size_t count) {
+            internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+                for (size_t i = first; i < last; i++) {
+                    columns.squares(l[i], begin, count, out.data() + i * m + begin);
+                }
+            });
+        });
+}
+
+// Like pairwiseSquaredDistances(), with distances.
+template <internal::PointRange A, internal::PointRange B,
+    internal::ScalarOutputRange Out>
+requires internal::PairablePoints<A, B>
+void pairwiseDistances(
+    const A& lhs,
+    const B& rhs,
+    Out&& matrix,
+    Precision precision = Precision::Exact,
+    ThreadPool& pool = defaultThreadPool())
+{
+    VE_TIME_KERNEL(PairwiseDistances,
+        std::ranges::size(lhs) * std::ranges::size(rhs));
+    using R = std::ranges::range_value_t<Out>;
+    constexpr size_t n = internal::PointTraits<internal::RangeValue<A>>::size;
+
+    auto l = internal::asSpan(lhs);
+    auto out = internal::asSpan(matrix);
+    const auto columns = internal::Columns<R, n>{internal::asSpan(rhs)};
+    const size_t m = columns.size();
+    assert(out.size() == l.size() * m);
+    internal::forEachTile(l.size(), m, pool,
+        [&] (size_t first, size_t last, size_t begin, size_t count) {
+            internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+                for (size_t i = first; i < last; i++) {
+                    columns.squares(l[i], begin, count, out.data() + i * m + begin);
+                }
+            });
+            // The square roots of the tile while it is still in cache.
+            for (size_t i = first; i < last; i++) {
+                internal::sqrtInPlace(
+                    out.data() + i * m + begin, count, precision == Precision::Fast);
+            }
+        });
+}
+
+// Finds all pairs (i, j) with lhs[i] and rhs[j] at most radius apart, in
+// order of i and then j. The first pairs.size() of them are written to
+// pairs, and the return value is the number found, so a caller whose buffer
+// was too small can call again with one of that size. A negative radius
+// finds no pairs.
+template <internal::PointRange A, internal::PointRange B>
+requires internal::PairablePoints<A, B>
+size_t pairsWithinRadius(
+    const A& lhs,
+    const B& rhs,
+    internal::PairScalar<A> radius,
+    std::span<std::pair<size_t, size_t>> pairs,
+    ThreadPool& pool = defaultThreadPool())
+{
+    VE_TIME_KERNEL(PairsWithinRadius,
+        std::ranges::size(lhs) * std::ranges::size(rhs));
+    using S = internal::PairScalar<A>;
+    constexpr size_t n = internal::PointTraits<internal::RangeValue<A>>::size;
+
+    // Also rejects a NaN radius.
+    if (!(radius >= 0)) {
+        return 0;
+    }
+    auto l = internal::asSpan(lhs);
+    const auto columns = internal::Columns<S, n>{internal::asSpan(rhs)};
+    return internal::findPairs(l.size(), columns.size(), radius * radius, pairs, pool,
+        [&] (size_t i, size_t begin, size_t count, S* squares) VE_FORCE_INLINE_LAMBDA {
+            columns.squares(l[i], begin, count, squares);
+            return std::pair{begin, count};
+        });
+}
+
+// Finds all pairs (i, j) with i < j of points at most radius apart, in
+// order of i and then j, like the other pairsWithinRadius().
+template <internal::PointRange R>
+size_t pairsWithinRadius(
+    const R& points,
+    internal::PairScalar<R> radius,
+    std::span<std::pair<size_t, size_t>> pairs,
+    ThreadPool& pool = defaultThreadPool())
+{
+    VE_TIME_KERNEL(PairsWithinRadius,
+        std::ranges::size(points) * std::ranges::size(points) / 2);
+    using S = internal::PairScalar<R>;
+    constexpr size_t n = internal::PointTraits<internal::RangeValue<R>>::size;
+
+    if (!(radius >= 0)) {
+        return 0;
+    }
+    auto input = internal::asSpan(points);
+    const auto columns = internal::Columns<S, n>{input};
+    return internal::findPairs(input.size(), columns.size(), radius * radius, pairs, pool,
+        [&] (size_t i, size_t begin, size_t count, S* squares) VE_FORCE_INLINE_LAMBDA {
+            const size_t end = begin + count;
+            const size_t start = std::min(std::max(begin, i + 1), end);
+            columns.squares(input[i], start, end - start, squares);
+            return std::pair{start, end - start};
+        });
+}
+
+} // namespace ve
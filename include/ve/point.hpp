@@ -1,71 +1,106 @@
 #pragma once
 
+#include "ve/internal/hash.hpp"
+#include "ve/internal/instrument.hpp"
 #include "ve/internal/pod_wrapper.hpp"
+#include "ve/internal/simd.hpp"
+#include "ve/internal/unroll.hpp"
 #include "ve/vector.hpp"
 
 #include <cstddef>
+#include <functional>
 #include <ostream>
 #include <type_traits>
 #include <utility>
 
 namespace ve {
 
-template <template <class> class M, class T, size_t N = sizeof(M<T>) / sizeof(T)>
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
 class Point : public internal::PodWrapper<M, T, N> {
     static_assert(std::is_trivial<M<T>>());
     static_assert(std::is_standard_layout<M<T>>());
-    static_assert(sizeof(M<T>) == N * sizeof(T));
+    static_assert(internal::hasValidLayout<M<T>, T, N>());
+
+    using Simd = internal::simd::Kernel<M, T, N>;
 
 public:
     using internal::PodWrapper<M, T, N>::PodWrapper;
 
     template <class U> requires std::is_convertible_v<U, T>
-    constexpr Point(const Point<M, U, N>& other)
+    VE_FORCE_INLINE constexpr Point(const Point<M, U, N>& other)
     {
         *this = other;
     }
 
     template <class U> requires std::is_convertible_v<U, T>
-    constexpr Point& operator=(const Point<M, U, N>& other)
+    VE_FORCE_INLINE constexpr Point& operator=(const Point<M, U, N>& other)
     {
-        for (size_t i = 0; i < N; i++) {
-            (*this)[i] = other[i];
-        }
+        VE_COUNT(Conversion);
+        internal::unroll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+            internal::get<I, N>(*this) = internal::get<I, N>(other);
+        });
         return *this;
     }
 
-    constexpr T& operator[](size_t i)
+    VE_FORCE_INLINE constexpr T& operator[](size_t i)
     {
+        if constexpr (internal::hasBoundComponents<M<T>, T, N>()) {
+            if (internal::constantEvaluated()) {
+                return internal::componentAt<T, N>(*this, i);
+            }
+        }
         return *(reinterpret_cast<T*>(this) + i);
     }
 
-    constexpr const T& operator[](size_t i) const
+    VE_FORCE_INLINE constexpr const T& operator[](size_t i) const
     {
+        if constexpr (internal::hasBoundComponents<M<T>, T, N>()) {
+            if (internal::constantEvaluated()) {
+                return internal::componentAt<const T, N>(*this, i);
+            }
+        }
         return *(reinterpret_cast<const T*>(this) + i);
     }
 
     template <class U> requires std::is_convertible_v<U, T>
-    constexpr Point& operator+=(const Vector<M, U, N>& vector)
+    VE_FORCE_INLINE constexpr Point& operator+=(const Vector<M, U, N>& vector)
     {
-        for (size_t i = 0; i < N; i++) {
-            (*this)[i] += vector[i];
+        VE_COUNT(PointTranslate);
+        if constexpr (std::is_same_v<U, T> && Simd::enabled) {
+            if (!internal::constantEvaluated()) {
+                Simd::add(internal::data<N>(*this), internal::data<N>(vector));
+                return *this;
+            }
         }
+        internal::unroll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+            internal::get<I, N>(*this) += internal::get<I, N>(vector);
+        });
         return *this;
     }
 
     template <class U> requires std::is_convertible_v<U, T>
-    constexpr Point& operator-=(const Vector<M, U, N>& vector)
+    VE_FORCE_INLINE constexpr Point& operator-=(const Vector<M, U, N>& vector)
     {
-        for (size_t i = 0; i < N; i++) {
-            (*this)[i] -= vector[i];
+        VE_COUNT(PointTranslate);
+        if constexpr (std::is_same_v<U, T> && Simd::enabled) {
+            if (!internal::constantEvaluated()) {
+                Simd::sub(internal::data<N>(*this), internal::data<N>(vector));
+                return *this;
+            }
         }
+        internal::unroll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+            internal::get<I, N>(*this) -= internal::get<I, N>(vector);
+        });
         return *this;
     }
 };
 
 template <template <class> class M, class U, class V, size_t N>
-constexpr auto operator+(const Point<M, U, N>& point, const Vector<M, V, N>& vector)
+VE_FORCE_INLINE constexpr auto operator+(
+    const Point<M, U, N>& point, const Vector<M, V, N>& vector)
 {
+    VE_COUNT(Temporary);
     using R = decltype(std::declval<U>() + std::declval<V>());
     Point<M, R, N> result = point;
     result += vector;
@@ -73,8 +108,10 @@ constexpr auto operator+(const Point<M, U, N>& point, const Vector<M, V, N>& vec
 }
 
 template <template <class> class M, class U, class V, size_t N>
-constexpr auto operator-(const Point<M, U, N>& point, const Vector<M, V, N>& vector)
+VE_FORCE_INLINE constexpr auto operator-(
+    const Point<M, U, N>& point, const Vector<M, V, N>& vector)
 {
+    VE_COUNT(Temporary);
     using R = decltype(std::declval<U>() - std::declval<V>());
     Point<M, R, N> result = point;
     result -= vector;
@@ -82,36 +119,64 @@ constexpr auto operator-(const Point<M, U, N>& point, const Vector<M, V, N>& vec
 }
 
 template <template <class> class M, class U, class V, size_t N>
-constexpr auto operator-(const Point<M, U, N>& lhs, const Point<M, V, N>& rhs)
+VE_FORCE_INLINE constexpr auto operator-(
+    const Point<M, U, N>& lhs, const Point<M, V, N>& rhs)
 {
+    VE_COUNT(PointDifference);
+    VE_COUNT(Temporary);
     using R = decltype(std::declval<U>() - std::declval<V>());
+    using Simd = internal::simd::Kernel<M, R, N>;
     Vector<M, R, N> result;
-    for (size_t i = 0; i < N; i++) {
-        result[i] = lhs[i] - rhs[i];
+    if constexpr (std::is_same_v<U, R> && std::is_same_v<V, R> && Simd::enabled) {
+        if (!internal::constantEvaluated()) {
+            Simd::sub(
+                internal::data<N>(result), internal::data<N>(lhs), internal::data<N>(rhs));
+            return result;
+        }
     }
+    internal::unroll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+        internal::get<I, N>(result) =
+            internal::get<I, N>(lhs) - internal::get<I, N>(rhs);
+    });
     return result;
 }
 
 template <template <class> class M, class U, class V, size_t N>
-constexpr bool operator==(const Point<M, U, N>& lhs, const Point<M, V, N>& rhs)
+VE_FORCE_INLINE constexpr bool operator==(
+    const Point<M, U, N>& lhs, const Point<M, V, N>& rhs)
 {
-    for (size_t i = 0; i < N; i++) {
-        if (!(lhs[i] == rhs[i])) {
-            return false;
+    VE_COUNT(PointCompare);
+    using Simd = internal::simd::Kernel<M, U, N>;
+    if constexpr (std::is_same_v<U, V> && Simd::enabled) {
+        if (!internal::constantEvaluated()) {
+            return Simd::equal(internal::data<N>(lhs), internal::data<N>(rhs));
         }
     }
-    return true;
+    return internal::unrollAll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+        return internal::get<I, N>(lhs) == internal::get<I, N>(rhs);
+    });
 }
 
 template <template <class> class M, class U, class V, size_t N>
-constexpr bool operator!=(const Point<M, U, N>& lhs, const Point<M, V, N>& rhs)
+VE_FORCE_INLINE constexpr bool operator!=(
+    const Point<M, U, N>& lhs, const Point<M, V, N>& rhs)
 {
     return !(lhs == rhs);
 }
 
 template <template <class> class M, class U, class V, size_t N>
-constexpr auto distance(const Point<M, U, N>& lhs, const Point<M, V, N>& rhs)
+VE_FORCE_INLINE constexpr auto squaredDistance(
+    const Point<M, U, N>& lhs, const Point<M, V, N>& rhs)
+{
+    VE_COUNT(SquaredDistance);
+    return squaredLength(lhs - rhs);
+}
+
+template <template <class> class M, class U, class V, size_t N>
+VE_FORCE_INLINE constexpr auto distance(
+    const Point<M, U, N>& lhs, const Point<M, V, N>& rhs)
 {
+    VE_COUNT(Distance);
     return length(lhs - rhs);
 }
 
@@ -128,3 +193,15 @@ constexpr std::ostream& operator<<(std::ostream& output, const Point<M, T, N>& p
 }
 
 } // namespace ve
+
+namespace std {
+
+template <template <class> class M, class T, size_t N>
+struct hash<ve::Point<M, T, N>> {
+    size_t operator()(const ve::Point<M, T, N>& point) const
+    {
+        return ve::internal::hashComponents<N>(point);
+    }
+};
+
+} // namespace std
@@ -0,0 +1,480 @@
+#pragma once
+
+#include "ve/point.hpp"
+#include "ve/thread_pool.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace ve {
+
+namespace internal {
+
+// Hands out blocks carved from large slabs, which are only released when the
+// arena is destroyed. Blocks are aligned to a cache line.
+class ChunkArena {
+public:
+    static constexpr size_t alignment = 64;
+    static constexpr size_t defaultSlabSize = size_t{1} << 20;
+
+    explicit ChunkArena(size_t slabSize = defaultSlabSize)
+        : _slabSize(slabSize)
+    { }
+
+    ChunkArena(const ChunkArena&) = delete;
+    ChunkArena& operator=(const ChunkArena&) = delete;
+
+    ~ChunkArena()
+    {
+        for (const auto& slab : _slabs) {
+            ::operator delete(slab.data, std::align_val_t{alignment});
+        }
+    }
+
+    void* allocate(size_t size)
+    {
+        size = (size + alignment - 1) / alignment * alignment;
+        if (_slabs.empty() || _used + size > _slabs.back().size) {
+            const size_t slabSize = std::max(_slabSize, size);
+            _slabs.push_back({
+                ::operator new(slabSize, std::align_val_t{alignment}), slabSize});
+            _used = 0;
+        }
+        void* block = static_cast<std::byte*>(_slabs.back().data) + _used;
+        _used += size;
+        return block;
+    }
+
+    // Bytes taken from the system, including unused slab tails.
+    size_t reserved() const
+    {
+        size_t total = 0;
+        for (const auto& slab : _slabs) {
+            total += slab.size;
+        }
+        return total;
+    }
+
+private:
+    struct Slab {
+        void* data;
+        size_t size;
+    };
+
+    size_t _slabSize;
+    std::vector<Slab> _slabs;
+    size_t _used = 0;
+};
+
+// Chunks of one attribute, stored as raw bytes. Values are trivially
+// copyable, so they are created by copying their bytes into place.
+struct AttributeChannel {
+    size_t elementSize;
+    std::vector<std::byte> defaultValue;
+    std::vector<std::byte*> chunks;
+};
+
+} // namespace internal
+
+// Handle of a per-point attribute channel of a PointCloud.
+template <class A>
+class Attribute {
+public:
+    using value_type = A;
+
+private:
+    template <template <class> class, class, size_t> friend class PointCloud;
+
+    explicit Attribute(size_t channel)
+        : _channel(channel)
+    { }
+
+    size_t _channel;
+};
+
+// An append-only sequence of points stored in fixed-size chunks taken from
+// an arena. Appending never moves existing points, so indices, references
+// and chunk spans stay valid for the lifetime of the cloud (until clear()
+// for indices). Memory grows by one chunk at a time, without the copy and
+// the 2x peak of a reallocating vector.
+//
+// Attribute channels (normals, colors, ids, ...) hold one trivially copyable
+// value per point, in chunks parallel to the point chunks, so chunk c of
+// every channel covers the same points. chunk(c) and attributeChunk(a, c)
+// return contiguous spans, which batch kernels and parallelForChunks() can
+// process independently.
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+class PointCloud {
+public:
+    using value_type = Point<M, T, N>;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using size_type = size_t;
+
+    template <bool Const>
+    class Iterator;
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    static constexpr size_t defaultChunkSize = 4096;
+
+    // The chunk size is a number of points, and must be a power of two.
+    explicit PointCloud(size_t chunkSize = defaultChunkSize)
+        : _chunkShift(static_cast<size_t>(std::countr_zero(chunkSize)))
+        , _arena(std::make_unique<internal::ChunkArena>(
+            std::max(internal::ChunkArena::defaultSlabSize,
+                chunkSize * sizeof(value_type))))
+    {
+        assert(std::has_single_bit(chunkSize));
+    }
+
+    PointCloud(PointCloud&&) noexcept = default;
+    PointCloud& operator=(PointCloud&&) noexcept = default;
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    size_t chunkSize() const
+    {
+        return size_t{1} << _chunkShift;
+    }
+
+    // Number of chunks holding points; the last one may be partially filled.
+    size_t chunkCount() const
+    {
+        return (_size + chunkSize() - 1) >> _chunkShift;
+    }
+
+    // Bytes held by the arena for points and attributes.
+    size_t memoryUsage() const
+    {
+        return _arena->reserved();
+    }
+
+    void reserve(size_t count)
+    {
+        const size_t chunks = (count + chunkSize() - 1) >> _chunkShift;
+        while (_chunks.size() < chunks) {
+            allocateChunk();
+        }
+    }
+
+    // Removes all points, keeping their chunks for reuse. Attribute channels
+    // stay registered.
+    void clear()
+    {
+        _size = 0;
+    }
+
+    // Appends a point, with default values for all attributes, and returns
+    // its index.
+    size_t push_back(const value_type& point)
+    {
+        const size_t index = _size;
+        const size_t offset = index & (chunkSize() - 1);
+        if (offset == 0) {
+            const size_t chunk = index >> _chunkShift;
+            if (chunk == _chunks.size()) {
+                allocateChunk();
+            }
+            _tail = _chunks[chunk];
+        }
+        new (_tail + offset) value_type(point);
+        if (!_channels.empty()) {
+            appendDefaultAttributes(index);
+        }
+        _size++;
+        return index;
+    }
+
+    value_type& operator[](size_t index)
+    {
+        assert(index < _size);
+        return _chunks[index >> _chunkShift][index & (chunkSize() - 1)];
+    }
+
+    const value_type& operator[](size_t index) const
+    {
+        assert(index < _size);
+        return _chunks[index >> _chunkShift][index & (chunkSize() - 1)];
+    }
+
+    std::span<value_type> chunk(size_t c)
+    {
+        return {_chunks[c], chunkLength(c)};
+    }
+
+    std::span<const value_type> chunk(size_t c) const
+    {
+        return {_chunks[c], chunkLength(c)};
+    }
+
+    // Adds an attribute channel. Existing points get the default value.
+    template <class A>
+    Attribute<A> addAttribute(const A& defaultValue = A{})
+    {
+        static_assert(std::is_trivially_copyable_v<A>);
+        static_assert(alignof(A) <= internal::ChunkArena::alignment);
+
+        auto& channel = _channels.emplace_back();
+        channel.elementSize = sizeof(A);
+        channel.defaultValue.resize(sizeof(A));
+        std::memcpy(channel.defaultValue.data(), &defaultValue, sizeof(A));
+        for (size_t c = 0; c < _chunks.size(); c++) {
+            auto* data = allocateChannelChunk(channel);
+            channel.chunks.push_back(data);
+            if (c < chunkCount()) {
+                std::uninitialized_fill_n(
+                    reinterpret_cast<A*>(data), chunkLength(c), defaultValue);
+            }
+        }
+        return Attribute<A>{_channels.size() - 1};
+    }
+
+    template <class A>
+    A& attribute(Attribute<A> id, size_t index)
+    {
+        assert(index < _size);
+        return channelChunk<A>(id, index >> _chunkShift)[index & (chunkSize() - 1)];
+    }
+
+    template <class A>
+    const A& attribute(Attribute<A> id, size_t index) const
+    {
+        assert(index < _size);
+        return channelChunk<A>(id, index >> _chunkShift)[index & (chunkSize() - 1)];
+    }
+
+    template <class A>
+    std::span<A> attributeChunk(Attribute<A> id, size_t c)
+    {
+        return {channelChunk<A>(id, c), chunkLength(c)};
+    }
+
+    template <class A>
+    std::span<const A> attributeChunk(Attribute<A> id, size_t c) const
+    {
+        return {channelChunk<A>(id, c), chunkLength(c)};
+    }
+
+    // Calls f(c) for every chunk index, on the pool.
+    template <class F>
+    void parallelForChunks(ThreadPool& pool, F&& f) const
+    {
+        pool.run(chunkCount(), f);
+    }
+
+    template <class F>
+    void parallelForChunks(F&& f) const
+    {
+        parallelForChunks(defaultThreadPool(), f);
+    }
+
+    iterator begin()
+    {
+        return {this, 0};
+    }
+
+    iterator end()
+    {
+        return {this, _size};
+    }
+
+    const_iterator begin() const
+    {
+        return {this, 0};
+    }
+
+    const_iterator end() const
+    {
+        return {this, _size};
+    }
+
+    template <bool Const>
+    class Iterator {
+    public:
+        using Cloud = std::conditional_t<Const, const PointCloud, PointCloud>;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Point<M, T, N>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+        Iterator() = default;
+
+        Iterator(Cloud* cloud, size_t index)
+            : _cloud(cloud)
+            , _index(index)
+        { }
+
+        operator Iterator<true>() const requires (!Const)
+        {
+            return {_cloud, _index};
+        }
+
+        reference operator*() const
+        {
+            return (*_cloud)[_index];
+        }
+
+        pointer operator->() const
+        {
+            return &(*_cloud)[_index];
+        }
+
+        reference operator[](difference_type offset) const
+        {
+            return (*_cloud)[static_cast<size_t>(
+                static_cast<difference_type>(_index) + offset)];
+        }
+
+        // Index of the point in the cloud.
+        size_t index() const
+        {
+            return _index;
+        }
+
+        Iterator& operator++()
+        {
+            _index++;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            auto copy = *this;
+            _index++;
+            return copy;
+        }
+
+        Iterator& operator--()
+        {
+            _index--;
+            return *this;
+        }
+
+        Iterator operator--(int)
+        {
+            auto copy = *this;
+            _index--;
+            return copy;
+        }
+
+        Iterator& operator+=(difference_type offset)
+        {
+            _index = static_cast<size_t>(
+                static_cast<difference_type>(_index) + offset);
+            return *this;
+        }
+
+        Iterator& operator-=(difference_type offset)
+        {
+            return *this += -offset;
+        }
+
+        friend Iterator operator+(Iterator it, difference_type offset)
+        {
+            return it += offset;
+        }
+
+        friend Iterator operator+(difference_type offset, Iterator it)
+        {
+            return it += offset;
+        }
+
+        friend Iterator operator-(Iterator it, difference_type offset)
+        {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const Iterator& lhs, const Iterator& rhs)
+        {
+            return static_cast<difference_type>(lhs._index) -
+                static_cast<difference_type>(rhs._index);
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs)
+        {
+            return lhs._index == rhs._index;
+        }
+
+        friend auto operator<=>(const Iterator& lhs, const Iterator& rhs)
+        {
+            return lhs._index <=> rhs._index;
+        }
+
+    private:
+        Cloud* _cloud = nullptr;
+        size_t _index = 0;
+    };
+
+private:
+    size_t chunkLength(size_t c) const
+    {
+        assert(c < chunkCount());
+        return std::min(chunkSize(), _size - (c << _chunkShift));
+    }
+
+    template <class A>
+    A* channelChunk(Attribute<A> id, size_t c) const
+    {
+        const auto& channel = _channels[id._channel];
+        assert(channel.elementSize == sizeof(A));
+        return std::launder(reinterpret_cast<A*>(channel.chunks[c]));
+    }
+
+    void appendDefaultAttributes(size_t index)
+    {
+        const size_t chunk = index >> _chunkShift;
+        const size_t offset = index & (chunkSize() - 1);
+        for (auto& channel : _channels) {
+            std::memcpy(
+                channel.chunks[chunk] + offset * channel.elementSize,
+                channel.defaultValue.data(),
+                channel.elementSize);
+        }
+    }
+
+    std::byte* allocateChannelChunk(const internal::AttributeChannel& channel)
+    {
+        return static_cast<std::byte*>(
+            _arena->allocate(chunkSize() * channel.elementSize));
+    }
+
+    void allocateChunk()
+    {
+        _chunks.push_back(static_cast<value_type*>(
+            _arena->allocate(chunkSize() * sizeof(value_type))));
+        for (auto& channel : _channels) {
+            channel.chunks.push_back(allocateChannelChunk(channel));
+        }
+    }
+
+    size_t _chunkShift;
+    size_t _size = 0;
+    // Chunk that the next point goes into, unless it starts a new chunk.
+    value_type* _tail = nullptr;
+    std::unique_ptr<internal::ChunkArena> _arena;
+    std::vector<value_type*> _chunks;
+    std::vector<internal::AttributeChannel> _channels;
+};
+
+} // namespace ve
@@ -0,0 +1,755 @@
+#pragma once
+
+#include "ve/dispatch.hpp"
+#include "ve/internal/element.hpp"
+#include "ve/internal/traits.hpp"
+#include "ve/point.hpp"
+#include "ve/vector.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ve {
+
+// Compressed point stream layout (version 1):
+//
+//   PointStreamHeader
+//   blocks of blockSize points, the last one possibly shorter, each holding
+//     the quantized components of its first point as zigzag varints, then
+//     the deltas from each point to the next, either
+//       Varint:    as zigzag varints, point by point, or
+//       BitPacked: as one byte per component giving a bit width, then per
+//                  component the zigzag deltas in that many bits each, in
+//                  the lanes described at internal::packLanes
+//   the block index: the offset of each block from the start, as uint64
+//   PointStreamTrailer
+//
+// A component v is stored as q = round(v / precision), so it decodes to
+// q * precision, within precision / 2 of v (plus the rounding of the
+// decoded type). Points that follow each other closely have small deltas,
+// which take one or two bytes per component instead of four or eight.
+//
+// Like point files, the header and index are in the byte order of the
+// writing machine, which the byte order mark detects.
+struct PointStreamHeader {
+    char magic[4];
+    std::uint16_t version;
+    std::uint16_t components;
+    std::uint32_t byteOrder;
+    std::uint32_t blockSize;
+    std::uint8_t encoding;
+    std::uint8_t reserved[7];
+    double precision;
+};
+
+struct PointStreamTrailer {
+    std::uint64_t count;
+    std::uint64_t indexOffset;
+    char magic[4];
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(PointStreamHeader) == 32);
+static_assert(sizeof(PointStreamTrailer) == 24);
+
+constexpr char pointStreamMagic[4] = {'V', 'E', 'P', 'Z'};
+constexpr std::uint16_t pointStreamVersion = 1;
+constexpr std::uint32_t pointStreamByteOrderMark = 0x01020304;
+
+enum class DeltaEncoding : std::uint8_t {
+    // One varint per delta: compact for irregular steps.
+    Varint = 0,
+    // Fixed bit widths per block and component: faster to decode.
+    BitPacked = 1,
+};
+
+struct PointCodecOptions {
+    DeltaEncoding encoding = DeltaEncoding::BitPacked;
+    // Points per block; decoding one point decodes its whole block.
+    std::uint32_t blockSize = 256;
+};
+
+class PointCodecError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+namespace internal {
+
+// Quantized components are kept below this bound in magnitude so that deltas
+// between them fit in an int64_t.
+constexpr double maxQuantized = 4611686018427387904.0; // 2^62
+
+constexpr std::uint64_t zigzag(std::int64_t value)
+{
+    return (static_cast<std::uint64_t>(value) << 1) ^
+        static_cast<std::uint64_t>(value >> 63);
+}
+
+constexpr std::int64_t unzigzag(std::uint64_t value)
+{
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+inline void appendVarint(std::vector<std::byte>& output, std::uint64_t value)
+{
+    while (value >= 0x80) {
+        output.push_back(static_cast<std::byte>(value | 0x80));
+        value >>= 7;
+    }
+    output.push_back(static_cast<std::byte>(value));
+}
+
+// Reads a varint and returns the position after it, or nullptr if it runs
+// past the end.
+inline const std::byte* readVarint(
+    const std::byte* data, const std::byte* end, std::uint64_t& value)
+{
+    value = 0;
+    for (unsigned shift = 0; shift < 64 && data < end; shift += 7) {
+        const auto byte = static_cast<std::uint64_t>(*data++);
+        value |= (byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            return data;
+        }
+    }
+    return nullptr;
+}
+
+// Bit-packed deltas are laid out in packLanes lanes of 32-bit words: delta j
+// goes to lane j % packLanes, at position j / packLanes of the lane's bit
+// stream, and word k of every lane is stored before word k + 1 of any. All
+// lanes then take their next value from the same word at the same shift, so
+// unpacking is a plain loop over lanes that compilers vectorize for any
+// instruction set. Widths above 32 bits are split into a stream of the low
+// 32 bits and a stream of the rest.
+constexpr size_t packLanes = 8;
+
+constexpr size_t packRows(size_t count)
+{
+    return (count + packLanes - 1) / packLanes;
+}
+
+// The size of a stream of rows values per lane in width bits each.
+constexpr size_t packedBytes(size_t rows, unsigned width)
+{
+    return (rows * width + 31) / 32 * packLanes * sizeof(std::uint32_t);
+}
+
+constexpr size_t packedBytesForWidth(size_t rows, unsigned width)
+{
+    return packedBytes(rows, std::min(width, 32u)) +
+        packedBytes(rows, width > 32 ? width - 32 : 0);
+}
+
+VE_FORCE_INLINE std::uint32_t loadLittle32(const std::byte* data)
+{
+    std::uint32_t word;
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(&word, data, sizeof(word));
+    } else {
+        word = 0;
+        for (int i = 0; i < 4; i++) {
+            word |= static_cast<std::uint32_t>(data[i]) << (8 * i);
+        }
+    }
+    return word;
+}
+
+// Loads one word of every lane. Loading the lanes one by one rather than
+// with a single memcpy lets compilers use one vector load instead of a copy
+// through the stack.
+VE_FORCE_INLINE void loadLanes(const std::byte* data, std::uint32_t (&words)[packLanes])
+{
+    for (size_t lane = 0; lane < packLanes; lane++) {
+        words[lane] = loadLittle32(data + lane * sizeof(std::uint32_t));
+    }
+}
+
+// Appends the values, shifted right by shift and cut to width bits, as one
+// stream.
+inline void appendPacked(
+    std::vector<std::byte>& output,
+    std::vector<std::uint32_t>& words,
+    const std::uint64_t* values,
+    size_t count,
+    unsigned shift,
+    unsigned width)
+{
+    const size_t rows = packRows(count);
+    words.assign(packedBytes(rows, width) / sizeof(std::uint32_t), 0);
+    const std::uint64_t mask = (std::uint64_t{1} << width) - 1;
+    for (size_t j = 0; j < count && width > 0; j++) {
+        const auto value = static_cast<std::uint32_t>((values[j] >> shift) & mask);
+        const size_t lane = j % packLanes;
+        const size_t bit = j / packLanes * width;
+        const size_t word = bit / 32;
+        words[word * packLanes + lane] |= value << (bit % 32);
+        if (bit % 32 + width > 32) {
+            words[(word + 1) * packLanes + lane] |= value >> (32 - bit % 32);
+        }
+    }
+    for (auto word : words) {
+        for (int i = 0; i < 4; i++) {
+            output.push_back(static_cast<std::byte>(word >> (8 * i)));
+        }
+    }
+}
+
+// Reads a stream of rows values per lane in width bits each, at most 32,
+// into values in their original order.
+VE_FORCE_INLINE void unpack(
+    const std::byte* data, size_t rows, unsigned width, std::uint32_t* values)
+{
+    if (width == 0) {
+        std::fill_n(values, rows * packLanes, 0);
+        return;
+    }
+    const std::uint32_t mask = width == 32 ? ~std::uint32_t{0} :
+        (std::uint32_t{1} << width) - 1;
+    for (size_t i = 0; i < rows; i++) {
+        const size_t bit = i * width;
+        const unsigned shift = bit % 32;
+        const std::byte* row = data + bit / 32 * packLanes * sizeof(std::uint32_t);
+        std::uint32_t* out = values + i * packLanes;
+        std::uint32_t words[packLanes];
+        loadLanes(row, words);
+        if (shift + width <= 32) {
+            for (size_t lane = 0; lane < packLanes; lane++) {
+                out[lane] = (words[lane] >> shift) & mask;
+            }
+        } else {
+            std::uint32_t next[packLanes];
+            loadLanes(row + sizeof(words), next);
+            for (size_t lane = 0; lane < packLanes; lane++) {
+                out[lane] = ((words[lane] >> shift) | (next[lane] << (32 - shift))) & mask;
+            }
+        }
+    }
+}
+
+template <class T>
+std::int64_t quantize(T value, double precision)
+{
+    const double scaled = static_cast<double>(
+        static_cast<PromotedType<T>>(value)) / precision;
+    if (!(std::abs(scaled) < maxQuantized)) {
+        throw PointCodecError{"point cannot be quantized with this precision"};
+    }
+    return std::llround(scaled);
+}
+
+// Zero when the value is less than 2^51 in magnitude; or'ed over many
+// values, it tells whether all of them are.
+VE_FORCE_INLINE std::uint64_t largeQuantized(std::int64_t value)
+{
+    return (static_cast<std::uint64_t>(value) + (std::uint64_t{1} << 51)) >> 52;
+}
+
+constexpr std::uint64_t smallQuantizedBias = 0x4338000000000000; // 1.5 * 2^52
+
+// Converts a value of less than 2^51 in magnitude exactly, like a cast, but
+// with operations that vectorize without AVX-512: the value is added to the
+// mantissa of 1.5 * 2^52, which is then subtracted.
+VE_FORCE_INLINE double smallQuantizedToDouble(std::int64_t value)
+{
+    return std::bit_cast<double>(static_cast<std::uint64_t>(value) + smallQuantizedBias) -
+        std::bit_cast<double>(smallQuantizedBias);
+}
+
+template <class T>
+VE_FORCE_INLINE T dequantize(double value, double precision)
+{
+    const double scaled = value * precision;
+    if constexpr (std::is_floating_point_v<PromotedType<T>>) {
+        return static_cast<T>(static_cast<PromotedType<T>>(scaled));
+    } else {
+        return static_cast<T>(std::llround(scaled));
+    }
+}
+
+} // namespace internal
+
+// Compresses points into a stream with the layout above, block by block, so
+// it holds one block of points however many are written. The stream is
+// written front to back, without seeking, and is complete once finish() has
+// written the index and trailer.
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+class PointEncoder {
+public:
+    using point_type = Point<M, T, N>;
+
+    PointEncoder(
+        std::ostream& output, double precision, PointCodecOptions options = {})
+        : _output(output)
+        , _options(options)
+        , _precision(precision)
+    {
+        assert(precision > 0 && std::isfinite(precision));
+        assert(options.blockSize > 0);
+        auto header = PointStreamHeader{};
+        std::copy(std::begin(pointStreamMagic), std::end(pointStreamMagic),
+            header.magic);
+        header.version = pointStreamVersion;
+        header.components = N;
+        header.byteOrder = pointStreamByteOrderMark;
+        header.blockSize = options.blockSize;
+        header.encoding = static_cast<std::uint8_t>(options.encoding);
+        header.precision = precision;
+        put(&header, sizeof(header));
+        _block.reserve(options.blockSize);
+    }
+
+    PointEncoder(const PointEncoder&) = delete;
+    PointEncoder& operator=(const PointEncoder&) = delete;
+
+    ~PointEncoder()
+    {
+        if (!_finished) {
+            try {
+                finish();
+            } catch (...) {
+            }
+        }
+    }
+
+    std::uint64_t size() const
+    {
+        return _count;
+    }
+
+    // Bytes written to the output so far.
+    std::uint64_t bytesWritten() const
+    {
+        return _written;
+    }
+
+    void write(const point_type& point)
+    {
+        write(std::span<const point_type>{&point, 1});
+    }
+
+    // Throws PointCodecError for components that are not finite or too
+    // large for the precision; the points before the bad one are kept.
+    template <internal::PointRange R>
+    requires std::is_same_v<internal::RangeValue<R>, point_type>
+    void write(const R& points)
+    {
+        assert(!_finished);
+        for (const auto& point : internal::asSpan(points)) {
+            Quantized quantized;
+            for (size_t c = 0; c < N; c++) {
+                quantized[c] = internal::quantize(point[c], _precision);
+            }
+            _block.push_back(quantized);
+            _count++;
+            if (_block.size() == _options.blockSize) {
+                writeBlock();
+            }
+        }
+    }
+
+    void finish()
+    {
+        if (_finished) {
+            return;
+        }
+        _finished = true;
+        if (!_block.empty()) {
+            writeBlock();
+        }
+        auto trailer = PointStreamTrailer{};
+        trailer.count = _count;
+        trailer.indexOffset = _written;
+        std::copy(std::begin(pointStreamMagic), std::end(pointStreamMagic),
+            trailer.magic);
+        put(_offsets.data(), _offsets.size() * sizeof(std::uint64_t));
+        put(&trailer, sizeof(trailer));
+        _output.flush();
+        if (!_output) {
+            throw PointCodecError{"failed to finish point stream"};
+        }
+    }
+
+private:
+    using Quantized = Point<M, std::int64_t, N>;
+
+    void writeBlock()
+    {
+        _offsets.push_back(_written);
+        _bytes.clear();
+        for (size_t c = 0; c < N; c++) {
+            internal::appendVarint(_bytes, internal::zigzag(_block[0][c]));
+        }
+
+        const size_t deltas = _block.size() - 1;
+        _zigzags.resize(N * deltas);
+        for (size_t j = 0; j < deltas; j++) {
+            const auto delta = _block[j + 1] - _block[j];
+            for (size_t c = 0; c < N; c++) {
+                _zigzags[c * deltas + j] = internal::zigzag(delta[c]);
+            }
+        }
+
+        if (_options.encoding == DeltaEncoding::Varint) {
+            for (size_t j = 0; j < deltas; j++) {
+                for (size_t c = 0; c < N; c++) {
+                    internal::appendVarint(_bytes, _zigzags[c * deltas + j]);
+                }
+            }
+        } else {
+            unsigned widths[N];
+            for (size_t c = 0; c < N; c++) {
+                std::uint64_t bits = 0;
+                for (size_t j = 0; j < deltas; j++) {
+                    bits |= _zigzags[c * deltas + j];
+                }
+                widths[c] = static_cast<unsigned>(std::bit_width(bits));
+                _bytes.push_back(static_cast<std::byte>(widths[c]));
+            }
+            for (size_t c = 0; c < N; c++) {
+                const std::uint64_t* zigzags = _zigzags.data() + c * deltas;
+                internal::appendPacked(_bytes, _words, zigzags, deltas, 0,
+                    std::min(widths[c], 32u));
+                if (widths[c] > 32) {
+                    internal::appendPacked(
+                        _bytes, _words, zigzags, deltas, 32, widths[c] - 32);
+                }
+            }
+        }
+        put(_bytes.data(), _bytes.size());
+        _block.clear();
+    }
+
+    void put(const void* data, size_t size)
+    {
+        _output.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (!_output) {
+            throw PointCodecError{"failed to write point stream"};
+        }
+        _written += size;
+    }
+
+    std::ostream& _output;
+    PointCodecOptions _options;
+    double _precision;
+    std::vector<Quantized> _block;
+    std::vector<std::uint64_t> _zigzags;
+    std::vector<std::uint32_t> _words;
+    std::vector<std::byte> _bytes;
+    std::vector<std::uint64_t> _offsets;
+    std::uint64_t _count = 0;
+    std::uint64_t _written = 0;
+    bool _finished = false;
+};
+
+// Decodes a complete point stream held in memory, for instance a mapped
+// file. Any block can be decoded on its own, so points are read from any
+// position without decoding what comes before their block, and sequential
+// reads need one block of working memory. The stream is validated when the
+// decoder is created, and blocks when they are decoded; corrupt data throws
+// PointCodecError.
+//
+// A decoder has working buffers, so threads decoding the same stream in
+// parallel each need their own.
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+class PointDecoder {
+public:
+    using point_type = Point<M, T, N>;
+
+    explicit PointDecoder(std::span<const std::byte> data)
+        : _data(data)
+    {
+        if (data.size() < sizeof(PointStreamHeader) + sizeof(PointStreamTrailer)) {
+            throw PointCodecError{"not a point stream"};
+        }
+        std::memcpy(&_header, data.data(), sizeof(_header));
+        std::memcpy(&_trailer, data.data() + data.size() - sizeof(_trailer),
+            sizeof(_trailer));
+        if (!std::equal(std::begin(pointStreamMagic), std::end(pointStreamMagic),
+                _header.magic) ||
+                !std::equal(std::begin(pointStreamMagic), std::end(pointStreamMagic),
+                    _trailer.magic)) {
+            throw PointCodecError{"not a point stream"};
+        }
+        if (_header.byteOrder != pointStreamByteOrderMark) {
+            throw PointCodecError{"point stream was written with a different byte order"};
+        }
+        if (_header.version != pointStreamVersion) {
+            throw PointCodecError{
+                "unsupported point stream version " + std::to_string(_header.version)};
+        }
+        if (_header.components != N) {
+            throw PointCodecError{"point stream components do not match the point type"};
+        }
+        if (_header.blockSize == 0 ||
+                _header.encoding > static_cast<std::uint8_t>(DeltaEncoding::BitPacked) ||
+                !(_header.precision > 0)) {
+            throw PointCodecError{"point stream is corrupt"};
+        }
+
+        const std::uint64_t blocks =
+            (_trailer.count + _header.blockSize - 1) / _header.blockSize;
+        const std::uint64_t indexEnd = data.size() - sizeof(PointStreamTrailer);
+        if (_trailer.indexOffset < sizeof(PointStreamHeader) ||
+                _trailer.indexOffset > indexEnd ||
+                (indexEnd - _trailer.indexOffset) / sizeof(std::uint64_t) != blocks ||
+                (indexEnd - _trailer.indexOffset) % sizeof(std::uint64_t) != 0) {
+            throw PointCodecError{"point stream is truncated or corrupt"};
+        }
+        _offsets.resize(blocks + 1);
+        std::memcpy(_offsets.data(), data.data() + _trailer.indexOffset,
+            blocks * sizeof(std::uint64_t));
+        _offsets[blocks] = _trailer.indexOffset;
+        for (size_t b = 0; b < blocks; b++) {
+            if (_offsets[b] < (b == 0 ? sizeof(PointStreamHeader) : _offsets[b - 1]) ||
+                    _offsets[b] >= _offsets[b + 1]) {
+                throw PointCodecError{"point stream is truncated or corrupt"};
+            }
+        }
+        // The working buffers hold the largest block, which is smaller than
+        // the block size for short streams.
+        _stride = blocks == 0 ? 0 : blockPoints(0);
+        _columns.resize(N * _stride);
+        _low.resize(internal::packRows(_stride) * internal::packLanes);
+        _high.resize(_low.size());
+        _values.resize(N * _stride);
+    }
+
+    std::uint64_t size() const
+    {
+        return _trailer.count;
+    }
+
+    double precision() const
+    {
+        return _header.precision;
+    }
+
+    DeltaEncoding encoding() const
+    {
+        return static_cast<DeltaEncoding>(_header.encoding);
+    }
+
+    size_t blockSize() const
+    {
+        return _header.blockSize;
+    }
+
+    size_t blockCount() const
+    {
+        return _offsets.size() - 1;
+    }
+
+    // Points in the block: blockSize(), except maybe for the last block.
+    size_t blockPoints(size_t block) const
+    {
+        assert(block < blockCount());
+        return static_cast<size_t>(std::min<std::uint64_t>(
+            _header.blockSize, _trailer.count - block * std::uint64_t{_header.blockSize}));
+    }
+
+    // Decodes the block to the start of points, which must have room for
+    // its points, and returns how many there are.
+    size_t decodeBlock(size_t block, std::span<point_type> points)
+    {
+        const size_t count = blockPoints(block);
+        assert(points.size() >= count);
+        const std::byte* data = _data.data() + _offsets[block];
+        const std::byte* end = _data.data() + _offsets[block + 1];
+        const size_t stride = _stride;
+
+        for (size_t c = 0; c < N; c++) {
+            std::uint64_t first;
+            data = internal::readVarint(data, end, first);
+            if (data == nullptr) {
+                throw PointCodecError{"point stream block is corrupt"};
+            }
+            _columns[c * stride] = internal::unzigzag(first);
+        }
+        if (encoding() == DeltaEncoding::Varint) {
+            decodeVarints(data, end, count);
+        } else {
+            decodePacked(data, end, count);
+        }
+
+        // Dequantizing each component and then interleaving them keeps both
+        // loops simple enough to vectorize.
+        const double scale = _header.precision;
+        const std::int64_t* columns = _columns.data();
+        T* values = _values.data();
+        internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+            std::uint64_t large = 0;
+            for (size_t c = 0; c < N; c++) {
+                for (size_t j = 0; j < count; j++) {
+                    large |= internal::largeQuantized(columns[c * stride + j]);
+                }
+            }
+            const bool small = large == 0;
+            for (size_t c = 0; c < N; c++) {
+                const std::int64_t* column = columns + c * stride;
+                T* out = values + c * stride;
+                if (small) {
+                    for (size_t j = 0; j < count; j++) {
+                        out[j] = internal::dequantize<T>(
+                            internal::smallQuantizedToDouble(column[j]), scale);
+                    }
+                } else {
+                    for (size_t j = 0; j < count; j++) {
+                        out[j] = internal::dequantize<T>(
+                            static_cast<double>(column[j]), scale);
+                    }
+                }
+            }
+            for (size_t j = 0; j < count; j++) {
+                for (size_t c = 0; c < N; c++) {
+                    points[j][c] = values[c * stride + j];
+                }
+            }
+        });
+        return count;
+    }
+
+    // Decodes points [first, first + points.size()).
+    void decode(std::uint64_t first, std::span<point_type> points)
+    {
+        assert(first <= size() && points.size() <= size() - first);
+        const size_t blockSize = _header.blockSize;
+        while (!points.empty()) {
+            const auto block = static_cast<size_t>(first / blockSize);
+            const auto offset = static_cast<size_t>(first % blockSize);
+            const size_t count = std::min(points.size(), blockPoints(block) - offset);
+            if (offset == 0 && count == blockPoints(block)) {
+                decodeBlock(block, points);
+            } else {
+                _scratch.resize(_stride);
+                decodeBlock(block, _scratch);
+                std::copy_n(_scratch.begin() + offset, count, points.begin());
+            }
+            points = points.subspan(count);
+            first += count;
+        }
+    }
+
+    // Reads the next points in order, like PointFileReader::read(), and
+    // returns how many were stored, 0 at the end.
+    size_t read(std::span<point_type> points)
+    {
+        const auto count = static_cast<size_t>(
+            std::min<std::uint64_t>(remaining(), points.size()));
+        decode(_position, points.first(count));
+        _position += count;
+        return count;
+    }
+
+    // Points not read yet.
+    std::uint64_t remaining() const
+    {
+        return size() - _position;
+    }
+
+    // Moves the position of read() to the point with the given index.
+    void seek(std::uint64_t index)
+    {
+        assert(index <= size());
+        _position = index;
+    }
+
+private:
+    void decodeVarints(const std::byte* data, const std::byte* end, size_t count)
+    {
+        const size_t stride = _stride;
+        for (size_t j = 1; j < count; j++) {
+            for (size_t c = 0; c < N; c++) {
+                std::uint64_t delta;
+                data = internal::readVarint(data, end, delta);
+                if (data == nullptr) {
+                    throw PointCodecError{"point stream block is corrupt"};
+                }
+                _columns[c * stride + j] = static_cast<std::int64_t>(
+                    static_cast<std::uint64_t>(_columns[c * stride + j - 1]) +
+                    static_cast<std::uint64_t>(internal::unzigzag(delta)));
+            }
+        }
+    }
+
+    void decodePacked(const std::byte* data, const std::byte* end, size_t count)
+    {
+        const size_t stride = _stride;
+        const size_t deltas = count - 1;
+        const size_t rows = internal::packRows(deltas);
+        unsigned widths[N] = {};
+        size_t size = N;
+        for (size_t c = 0; c < N && data + c < end; c++) {
+            widths[c] = static_cast<unsigned>(data[c]);
+            size += internal::packedBytesForWidth(rows, std::min(widths[c], 64u));
+        }
+        if (static_cast<size_t>(end - data) < size ||
+                std::any_of(widths, widths + N, [] (unsigned w) { return w > 64; })) {
+            throw PointCodecError{"point stream block is corrupt"};
+        }
+        data += N;
+
+        std::uint32_t* low = _low.data();
+        std::uint32_t* high = _high.data();
+        for (size_t c = 0; c < N; c++) {
+            std::int64_t* column = _columns.data() + c * stride;
+            const unsigned width = widths[c];
+            internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+                internal::unpack(data, rows, std::min(width, 32u), low);
+                if (width > 32) {
+                    internal::unpack(data + internal::packedBytes(rows, 32), rows,
+                        width - 32, high);
+                } else {
+                    // Narrow deltas are decoded ahead of the running sum, so
+                    // that it is a plain add.
+                    for (size_t j = 0; j < rows * internal::packLanes; j++) {
+                        low[j] = (low[j] >> 1) ^ (0 - (low[j] & 1));
+                    }
+                }
+            });
+            // The running sum wraps rather than overflowing on corrupt data.
+            auto sum = static_cast<std::uint64_t>(column[0]);
+            if (width <= 32) {
+                for (size_t j = 0; j < deltas; j++) {
+                    sum += static_cast<std::uint64_t>(static_cast<std::int32_t>(low[j]));
+                    column[j + 1] = static_cast<std::int64_t>(sum);
+                }
+            } else {
+                for (size_t j = 0; j < deltas; j++) {
+                    sum += static_cast<std::uint64_t>(internal::unzigzag(
+                        low[j] | std::uint64_t{high[j]} << 32));
+                    column[j + 1] = static_cast<std::int64_t>(sum);
+                }
+            }
+            data += internal::packedBytesForWidth(rows, width);
+        }
+    }
+
+    std::span<const std::byte> _data;
+    PointStreamHeader _header = {};
+    PointStreamTrailer _trailer = {};
+    std::vector<std::uint64_t> _offsets;
+    size_t _stride = 0;
+    std::vector<std::int64_t> _columns;
+    std::vector<std::uint32_t> _low;
+    std::vector<std::uint32_t> _high;
+    std::vector<T> _values;
+    std::vector<point_type> _scratch;
+    std::uint64_t _position = 0;
+};
+
+} // namespace ve
@@ -0,0 +1,536 @@
+#pragma once
+
+#include "ve/compact.hpp"
+#include "ve/internal/traits.hpp"
+#include "ve/point.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace ve {
+
+// Binary point file layout (version 1):
+//
+//   [0, 64)             PointFileHeader
+//   [dataOffset, ...)   count points, each pointSize bytes, stored exactly as
+//                       Point<M, T, N> is laid out in memory
+//
+// The data is written in the byte order of the writing machine; byteOrder
+// holds pointFileByteOrderMark as written by that machine, so a reader on a
+// machine with different endianness detects the mismatch. The model field
+// is an optional user-chosen name that distinguishes models with identical
+// layout (e.g. XYZ and RGB). scale is the scale of fixed-point elements and
+// zero for other element types.
+struct PointFileHeader {
+    char magic[4];
+    std::uint16_t version;
+    std::uint16_t headerSize;
+    std::uint32_t byteOrder;
+    std::uint8_t elementKind;
+    std::uint8_t elementSize;
+    std::uint16_t components;
+    std::uint32_t pointSize;
+    std::uint32_t scale;
+    std::uint64_t count;
+    std::uint64_t dataOffset;
+    char model[24];
+};
+
+static_assert(sizeof(PointFileHeader) == 64);
+static_assert(std::is_trivially_copyable_v<PointFileHeader>);
+
+constexpr char pointFileMagic[4] = {'V', 'E', 'P', 'C'};
+constexpr std::uint16_t pointFileVersion = 1;
+constexpr std::uint32_t pointFileByteOrderMark = 0x01020304;
+
+class PointFileError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+namespace internal {
+
+enum class ElementKind : std::uint8_t {
+    Signed = 0,
+    Unsigned = 1,
+    Float = 2,
+    Half = 3,
+    BFloat16 = 4,
+    SignedFixed = 5,
+    UnsignedFixed = 6,
+};
+
+template <class T>
+struct IsFixed : std::false_type { };
+
+template <class Rep, std::uint32_t Scale>
+struct IsFixed<Fixed<Rep, Scale>> : std::true_type { };
+
+template <class T>
+constexpr ElementKind elementKind()
+{
+    if constexpr (std::is_same_v<T, Half>) {
+        return ElementKind::Half;
+    } else if constexpr (std::is_same_v<T, BFloat16>) {
+        return ElementKind::BFloat16;
+    } else if constexpr (IsFixed<T>::value) {
+        return std::is_signed_v<typename T::rep> ?
+            ElementKind::SignedFixed : ElementKind::UnsignedFixed;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return ElementKind::Float;
+    } else if constexpr (std::is_signed_v<T>) {
+        return ElementKind::Signed;
+    } else {
+        return ElementKind::Unsigned;
+    }
+}
+
+template <class T>
+constexpr std::uint32_t elementScale()
+{
+    if constexpr (IsFixed<T>::value) {
+        return T::scale;
+    } else {
+        return 0;
+    }
+}
+
+template <class P>
+PointFileHeader makePointFileHeader(std::string_view model, std::uint64_t count)
+{
+    using T = typename PointTraits<P>::value_type;
+
+    if (model.size() > sizeof(PointFileHeader::model)) {
+        throw PointFileError{"point file model name is too long"};
+    }
+    auto header = PointFileHeader{};
+    std::copy(std::begin(pointFileMagic), std::end(pointFileMagic), header.magic);
+    header.version = pointFileVersion;
+    header.headerSize = sizeof(PointFileHeader);
+    header.byteOrder = pointFileByteOrderMark;
+    header.elementKind = static_cast<std::uint8_t>(elementKind<T>());
+    header.elementSize = sizeof(T);
+    header.components = PointTraits<P>::size;
+    header.pointSize = sizeof(P);
+    header.scale = elementScale<T>();
+    header.count = count;
+    header.dataOffset = sizeof(PointFileHeader);
+    std::copy(model.begin(), model.end(), header.model);
+    return header;
+}
+
+inline std::string_view modelName(const PointFileHeader& header)
+{
+    auto end = std::find(std::begin(header.model), std::end(header.model), '\0');
+    return {header.model, static_cast<size_t>(end - header.model)};
+}
+
+template <class P>
+void validatePointFileHeader(
+    const PointFileHeader& header, std::string_view model, std::uint64_t fileSize)
+{
+    using T = typename PointTraits<P>::value_type;
+
+    if (!std::equal(
+            std::begin(pointFileMagic), std::end(pointFileMagic), header.magic)) {
+        throw PointFileError{"not a point file"};
+    }
+    if (header.byteOrder != pointFileByteOrderMark) {
+        throw PointFileError{"point file was written with a different byte order"};
+    }
+    if (header.version != pointFileVersion) {
+        throw PointFileError{
+            "unsupported point file version " + std::to_string(header.version)};
+    }
+    if (header.elementKind != static_cast<std::uint8_t>(elementKind<T>()) ||
+            header.elementSize != sizeof(T) ||
+            header.scale != elementScale<T>() ||
+            header.components != PointTraits<P>::size ||
+            header.pointSize != sizeof(P)) {
+        throw PointFileError{"point file layout does not match the point type"};
+    }
+    if (!model.empty() && modelName(header) != model) {
+        throw PointFileError{"point file model does not match"};
+    }
+    if (header.dataOffset < sizeof(PointFileHeader) ||
+            header.dataOffset % alignof(P) != 0 ||
+            header.dataOffset > fileSize ||
+            header.count > (fileSize - header.dataOffset) / sizeof(P)) {
+        throw PointFileError{"point file is truncated or corrupt"};
+    }
+}
+
+} // namespace internal
+
+// Writes points to a file one at a time or in ranges, without holding them
+// in memory. The point count in the header is filled in by close(); a file
+// that was never closed reads back as empty.
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+class PointFileWriter {
+public:
+    using point_type = Point<M, T, N>;
+
+    explicit PointFileWriter(
+        const std::filesystem::path& path, std::string_view model = {})
+        : _header(internal::makePointFileHeader<point_type>(model, 0))
+        , _output(path, std::ios::binary | std::ios::trunc)
+    {
+        if (!_output) {
+            throw PointFileError{"cannot open " + path.string() + " for writing"};
+        }
+        writeHeader();
+    }
+
+    PointFileWriter(const PointFileWriter&) = delete;
+    PointFileWriter& operator=(const PointFileWriter&) = delete;
+
+    ~PointFileWriter()
+    {
+        if (_output.is_open()) {
+            try {
+                close();
+            } catch (...) {
+            }
+        }
+    }
+
+    std::uint64_t size() const
+    {
+        return _header.count;
+    }
+
+    void write(const point_type& point)
+    {
+        write(std::span<const point_type>{&point, 1});
+    }
+
+    template <internal::PointRange R>
+    requires std::is_same_v<internal::RangeValue<R>, point_type>
+    void write(const R& points)
+    {
+        auto input = internal::asSpan(points);
+        _output.write(
+            reinterpret_cast<const char*>(input.data()),
+            static_cast<std::streamsize>(input.size_bytes()));
+        if (!_output) {
+            throw PointFileError{"failed to write points"};
+        }
+        _header.count += input.size();
+    }
+
+    void close()
+    {
+        _output.seekp(0);
+        writeHeader();
+        _output.close();
+        if (!_output) {
+            throw PointFileError{"failed to finish point file"};
+        }
+    }
+
+private:
+    void writeHeader()
+    {
+        _output.write(
+            reinterpret_cast<const char*>(&_header), sizeof(_header));
+        if (!_output) {
+            throw PointFileError{"failed to write point file header"};
+        }
+    }
+
+    PointFileHeader _header;
+    std::ofstream _output;
+};
+
+// Reads a point file front to back in batches of the caller's size, so
+// files larger than memory (or address space) are processed with a fixed
+// buffer. read() returns the number of points stored, and 0 at the end.
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+class PointFileReader {
+public:
+    using point_type = Point<M, T, N>;
+
+    explicit PointFileReader(
+        const std::filesystem::path& path, std::string_view model = {})
+        : _input(path, std::ios::binary)
+    {
+        if (!_input) {
+            throw PointFileError{"cannot open " + path.string() + " for reading"};
+        }
+        const auto fileSize = std::filesystem::file_size(path);
+        if (fileSize < sizeof(PointFileHeader) ||
+                !_input.read(reinterpret_cast<char*>(&_header), sizeof(_header))) {
+            throw PointFileError{"not a point file"};
+        }
+        internal::validatePointFileHeader<point_type>(_header, model, fileSize);
+        _input.seekg(static_cast<std::streamoff>(_header.dataOffset));
+        _remaining = _header.count;
+    }
+
+    const PointFileHeader& header() const
+    {
+        return _header;
+    }
+
+    std::string_view model() const
+    {
+        return internal::modelName(_header);
+    }
+
+    std::uint64_t size() const
+    {
+        return _header.count;
+    }
+
+    // Points not read yet.
+    std::uint64_t remaining() const
+    {
+        return _remaining;
+    }
+
+    size_t read(std::span<point_type> points)
+    {
+        const auto count = static_cast<size_t>(
+            std::min<std::uint64_t>(_remaining, points.size()));
+        _input.read(
+            reinterpret_cast<char*>(points.data()),
+            static_cast<std::streamsize>(count * sizeof(point_type)));
+        if (!_input) {
+            throw PointFileError{"failed to read points"};
+        }
+        _remaining -= count;
+        return count;
+    }
+
+private:
+    PointFileHeader _header = {};
+    std::ifstream _input;
+    std::uint64_t _remaining = 0;
+};
+
+// A read-only memory mapping of a point file. The points are used in place:
+// opening the file only validates the header, and pages are loaded by the
+// operating system as they are touched.
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+class MappedPointFile {
+public:
+    using point_type = Point<M, T, N>;
+
+    MappedPointFile() = default;
+
+    explicit MappedPointFile(
+        const std::filesystem::path& path, std::string_view model = {})
+    {
+        map(path);
+        try {
+            if (_size < sizeof(PointFileHeader)) {
+                throw PointFileError{"not a point file"};
+            }
+            std::memcpy(&_header, _address, sizeof(_header));
+            internal::validatePointFileHeader<point_type>(_header, model, _size);
+            _points = std::span<const point_type>{
+                reinterpret_cast<const point_type*>(
+                    static_cast<const char*>(_address) + _header.dataOffset),
+                static_cast<size_t>(_header.count)};
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    MappedPointFile(MappedPointFile&& other) noexcept
+    {
+        swap(other);
+    }
+
+    MappedPointFile& operator=(MappedPointFile&& other) noexcept
+    {
+        if (this != &other) {
+            unmap();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~MappedPointFile()
+    {
+        unmap();
+    }
+
+    const PointFileHeader& header() const
+    {
+        return _header;
+    }
+
+    std::string_view model() const
+    {
+        return internal::modelName(_header);
+    }
+
+    std::span<const point_type> points() const
+    {
+        return _points;
+    }
+
+    size_t size() const
+    {
+        return _points.size();
+    }
+
+    bool empty() const
+    {
+        return _points.empty();
+    }
+
+    const point_type& operator[](size_t index) const
+    {
+        return _points[index];
+    }
+
+    auto begin() const
+    {
+        return _points.begin();
+    }
+
+    auto end() const
+    {
+        return _points.end();
+    }
+
+private:
+    void swap(MappedPointFile& other) noexcept
+    {
+        std::swap(_header, other._header);
+        std::swap(_points, other._points);
+        std::swap(_address, other._address);
+        std::swap(_size, other._size);
+    }
+
+#ifdef _WIN32
+    void map(const std::filesystem::path& path)
+    {
+        HANDLE file = CreateFileW(
+            path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::system_error{
+                static_cast<int>(GetLastError()), std::system_category(),
+                "cannot open " + path.string()};
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            auto error = GetLastError();
+            CloseHandle(file);
+            throw std::system_error{
+                static_cast<int>(error), std::system_category(),
+                "cannot stat " + path.string()};
+        }
+        if (fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return;
+        }
+        HANDLE mapping = CreateFileMappingW(
+            file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        auto error = GetLastError();
+        CloseHandle(file);
+        if (!mapping) {
+            throw std::system_error{
+                static_cast<int>(error), std::system_category(),
+                "cannot map " + path.string()};
+        }
+        _address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        error = GetLastError();
+        CloseHandle(mapping);
+        if (!_address) {
+            throw std::system_error{
+                static_cast<int>(error), std::system_category(),
+                "cannot map " + path.string()};
+        }
+        _size = static_cast<size_t>(fileSize.QuadPart);
+    }
+
+    void unmap() noexcept
+    {
+        if (_address) {
+            UnmapViewOfFile(_address);
+        }
+        _address = nullptr;
+        _size = 0;
+        _points = {};
+    }
+#else
+    void map(const std::filesystem::path& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error{
+                errno, std::generic_category(), "cannot open " + path.string()};
+        }
+        struct stat status;
+        if (::fstat(fd, &status) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error{
+                error, std::generic_category(), "cannot stat " + path.string()};
+        }
+        const auto size = static_cast<size_t>(status.st_size);
+        if (size == 0) {
+            ::close(fd);
+            return;
+        }
+        void* address = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        int error = errno;
+        ::close(fd);
+        if (address == MAP_FAILED) {
+            throw std::system_error{
+                error, std::generic_category(), "cannot map " + path.string()};
+        }
+        _address = address;
+        _size = size;
+    }
+
+    void unmap() noexcept
+    {
+        if (_address) {
+            ::munmap(_address, _size);
+        }
+        _address = nullptr;
+        _size = 0;
+        _points = {};
+    }
+#endif
+
+    PointFileHeader _header = {};
+    std::span<const point_type> _points;
+    void* _address = nullptr;
+    size_t _size = 0;
+};
+
+} // namespace ve
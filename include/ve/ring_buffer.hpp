@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ve {
+
+namespace internal {
+
+constexpr size_t cacheLineSize = 64;
+
+// A position in the ring on a cache line of its own, so that producers and
+// consumers updating different positions do not invalidate each other's
+// lines.
+struct alignas(cacheLineSize) RingPosition {
+    std::atomic<size_t> value = 0;
+};
+
+} // namespace internal
+
+// A bounded queue of trivially copyable values, such as points and
+// vectors, that any number of threads can push to and pop from without a
+// lock.
+//
+// Each slot carries a sequence number that says whether it is free or
+// holds a value for the current lap around the ring, as in Dmitry Vyukov's
+// bounded MPMC queue. Values are pushed and popped in batches: a batch
+// takes a run of ready slots with a single compare-and-swap on a position,
+// is copied with at most two memcpy calls (the run may wrap around), and
+// then hands each slot over by advancing its sequence number. A thread that
+// is preempted in the middle of a batch holds back only its own slots:
+// other producers keep pushing into free slots, and consumers pop
+// everything before the stalled batch and see the rest once it completes.
+//
+// Values pushed by one thread are popped in the order they were pushed.
+// The capacity is rounded up to a power of two. Positions are 64-bit
+// counters, which do not wrap around in practice.
+template <class V>
+class RingBuffer {
+    static_assert(std::is_trivially_copyable_v<V>);
+
+public:
+    using value_type = V;
+
+    explicit RingBuffer(size_t capacity)
+        : _slots(std::bit_ceil(std::max<size_t>(capacity, 1)))
+        , _sequences(_slots.size())
+        , _mask(_slots.size() - 1)
+    {
+        for (size_t i = 0; i < _sequences.size(); i++) {
+            _sequences[i].store(i, std::memory_order_relaxed);
+        }
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    size_t capacity() const
+    {
+        return _slots.size();
+    }
+
+    // The number of values pushed and not yet popped, counting batches that
+    // are still being copied. Other threads may change it at any time.
+    size_t size() const
+    {
+        const size_t popped = _popPosition.value.load(std::memory_order_acquire);
+        return _pushPosition.value.load(std::memory_order_acquire) - popped;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    // Pushes as many of the values as there are free slots for, in order,
+    // and returns how many that is.
+    size_t push(std::span<const V> values)
+    {
+        const auto [first, count] = reserve(_pushPosition, 0, values.size());
+        if (count == 0) {
+            return 0;
+        }
+        copyIn(values.data(), first, count);
+        release(first, count, 1);
+        return count;
+    }
+
+    bool push(const V& value)
+    {
+        return push(std::span{&value, 1}) == 1;
+    }
+
+    // Pops up to values.size() values into the start of values and returns
+    // how many were popped.
+    size_t pop(std::span<V> values)
+    {
+        const auto [first, count] = reserve(_popPosition, 1, values.size());
+        if (count == 0) {
+            return 0;
+        }
+        copyOut(values.data(), first, count);
+        release(first, count, capacity());
+        return count;
+    }
+
+    std::optional<V> pop()
+    {
+        V value;
+        if (pop(std::span{&value, 1}) == 0) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    // Pops every value available and appends them to the output, copied in
+    // at most two blocks. Returns how many were appended.
+    size_t drain(std::vector<V>& output)
+    {
+        const auto [first, count] = reserve(_popPosition, 1, capacity());
+        const size_t offset = first & _mask;
+        const size_t head = std::min(count, capacity() - offset);
+        output.reserve(output.size() + count);
+        output.insert(output.end(), _slots.begin() + offset, _slots.begin() + offset + head);
+        output.insert(output.end(), _slots.begin(), _slots.begin() + (count - head));
+        release(first, count, capacity());
+        return count;
+    }
+
+private:
+    // Takes up to limit consecutive positions from the given one whose slots
+    // are ready, that is whose sequence numbers are their position plus
+    // ready: 0 for free slots when pushing, 1 for filled ones when popping.
+    // Returns the first position taken and how many were taken.
+    std::pair<size_t, size_t> reserve(
+        internal::RingPosition& position, size_t ready, size_t limit)
+    {
+        const auto* sequences = _sequences.data();
+        const size_t mask = _mask;
+        size_t first = position.value.load(std::memory_order_relaxed);
+        for (;;) {
+            size_t count = 0;
+            std::ptrdiff_t lag = 0;
+            while (count < limit) {
+                const size_t sequence =
+                    sequences[(first + count) & mask].load(std::memory_order_acquire);
+                lag = static_cast<std::ptrdiff_t>(sequence - (first + count + ready));
+                if (lag != 0) {
+                    break;
+                }
+                count++;
+            }
+            if (count == 0) {
+                if (lag <= 0) {
+                    // The first slot is not ready: the ring is full when
+                    // pushing, or empty when popping.
+                    return {first, 0};
+                }
+                // Another thread took the first slot; the position was stale.
+                first = position.value.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (position.value.compare_exchange_weak(
+                    first, first + count, std::memory_order_relaxed)) {
+                return {first, count};
+            }
+        }
+    }
+
+    // Hands the slots of a reserved batch to the other side by setting
+    // their sequence numbers to their position plus the given step: 1 after
+    // pushing, the capacity (the next lap) after popping. The release makes
+    // the copy visible before the slot changes hands.
+    void release(size_t first, size_t count, size_t step)
+    {
+        auto* sequences = _sequences.data();
+        const size_t mask = _mask;
+        for (size_t i = first; i < first + count; i++) {
+            sequences[i & mask].store(i + step, std::memory_order_release);
+        }
+    }
+
+    // Copies to or from the slots from position first on, in one block or in
+    // two when the range wraps around the end of the ring.
+    void copyIn(const V* values, size_t first, size_t count)
+    {
+        const size_t offset = first & _mask;
+        const size_t head = std::min(count, capacity() - offset);
+        std::memcpy(_slots.data() + offset, values, head * sizeof(V));
+        std::memcpy(_slots.data(), values + head, (count - head) * sizeof(V));
+    }
+
+    void copyOut(V* values, size_t first, size_t count) const
+    {
+        const size_t offset = first & _mask;
+        const size_t head = std::min(count, capacity() - offset);
+        std::memcpy(values, _slots.data() + offset, head * sizeof(V));
+        std::memcpy(values + head, _slots.data(), (count - head) * sizeof(V));
+    }
+
+    std::vector<V> _slots;
+    std::vector<std::atomic<size_t>> _sequences;
+    size_t _mask;
+    internal::RingPosition _pushPosition;
+    internal::RingPosition _popPosition;
+};
+
+} // namespace ve
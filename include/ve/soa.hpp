@@ -0,0 +1,429 @@
+#pragma once
+
+#include "ve/point.hpp"
+#include "ve/vector.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ve {
+
+template <template <class> class M, class T, size_t N> class VectorArray;
+template <template <class> class M, class T, size_t N> class PointArray;
+
+namespace internal {
+
+template <
+    template <template <class> class, class, size_t> class Kind,
+    template <class> class M,
+    class T,
+    size_t N>
+class SoaReference {
+public:
+    using value_type = Kind<M, std::remove_const_t<T>, N>;
+
+    constexpr SoaReference(const std::array<T*, N>& components)
+        : _components(components)
+    { }
+
+    SoaReference(const SoaReference&) = default;
+
+    constexpr const SoaReference& operator=(const SoaReference& other) const
+    {
+        return *this = static_cast<value_type>(other);
+    }
+
+    template <class U> requires std::is_convertible_v<U, T>
+    constexpr const SoaReference& operator=(const Kind<M, U, N>& value) const
+    {
+        for (size_t i = 0; i < N; i++) {
+            *_components[i] = value[i];
+        }
+        return *this;
+    }
+
+    constexpr T& operator[](size_t i) const
+    {
+        return *_components[i];
+    }
+
+    constexpr operator value_type() const
+    {
+        value_type value;
+        for (size_t i = 0; i < N; i++) {
+            value[i] = *_components[i];
+        }
+        return value;
+    }
+
+    template <class R> requires requires (value_type v, const R& r) { v += r; }
+    constexpr const SoaReference& operator+=(const R& rhs) const
+    {
+        auto value = static_cast<value_type>(*this);
+        value += rhs;
+        return *this = value;
+    }
+
+    template <class R> requires requires (value_type v, const R& r) { v -= r; }
+    constexpr const SoaReference& operator-=(const R& rhs) const
+    {
+        auto value = static_cast<value_type>(*this);
+        value -= rhs;
+        return *this = value;
+    }
+
+    template <class R> requires requires (value_type v, const R& r) { v *= r; }
+    constexpr const SoaReference& operator*=(const R& rhs) const
+    {
+        auto value = static_cast<value_type>(*this);
+        value *= rhs;
+        return *this = value;
+    }
+
+    template <class R> requires requires (value_type v, const R& r) { v /= r; }
+    constexpr const SoaReference& operator/=(const R& rhs) const
+    {
+        auto value = static_cast<value_type>(*this);
+        value /= rhs;
+        return *this = value;
+    }
+
+    friend constexpr bool operator==(
+        const SoaReference& lhs, const value_type& rhs)
+    {
+        return static_cast<value_type>(lhs) == rhs;
+    }
+
+    friend std::ostream& operator<<(
+        std::ostream& output, const SoaReference& reference)
+    {
+        return output << static_cast<value_type>(reference);
+    }
+
+private:
+    std::array<T*, N> _components;
+};
+
+template <
+    template <template <class> class, class, size_t> class Kind,
+    template <class> class M,
+    class T,
+    size_t N>
+class SoaStorage {
+public:
+    using value_type = Kind<M, T, N>;
+    using reference = SoaReference<Kind, M, T, N>;
+    using const_reference = SoaReference<Kind, M, const T, N>;
+
+    SoaStorage() = default;
+
+    explicit SoaStorage(size_t size, const value_type& value = value_type{})
+    {
+        for (size_t i = 0; i < N; i++) {
+            _components[i].assign(size, value[i]);
+        }
+    }
+
+    SoaStorage(std::initializer_list<value_type> values)
+    {
+        reserve(values.size());
+        for (const auto& value : values) {
+            push_back(value);
+        }
+    }
+
+    template <class U> requires std::is_convertible_v<U, T>
+    explicit SoaStorage(const SoaStorage<Kind, M, U, N>& other)
+    {
+        for (size_t i = 0; i < N; i++) {
+            const U* source = other.data(i);
+            _components[i].assign(source, source + other.size());
+        }
+    }
+
+    size_t size() const
+    {
+        return _components[0].size();
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    void reserve(size_t capacity)
+    {
+        for (auto& component : _components) {
+            component.reserve(capacity);
+        }
+    }
+
+    void resize(size_t size, const value_type& value = value_type{})
+    {
+        for (size_t i = 0; i < N; i++) {
+            _components[i].resize(size, value[i]);
+        }
+    }
+
+    void clear()
+    {
+        for (auto& component : _components) {
+            component.clear();
+        }
+    }
+
+    template <class U> requires std::is_convertible_v<U, T>
+    void push_back(const Kind<M, U, N>& value)
+    {
+        for (size_t i = 0; i < N; i++) {
+            _components[i].push_back(value[i]);
+        }
+    }
+
+    T* data(size_t component)
+    {
+        return _components[component].data();
+    }
+
+    const T* data(size_t component) const
+    {
+        return _components[component].data();
+    }
+
+    reference operator[](size_t index)
+    {
+        std::array<T*, N> pointers;
+        for (size_t i = 0; i < N; i++) {
+            pointers[i] = data(i) + index;
+        }
+        return reference{pointers};
+    }
+
+    const_reference operator[](size_t index) const
+    {
+        std::array<const T*, N> pointers;
+        for (size_t i = 0; i < N; i++) {
+            pointers[i] = data(i) + index;
+        }
+        return const_reference{pointers};
+    }
+
+protected:
+    template <class F>
+    void apply(F&& f)
+    {
+        const size_t count = size();
+        for (size_t i = 0; i < N; i++) {
+            T* out = data(i);
+            for (size_t j = 0; j < count; j++) {
+                f(i, out[j]);
+            }
+        }
+    }
+
+    template <template <template <class> class, class, size_t> class K, class U, class F>
+    void apply(const SoaStorage<K, M, U, N>& other, F&& f)
+    {
+        assert(other.size() == size());
+        const size_t count = size();
+        for (size_t i = 0; i < N; i++) {
+            T* out = data(i);
+            const U* in = other.data(i);
+            for (size_t j = 0; j < count; j++) {
+                f(out[j], in[j]);
+            }
+        }
+    }
+
+private:
+    std::array<std::vector<T>, N> _components;
+};
+
+} // namespace internal
+
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+class VectorArray : public internal::SoaStorage<Vector, M, T, N> {
+public:
+    using internal::SoaStorage<Vector, M, T, N>::SoaStorage;
+
+    template <class U> requires std::is_convertible_v<U, T>
+    VectorArray& operator+=(const Vector<M, U, N>& vector)
+    {
+        this->apply([&vector] (size_t i, T& x) { x += vector[i]; });
+        return *this;
+    }
+
+    template <class U> requires std::is_convertible_v<U, T>
+    VectorArray& operator+=(const VectorArray<M, U, N>& other)
+    {
+        this->apply(other, [] (T& x, const U& y) { x += y; });
+        return *this;
+    }
+
+    template <class U> requires std::is_convertible_v<U, T>
+    VectorArray& operator-=(const Vector<M, U, N>& vector)
+    {
+        this->apply([&vector] (size_t i, T& x) { x -= vector[i]; });
+        return *this;
+    }
+
+    template <class U> requires std::is_convertible_v<U, T>
+    VectorArray& operator-=(const VectorArray<M, U, N>& other)
+    {
+        this->apply(other, [] (T& x, const U& y) { x -= y; });
+        return *this;
+    }
+
+    template <class S> requires std::is_convertible_v<S, T>
+    VectorArray& operator*=(const S& scalar)
+    {
+        this->apply([&scalar] (size_t, T& x) { x *= scalar; });
+        return *this;
+    }
+
+    template <class S> requires std::is_convertible_v<S, T>
+    VectorArray& operator/=(const S& scalar)
+    {
+        this->apply([&scalar] (size_t, T& x) { x /= scalar; });
+        return *this;
+    }
+};
+
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+class PointArray : public internal::SoaStorage<Point, M, T, N> {
+public:
+    using internal::SoaStorage<Point, M, T, N>::SoaStorage;
+
+    template <class U> requires std::is_convertible_v<U, T>
+    PointArray& operator+=(const Vector<M, U, N>& vector)
+    {
+        this->apply([&vector] (size_t i, T& x) { x += vector[i]; });
+        return *this;
+    }
+
+    template <class U> requires std::is_convertible_v<U, T>
+    PointArray& operator+=(const VectorArray<M, U, N>& vectors)
+    {
+        this->apply(vectors, [] (T& x, const U& y) { x += y; });
+        return *this;
+    }
+
+    template <class U> requires std::is_convertible_v<U, T>
+    PointArray& operator-=(const Vector<M, U, N>& vector)
+    {
+        this->apply([&vector] (size_t i, T& x) { x -= vector[i]; });
+        return *this;
+    }
+
+    template <class U> requires std::is_convertible_v<U, T>
+    PointArray& operator-=(const VectorArray<M, U, N>& vectors)
+    {
+        this->apply(vectors, [] (T& x, const U& y) { x -= y; });
+        return *this;
+    }
+};
+
+template <template <class> class M, class U, class V, size_t N>
+auto operator+(const VectorArray<M, U, N>& lhs, const VectorArray<M, V, N>& rhs)
+{
+    using R = decltype(std::declval<U>() + std::declval<V>());
+    VectorArray<M, R, N> result{lhs};
+    result += rhs;
+    return result;
+}
+
+template <template <class> class M, class U, class V, size_t N>
+auto operator-(const VectorArray<M, U, N>& lhs, const VectorArray<M, V, N>& rhs)
+{
+    using R = decltype(std::declval<U>() - std::declval<V>());
+    VectorArray<M, R, N> result{lhs};
+    result -= rhs;
+    return result;
+}
+
+template <template <class> class M, class T, class S, size_t N>
+auto operator*(const VectorArray<M, T, N>& vectors, const S& scalar)
+{
+    using R = decltype(std::declval<T>() * std::declval<S>());
+    VectorArray<M, R, N> result{vectors};
+    result *= scalar;
+    return result;
+}
+
+template <template <class> class M, class T, class S, size_t N>
+auto operator*(const S& scalar, const VectorArray<M, T, N>& vectors)
+{
+    return vectors * scalar;
+}
+
+template <template <class> class M, class T, class S, size_t N>
+auto operator/(const VectorArray<M, T, N>& vectors, const S& scalar)
+{
+    using R = decltype(std::declval<T>() / std::declval<S>());
+    VectorArray<M, R, N> result{vectors};
+    result /= scalar;
+    return result;
+}
+
+template <template <class> class M, class U, class V, size_t N>
+auto operator+(const PointArray<M, U, N>& points, const Vector<M, V, N>& vector)
+{
+    using R = decltype(std::declval<U>() + std::declval<V>());
+    PointArray<M, R, N> result{points};
+    result += vector;
+    return result;
+}
+
+template <template <class> class M, class U, class V, size_t N>
+auto operator+(const PointArray<M, U, N>& points, const VectorArray<M, V, N>& vectors)
+{
+    using R = decltype(std::declval<U>() + std::declval<V>());
+    PointArray<M, R, N> result{points};
+    result += vectors;
+    return result;
+}
+
+template <template <class> class M, class U, class V, size_t N>
+auto operator-(const PointArray<M, U, N>& points, const Vector<M, V, N>& vector)
+{
+    using R = decltype(std::declval<U>() - std::declval<V>());
+    PointArray<M, R, N> result{points};
+    result -= vector;
+    return result;
+}
+
+template <template <class> class M, class U, class V, size_t N>
+auto operator-(const PointArray<M, U, N>& points, const VectorArray<M, V, N>& vectors)
+{
+    using R = decltype(std::declval<U>() - std::declval<V>());
+    PointArray<M, R, N> result{points};
+    result -= vectors;
+    return result;
+}
+
+template <template <class> class M, class U, class V, size_t N>
+auto operator-(const PointArray<M, U, N>& lhs, const PointArray<M, V, N>& rhs)
+{
+    assert(lhs.size() == rhs.size());
+    using R = decltype(std::declval<U>() - std::declval<V>());
+    VectorArray<M, R, N> result(lhs.size());
+    for (size_t i = 0; i < N; i++) {
+        R* out = result.data(i);
+        const U* l = lhs.data(i);
+        const V* r = rhs.data(i);
+        for (size_t j = 0; j < lhs.size(); j++) {
+            out[j] = l[j] - r[j];
+        }
+    }
+    return result;
+}
+
+} // namespace ve
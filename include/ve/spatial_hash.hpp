@@ -0,0 +1,257 @@
+#pragma once
+
+#include "ve/internal/hash.hpp"
+#include "ve/internal/traits.hpp"
+#include "ve/point.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ve {
+
+// Points bucketed by a uniform grid of cubic cells. Cells are kept in an
+// open-addressing (linear probing) table, and the points of a cell form a
+// linked list through an index array, so inserting a point and querying a
+// small radius around a point take expected constant time.
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+class SpatialHash {
+public:
+    using point_type = Point<M, T, N>;
+    using scalar_type = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+
+    explicit SpatialHash(scalar_type cellSize, size_t expectedSize = 0)
+        : _cellSize(cellSize)
+        , _inverseCellSize(scalar_type{1} / cellSize)
+    {
+        assert(cellSize > 0);
+        reserve(expectedSize);
+    }
+
+    size_t size() const
+    {
+        return _points.size();
+    }
+
+    bool empty() const
+    {
+        return _points.empty();
+    }
+
+    scalar_type cellSize() const
+    {
+        return _cellSize;
+    }
+
+    const std::vector<point_type>& points() const
+    {
+        return _points;
+    }
+
+    void reserve(size_t count)
+    {
+        _points.reserve(count);
+        _next.reserve(count);
+        size_t capacity = 16;
+        while (capacity < 2 * count) {
+            capacity *= 2;
+        }
+        if (capacity > _slots.size()) {
+            rehash(capacity);
+        }
+    }
+
+    void clear()
+    {
+        _points.clear();
+        _next.clear();
+        std::fill(_slots.begin(), _slots.end(), Slot{{}, none});
+        _usedSlots = 0;
+    }
+
+    // Adds a point and returns its index in points().
+    size_t insert(const point_type& point)
+    {
+        assert(_points.size() < none);
+        if (2 * (_usedSlots + 1) > _slots.size()) {
+            rehash(std::max<size_t>(16, 2 * _slots.size()));
+        }
+
+        const auto index = static_cast<std::uint32_t>(_points.size());
+        const auto cell = cellOf(point);
+        auto& slot = _slots[findSlot(cell)];
+        if (slot.head == none) {
+            slot.cell = cell;
+            _usedSlots++;
+        }
+        _points.push_back(point);
+        _next.push_back(slot.head);
+        slot.head = index;
+        return index;
+    }
+
+    // Calls f(index) for every stored point within the given (non-squared)
+    // radius of the query. A negative or NaN radius finds nothing.
+    template <class F>
+    void forEachWithin(const point_type& query, scalar_type radius, F&& f) const
+    {
+        if (empty() || !(radius >= 0)) {
+            return;
+        }
+
+        Cell low;
+        Cell high;
+        for (size_t c = 0; c < N; c++) {
+            low[c] = cellCoordinate(static_cast<scalar_type>(query[c]) - radius);
+            high[c] = cellCoordinate(static_cast<scalar_type>(query[c]) + radius);
+        }
+
+        const auto squaredRadius = radius * radius;
+        auto cell = low;
+        for (;;) {
+            const auto& slot = _slots[findSlot(cell)];
+            for (auto i = slot.head; i != none; i = _next[i]) {
+                if (squaredDistance(_points[i], query) <= squaredRadius) {
+                    f(static_cast<size_t>(i));
+                }
+            }
+
+            size_t c = 0;
+            while (c < N && cell[c] == high[c]) {
+                cell[c] = low[c];
+                c++;
+            }
+            if (c == N) {
+                break;
+            }
+            cell[c]++;
+        }
+    }
+
+    // Index of the stored point closest to the query, if there is one within
+    // the radius. Ties go to the point inserted first.
+    std::optional<size_t> nearest(const point_type& query, scalar_type radius) const
+    {
+        std::optional<size_t> result;
+        auto best = std::numeric_limits<scalar_type>::max();
+        forEachWithin(query, radius, [&] (size_t index) {
+            const auto distance = squaredDistance(_points[index], query);
+            if (distance < best || (distance == best && result && index < *result)) {
+                best = distance;
+                result = index;
+            }
+        });
+        return result;
+    }
+
+private:
+    using Cell = std::array<std::int64_t, N>;
+
+    struct Slot {
+        Cell cell;
+        std::uint32_t head;
+    };
+
+    static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+    static scalar_type squaredDistance(const point_type& a, const point_type& b)
+    {
+        auto sum = scalar_type{0};
+        for (size_t i = 0; i < N; i++) {
+            auto d = static_cast<scalar_type>(a[i]) - static_cast<scalar_type>(b[i]);
+            sum += d * d;
+        }
+        return sum;
+    }
+
+    std::int64_t cellCoordinate(scalar_type value) const
+    {
+        return static_cast<std::int64_t>(std::floor(value * _inverseCellSize));
+    }
+
+    Cell cellOf(const point_type& point) const
+    {
+        Cell cell;
+        for (size_t c = 0; c < N; c++) {
+            cell[c] = cellCoordinate(static_cast<scalar_type>(point[c]));
+        }
+        return cell;
+    }
+
+    // The slot holding the cell, or the empty slot where it would go.
+    size_t findSlot(const Cell& cell) const
+    {
+        const size_t mask = _slots.size() - 1;
+        size_t i = internal::hashComponents<N>(cell) & mask;
+        while (_slots[i].head != none && _slots[i].cell != cell) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void rehash(size_t capacity)
+    {
+        auto old = std::exchange(_slots, std::vector<Slot>(capacity, Slot{{}, none}));
+        for (const auto& slot : old) {
+            if (slot.head != none) {
+                _slots[findSlot(slot.cell)] = slot;
+            }
+        }
+    }
+
+    scalar_type _cellSize;
+    scalar_type _inverseCellSize;
+    std::vector<point_type> _points;
+    std::vector<std::uint32_t> _next;
+    std::vector<Slot> _slots;
+    size_t _usedSlots = 0;
+};
+
+template <class P>
+struct Welded {
+    // Representative points, in order of first appearance.
+    std::vector<P> points;
+    // For every input point, the index of its representative.
+    std::vector<std::uint32_t> indices;
+};
+
+// Merges points that lie within the tolerance of an earlier representative.
+// Points are visited in order; each one is mapped to the closest existing
+// representative within the tolerance, or becomes a new representative.
+// Runs in expected O(n) time for tolerances that are small relative to the
+// spacing of distinct points. A tolerance of zero merges exact duplicates;
+// a negative or NaN tolerance merges nothing.
+template <internal::PointRange R>
+auto weld(
+    const R& points,
+    typename internal::ValueTraits<internal::RangeValue<R>>::template
+        rebindKind<SpatialHash>::scalar_type tolerance)
+{
+    using P = internal::RangeValue<R>;
+    using Hash = typename internal::ValueTraits<P>::template rebindKind<SpatialHash>;
+
+    auto input = internal::asSpan(points);
+    auto hash = Hash{tolerance > 0 ? tolerance : 1, input.size()};
+    auto result = Welded<P>{};
+    result.indices.reserve(input.size());
+    for (const auto& point : input) {
+        auto index = hash.nearest(point, tolerance);
+        if (!index) {
+            index = hash.insert(point);
+        }
+        result.indices.push_back(static_cast<std::uint32_t>(*index));
+    }
+    result.points = hash.points();
+    return result;
+}
+
+} // namespace ve
@@ -0,0 +1,414 @@
+#pragma once
+
+#include "ve/aabb.hpp"
+#include "ve/algorithms.hpp"
+#include "ve/internal/simd.hpp"
+#include "ve/internal/traits.hpp"
+#include "ve/point.hpp"
+#include "ve/thread_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace ve {
+
+enum class Curve {
+    Morton,
+    Hilbert,
+};
+
+namespace internal {
+
+// Moves bit i of the low 32 bits to bit 2i.
+constexpr std::uint64_t spreadBits2(std::uint32_t value)
+{
+#ifdef VE_SIMD_BMI2
+    if (!std::is_constant_evaluated()) {
+        return _pdep_u64(value, 0x5555555555555555u);
+    }
+#endif
+    std::uint64_t x = value;
+    x = (x | (x << 16)) & 0x0000ffff0000ffffu;
+    x = (x | (x << 8)) & 0x00ff00ff00ff00ffu;
+    x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0fu;
+    x = (x | (x << 2)) & 0x3333333333333333u;
+    x = (x | (x << 1)) & 0x5555555555555555u;
+    return x;
+}
+
+// Moves bit i of the low 21 bits to bit 3i.
+constexpr std::uint64_t spreadBits3(std::uint32_t value)
+{
+#ifdef VE_SIMD_BMI2
+    if (!std::is_constant_evaluated()) {
+        return _pdep_u64(value, 0x1249249249249249u);
+    }
+#endif
+    std::uint64_t x = value & 0x1fffffu;
+    x = (x | (x << 32)) & 0x001f00000000ffffu;
+    x = (x | (x << 16)) & 0x001f0000ff0000ffu;
+    x = (x | (x << 8)) & 0x100f00f00f00f00fu;
+    x = (x | (x << 4)) & 0x10c30c30c30c30c3u;
+    x = (x | (x << 2)) & 0x1249249249249249u;
+    return x;
+}
+
+// Number of bits per axis that fit in a 64-bit key.
+template <size_t N>
+constexpr unsigned curveBits = 64 / N;
+
+template <size_t N>
+concept CurveDimension = N == 2 || N == 3;
+
+// Interleaves the cell coordinates so that bit b of axis c lands at bit
+// b * N + c of the key.
+template <size_t N> requires CurveDimension<N>
+constexpr std::uint64_t interleave(const std::array<std::uint32_t, N>& cell)
+{
+    if constexpr (N == 2) {
+        return spreadBits2(cell[0]) | (spreadBits2(cell[1]) << 1);
+    } else {
+        return spreadBits3(cell[0]) | (spreadBits3(cell[1]) << 1) |
+            (spreadBits3(cell[2]) << 2);
+    }
+}
+
+constexpr std::uint64_t mortonIndex(const auto& cell)
+{
+    return interleave(cell);
+}
+
+// Hilbert index of a cell in a grid of 2^bits cells per axis, computed with
+// Skilling's transpose algorithm ("Programming the Hilbert curve", 2004).
+// Consecutive indices always belong to face-adjacent cells.
+template <size_t N> requires CurveDimension<N>
+constexpr std::uint64_t hilbertIndex(
+    std::array<std::uint32_t, N> cell, unsigned bits = curveBits<N>)
+{
+    const std::uint32_t high = std::uint32_t{1} << (bits - 1);
+
+    for (std::uint32_t q = high; q > 1; q >>= 1) {
+        const std::uint32_t p = q - 1;
+        for (size_t i = 0; i < N; i++) {
+            if (cell[i] & q) {
+                cell[0] ^= p;
+            } else {
+                const std::uint32_t t = (cell[0] ^ cell[i]) & p;
+                cell[0] ^= t;
+                cell[i] ^= t;
+            }
+        }
+    }
+
+    for (size_t i = 1; i < N; i++) {
+        cell[i] ^= cell[i - 1];
+    }
+    std::uint32_t t = 0;
+    for (std::uint32_t q = high; q > 1; q >>= 1) {
+        if (cell[N - 1] & q) {
+            t ^= q - 1;
+        }
+    }
+    for (size_t i = 0; i < N; i++) {
+        cell[i] ^= t;
+    }
+
+    // The transposed index reads most significant bit first from axis 0,
+    // so axes go into the key in reverse order.
+    std::array<std::uint32_t, N> reversed;
+    for (size_t i = 0; i < N; i++) {
+        reversed[i] = cell[N - 1 - i];
+    }
+    return interleave(reversed);
+}
+
+// Maps points inside a box to integer cells of a grid with 2^curveBits<N>
+// cells per axis. Points outside the box are clamped to its border cells.
+template <size_t N>
+class CurveGrid {
+public:
+    template <template <class> class M, class T>
+    explicit CurveGrid(const AABB<M, T, N>& box)
+    {
+        constexpr double maxCell = static_cast<double>(
+            (std::uint64_t{1} << curveBits<N>) - 1);
+        for (size_t c = 0; c < N; c++) {
+            const double extent =
+                static_cast<double>(box.max[c]) - static_cast<double>(box.min[c]);
+            _offset[c] = static_cast<double>(box.min[c]);
+            _scale[c] = extent > 0 ? maxCell / extent : 0;
+        }
+    }
+
+    template <class P>
+    std::array<std::uint32_t, N> operator()(const P& point) const
+    {
+        constexpr double maxCell = static_cast<double>(
+            (std::uint64_t{1} << curveBits<N>) - 1);
+        std::array<std::uint32_t, N> cell;
+        for (size_t c = 0; c < N; c++) {
+            double value = (static_cast<double>(point[c]) - _offset[c]) * _scale[c];
+            value = value > 0 ? value : 0;
+            value = value < maxCell ? value : maxCell;
+            cell[c] = static_cast<std::uint32_t>(value);
+        }
+        return cell;
+    }
+
+private:
+    std::array<double, N> _offset;
+    std::array<double, N> _scale;
+};
+
+constexpr size_t curveGrainSize = 16384;
+
+template <class R, class Out>
+void curveKeys(
+    Curve curve, const R& points, const auto& box, Out&& keys, ThreadPool& pool)
+{
+    constexpr size_t n = PointTraits<RangeValue<R>>::size;
+
+    auto in = asSpan(points);
+    auto out = asSpan(keys);
+    assert(in.size() == out.size());
+    const auto grid = CurveGrid<n>{box};
+    parallelFor(pool, in.size(), curveGrainSize, [&] (size_t begin, size_t end) {
+        if (curve == Curve::Hilbert) {
+            for (size_t i = begin; i < end; i++) {
+                out[i] = hilbertIndex<n>(grid(in[i]));
+            }
+        } else {
+            for (size_t i = begin; i < end; i++) {
+                out[i] = mortonIndex(grid(in[i]));
+            }
+        }
+    });
+}
+
+// Stable LSD radix sort of (key, index) pairs with 8-bit digits. Each pass
+// splits the input into the same chunks; every chunk counts its digits, the
+// counts are turned into per-chunk output offsets, and chunks scatter in
+// parallel. Digits that are equal for all keys are skipped.
+template <std::unsigned_integral K>
+void radixSortPairs(
+    std::span<K> keys, std::span<std::uint32_t> indices, ThreadPool& pool)
+{
+    constexpr size_t radix = 256;
+    constexpr size_t digits = sizeof(K);
+    const size_t count = keys.size();
+
+    const size_t chunks = std::clamp<size_t>(
+        count / curveGrainSize, 1, pool.size() * 4);
+    const size_t chunkSize = (count + chunks - 1) / chunks;
+
+    std::vector<std::array<size_t, radix>> histograms(chunks * digits);
+    pool.run(chunks, [&] (size_t chunk) {
+        auto* histogram = &histograms[chunk * digits];
+        std::fill(histogram, histogram + digits, std::array<size_t, radix>{});
+        const size_t end = std::min(count, (chunk + 1) * chunkSize);
+        for (size_t i = chunk * chunkSize; i < end; i++) {
+            for (size_t d = 0; d < digits; d++) {
+                histogram[d][(keys[i] >> (8 * d)) & 0xff]++;
+            }
+        }
+    });
+
+    std::vector<K> keyBuffer(count);
+    std::vector<std::uint32_t> indexBuffer(count);
+    auto sourceKeys = keys;
+    auto sourceIndices = indices;
+    auto targetKeys = std::span<K>{keyBuffer};
+    auto targetIndices = std::span<std::uint32_t>{indexBuffer};
+
+    std::vector<std::array<size_t, radix>> offsets(chunks);
+    for (size_t d = 0; d < digits; d++) {
+        const size_t shift = 8 * d;
+
+        auto total = std::array<size_t, radix>{};
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            for (size_t b = 0; b < radix; b++) {
+                total[b] += histograms[chunk * digits + d][b];
+            }
+        }
+        if (std::find(total.begin(), total.end(), count) != total.end()) {
+            continue;
+        }
+
+        // Chunk histograms of this digit, for the current order of keys.
+        if (d > 0 && chunks > 1) {
+            pool.run(chunks, [&] (size_t chunk) {
+                auto& histogram = offsets[chunk];
+                histogram.fill(0);
+                const size_t end = std::min(count, (chunk + 1) * chunkSize);
+                for (size_t i = chunk * chunkSize; i < end; i++) {
+                    histogram[(sourceKeys[i] >> shift) & 0xff]++;
+                }
+            });
+        } else {
+            for (size_t chunk = 0; chunk < chunks; chunk++) {
+                offsets[chunk] = histograms[chunk * digits + d];
+            }
+        }
+
+        size_t offset = 0;
+        for (size_t b = 0; b < radix; b++) {
+            for (size_t chunk = 0; chunk < chunks; chunk++) {
+                const size_t size = offsets[chunk][b];
+                offsets[chunk][b] = offset;
+                offset += size;
+            }
+        }
+
+        pool.run(chunks, [&] (size_t chunk) {
+            auto& offset = offsets[chunk];
+            const size_t end = std::min(count, (chunk + 1) * chunkSize);
+            for (size_t i = chunk * chunkSize; i < end; i++) {
+                const size_t target = offset[(sourceKeys[i] >> shift) & 0xff]++;
+                targetKeys[target] = sourceKeys[i];
+                targetIndices[target] = sourceIndices[i];
+            }
+        });
+
+        std::swap(sourceKeys, targetKeys);
+        std::swap(sourceIndices, targetIndices);
+    }
+
+    if (sourceKeys.data() != keys.data()) {
+        std::copy(sourceKeys.begin(), sourceKeys.end(), keys.begin());
+        std::copy(sourceIndices.begin(), sourceIndices.end(), indices.begin());
+    }
+}
+
+template <class T>
+void applyPermutation(
+    std::span<T> values, std::span<const std::uint32_t> order, ThreadPool& pool)
+{
+    std::vector<T> sorted(values.size());
+    parallelFor(pool, values.size(), curveGrainSize, [&] (size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            sorted[i] = values[order[i]];
+        }
+    });
+    std::copy(sorted.begin(), sorted.end(), values.begin());
+}
+
+template <class K, class... Values>
+void sortByKeys(std::span<K> keys, ThreadPool& pool, std::span<Values>... values)
+{
+    assert(((values.size() == keys.size()) && ...));
+    assert(keys.size() <= std::numeric_limits<std::uint32_t>::max());
+
+    std::vector<std::uint32_t> order(keys.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = static_cast<std::uint32_t>(i);
+    }
+    radixSortPairs(keys, std::span{order}, pool);
+    (applyPermutation(values, std::span<const std::uint32_t>{order}, pool), ...);
+}
+
+template <class R>
+concept CurvePointRange =
+    PointRange<R> && CurveDimension<PointTraits<RangeValue<R>>::size>;
+
+template <class R>
+concept KeyOutputRange =
+    OutputRange<R> && std::unsigned_integral<std::ranges::range_value_t<R>>;
+
+} // namespace internal
+
+// Morton (Z-order) and Hilbert keys of 2D and 3D points. The box is divided
+// into a grid of 2^32 (2D) or 2^21 (3D) cells per axis, and the key is the
+// position of the point's cell along the curve. Points outside the box are
+// clamped to it. Hilbert keys preserve locality better: cells with
+// consecutive keys are always adjacent, while Z-order makes long jumps
+// between quadrants.
+template <template <class> class M, class T, size_t N, class U>
+requires internal::CurveDimension<N>
+std::uint64_t mortonKey(const Point<M, U, N>& point, const AABB<M, T, N>& box)
+{
+    return internal::mortonIndex(internal::CurveGrid<N>{box}(point));
+}
+
+template <template <class> class M, class T, size_t N, class U>
+requires internal::CurveDimension<N>
+std::uint64_t hilbertKey(const Point<M, U, N>& point, const AABB<M, T, N>& box)
+{
+    return internal::hilbertIndex<N>(internal::CurveGrid<N>{box}(point));
+}
+
+template <internal::CurvePointRange R, internal::KeyOutputRange Out>
+void mortonKeys(
+    const R& points,
+    const auto& box,
+    Out&& keys,
+    ThreadPool& pool = defaultThreadPool())
+{
+    internal::curveKeys(Curve::Morton, points, box, keys, pool);
+}
+
+template <internal::CurvePointRange R, internal::KeyOutputRange Out>
+void hilbertKeys(
+    const R& points,
+    const auto& box,
+    Out&& keys,
+    ThreadPool& pool = defaultThreadPool())
+{
+    internal::curveKeys(Curve::Hilbert, points, box, keys, pool);
+}
+
+// Sorts the keys and reorders the values (and the payload) the same way.
+// The sort is stable, so values with equal keys keep their relative order.
+template <internal::KeyOutputRange Keys, internal::OutputRange Values>
+void sortByKeys(
+    Keys&& keys, Values&& values, ThreadPool& pool = defaultThreadPool())
+{
+    internal::sortByKeys(internal::asSpan(keys), pool, internal::asSpan(values));
+}
+
+template <internal::KeyOutputRange Keys, internal::OutputRange Values,
+    internal::OutputRange Payload>
+void sortByKeys(
+    Keys&& keys,
+    Values&& values,
+    Payload&& payload,
+    ThreadPool& pool = defaultThreadPool())
+{
+    internal::sortByKeys(
+        internal::asSpan(keys), pool,
+        internal::asSpan(values), internal::asSpan(payload));
+}
+
+// Reorders points along a space-filling curve through their bounding box,
+// so that points close in space end up close in memory.
+template <internal::CurvePointRange R>
+requires internal::OutputRange<R>
+void spatialSort(
+    R&& points, Curve curve = Curve::Hilbert, ThreadPool& pool = defaultThreadPool())
+{
+    std::vector<std::uint64_t> keys(std::ranges::size(points));
+    internal::curveKeys(curve, points, bounds(points, pool), keys, pool);
+    sortByKeys(keys, points, pool);
+}
+
+template <internal::CurvePointRange R, internal::OutputRange Payload>
+requires internal::OutputRange<R>
+void spatialSort(
+    R&& points,
+    Payload&& payload,
+    Curve curve = Curve::Hilbert,
+    ThreadPool& pool = defaultThreadPool())
+{
+    std::vector<std::uint64_t> keys(std::ranges::size(points));
+    internal::curveKeys(curve, points, bounds(points, pool), keys, pool);
+    sortByKeys(keys, points, payload, pool);
+}
+
+} // namespace ve
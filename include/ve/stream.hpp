@@ -0,0 +1,535 @@
+#pragma once
+
+#include "ve/internal/traits.hpp"
+#include "ve/text.hpp"
+#include "ve/thread_pool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ve {
+
+// Streaming pipelines move values from a source through a list of stages to
+// a sink, one batch at a time.
+//
+// A source has size_t read(std::span<V> batch), which fills a prefix of the
+// batch and returns its length, or 0 at the end of the input. A sink has
+// write(std::span<const V> batch). PointFileReader and PointFileWriter are
+// a source and a sink, as are PointDecoder and PointEncoder for compressed
+// streams; TextReader, TextWriter, GeneratorSource, SpanSource and
+// ReduceSink below cover other inputs and outputs.
+
+class StreamError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+struct StreamOptions {
+    // Values per batch.
+    size_t batchSize = 16384;
+    // Batches allocated by the pipeline. Reading, the stages and writing
+    // each work on their own batch, so 3 is the least that keeps them all
+    // busy; more batches absorb jitter in any of them.
+    size_t batchCount = 4;
+    // Elementwise stages of a batch are split across this pool. Without a
+    // pool they run on the stage thread only.
+    ThreadPool* pool = nullptr;
+};
+
+struct StreamStats {
+    std::uint64_t read = 0;
+    std::uint64_t written = 0;
+    std::uint64_t batches = 0;
+};
+
+namespace internal {
+
+// A FIFO of at most `capacity` items, shared by one producer and one
+// consumer thread. close() ends the stream after the queued items;
+// cancel() ends it at once, for both sides.
+template <class T>
+class StreamQueue {
+public:
+    explicit StreamQueue(size_t capacity)
+        : _items(capacity)
+    { }
+
+    bool push(T item)
+    {
+        auto lock = std::lock_guard{_mutex};
+        if (_cancelled) {
+            return false;
+        }
+        assert(_count < _items.size());
+        _items[(_head + _count) % _items.size()] = std::move(item);
+        _count++;
+        _ready.notify_one();
+        return true;
+    }
+
+    std::optional<T> pop()
+    {
+        auto lock = std::unique_lock{_mutex};
+        _ready.wait(lock, [this] { return _cancelled || _closed || _count > 0; });
+        if (_cancelled || _count == 0) {
+            return std::nullopt;
+        }
+        auto item = std::move(_items[_head]);
+        _head = (_head + 1) % _items.size();
+        _count--;
+        return item;
+    }
+
+    void close()
+    {
+        auto lock = std::lock_guard{_mutex};
+        _closed = true;
+        _ready.notify_all();
+    }
+
+    void cancel()
+    {
+        auto lock = std::lock_guard{_mutex};
+        _cancelled = true;
+        _ready.notify_all();
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _ready;
+    std::vector<T> _items;
+    size_t _head = 0;
+    size_t _count = 0;
+    bool _closed = false;
+    bool _cancelled = false;
+};
+
+// Elementwise stages are run over blocks of this many values, all stages
+// on one block before the next, so the block stays in cache.
+constexpr size_t streamBlockSize = 1024;
+
+} // namespace internal
+
+// Source that produces count values, f(0), f(1), ..., f(count - 1).
+template <class V, class F>
+class GeneratorSource {
+public:
+    GeneratorSource(std::uint64_t count, F f)
+        : _count(count)
+        , _f(std::move(f))
+    { }
+
+    size_t read(std::span<V> batch)
+    {
+        const auto count = static_cast<size_t>(
+            std::min<std::uint64_t>(batch.size(), _count - _next));
+        for (size_t i = 0; i < count; i++) {
+            batch[i] = _f(_next++);
+        }
+        return count;
+    }
+
+private:
+    std::uint64_t _count;
+    std::uint64_t _next = 0;
+    F _f;
+};
+
+template <class F>
+GeneratorSource(std::uint64_t, F)
+    -> GeneratorSource<std::invoke_result_t<F&, std::uint64_t>, F>;
+
+// Source that copies values out of a range that is already in memory.
+template <class V>
+class SpanSource {
+public:
+    explicit SpanSource(std::span<const V> values)
+        : _values(values)
+    { }
+
+    template <internal::ContiguousRange R>
+    explicit SpanSource(const R& values)
+        : _values(internal::asSpan(values))
+    { }
+
+    size_t read(std::span<V> batch)
+    {
+        const size_t count = std::min(batch.size(), _values.size());
+        std::copy_n(_values.begin(), count, batch.begin());
+        _values = _values.subspan(count);
+        return count;
+    }
+
+private:
+    std::span<const V> _values;
+};
+
+template <internal::ContiguousRange R>
+SpanSource(const R&) -> SpanSource<internal::RangeValue<R>>;
+
+// Source that parses values from a text stream, in the format accepted by
+// fromChars(): any number of values per line, '#' comments and empty lines
+// skipped. Only the current line is held in memory. A value that cannot be
+// read throws StreamError with its line number.
+template <internal::TextValue V>
+class TextReader {
+public:
+    explicit TextReader(std::istream& input)
+        : _input(input)
+    { }
+
+    size_t read(std::span<V> batch)
+    {
+        size_t count = 0;
+        while (count < batch.size()) {
+            while (_position < _line.size() &&
+                    internal::isSeparator(_line[_position])) {
+                _position++;
+            }
+            if (_position == _line.size() || _line[_position] == '#') {
+                if (!std::getline(_input, _line)) {
+                    if (!_input.eof()) {
+                        throw StreamError{"failed to read text input"};
+                    }
+                    _line.clear();
+                    _position = 0;
+                    break;
+                }
+                _position = 0;
+                _lineNumber++;
+                continue;
+            }
+
+            const char* first = _line.data() + _position;
+            const char* last = _line.data() + _line.size();
+            auto result = fromChars(first, last, batch[count]);
+            if (result.ec != std::errc{}) {
+                throw StreamError{
+                    "invalid value on line " + std::to_string(_lineNumber)};
+            }
+            _position += static_cast<size_t>(result.ptr - first);
+            count++;
+        }
+        return count;
+    }
+
+private:
+    std::istream& _input;
+    std::string _line;
+    size_t _position = 0;
+    std::uint64_t _lineNumber = 0;
+};
+
+// Sink that writes one value per line, as toChars() formats it.
+template <internal::TextValue V>
+class TextWriter {
+public:
+    explicit TextWriter(std::ostream& output)
+        : _output(output)
+    { }
+
+    void write(std::span<const V> batch)
+    {
+        _text.clear();
+        for (const auto& value : batch) {
+            appendText(_text, value);
+            _text.push_back('\n');
+        }
+        _output.write(_text.data(), static_cast<std::streamsize>(_text.size()));
+        if (!_output) {
+            throw StreamError{"failed to write text output"};
+        }
+    }
+
+private:
+    std::ostream& _output;
+    std::string _text;
+};
+
+// Sink that folds every value into an accumulator: result = f(result, v),
+// in stream order.
+template <class R, class F>
+class ReduceSink {
+public:
+    ReduceSink(R init, F f)
+        : _result(std::move(init))
+        , _f(std::move(f))
+    { }
+
+    template <class V>
+    void write(std::span<const V> batch)
+    {
+        for (const auto& value : batch) {
+            _result = _f(std::move(_result), value);
+        }
+    }
+
+    const R& result() const
+    {
+        return _result;
+    }
+
+private:
+    R _result;
+    F _f;
+};
+
+// Reads batches from a source, runs them through the stages in order and
+// writes what is left to a sink, with bounded memory: the pipeline owns
+// batchCount batches of batchSize values, allocated once and reused for
+// every run, and nothing else grows with the input.
+//
+// run() reads on one thread, runs the stages on another and writes on the
+// calling thread, so I/O overlaps with computation. Batches reach the sink
+// in input order. The source, the sink and stages added with stage() or
+// filter() are each called from one thread at a time. Elementwise stages,
+// including map(), are called on parts of a batch from several pool threads
+// at once when StreamOptions::pool is set, so their callables must then be
+// safe to call concurrently. An exception from any of them stops the
+// pipeline and is rethrown by run().
+template <class V>
+class StreamPipeline {
+public:
+    using value_type = V;
+
+    // Processes a batch in place and returns how many values it keeps,
+    // which are moved to the front of the batch.
+    using Stage = std::function<size_t(std::span<V>)>;
+
+    explicit StreamPipeline(StreamOptions options = {})
+        : _options(options)
+        , _buffer(options.batchSize * options.batchCount)
+    {
+        assert(options.batchSize > 0);
+        assert(options.batchCount > 0);
+    }
+
+    // Adds a stage that may drop values or depend on their order.
+    StreamPipeline& stage(Stage stage)
+    {
+        _stages.push_back({std::move(stage), false});
+        return *this;
+    }
+
+    // Adds a stage that processes each value on its own and keeps them all,
+    // so a batch can be split between threads. f(std::span<V>) updates the
+    // values in place; with a pool it runs concurrently on disjoint parts of
+    // the batch.
+    template <class F>
+    StreamPipeline& elementwise(F f)
+    {
+        _stages.push_back({
+            [f = std::move(f)] (std::span<V> values) {
+                f(values);
+                return values.size();
+            },
+            true});
+        return *this;
+    }
+
+    // Replaces every value v with f(v). Like any elementwise stage, f must be
+    // thread-safe when the pipeline has a pool.
+    template <class F>
+    requires std::is_convertible_v<std::invoke_result_t<F&, const V&>, V>
+    StreamPipeline& map(F f)
+    {
+        return elementwise([f = std::move(f)] (std::span<V> values) {
+            for (auto& value : values) {
+                value = f(std::as_const(value));
+            }
+        });
+    }
+
+    // Keeps the values for which the predicate is true, in order.
+    template <class F>
+    StreamPipeline& filter(F predicate)
+    {
+        return stage([predicate = std::move(predicate)] (std::span<V> values) {
+            size_t kept = 0;
+            for (size_t i = 0; i < values.size(); i++) {
+                if (predicate(std::as_const(values[i]))) {
+                    values[kept++] = values[i];
+                }
+            }
+            return kept;
+        });
+    }
+
+    // Adds a vector to every value.
+    template <class O>
+    StreamPipeline& offset(const O& offset)
+    {
+        return elementwise([offset] (std::span<V> values) {
+            for (auto& value : values) {
+                value += offset;
+            }
+        });
+    }
+
+    // Multiplies every component by the matching component of the factors.
+    template <class S>
+    StreamPipeline& scale(const S& factors)
+    {
+        using T = typename internal::ValueTraits<V>::value_type;
+        constexpr size_t n = internal::ValueTraits<V>::size;
+        return elementwise([factors] (std::span<V> values) {
+            for (auto& value : values) {
+                for (size_t i = 0; i < n; i++) {
+                    value[i] = static_cast<T>(value[i] * factors[i]);
+                }
+            }
+        });
+    }
+
+    // Bytes of batch storage, the memory the pipeline itself uses.
+    size_t memoryUsage() const
+    {
+        return _buffer.size() * sizeof(V);
+    }
+
+    template <class Source, class Sink>
+    StreamStats run(Source&& source, Sink&& sink)
+    {
+        const size_t batchCount = _options.batchCount;
+        auto free = internal::StreamQueue<size_t>{batchCount};
+        auto filled = internal::StreamQueue<size_t>{batchCount};
+        auto processed = internal::StreamQueue<size_t>{batchCount};
+        auto sizes = std::vector<size_t>(batchCount);
+        auto stats = StreamStats{};
+
+        std::exception_ptr error;
+        auto errorMutex = std::mutex{};
+        auto fail = [&] {
+            {
+                auto lock = std::lock_guard{errorMutex};
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            free.cancel();
+            filled.cancel();
+            processed.cancel();
+        };
+
+        for (size_t b = 0; b < batchCount; b++) {
+            free.push(b);
+        }
+
+        auto reader = std::thread{[&] {
+            try {
+                while (auto b = free.pop()) {
+                    sizes[*b] = source.read(batch(*b));
+                    if (sizes[*b] == 0) {
+                        break;
+                    }
+                    stats.read += sizes[*b];
+                    stats.batches++;
+                    filled.push(*b);
+                }
+                filled.close();
+            } catch (...) {
+                fail();
+            }
+        }};
+
+        auto worker = std::thread{[&] {
+            try {
+                while (auto b = filled.pop()) {
+                    sizes[*b] = process(batch(*b).first(sizes[*b]));
+                    processed.push(*b);
+                }
+                processed.close();
+            } catch (...) {
+                fail();
+            }
+        }};
+
+        try {
+            while (auto b = processed.pop()) {
+                if (sizes[*b] > 0) {
+                    sink.write(std::span<const V>{batch(*b).first(sizes[*b])});
+                    stats.written += sizes[*b];
+                }
+                free.push(*b);
+            }
+        } catch (...) {
+            fail();
+        }
+
+        reader.join();
+        worker.join();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return stats;
+    }
+
+private:
+    struct StageEntry {
+        Stage apply;
+        bool elementwise;
+    };
+
+    std::span<V> batch(size_t b)
+    {
+        return std::span{_buffer}.subspan(
+            b * _options.batchSize, _options.batchSize);
+    }
+
+    size_t process(std::span<V> values)
+    {
+        size_t s = 0;
+        while (s < _stages.size() && !values.empty()) {
+            if (!_stages[s].elementwise) {
+                values = values.first(_stages[s].apply(values));
+                s++;
+                continue;
+            }
+
+            size_t end = s;
+            while (end < _stages.size() && _stages[end].elementwise) {
+                end++;
+            }
+            auto runBlocks = [&] (size_t begin, size_t stop) {
+                for (size_t i = begin; i < stop; i += internal::streamBlockSize) {
+                    auto block = values.subspan(
+                        i, std::min(internal::streamBlockSize, stop - i));
+                    for (size_t k = s; k < end; k++) {
+                        _stages[k].apply(block);
+                    }
+                }
+            };
+            if (_options.pool) {
+                parallelFor(*_options.pool, values.size(),
+                    4 * internal::streamBlockSize, runBlocks);
+            } else {
+                runBlocks(0, values.size());
+            }
+            s = end;
+        }
+        return values.size();
+    }
+
+    StreamOptions _options;
+    std::vector<V> _buffer;
+    std::vector<StageEntry> _stages;
+};
+
+} // namespace ve
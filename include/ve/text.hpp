@@ -0,0 +1,318 @@
+#pragma once
+
+#include "ve/internal/element.hpp"
+#include "ve/internal/traits.hpp"
+#include "ve/point.hpp"
+#include "ve/vector.hpp"
+
+#include <charconv>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+#include <version>
+
+#if __has_include(<format>)
+    #include <format>
+#endif
+
+#ifndef __cpp_lib_to_chars
+    #include <algorithm>
+    #include <locale>
+    #include <sstream>
+#endif
+
+namespace ve {
+
+namespace internal {
+
+template <class V>
+concept TextValue = ValueTraits<V>::size > 0;
+
+template <class V>
+constexpr char openBracket = VectorTraits<V>::isVector ? '[' : '(';
+
+template <class V>
+constexpr char closeBracket = VectorTraits<V>::isVector ? ']' : ')';
+
+// Upper bound on the length of a number written by std::to_chars in its
+// shortest round-trip form: sign, digits, decimal point and exponent.
+template <class T>
+constexpr size_t maxNumberSize()
+{
+    if constexpr (std::is_floating_point_v<T>) {
+        return std::numeric_limits<T>::max_digits10 + 8;
+    } else {
+        return std::numeric_limits<T>::digits10 + 2;
+    }
+}
+
+inline bool isSeparator(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == ',' || c == ';' ||
+        c == '(' || c == ')' || c == '[' || c == ']';
+}
+
+#ifdef __cpp_lib_to_chars
+
+template <class T>
+std::to_chars_result writeNumber(char* first, char* last, T value)
+{
+    return std::to_chars(first, last, value);
+}
+
+template <class T>
+std::from_chars_result readNumber(const char* first, const char* last, T& value)
+{
+    return std::from_chars(first, last, value);
+}
+
+#else
+
+// Standard libraries without floating-point std::to_chars and
+// std::from_chars (libstdc++ before 11, libc++ before 20) do not define
+// __cpp_lib_to_chars. There, floating-point numbers go through streams in
+// the classic locale instead. They are written with the fewest significant
+// digits that read back exactly, in %g form, and read like from_chars()
+// except that "inf" and "nan" are not accepted.
+template <class T>
+bool readsBack(const std::string& text, T value)
+{
+    auto stream = std::istringstream{text};
+    stream.imbue(std::locale::classic());
+    auto result = T{};
+    stream >> result;
+    return !stream.fail() && result == value;
+}
+
+template <class T>
+std::to_chars_result writeNumber(char* first, char* last, T value)
+{
+    if constexpr (std::is_floating_point_v<T>) {
+        auto stream = std::ostringstream{};
+        stream.imbue(std::locale::classic());
+        for (int digits = std::numeric_limits<T>::digits10; ; digits++) {
+            stream.str({});
+            stream.precision(digits);
+            stream << value;
+            if (digits >= std::numeric_limits<T>::max_digits10 ||
+                    readsBack(stream.str(), value)) {
+                break;
+            }
+        }
+        const auto text = stream.str();
+        if (text.size() > static_cast<size_t>(last - first)) {
+            return {last, std::errc::value_too_large};
+        }
+        return {std::copy(text.begin(), text.end(), first), std::errc{}};
+    } else {
+        return std::to_chars(first, last, value);
+    }
+}
+
+template <class T>
+std::from_chars_result readNumber(const char* first, const char* last, T& value)
+{
+    if constexpr (std::is_floating_point_v<T>) {
+        // Like from_chars(), no leading whitespace or plus sign.
+        const char* end = first;
+        while (end != last && ((*end >= '0' && *end <= '9') || *end == '.' ||
+                *end == 'e' || *end == 'E' || *end == '+' || *end == '-')) {
+            end++;
+        }
+        if (first == end || *first == '+') {
+            return {first, std::errc::invalid_argument};
+        }
+        auto stream = std::istringstream{std::string{first, end}};
+        stream.imbue(std::locale::classic());
+        auto result = T{};
+        stream >> result;
+        if (stream.fail()) {
+            return {first, std::errc::invalid_argument};
+        }
+        value = result;
+        const auto read = stream.eof() ? end - first : std::streamoff{stream.tellg()};
+        return {first + read, std::errc{}};
+    } else {
+        return std::from_chars(first, last, value);
+    }
+}
+
+#endif
+
+} // namespace internal
+
+// Buffer size that is always enough for toChars() of a value of type V.
+template <internal::TextValue V>
+constexpr size_t maxTextSize = 2 + internal::ValueTraits<V>::size * (2 +
+    internal::maxNumberSize<
+        internal::PromotedType<typename internal::ValueTraits<V>::value_type>>());
+
+// Writes "[x, y, ...]" for vectors and "(x, y, ...)" for points into
+// [first, last), in the same shape as operator<<, but without locale or
+// stream overhead. Floating-point components use the shortest representation
+// that reads back exactly. On failure, returns {last, errc::value_too_large}.
+template <internal::TextValue V>
+std::to_chars_result toChars(char* first, char* last, const V& value)
+{
+    const auto tooLarge = std::to_chars_result{last, std::errc::value_too_large};
+    using T = typename internal::ValueTraits<V>::value_type;
+    constexpr size_t n = internal::ValueTraits<V>::size;
+
+    if (first == last) {
+        return tooLarge;
+    }
+    *first++ = internal::openBracket<V>;
+    for (size_t i = 0; i < n; i++) {
+        if (i > 0) {
+            if (last - first < 2) {
+                return tooLarge;
+            }
+            *first++ = ',';
+            *first++ = ' ';
+        }
+        auto result = internal::writeNumber(
+            first, last, static_cast<internal::PromotedType<T>>(value[i]));
+        if (result.ec != std::errc{}) {
+            return tooLarge;
+        }
+        first = result.ptr;
+    }
+    if (first == last) {
+        return tooLarge;
+    }
+    *first++ = internal::closeBracket<V>;
+    return {first, std::errc{}};
+}
+
+// Appends the text of a value to a string, growing it at most once.
+template <internal::TextValue V>
+void appendText(std::string& output, const V& value)
+{
+    const size_t size = output.size();
+    output.resize(size + maxTextSize<V>);
+    auto result = toChars(output.data() + size, output.data() + output.size(), value);
+    output.resize(static_cast<size_t>(result.ptr - output.data()));
+}
+
+// Reads the N components of one value from [first, last). Components may be
+// separated by whitespace, commas or semicolons, and may be enclosed in
+// brackets or parentheses, so both CSV rows and the output of toChars() are
+// accepted. Components of one value must be on the same line.
+template <internal::TextValue V>
+std::from_chars_result fromChars(const char* first, const char* last, V& value)
+{
+    using T = typename internal::ValueTraits<V>::value_type;
+    constexpr size_t n = internal::ValueTraits<V>::size;
+
+    for (size_t i = 0; i < n; i++) {
+        while (first != last && internal::isSeparator(*first)) {
+            first++;
+        }
+        auto component = internal::PromotedType<T>{};
+        auto result = internal::readNumber(first, last, component);
+        if (result.ec != std::errc{}) {
+            return result;
+        }
+        value[i] = component;
+        first = result.ptr;
+    }
+    while (first != last && *first != '\n' && internal::isSeparator(*first)) {
+        first++;
+    }
+    return {first, std::errc{}};
+}
+
+// Reads a list of values from [first, last) and appends them to the output.
+// Values are read as in fromChars() for a single value; any number of values
+// may share a line, but a value may not span lines. Empty lines and lines
+// starting with '#' are skipped. On error, the returned pointer is the start
+// of the value that could not be read, and the values before it have been
+// appended.
+template <internal::TextValue V>
+std::from_chars_result fromChars(
+    const char* first, const char* last, std::vector<V>& output)
+{
+    while (first != last) {
+        while (first != last && (*first == '\n' || internal::isSeparator(*first))) {
+            first++;
+        }
+        if (first == last) {
+            break;
+        }
+        if (*first == '#') {
+            while (first != last && *first != '\n') {
+                first++;
+            }
+            continue;
+        }
+
+        V value;
+        auto result = fromChars(first, last, value);
+        if (result.ec != std::errc{}) {
+            return {first, result.ec};
+        }
+        output.push_back(value);
+        first = result.ptr;
+    }
+    return {first, std::errc{}};
+}
+
+template <internal::TextValue V>
+std::from_chars_result fromChars(std::string_view text, std::vector<V>& output)
+{
+    return fromChars(text.data(), text.data() + text.size(), output);
+}
+
+} // namespace ve
+
+#ifdef __cpp_lib_format
+
+namespace ve::internal {
+
+// Formats each component with the standard formatter of its type, so a
+// format spec such as "{:.3f}" applies to every component.
+template <class V, class Char>
+struct ComponentFormatter {
+    using T = PromotedType<typename ValueTraits<V>::value_type>;
+
+    constexpr auto parse(std::basic_format_parse_context<Char>& context)
+    {
+        return _component.parse(context);
+    }
+
+    template <class Context>
+    auto format(const V& value, Context& context) const
+    {
+        auto out = context.out();
+        *out++ = static_cast<Char>(openBracket<V>);
+        for (size_t i = 0; i < ValueTraits<V>::size; i++) {
+            if (i > 0) {
+                *out++ = static_cast<Char>(',');
+                *out++ = static_cast<Char>(' ');
+            }
+            context.advance_to(out);
+            out = _component.format(static_cast<T>(value[i]), context);
+        }
+        *out++ = static_cast<Char>(closeBracket<V>);
+        return out;
+    }
+
+private:
+    mutable std::formatter<T, Char> _component;
+};
+
+} // namespace ve::internal
+
+template <template <class> class M, class T, size_t N, class Char>
+struct std::formatter<ve::Vector<M, T, N>, Char>
+    : ve::internal::ComponentFormatter<ve::Vector<M, T, N>, Char> { };
+
+template <template <class> class M, class T, size_t N, class Char>
+struct std::formatter<ve::Point<M, T, N>, Char>
+    : ve::internal::ComponentFormatter<ve::Point<M, T, N>, Char> { };
+
+#endif
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ve {
+
+// A fixed set of worker threads that execute indexed tasks. The calling
+// thread takes part in run(), so a pool of size 1 runs everything inline.
+// run() called from inside a task executes serially on that thread.
+class ThreadPool {
+public:
+    explicit ThreadPool(
+        size_t threadCount = std::max(1u, std::thread::hardware_concurrency()))
+    {
+        for (size_t i = 1; i < threadCount; i++) {
+            _workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            auto lock = std::lock_guard{_mutex};
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (auto& worker : _workers) {
+            worker.join();
+        }
+    }
+
+    size_t size() const
+    {
+        return _workers.size() + 1;
+    }
+
+    template <class F>
+    void run(size_t taskCount, F&& task)
+    {
+        if (taskCount == 0) {
+            return;
+        }
+        if (taskCount == 1 || _workers.empty() || insideTask()) {
+            for (size_t i = 0; i < taskCount; i++) {
+                task(i);
+            }
+            return;
+        }
+
+        auto runLock = std::lock_guard{_runMutex};
+        {
+            auto lock = std::unique_lock{_mutex};
+            _done.wait(lock, [this] { return _activeWorkers == 0; });
+            _task = std::ref(task);
+            _taskCount = taskCount;
+            _nextTask = 0;
+            _finishedTasks = 0;
+            _error = nullptr;
+            _generation++;
+        }
+        _wake.notify_all();
+
+        size_t finished = execute();
+
+        auto lock = std::unique_lock{_mutex};
+        _finishedTasks += finished;
+        _done.wait(lock, [this] {
+            return _finishedTasks == _taskCount && _activeWorkers == 0;
+        });
+        _task = nullptr;
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+    }
+
+private:
+    static bool& insideTask()
+    {
+        thread_local bool inside = false;
+        return inside;
+    }
+
+    void work()
+    {
+        size_t seenGeneration = 0;
+        auto lock = std::unique_lock{_mutex};
+        for (;;) {
+            _wake.wait(lock, [this, &seenGeneration] {
+                return _stopping || _generation != seenGeneration;
+            });
+            if (_stopping) {
+                return;
+            }
+            seenGeneration = _generation;
+            _activeWorkers++;
+
+            lock.unlock();
+            size_t finished = execute();
+            lock.lock();
+
+            _finishedTasks += finished;
+            _activeWorkers--;
+            if (_activeWorkers == 0) {
+                _done.notify_all();
+            }
+        }
+    }
+
+    size_t execute()
+    {
+        insideTask() = true;
+        size_t finished = 0;
+        for (;;) {
+            size_t index = _nextTask.fetch_add(1);
+            if (index >= _taskCount) {
+                break;
+            }
+            try {
+                _task(index);
+            } catch (...) {
+                auto lock = std::lock_guard{_mutex};
+                if (!_error) {
+                    _error = std::current_exception();
+                }
+            }
+            finished++;
+        }
+        insideTask() = false;
+        return finished;
+    }
+
+    std::vector<std::thread> _workers;
+    std::mutex _runMutex;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    std::function<void(size_t)> _task;
+    size_t _taskCount = 0;
+    std::atomic<size_t> _nextTask = 0;
+    size_t _finishedTasks = 0;
+    size_t _activeWorkers = 0;
+    size_t _generation = 0;
+    std::exception_ptr _error;
+    bool _stopping = false;
+};
+
+inline ThreadPool& defaultThreadPool()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+// Splits [0, count) into chunks of at least grainSize elements and calls
+// f(begin, end) for each chunk on the pool.
+template <class F>
+void parallelFor(ThreadPool& pool, size_t count, size_t grainSize, F&& f)
+{
+    if (count == 0) {
+        return;
+    }
+    grainSize = std::max<size_t>(grainSize, 1);
+    const size_t chunks = std::min(
+        (count + grainSize - 1) / grainSize, pool.size() * 4);
+    const size_t chunkSize = (count + chunks - 1) / chunks;
+    pool.run(chunks, [&] (size_t chunk) {
+        const size_t begin = chunk * chunkSize;
+        const size_t end = std::min(count, begin + chunkSize);
+        if (begin < end) {
+            f(begin, end);
+        }
+    });
+}
+
+} // namespace ve
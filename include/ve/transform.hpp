@@ -0,0 +1,578 @@
+#pragma once
+
+#include "ve/aabb.hpp"
+#include "ve/dispatch.hpp"
+#include "ve/internal/traits.hpp"
+#include "ve/point.hpp"
+#include "ve/soa.hpp"
+#include "ve/vector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+namespace ve {
+
+// A square N x N matrix acting on Vector<M, ?, N>. Elements are stored in row
+// order in plain arrays, so matrices can be built and multiplied in constant
+// expressions.
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+class Matrix {
+public:
+    using Rows = std::array<std::array<T, N>, N>;
+
+    constexpr Matrix() = default;
+
+    constexpr explicit Matrix(const Rows& rows)
+        : _rows(rows)
+    { }
+
+    static constexpr Matrix identity()
+    {
+        return scale(T{1});
+    }
+
+    static constexpr Matrix scale(T factor)
+    {
+        auto matrix = Matrix{};
+        for (size_t i = 0; i < N; i++) {
+            matrix(i, i) = factor;
+        }
+        return matrix;
+    }
+
+    static constexpr Matrix diagonal(const std::array<T, N>& factors)
+    {
+        auto matrix = Matrix{};
+        for (size_t i = 0; i < N; i++) {
+            matrix(i, i) = factors[i];
+        }
+        return matrix;
+    }
+
+    constexpr T& operator()(size_t row, size_t column)
+    {
+        return _rows[row][column];
+    }
+
+    constexpr const T& operator()(size_t row, size_t column) const
+    {
+        return _rows[row][column];
+    }
+
+    constexpr const Rows& rows() const
+    {
+        return _rows;
+    }
+
+    constexpr Matrix transposed() const
+    {
+        auto result = Matrix{};
+        for (size_t i = 0; i < N; i++) {
+            for (size_t j = 0; j < N; j++) {
+                result(j, i) = (*this)(i, j);
+            }
+        }
+        return result;
+    }
+
+private:
+    Rows _rows{};
+};
+
+template <template <class> class M, class U, class V, size_t N>
+constexpr bool operator==(const Matrix<M, U, N>& lhs, const Matrix<M, V, N>& rhs)
+{
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = 0; j < N; j++) {
+            if (lhs(i, j) != rhs(i, j)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <template <class> class M, class U, class V, size_t N>
+constexpr bool operator!=(const Matrix<M, U, N>& lhs, const Matrix<M, V, N>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <template <class> class M, class U, class V, size_t N,
+    class R = decltype(std::declval<U>() * std::declval<V>())>
+constexpr Matrix<M, R, N> operator*(
+    const Matrix<M, U, N>& lhs, const Matrix<M, V, N>& rhs)
+{
+    auto result = Matrix<M, R, N>{};
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = 0; j < N; j++) {
+            auto sum = R{0};
+            for (size_t k = 0; k < N; k++) {
+                sum += lhs(i, k) * rhs(k, j);
+            }
+            result(i, j) = sum;
+        }
+    }
+    return result;
+}
+
+template <template <class> class M, class U, class V, size_t N,
+    class R = decltype(std::declval<U>() * std::declval<V>())>
+constexpr Vector<M, R, N> operator*(
+    const Matrix<M, U, N>& matrix, const Vector<M, V, N>& vector)
+{
+    Vector<M, R, N> result;
+    for (size_t i = 0; i < N; i++) {
+        auto sum = R{0};
+        for (size_t k = 0; k < N; k++) {
+            sum += matrix(i, k) * vector[k];
+        }
+        result[i] = sum;
+    }
+    return result;
+}
+
+// An affine transform x -> linear * x + translation. Applied to a Point, it
+// includes the translation; applied to a Vector (a difference of points), it
+// does not. Composition a * b applies b first.
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
+class Transform {
+public:
+    constexpr Transform()
+        : linear(Matrix<M, T, N>::identity())
+    { }
+
+    constexpr explicit Transform(
+        const Matrix<M, T, N>& linear, const std::array<T, N>& translation = {})
+        : linear(linear)
+        , translation(translation)
+    { }
+
+    static constexpr Transform translate(const std::array<T, N>& offset)
+    {
+        return Transform{Matrix<M, T, N>::identity(), offset};
+    }
+
+    template <class U> requires std::is_convertible_v<U, T>
+    static Transform translate(const Vector<M, U, N>& offset)
+    {
+        auto result = Transform{};
+        for (size_t i = 0; i < N; i++) {
+            result.translation[i] = offset[i];
+        }
+        return result;
+    }
+
+    static constexpr Transform scale(T factor)
+    {
+        return Transform{Matrix<M, T, N>::scale(factor)};
+    }
+
+    template <class U, class R = decltype(std::declval<T>() * std::declval<U>())>
+    constexpr Point<M, R, N> operator()(const Point<M, U, N>& point) const
+    {
+        Point<M, R, N> result;
+        for (size_t i = 0; i < N; i++) {
+            auto sum = static_cast<R>(translation[i]);
+            for (size_t k = 0; k < N; k++) {
+                sum += linear(i, k) * point[k];
+            }
+            result[i] = sum;
+        }
+        return result;
+    }
+
+    template <class U, class R = decltype(std::declval<T>() * std::declval<U>())>
+    constexpr Vector<M, R, N> operator()(const Vector<M, U, N>& vector) const
+    {
+        return linear * vector;
+    }
+
+    Matrix<M, T, N> linear;
+    std::array<T, N> translation{};
+};
+
+template <template <class> class M, class U, class V, size_t N>
+constexpr bool operator==(
+    const Transform<M, U, N>& lhs, const Transform<M, V, N>& rhs)
+{
+    for (size_t i = 0; i < N; i++) {
+        if (lhs.translation[i] != rhs.translation[i]) {
+            return false;
+        }
+    }
+    return lhs.linear == rhs.linear;
+}
+
+template <template <class> class M, class U, class V, size_t N>
+constexpr bool operator!=(
+    const Transform<M, U, N>& lhs, const Transform<M, V, N>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <template <class> class M, class U, class V, size_t N,
+    class R = decltype(std::declval<U>() * std::declval<V>())>
+constexpr Transform<M, R, N> operator*(
+    const Transform<M, U, N>& lhs, const Transform<M, V, N>& rhs)
+{
+    std::array<R, N> translation{};
+    for (size_t i = 0; i < N; i++) {
+        auto sum = static_cast<R>(lhs.translation[i]);
+        for (size_t k = 0; k < N; k++) {
+            sum += lhs.linear(i, k) * rhs.translation[k];
+        }
+        translation[i] = sum;
+    }
+    return Transform<M, R, N>{lhs.linear * rhs.linear, translation};
+}
+
+namespace internal {
+
+// Structure of arrays transforms and fused bounds work on blocks of
+// components laid out one array per component, which lets the compiler
+// vectorize across elements. For fused bounds, array of structures input is
+// transposed into such blocks on the stack.
+constexpr size_t transformBlockSize = 256;
+
+// Coefficients and sums use the compute type C, the type of the product of
+// transform and input components as for Transform::operator(), so that for
+// example integer points under a float transform are not truncated early.
+// Results are converted to the output component type when they are stored.
+template <class C, size_t N>
+struct TransformKernel {
+    template <template <class> class M, class T>
+    TransformKernel(const Transform<M, T, N>& transform, bool translate)
+    {
+        for (size_t i = 0; i < N; i++) {
+            for (size_t k = 0; k < N; k++) {
+                linear[i][k] = static_cast<C>(transform.linear(i, k));
+            }
+            translation[i] = translate ? static_cast<C>(transform.translation[i]) : C{0};
+        }
+    }
+
+    // Transforms one element of an array of structures. Whole elements are
+    // small enough for the compiler to vectorize across components.
+    template <class In, class Out>
+    void element(const In& in, Out& out) const
+    {
+        using R = typename ValueTraits<Out>::value_type;
+        C x[N];
+        for (size_t k = 0; k < N; k++) {
+            x[k] = static_cast<C>(in[k]);
+        }
+        for (size_t j = 0; j < N; j++) {
+            auto sum = translation[j];
+            for (size_t k = 0; k < N; k++) {
+                sum += linear[j][k] * x[k];
+            }
+            out[j] = static_cast<R>(sum);
+        }
+    }
+
+    // Transforms count <= transformBlockSize elements whose components are
+    // in a local block. Each output component is a separate loop over the
+    // block, which only writes to one array and therefore vectorizes.
+    template <class R>
+    void block(
+        const C (&x)[N][transformBlockSize],
+        const std::array<R*, N>& out,
+        size_t count) const
+    {
+        for (size_t j = 0; j < N; j++) {
+            C row[N];
+            std::copy(std::begin(linear[j]), std::end(linear[j]), row);
+            const C offset = translation[j];
+            R* y = out[j];
+            for (size_t i = 0; i < count; i++) {
+                auto sum = offset;
+                for (size_t k = 0; k < N; k++) {
+                    sum += row[k] * x[k][i];
+                }
+                y[i] = static_cast<R>(sum);
+            }
+        }
+    }
+
+    // Transforms separate component arrays. The output may alias the input.
+    template <class U, class R>
+    void operator()(
+        std::array<const U*, N> in,
+        std::array<R*, N> out,
+        size_t count) const
+    {
+        C x[N][transformBlockSize];
+        for (size_t start = 0; start < count; start += transformBlockSize) {
+            const size_t size = std::min(transformBlockSize, count - start);
+            for (size_t k = 0; k < N; k++) {
+                for (size_t i = 0; i < size; i++) {
+                    x[k][i] = static_cast<C>(in[k][i]);
+                }
+            }
+            block(x, out, size);
+            for (size_t k = 0; k < N; k++) {
+                in[k] += size;
+                out[k] += size;
+            }
+        }
+    }
+
+    C linear[N][N];
+    C translation[N];
+};
+
+template <class R, size_t N>
+struct Bounds {
+    Bounds()
+    {
+        std::fill(std::begin(min), std::end(min), std::numeric_limits<R>::max());
+        std::fill(std::begin(max), std::end(max), std::numeric_limits<R>::lowest());
+    }
+
+    void extend(const std::array<R*, N>& values, size_t count)
+    {
+        for (size_t c = 0; c < N; c++) {
+            extendComponent(c, values[c], count);
+        }
+    }
+
+    // Keeps a fixed number of independent minima and maxima so that the loop
+    // vectorizes without relying on reassociation.
+    void extendComponent(size_t c, const R* values, size_t count)
+    {
+        constexpr size_t lanes = 8;
+        R lo[lanes];
+        R hi[lanes];
+        std::fill(std::begin(lo), std::end(lo), min[c]);
+        std::fill(std::begin(hi), std::end(hi), max[c]);
+        size_t i = 0;
+        for (; i + lanes <= count; i += lanes) {
+            for (size_t j = 0; j < lanes; j++) {
+                lo[j] = values[i + j] < lo[j] ? values[i + j] : lo[j];
+                hi[j] = hi[j] < values[i + j] ? values[i + j] : hi[j];
+            }
+        }
+        for (; i < count; i++) {
+            lo[0] = values[i] < lo[0] ? values[i] : lo[0];
+            hi[0] = hi[0] < values[i] ? values[i] : hi[0];
+        }
+        min[c] = *std::min_element(std::begin(lo), std::end(lo));
+        max[c] = *std::max_element(std::begin(hi), std::end(hi));
+    }
+
+    template <template <class> class M>
+    AABB<M, R, N> box() const
+    {
+        auto result = AABB<M, R, N>{};
+        for (size_t c = 0; c < N; c++) {
+            result.min[c] = min[c];
+            result.max[c] = max[c];
+        }
+        return result;
+    }
+
+    R min[N];
+    R max[N];
+};
+
+// Transforms an array of structures in blocks, calling sink(components,
+// start, count) with the transformed components of each block, converted to
+// R.
+template <class R, class C, size_t N, class In, class Sink>
+void transformBlocks(
+    const TransformKernel<C, N>& kernel, std::span<const In> in, Sink&& sink)
+{
+    C source[N][transformBlockSize];
+    R target[N][transformBlockSize];
+    std::array<R*, N> targetComponents;
+    for (size_t c = 0; c < N; c++) {
+        targetComponents[c] = target[c];
+    }
+
+    for (size_t start = 0; start < in.size(); start += transformBlockSize) {
+        const size_t count = std::min(transformBlockSize, in.size() - start);
+        for (size_t i = 0; i < count; i++) {
+            for (size_t c = 0; c < N; c++) {
+                source[c][i] = static_cast<C>(in[start + i][c]);
+            }
+        }
+        kernel.block(source, targetComponents, count);
+        sink(targetComponents, start, count);
+    }
+}
+
+template <class R, size_t N, class Out>
+void storeBlock(
+    const std::array<R*, N>& components,
+    std::span<Out> out,
+    size_t start,
+    size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        for (size_t c = 0; c < N; c++) {
+            out[start + i][c] = components[c][i];
+        }
+    }
+}
+
+template <class In, class Out>
+concept TransformableRanges =
+    (VectorRange<In> && VectorOutputRange<Out>) ||
+    (PointRange<In> && PointOutputRange<Out>);
+
+template <class Array>
+auto components(Array& array)
+{
+    constexpr size_t n = ValueTraits<typename Array::value_type>::size;
+    using T = std::remove_reference_t<decltype(*array.data(0))>;
+    std::array<T*, n> result;
+    for (size_t c = 0; c < n; c++) {
+        result[c] = array.data(c);
+    }
+    return result;
+}
+
+} // namespace internal
+
+// Applies the transform to every element of a contiguous range of points or
+// vectors. Points are translated, vectors are not. Computation is done in
+// the same type as for a single element, and results are converted to the
+// component type of the output, which may alias the input.
+template <template <class> class M, class T, size_t N,
+    class In, class Out>
+requires internal::TransformableRanges<In, Out>
+void transform(const Transform<M, T, N>& transform, const In& input, Out&& output)
+{
+    using U = typename internal::ValueTraits<internal::RangeValue<In>>::value_type;
+    using C = decltype(std::declval<T>() * std::declval<U>());
+
+    auto in = std::span<const internal::RangeValue<In>>{internal::asSpan(input)};
+    auto out = internal::asSpan(output);
+    assert(in.size() == out.size());
+    const auto kernel = internal::TransformKernel<C, N>{
+        transform, internal::PointRange<In>};
+    internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+        for (size_t i = 0; i < in.size(); i++) {
+            kernel.element(in[i], out[i]);
+        }
+    });
+}
+
+// Same as transform(), and also returns the bounding box of the output.
+template <template <class> class M, class T, size_t N,
+    internal::PointRange In, internal::PointOutputRange Out>
+auto transformWithBounds(
+    const Transform<M, T, N>& transform, const In& input, Out&& output)
+{
+    using O = std::ranges::range_value_t<Out>;
+    using R = typename internal::ValueTraits<O>::value_type;
+    using U = typename internal::ValueTraits<internal::RangeValue<In>>::value_type;
+    using C = decltype(std::declval<T>() * std::declval<U>());
+
+    auto in = std::span<const internal::RangeValue<In>>{internal::asSpan(input)};
+    auto out = internal::asSpan(output);
+    assert(in.size() == out.size());
+    const auto kernel = internal::TransformKernel<C, N>{transform, true};
+    auto bounds = internal::Bounds<R, N>{};
+    internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+        internal::transformBlocks<R>(kernel, in,
+            [&out, &bounds] (
+                    const std::array<R*, N>& block, size_t start, size_t count) {
+                internal::storeBlock(block, out, start, count);
+                bounds.extend(block, count);
+            });
+    });
+    return bounds.template box<M>();
+}
+
+// Bounding box of the transformed points, without storing them.
+template <template <class> class M, class T, size_t N, internal::PointRange In>
+auto transformedBounds(const Transform<M, T, N>& transform, const In& input)
+{
+    using U = typename internal::ValueTraits<internal::RangeValue<In>>::value_type;
+    using R = decltype(std::declval<T>() * std::declval<U>());
+
+    auto in = std::span<const internal::RangeValue<In>>{internal::asSpan(input)};
+    const auto kernel = internal::TransformKernel<R, N>{transform, true};
+    auto bounds = internal::Bounds<R, N>{};
+    internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+        internal::transformBlocks<R>(kernel, in,
+            [&bounds] (const std::array<R*, N>& block, size_t, size_t count) {
+                bounds.extend(block, count);
+            });
+    });
+    return bounds.template box<M>();
+}
+
+// Structure of arrays overloads. The output is resized to match the input
+// and may be the same array.
+template <template <class> class M, class T, class U, class R, size_t N>
+void transform(
+    const Transform<M, T, N>& transform,
+    const PointArray<M, U, N>& input,
+    PointArray<M, R, N>& output)
+{
+    using C = decltype(std::declval<T>() * std::declval<U>());
+    output.resize(input.size());
+    const auto kernel = internal::TransformKernel<C, N>{transform, true};
+    auto in = internal::components(input);
+    auto out = internal::components(output);
+    internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+        kernel(in, out, input.size());
+    });
+}
+
+template <template <class> class M, class T, class U, class R, size_t N>
+void transform(
+    const Transform<M, T, N>& transform,
+    const VectorArray<M, U, N>& input,
+    VectorArray<M, R, N>& output)
+{
+    using C = decltype(std::declval<T>() * std::declval<U>());
+    output.resize(input.size());
+    const auto kernel = internal::TransformKernel<C, N>{transform, false};
+    auto in = internal::components(input);
+    auto out = internal::components(output);
+    internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+        kernel(in, out, input.size());
+    });
+}
+
+template <template <class> class M, class T, class U, class R, size_t N>
+AABB<M, R, N> transformWithBounds(
+    const Transform<M, T, N>& transform,
+    const PointArray<M, U, N>& input,
+    PointArray<M, R, N>& output)
+{
+    using C = decltype(std::declval<T>() * std::declval<U>());
+    output.resize(input.size());
+    const auto kernel = internal::TransformKernel<C, N>{transform, true};
+    auto in = internal::components(input);
+    auto out = internal::components(output);
+    auto bounds = internal::Bounds<R, N>{};
+    internal::dispatch([&] (auto) VE_FORCE_INLINE_LAMBDA {
+        for (size_t start = 0; start < input.size();
+                start += internal::transformBlockSize) {
+            const size_t count =
+                std::min(internal::transformBlockSize, input.size() - start);
+            kernel(in, out, count);
+            bounds.extend(out, count);
+            for (size_t c = 0; c < N; c++) {
+                in[c] += count;
+                out[c] += count;
+            }
+        }
+    });
+    return bounds.template box<M>();
+}
+
+} // namespace ve
@@ -1,6 +1,11 @@
 #pragma once
 
+#include "ve/internal/element.hpp"
+#include "ve/internal/hash.hpp"
+#include "ve/internal/instrument.hpp"
 #include "ve/internal/pod_wrapper.hpp"
+#include "ve/internal/simd.hpp"
+#include "ve/internal/unroll.hpp"
 
 #include <cmath>
 #include <cstddef>
@@ -11,89 +16,141 @@
 
 namespace ve {
 
-template <template <class> class M, class T, size_t N = sizeof(M<T>) / sizeof(T)>
+template <template <class> class M, class T,
+    size_t N = internal::componentCount<M<T>, T>()>
 class Vector : public internal::PodWrapper<M, T, N> {
     static_assert(std::is_trivial<M<T>>());
     static_assert(std::is_standard_layout<M<T>>());
-    static_assert(sizeof(M<T>) == N * sizeof(T));
+    static_assert(internal::hasValidLayout<M<T>, T, N>());
+
+    using Simd = internal::simd::Kernel<M, T, N>;
 
 public:
     using internal::PodWrapper<M, T, N>::PodWrapper;
 
     template <class U> requires std::is_convertible_v<U, T>
-    constexpr Vector(const Vector<M, U, N>& other)
+    VE_FORCE_INLINE constexpr Vector(const Vector<M, U, N>& other)
     {
         *this = other;
     }
 
     template <class U> requires std::is_convertible_v<U, T>
-    constexpr Vector& operator=(const Vector<M, U, N>& other)
+    VE_FORCE_INLINE constexpr Vector& operator=(const Vector<M, U, N>& other)
     {
-        for (size_t i = 0; i < N; i++) {
-            (*this)[i] = other[i];
-        }
+        VE_COUNT(Conversion);
+        internal::unroll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+            internal::get<I, N>(*this) = internal::get<I, N>(other);
+        });
         return *this;
     }
 
-    constexpr T& operator[](size_t i)
+    VE_FORCE_INLINE constexpr T& operator[](size_t i)
     {
+        if constexpr (internal::hasBoundComponents<M<T>, T, N>()) {
+            if (internal::constantEvaluated()) {
+                return internal::componentAt<T, N>(*this, i);
+            }
+        }
         return *(reinterpret_cast<T*>(this) + i);
     }
 
-    constexpr const T& operator[](size_t i) const
+    VE_FORCE_INLINE constexpr const T& operator[](size_t i) const
     {
+        if constexpr (internal::hasBoundComponents<M<T>, T, N>()) {
+            if (internal::constantEvaluated()) {
+                return internal::componentAt<const T, N>(*this, i);
+            }
+        }
         return *(reinterpret_cast<const T*>(this) + i);
     }
 
-    constexpr Vector operator-() const
+    VE_FORCE_INLINE constexpr Vector operator-() const
     {
+        VE_COUNT(VectorNegate);
+        VE_COUNT(Temporary);
         Vector result = *this;
-        for (size_t i = 0; i < N; i++) {
-            result[i] = -result[i];
+        if constexpr (Simd::enabled) {
+            if (!internal::constantEvaluated()) {
+                Simd::neg(internal::data<N>(result));
+                return result;
+            }
         }
+        internal::unroll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+            internal::get<I, N>(result) = -internal::get<I, N>(result);
+        });
         return result;
     }
 
     template <class U> requires std::is_convertible_v<U, T>
-    constexpr Vector& operator+=(const Vector<M, U, N>& other)
+    VE_FORCE_INLINE constexpr Vector& operator+=(const Vector<M, U, N>& other)
     {
-        for (size_t i = 0; i < N; i++) {
-            (*this)[i] += other[i];
+        VE_COUNT(VectorAdd);
+        if constexpr (std::is_same_v<U, T> && Simd::enabled) {
+            if (!internal::constantEvaluated()) {
+                Simd::add(internal::data<N>(*this), internal::data<N>(other));
+                return *this;
+            }
         }
+        internal::unroll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+            internal::get<I, N>(*this) += internal::get<I, N>(other);
+        });
         return *this;
     }
 
     template <class U> requires std::is_convertible_v<U, T>
-    constexpr Vector& operator-=(const Vector<M, U, N>& other)
+    VE_FORCE_INLINE constexpr Vector& operator-=(const Vector<M, U, N>& other)
     {
-        for (size_t i = 0; i < N; i++) {
-            (*this)[i] -= other[i];
+        VE_COUNT(VectorSubtract);
+        if constexpr (std::is_same_v<U, T> && Simd::enabled) {
+            if (!internal::constantEvaluated()) {
+                Simd::sub(internal::data<N>(*this), internal::data<N>(other));
+                return *this;
+            }
         }
+        internal::unroll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+            internal::get<I, N>(*this) -= internal::get<I, N>(other);
+        });
         return *this;
     }
 
     template <class S> requires std::is_convertible_v<S, T>
-    constexpr Vector& operator*=(const S& scalar)
+    VE_FORCE_INLINE constexpr Vector& operator*=(const S& scalar)
     {
-        for (size_t i = 0; i < N; i++) {
-            (*this)[i] *= scalar;
+        VE_COUNT(VectorMultiply);
+        if constexpr (std::is_same_v<S, T> && Simd::multiplies) {
+            if (!internal::constantEvaluated()) {
+                Simd::mul(internal::data<N>(*this), scalar);
+                return *this;
+            }
         }
+        internal::unroll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+            internal::get<I, N>(*this) *= scalar;
+        });
         return *this;
     }
 
     template <class S> requires std::is_convertible_v<S, T>
-    constexpr Vector& operator/=(const S& scalar)
+    VE_FORCE_INLINE constexpr Vector& operator/=(const S& scalar)
     {
-        for (size_t i = 0; i < N; i++) {
-            (*this)[i] /= scalar;
+        VE_COUNT(VectorDivide);
+        if constexpr (std::is_same_v<S, T> && Simd::divides) {
+            if (!internal::constantEvaluated()) {
+                Simd::div(internal::data<N>(*this), scalar);
+                return *this;
+            }
         }
+        internal::unroll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+            internal::get<I, N>(*this) /= scalar;
+        });
         return *this;
     }
 };
 
 template <template <class> class M, class U, class V, size_t N>
-constexpr auto operator+(const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
+VE_FORCE_INLINE constexpr auto operator+(
+    const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
 {
+    VE_COUNT(Temporary);
     using R = decltype(std::declval<U>() + std::declval<V>());
     Vector<M, R, N> result = lhs;
     result += rhs;
@@ -101,8 +158,10 @@ constexpr auto operator+(const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
 }
 
 template <template <class> class M, class U, class V, size_t N>
-constexpr auto operator-(const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
+VE_FORCE_INLINE constexpr auto operator-(
+    const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
 {
+    VE_COUNT(Temporary);
     using R = decltype(std::declval<U>() - std::declval<V>());
     Vector<M, R, N> result = lhs;
     result -= rhs;
@@ -110,8 +169,10 @@ constexpr auto operator-(const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
 }
 
 template <template <class> class M, class T, class S, size_t N>
-constexpr auto operator*(const Vector<M, T, N>& vector, const S& scalar)
+VE_FORCE_INLINE constexpr auto operator*(
+    const Vector<M, T, N>& vector, const S& scalar)
 {
+    VE_COUNT(Temporary);
     using R = decltype(std::declval<T>() * std::declval<S>());
     Vector<M, R, N> result = vector;
     result *= scalar;
@@ -119,14 +180,17 @@ constexpr auto operator*(const Vector<M, T, N>& vector, const S& scalar)
 }
 
 template <template <class> class M, class T, class S, size_t N>
-constexpr auto operator*(const S& scalar, const Vector<M, T, N>& vector)
+VE_FORCE_INLINE constexpr auto operator*(
+    const S& scalar, const Vector<M, T, N>& vector)
 {
     return vector * scalar;
 }
 
 template <template <class> class M, class T, class S, size_t N>
-constexpr auto operator/(const Vector<M, T, N>& vector, const S& scalar)
+VE_FORCE_INLINE constexpr auto operator/(
+    const Vector<M, T, N>& vector, const S& scalar)
 {
+    VE_COUNT(Temporary);
     using R = decltype(std::declval<T>() / std::declval<S>());
     Vector<M, R, N> result = vector;
     result /= scalar;
@@ -134,67 +198,104 @@ constexpr auto operator/(const Vector<M, T, N>& vector, const S& scalar)
 }
 
 template <template <class> class M, class U, class V, size_t N>
-constexpr bool operator==(const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
+VE_FORCE_INLINE constexpr bool operator==(
+    const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
 {
-    for (size_t i = 0; i < N; i++) {
-        if (!(lhs[i] == rhs[i])) {
-            return false;
+    VE_COUNT(VectorCompare);
+    using Simd = internal::simd::Kernel<M, U, N>;
+    if constexpr (std::is_same_v<U, V> && Simd::enabled) {
+        if (!internal::constantEvaluated()) {
+            return Simd::equal(internal::data<N>(lhs), internal::data<N>(rhs));
         }
     }
-    return true;
+    return internal::unrollAll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+        return internal::get<I, N>(lhs) == internal::get<I, N>(rhs);
+    });
 }
 
 template <template <class> class M, class U, class V, size_t N>
-constexpr bool operator!=(const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
+VE_FORCE_INLINE constexpr bool operator!=(
+    const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
 {
     return !(lhs == rhs);
 }
 
 template <template <class> class M, class U, class V, size_t N>
-constexpr bool operator<=(const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
+VE_FORCE_INLINE constexpr bool operator<=(
+    const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
 {
-    for (size_t i = 0; i < N; i++) {
-        if (!(lhs[i] <= rhs[i])) {
-            return false;
-        }
-    }
-    return true;
+    VE_COUNT(VectorOrder);
+    return internal::unrollAll<N>([&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+        return internal::get<I, N>(lhs) <= internal::get<I, N>(rhs);
+    });
 }
 
 template <template <class> class M, class U, class V, size_t N>
-constexpr bool operator>=(const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
+VE_FORCE_INLINE constexpr bool operator>=(
+    const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
 {
     return rhs <= lhs;
 }
 
 template <template <class> class M, class U, class V, size_t N>
-constexpr bool operator<(const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
+VE_FORCE_INLINE constexpr bool operator<(
+    const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
 {
     return lhs <= rhs && lhs != rhs;
 }
 
 template <template <class> class M, class U, class V, size_t N>
-constexpr bool operator>(const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
+VE_FORCE_INLINE constexpr bool operator>(
+    const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
 {
     return rhs < lhs;
 }
 
+template <template <class> class M, class U, class V, size_t N>
+VE_FORCE_INLINE constexpr auto dot(
+    const Vector<M, U, N>& lhs, const Vector<M, V, N>& rhs)
+{
+    VE_COUNT(Dot);
+    using R = decltype(std::declval<U>() * std::declval<V>());
+    return internal::unrollSum<N>(R{0}, [&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+        return internal::get<I, N>(lhs) * internal::get<I, N>(rhs);
+    });
+}
+
 template <template <class> class M, class T, size_t N>
-constexpr auto length(const Vector<M, T, N>& vector) requires std::is_arithmetic_v<T>
+VE_FORCE_INLINE constexpr auto squaredLength(const Vector<M, T, N>& vector)
+    requires internal::Arithmetic<T>
 {
-    auto sqsum = T{0};
-    for (size_t i = 0; i < N; i++) {
-        sqsum += vector[i] * vector[i];
+    VE_COUNT(SquaredLength);
+    using Simd = internal::simd::Kernel<M, T, N>;
+    if constexpr (Simd::measures) {
+        if (!internal::constantEvaluated()) {
+            return Simd::squaredSum(internal::data<N>(vector));
+        }
     }
-    return std::sqrt(sqsum);
+    using R = internal::PromotedType<T>;
+    return internal::unrollSum<N>(R{0}, [&] <size_t I> () VE_FORCE_INLINE_LAMBDA {
+        return internal::get<I, N>(vector) * internal::get<I, N>(vector);
+    });
+}
+
+template <template <class> class M, class T, size_t N>
+VE_FORCE_INLINE constexpr auto length(const Vector<M, T, N>& vector)
+    requires internal::Arithmetic<T>
+{
+    VE_COUNT(Length);
+    VE_COUNT(Sqrt);
+    return std::sqrt(squaredLength(vector));
 }
 
 template <template <class> class M, class T, size_t N>
-constexpr Vector<M, T, N> unit(const Vector<M, T, N>& vector)
-    requires std::is_arithmetic_v<T>
+VE_FORCE_INLINE constexpr Vector<M, T, N> unit(const Vector<M, T, N>& vector)
+    requires internal::Arithmetic<T>
 {
-    if (length(vector) > 0) {
-        return vector / length(vector);
+    VE_COUNT(Unit);
+    auto norm = length(vector);
+    if (norm > 0) {
+        return vector / norm;
     } else {
         return vector;
     }
@@ -222,7 +323,7 @@ struct less<ve::Vector<M, T, N>> {
         const ve::Vector<M, T, N>& lhs, const ve::Vector<M, T, N>& rhs) const
     {
         size_t i = 0;
-        while (lhs[i] == rhs[i] && i < N) {
+        while (i < N && lhs[i] == rhs[i]) {
             i++;
         }
         return i < N && lhs[i] < rhs[i];
@@ -256,5 +357,13 @@ struct greater_equal<ve::Vector<M, T, N>> {
     }
 };
 
+template <template <class> class M, class T, size_t N>
+struct hash<ve::Vector<M, T, N>> {
+    size_t operator()(const ve::Vector<M, T, N>& vector) const
+    {
+        return ve::internal::hashComponents<N>(vector);
+    }
+};
+
 } // namespace std
 
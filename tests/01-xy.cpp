@@ -4,6 +4,7 @@
 
 #include <cmath>
 #include <set>
+#include <unordered_set>
 #include <sstream>
 #include <type_traits>
 #include <utility>
@@ -44,6 +45,13 @@ template <class T> struct XYModel {
 template <class T> using XYVector = ve::Vector<XYModel, T, 2>;
 template <class T> using XYPoint = ve::Point<XYModel, T, 2>;
 
+// Components stored in an array rather than as named members.
+template <class T> struct ArrayModel {
+    T v[3];
+};
+template <class T> using ArrayVector = ve::Vector<ArrayModel, T>;
+template <class T> using ArrayPoint = ve::Point<ArrayModel, T>;
+
 TEST_CASE("Initialization, explicit arguments")
 {
     auto v = XYVector<int>{1, 2};
@@ -233,10 +241,88 @@ TEST_CASE("Point Comparison")
     CHECK(s12 != s02);
 }
 
+TEST_CASE("Constant evaluation")
+{
+    constexpr auto v = XYVector<int>{1, 2};
+    constexpr auto w = XYVector<double>{0.5, -1.5};
+    constexpr auto p = XYPoint<int>{3, 4};
+
+    static_assert(v[0] == 1 && v[1] == 2);
+    static_assert(-v == XYVector<int>{-1, -2});
+    static_assert(v + w == XYVector<double>{1.5, 0.5});
+    static_assert(v * 3 - v / 1 == XYVector<int>{2, 4});
+    static_assert(2.0 * w == XYVector<double>{1.0, -3.0});
+    static_assert(v != XYVector<int>{});
+    static_assert(v <= XYVector<int>{1, 3} && v < XYVector<int>{2, 3});
+    static_assert(dot(v, w) == -2.5);
+    static_assert(squaredLength(v) == 5);
+    static_assert(p + v == XYPoint<int>{4, 6});
+    static_assert(p - v == XYPoint<int>{2, 2});
+    static_assert(p - XYPoint<int>{1, 1} == XYVector<int>{2, 3});
+    static_assert(squaredDistance(p, XYPoint<int>{}) == 25);
+    static_assert(XYVector<double>{v} == XYVector<double>{1.0, 2.0});
+    static_assert(std::less<XYVector<int>>{}(v, XYVector<int>{1, 3}));
+
+    constexpr auto accumulated = [] {
+        auto result = XYVector<int>{};
+        for (int i = 0; i < 4; i++) {
+            result += XYVector<int>{i, 1};
+            result[1] *= 2;
+        }
+        result -= XYVector<int>{1, 0};
+        return result;
+    }();
+    static_assert(accumulated == XYVector<int>{5, 30});
+}
+
+TEST_CASE("Models with an array member")
+{
+    static_assert(std::is_same_v<ArrayVector<float>, ve::Vector<ArrayModel, float, 3>>);
+    static_assert(!ve::internal::hasBoundComponents<ArrayModel<float>, float, 3>());
+
+    auto v = ArrayVector<float>{1, 2, 3};
+    auto w = ArrayVector<float>{0.5f, -1, 2};
+    auto p = ArrayPoint<int>{3, 4, 5};
+    CHECK(v[0] == 1);
+    CHECK(v.v[2] == 3);
+    CHECK(-v == ArrayVector<float>{-1, -2, -3});
+    CHECK(v + w == ArrayVector<float>{1.5f, 1, 5});
+    CHECK(v * 2 - w / 0.5f == ArrayVector<float>{1, 6, 2});
+    CHECK(dot(v, w) == 4.5f);
+    CHECK(squaredLength(v) == 14);
+    CHECK(v != w);
+    CHECK(w <= v);
+    CHECK(p + ArrayVector<int>{1, 1, 1} == ArrayPoint<int>{4, 5, 6});
+    CHECK(p - ArrayPoint<int>{3, 3, 3} == ArrayVector<int>{0, 1, 2});
+    CHECK(ArrayVector<double>{v} == ArrayVector<double>{1, 2, 3});
+
+    v += w;
+    v[1] *= 2;
+    CHECK(v == ArrayVector<float>{1.5f, 2, 5});
+}
+
 TEST_CASE("Can put into set")
 {
     std::set<XYVector<int>> vs;
     std::set<XYPoint<int>> ps;
+
+    vs = {{1, 2}, {1, 2}, {0, 3}};
+    CHECK(vs.size() == 2);
+    CHECK(*vs.begin() == XYVector<int>{0, 3});
+    CHECK(!std::less<XYVector<int>>{}({1, 2}, {1, 2}));
+}
+
+TEST_CASE("Can put into unordered_set")
+{
+    std::unordered_set<XYVector<int>> vs = {{1, 2}, {2, 1}, {1, 2}};
+    CHECK(vs.size() == 2);
+    CHECK(vs.contains({2, 1}));
+
+    std::unordered_set<XYPoint<double>> ps = {{0.0, 1.5}, {-0.0, 1.5}};
+    CHECK(ps.size() == 1);
+    CHECK(std::hash<XYPoint<double>>{}({0.0, -0.0}) ==
+        std::hash<XYPoint<double>>{}({-0.0, 0.0}));
+    CHECK(std::hash<XYVector<int>>{}({1, 2}) != std::hash<XYVector<int>>{}({2, 1}));
 }
 
 TEST_CASE("Utility Functions")
@@ -247,10 +333,11 @@ TEST_CASE("Utility Functions")
     }
 
     SECTION("unit") {
-        auto v = XYVector<int>{1, 1};
-        auto r = XYVector<decltype(std::sqrt(std::declval<int>()))>{
-            1 / std::sqrt(2), 1 / std::sqrt(2)};
+        auto v = XYVector<double>{1, 1};
+        auto r = XYVector<double>{1 / std::sqrt(2), 1 / std::sqrt(2)};
         CHECK(unit(v) == r);
+        // Integer vectors keep their type, so the result truncates.
+        CHECK(unit(XYVector<int>{1, 1}) == XYVector<int>{0, 0});
     }
 
     SECTION("distance") {
@@ -0,0 +1,100 @@
+#include <ve.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+#include <type_traits>
+
+template <class T> struct XYModel {
+    T x;
+    T y;
+};
+template <class T> using XYVector = ve::Vector<XYModel, T, 2>;
+template <class T> using XYPoint = ve::Point<XYModel, T, 2>;
+template <class T> using XYVectorArray = ve::VectorArray<XYModel, T, 2>;
+template <class T> using XYPointArray = ve::PointArray<XYModel, T, 2>;
+
+TEST_CASE("SoA construction and access")
+{
+    auto points = XYPointArray<int>{{1, 2}, {3, 4}, {5, 6}};
+    REQUIRE(points.size() == 3);
+    CHECK(points.data(0)[1] == 3);
+    CHECK(points.data(1)[1] == 4);
+
+    CHECK(points[0] == XYPoint<int>{1, 2});
+    CHECK(points[2][1] == 6);
+
+    points[1] = XYPoint<short>{7, 8};
+    CHECK(points[1] == XYPoint<int>{7, 8});
+
+    XYPoint<int> p = points[1];
+    CHECK(p.x == 7);
+    CHECK(p.y == 8);
+
+    points[2][0] = 9;
+    CHECK(points[2] == XYPoint<int>{9, 6});
+
+    points.push_back(XYPoint<int>{10, 11});
+    CHECK(points.size() == 4);
+    CHECK(points[3] == XYPoint<int>{10, 11});
+
+    const auto& constPoints = points;
+    CHECK(constPoints[3] == XYPoint<int>{10, 11});
+
+    std::ostringstream stream;
+    stream << points[0] << " " << XYVectorArray<int>(1, {1, 2})[0];
+    CHECK(stream.str() == "(1, 2) [1, 2]");
+}
+
+TEST_CASE("SoA element proxies")
+{
+    auto points = XYPointArray<int>(2, {1, 1});
+    points[0] += XYVector<int>{1, 2};
+    CHECK(points[0] == XYPoint<int>{2, 3});
+    CHECK(points[1] == XYPoint<int>{1, 1});
+
+    auto vectors = XYVectorArray<int>(2, {1, 2});
+    vectors[1] *= 3;
+    CHECK(vectors[1] == XYVector<int>{3, 6});
+
+    points[1] = points[0];
+    CHECK(points[1] == XYPoint<int>{2, 3});
+}
+
+TEST_CASE("SoA whole-array arithmetics")
+{
+    auto points = XYPointArray<float>{{1, 2}, {3, 4}};
+    auto vectors = XYVectorArray<int>{{1, 1}, {2, 2}};
+
+    points += XYVector<int>{1, 1};
+    CHECK(points[0] == XYPoint<float>{2, 3});
+    CHECK(points[1] == XYPoint<float>{4, 5});
+
+    points -= vectors;
+    CHECK(points[0] == XYPoint<float>{1, 2});
+    CHECK(points[1] == XYPoint<float>{2, 3});
+
+    vectors *= 2;
+    CHECK(vectors[1] == XYVector<int>{4, 4});
+
+    auto moved = points + vectors;
+    static_assert(std::is_same<decltype(moved), XYPointArray<float>>());
+    CHECK(moved[0] == XYPoint<float>{3, 4});
+    CHECK(moved[1] == XYPoint<float>{6, 7});
+
+    auto diff = moved - points;
+    static_assert(std::is_same<decltype(diff), XYVectorArray<float>>());
+    CHECK(diff[1] == XYVector<float>{4, 4});
+
+    auto scaled = 0.5 * vectors;
+    static_assert(std::is_same<decltype(scaled), XYVectorArray<double>>());
+    CHECK(scaled[0] == XYVector<double>{1, 1});
+
+    auto sum = vectors + XYVectorArray<long long>{{1, 1}, {1, 1}};
+    static_assert(std::is_same<decltype(sum), XYVectorArray<long long>>());
+    CHECK(sum[1] == XYVector<long long>{5, 5});
+
+    auto shifted = points - XYVector<double>{1, 1};
+    static_assert(std::is_same<decltype(shifted), XYPointArray<double>>());
+    CHECK(shifted[0] == XYPoint<double>{0, 1});
+}
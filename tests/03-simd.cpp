@@ -0,0 +1,119 @@
+#include <ve.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <type_traits>
+
+#define HAS_TYPE(EXPRESSION, TYPE) \
+    static_assert(std::is_same<decltype(EXPRESSION), TYPE>());
+
+template <class T> struct alignas(4 * sizeof(T)) PaddedXYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Vector3 = ve::Vector<PaddedXYZModel, T>;
+template <class T> using Point3 = ve::Point<PaddedXYZModel, T>;
+
+template <class T> struct XYZWModel {
+    T x;
+    T y;
+    T z;
+    T w;
+};
+template <class T> using Vector4 = ve::Vector<XYZWModel, T>;
+
+template <class T> struct XYModel {
+    T x;
+    T y;
+};
+template <class T> using Vector2 = ve::Vector<XYModel, T>;
+
+static_assert(sizeof(Vector3<float>) == 16);
+static_assert(sizeof(Vector3<double>) == 32);
+static_assert(std::is_same<Vector3<float>, ve::Vector<PaddedXYZModel, float, 3>>());
+static_assert(std::is_same<Vector4<int>, ve::Vector<XYZWModel, int, 4>>());
+
+TEST_CASE("Padded model arithmetics")
+{
+    auto check = [] <class T> (T) {
+        auto a = Vector3<T>{1, 2, 3};
+        auto b = Vector3<T>{4, 6, 8};
+        auto p = Point3<T>{1, 1, 1};
+
+        HAS_TYPE(a + b, Vector3<T>);
+        HAS_TYPE(p + a, Point3<T>);
+        HAS_TYPE(p - p, Vector3<T>);
+        HAS_TYPE(a * T{2}, Vector3<T>);
+
+        CHECK(a + b == Vector3<T>{5, 8, 11});
+        CHECK(b - a == Vector3<T>{3, 4, 5});
+        CHECK(-a == Vector3<T>{-1, -2, -3});
+        CHECK(a * T{2} == Vector3<T>{2, 4, 6});
+        CHECK(T{2} * a == Vector3<T>{2, 4, 6});
+        CHECK(p + a == Point3<T>{2, 3, 4});
+        CHECK(p - a == Point3<T>{0, -1, -2});
+        CHECK(Point3<T>{4, 6, 8} - p == Vector3<T>{3, 5, 7});
+        CHECK(a != b);
+        CHECK(a != Vector3<T>{1, 2, 4});
+        CHECK(p != Point3<T>{1, 1, 2});
+        CHECK(p == Point3<long long>{1, 1, 1});
+
+        a += b;
+        CHECK(a == Vector3<T>{5, 8, 11});
+        a -= b;
+        CHECK(a == Vector3<T>{1, 2, 3});
+        a *= T{3};
+        CHECK(a == Vector3<T>{3, 6, 9});
+    };
+
+    check(1.f);
+    check(1.0);
+    check(1);
+}
+
+TEST_CASE("Padded model division and length")
+{
+    auto v = Vector3<float>{2, 4, 4};
+    CHECK(v / 2.f == Vector3<float>{1, 2, 2});
+    CHECK(length(v) == 6.f);
+    CHECK(length(Vector3<double>{2, 3, 6}) == 7.0);
+    CHECK(unit(Vector3<double>{0, 0, 5}) == Vector3<double>{0, 0, 1});
+}
+
+TEST_CASE("Packed register-sized models")
+{
+    auto v4 = Vector4<float>{1, 2, 2, 4};
+    CHECK(length(v4) == 5.f);
+    CHECK(v4 + v4 == Vector4<float>{2, 4, 4, 8});
+    CHECK(-Vector4<int>{1, 2, 3, 4} == Vector4<int>{-1, -2, -3, -4});
+
+    auto v2 = Vector2<float>{3, 4};
+    CHECK(length(v2) == 5.f);
+    CHECK(v2 - v2 == Vector2<float>{0, 0});
+    CHECK(Vector2<int>{1, 2} + Vector2<int>{3, 4} == Vector2<int>{4, 6});
+    CHECK(length(Vector2<double>{6, 8}) == 10.0);
+}
+
+TEST_CASE("Padded model comparisons follow scalar semantics")
+{
+    auto nan = std::nanf("");
+    CHECK(Vector3<float>{nan, 0, 0} != Vector3<float>{nan, 0, 0});
+    CHECK(Vector3<float>{-0.f, 0, 0} == Vector3<float>{0.f, 0, 0});
+}
+
+TEST_CASE("Register-sized models in constant evaluation")
+{
+    constexpr auto v = Vector3<float>{1.f, 2.f, 3.f};
+    constexpr auto p = Point3<float>{0.5f, 0.5f, 0.5f};
+    static_assert(-v == Vector3<float>{-1.f, -2.f, -3.f});
+    static_assert(v + v - v * 2.f == Vector3<float>{});
+    static_assert(v / 2.f == Vector3<float>{0.5f, 1.f, 1.5f});
+    static_assert(squaredLength(v) == 14.f);
+    static_assert(p + v - p == v);
+    static_assert(squaredDistance(p, p) == 0.f);
+    static_assert(Vector4<double>{1.0, 2.0, 3.0, 4.0} * 2.0 ==
+        Vector4<double>{2.0, 4.0, 6.0, 8.0});
+    static_assert(-Vector2<int>{1, -2} == Vector2<int>{-1, 2});
+}
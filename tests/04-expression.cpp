@@ -0,0 +1,88 @@
+#include <ve.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <type_traits>
+
+#define HAS_TYPE(EXPRESSION, TYPE) \
+    static_assert(std::is_same<decltype(EXPRESSION), TYPE>());
+
+template <class T> struct XYModel {
+    T x;
+    T y;
+};
+template <class T> using XYVector = ve::Vector<XYModel, T, 2>;
+template <class T> using XYPoint = ve::Point<XYModel, T, 2>;
+
+TEST_CASE("Expression result types match eager operators")
+{
+    auto v = XYVector<short>{1, 1};
+    auto p1 = XYPoint<int>{3, 4};
+    auto p2 = XYPoint<double>{4.0, 5.0};
+
+    HAS_TYPE(ve::eval(ve::lazy(p1) + v), decltype(p1 + v));
+    HAS_TYPE(ve::eval(p2 - ve::lazy(v)), decltype(p2 - v));
+    HAS_TYPE(ve::eval(ve::lazy(p2) - p1), decltype(p2 - p1));
+    HAS_TYPE(ve::eval(2 * ve::lazy(v)), decltype(2 * v));
+    HAS_TYPE(ve::eval(ve::lazy(v) * 1ll), decltype(v * 1ll));
+    HAS_TYPE(ve::eval(ve::lazy(v) / 2.f), decltype(v / 2.f));
+    HAS_TYPE(ve::eval(-ve::lazy(v)), decltype(-v));
+    HAS_TYPE(ve::eval(ve::lazy(v) + ve::lazy(v)), decltype(v + v));
+
+    CHECK(ve::eval(ve::lazy(p1) + v) == p1 + v);
+    CHECK(ve::eval(p2 - ve::lazy(v)) == p2 - v);
+    CHECK(ve::eval(ve::lazy(p2) - p1) == p2 - p1);
+    CHECK(ve::eval(2 * ve::lazy(v)) == 2 * v);
+    CHECK(ve::eval(-ve::lazy(v)) == -v);
+}
+
+TEST_CASE("Chained expressions")
+{
+    auto p = XYPoint<float>{1, 2};
+    auto v1 = XYVector<float>{1, 0};
+    auto v2 = XYVector<float>{0, 1};
+    float a = 2;
+    float b = 3;
+
+    XYPoint<float> r = ve::lazy(p) + a * ve::lazy(v1) - b * ve::lazy(v2);
+    CHECK(r == p + a * v1 - b * v2);
+    CHECK(r == XYPoint<float>{3, -1});
+
+    XYPoint<double> d = p + ve::lazy(v1) / 2.f;
+    CHECK(d == XYPoint<double>{1.5, 2});
+
+    r = ve::lazy(p) - (ve::lazy(v1) + v2) * 2.f;
+    CHECK(r == XYPoint<float>{-1, 0});
+
+    XYVector<float> w = ve::lazy(r) - p;
+    CHECK(w == XYVector<float>{-2, -2});
+}
+
+TEST_CASE("Compound assignment from expressions")
+{
+    auto p = XYPoint<double>{0, 0};
+    auto v = XYVector<double>{1, 2};
+    auto a = XYVector<double>{1, 1};
+    double dt = 0.5;
+
+    v += ve::lazy(a) * dt;
+    CHECK(v == XYVector<double>{1.5, 2.5});
+    p += ve::lazy(v) * dt;
+    CHECK(p == XYPoint<double>{0.75, 1.25});
+    p -= ve::lazy(v) * 2.0;
+    CHECK(p == XYPoint<double>{-2.25, -3.75});
+    v -= -ve::lazy(a);
+    CHECK(v == XYVector<double>{2.5, 3.5});
+}
+
+TEST_CASE("Expressions can be stored and evaluated later")
+{
+    auto p = XYPoint<int>{1, 2};
+    auto v = XYVector<int>{3, 4};
+    auto moved = ve::lazy(p) + 2 * ve::lazy(v);
+
+    CHECK(ve::eval(moved) == XYPoint<int>{7, 10});
+    v = XYVector<int>{0, 1};
+    CHECK(ve::eval(moved) == XYPoint<int>{1, 4});
+    CHECK(moved[1] == 4);
+}
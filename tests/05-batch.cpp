@@ -0,0 +1,104 @@
+#include <ve.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <cmath>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Vector3 = ve::Vector<XYZModel, T>;
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+
+namespace {
+
+std::vector<Vector3<float>> makeVectors(size_t count)
+{
+    std::vector<Vector3<float>> vectors;
+    for (size_t i = 0; i < count; i++) {
+        auto f = static_cast<float>(i);
+        vectors.push_back({f * 0.5f - 100.f, std::sin(f) * 10.f, 1.f / (f + 1.f)});
+    }
+    vectors.push_back({0, 0, 0});
+    return vectors;
+}
+
+} // namespace
+
+TEST_CASE("Single vector helpers")
+{
+    CHECK(ve::dot(Vector3<int>{1, 2, 3}, Vector3<double>{4, 5, 6}) == 32.0);
+    CHECK(ve::squaredLength(Vector3<int>{1, 2, 2}) == 9);
+    CHECK(ve::squaredDistance(Point3<int>{1, 1, 1}, Point3<int>{2, 3, 3}) == 9);
+    static_assert(std::is_same_v<decltype(ve::unit(Vector3<int>{})), Vector3<int>>);
+    CHECK(ve::unit(Vector3<int>{0, 0, 0}) == Vector3<int>{0, 0, 0});
+    CHECK(ve::unit(Vector3<int>{0, 0, 5}) == Vector3<int>{0, 0, 1});
+    CHECK(ve::unit(Vector3<float>{0, 3, 4}) == Vector3<float>{0, 0.6f, 0.8f});
+}
+
+TEST_CASE("Batch lengths and squared lengths")
+{
+    auto vectors = makeVectors(1001);
+    std::vector<float> squares(vectors.size());
+    std::vector<float> exact(vectors.size());
+    std::vector<float> fast(vectors.size());
+
+    ve::squaredLengths(vectors, squares);
+    ve::lengths(vectors, exact);
+    ve::lengths(std::span{vectors}, std::span{fast}, ve::Precision::Fast);
+
+    for (size_t i = 0; i < vectors.size(); i++) {
+        CHECK(squares[i] == ve::squaredLength(vectors[i]));
+        CHECK(exact[i] == ve::length(vectors[i]));
+        CHECK(std::abs(fast[i] - exact[i]) <= std::ldexp(exact[i], -21));
+    }
+    CHECK(fast.back() == 0.f);
+}
+
+TEST_CASE("Batch normalize")
+{
+    auto vectors = makeVectors(517);
+    std::vector<Vector3<float>> exact(vectors.size());
+    std::vector<Vector3<float>> fast(vectors.size());
+    std::vector<Vector3<double>> promoted(vectors.size());
+
+    ve::normalize(vectors, exact);
+    ve::normalize(vectors, fast, ve::Precision::Fast);
+    ve::normalize(vectors, promoted);
+
+    for (size_t i = 0; i < vectors.size(); i++) {
+        auto expected = ve::unit(vectors[i]);
+        for (size_t c = 0; c < 3; c++) {
+            CHECK(std::abs(exact[i][c] - expected[c]) <= 1e-6f);
+            CHECK(std::abs(fast[i][c] - expected[c]) <= 1e-6f);
+            CHECK(std::abs(promoted[i][c] - expected[c]) <= 1e-6);
+        }
+    }
+    CHECK(exact.back() == Vector3<float>{0, 0, 0});
+    CHECK(fast.back() == Vector3<float>{0, 0, 0});
+
+    ve::normalize(vectors, vectors);
+    CHECK(vectors == exact);
+}
+
+TEST_CASE("Batch dot products and distances")
+{
+    auto a = std::array{Point3<int>{0, 0, 0}, Point3<int>{1, 2, 3}};
+    auto b = std::array{Point3<double>{3, 4, 0}, Point3<double>{1, 2, 3}};
+    auto u = std::array{Vector3<int>{1, 2, 3}, Vector3<int>{0, 1, 0}};
+    auto v = std::array{Vector3<float>{1, 1, 1}, Vector3<float>{5, 7, 9}};
+
+    std::array<double, 2> out;
+    ve::squaredDistances(a, b, out);
+    CHECK(out == std::array{25.0, 0.0});
+    ve::distances(a, b, out);
+    CHECK(out == std::array{5.0, 0.0});
+    ve::dots(u, v, out);
+    CHECK(out == std::array{6.0, 7.0});
+}
@@ -0,0 +1,140 @@
+#include <ve.hpp>
+#include <ve/kd_tree.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "random_points.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+template <class T> using Box3 = ve::AABB<XYZModel, T>;
+
+namespace {
+
+std::vector<size_t> sorted(std::vector<size_t> values)
+{
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+} // namespace
+
+TEST_CASE("AABB")
+{
+    auto box = Box3<int>{Point3<int>{3, 0, 5}, Point3<int>{1, 2, 4}};
+    CHECK(box.min == Point3<int>{1, 0, 4});
+    CHECK(box.max == Point3<int>{3, 2, 5});
+    CHECK(box.contains(Point3<int>{1, 2, 5}));
+    CHECK_FALSE(box.contains(Point3<int>{0, 1, 4}));
+
+    auto grown = Box3<int>{};
+    CHECK(grown.empty());
+    grown.extend(Point3<int>{1, 0, 4}).extend(Point3<int>{3, 2, 5});
+    CHECK_FALSE(grown.empty());
+    CHECK(grown == box);
+}
+
+TEST_CASE("k-d tree matches brute force")
+{
+    auto points = test::randomPoints<Point3<float>>(5000, 100.f, 1);
+    auto queries = test::randomPoints<Point3<float>>(50, 100.f, 2);
+    auto tree = ve::KdTree<XYZModel, float>{points, 8};
+    REQUIRE(tree.size() == points.size());
+
+    for (const auto& query : queries) {
+        std::vector<float> distances;
+        for (const auto& point : points) {
+            distances.push_back(ve::squaredDistance(point, query));
+        }
+
+        auto neighbors = tree.nearest(query, 10);
+        REQUIRE(neighbors.size() == 10);
+        auto expected = distances;
+        std::sort(expected.begin(), expected.end());
+        for (size_t i = 0; i < neighbors.size(); i++) {
+            CHECK(neighbors[i].squaredDistance == expected[i]);
+            CHECK(distances[neighbors[i].index] == expected[i]);
+        }
+
+        std::vector<size_t> inRadius;
+        for (size_t i = 0; i < points.size(); i++) {
+            if (distances[i] <= 30.f * 30.f) {
+                inRadius.push_back(i);
+            }
+        }
+        CHECK(sorted(tree.withinRadius(query, 30.f)) == inRadius);
+
+        auto box = Box3<float>{
+            query - ve::Vector<XYZModel, float>{10, 20, 30},
+            query + ve::Vector<XYZModel, float>{30, 20, 10}};
+        std::vector<size_t> inBox;
+        for (size_t i = 0; i < points.size(); i++) {
+            if (box.contains(points[i])) {
+                inBox.push_back(i);
+            }
+        }
+        CHECK(sorted(tree.withinBox(box)) == inBox);
+    }
+}
+
+TEST_CASE("k-d tree batch queries")
+{
+    auto points = test::randomPoints<Point3<float>>(2000, 100.f, 3);
+    auto queries = test::randomPoints<Point3<float>>(300, 100.f, 4);
+    auto tree = ve::KdTree<XYZModel, float>{points};
+    auto pool = ve::ThreadPool{4};
+
+    std::vector<ve::KdTree<XYZModel, float>::Neighbor> neighbors(queries.size() * 3);
+    tree.nearest(queries, 3, neighbors, pool);
+    auto radius = tree.withinRadius(queries, 15.f, pool);
+    REQUIRE(radius.size() == queries.size());
+
+    for (size_t i = 0; i < queries.size(); i++) {
+        auto single = tree.nearest(queries[i], 3);
+        for (size_t j = 0; j < 3; j++) {
+            CHECK(neighbors[i * 3 + j].index == single[j].index);
+        }
+        CHECK(radius[i] == tree.withinRadius(queries[i], 15.f));
+    }
+}
+
+TEST_CASE("k-d tree edge cases")
+{
+    auto empty = ve::KdTree<XYZModel, int>{std::vector<Point3<int>>{}};
+    CHECK(empty.nearest(Point3<int>{0, 0, 0}, 3).empty());
+    CHECK(empty.withinRadius(Point3<int>{0, 0, 0}, 10).empty());
+
+    auto duplicates = std::vector<Point3<int>>(100, Point3<int>{1, 1, 1});
+    auto tree = ve::KdTree<XYZModel, int>{duplicates, 4};
+    CHECK(tree.withinRadius(Point3<int>{1, 1, 1}, 0).size() == 100);
+    CHECK(tree.withinBox(Box3<int>{Point3<int>{1, 1, 1}, Point3<int>{1, 1, 1}}).size() == 100);
+
+    auto few = tree.nearest(Point3<int>{0, 0, 0}, 200);
+    CHECK(few.size() == 100);
+    CHECK(few.front().squaredDistance == 3.0);
+}
+
+TEST_CASE("k-d tree negative and NaN radii find nothing")
+{
+    const auto points = std::vector<Point3<float>>{{0.f, 0.f, 0.f}, {0.5f, 0.f, 0.f}};
+    auto tree = ve::KdTree<XYZModel, float>{points};
+    REQUIRE(tree.withinRadius(Point3<float>{0.f, 0.f, 0.f}, 1.f).size() == 2);
+
+    auto pool = ve::ThreadPool{2};
+    const auto nan = std::numeric_limits<float>::quiet_NaN();
+    for (float radius : {-1.f, -0.1f, nan}) {
+        CHECK(tree.withinRadius(Point3<float>{0.f, 0.f, 0.f}, radius).empty());
+        auto batch = tree.withinRadius(points, radius, pool);
+        REQUIRE(batch.size() == points.size());
+        CHECK(batch[0].empty());
+        CHECK(batch[1].empty());
+    }
+}
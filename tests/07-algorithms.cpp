@@ -0,0 +1,138 @@
+#include <ve.hpp>
+#include <ve/algorithms.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "random_points.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Vector3 = ve::Vector<XYZModel, T>;
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+
+TEST_CASE("Reductions over integer vectors")
+{
+    std::vector<Vector3<int>> vectors;
+    for (int i = 0; i < 100001; i++) {
+        vectors.push_back({i % 7, -(i % 5), 1});
+    }
+
+    auto expected = Vector3<int>{};
+    for (const auto& v : vectors) {
+        expected += v;
+    }
+    auto pool = ve::ThreadPool{3};
+    CHECK(ve::sum(vectors, pool) == expected);
+    CHECK(ve::componentMin(vectors, pool) == Vector3<int>{0, -4, 1});
+    CHECK(ve::componentMax(vectors, pool) == Vector3<int>{6, 0, 1});
+
+    std::vector<Point3<int>> points = {{0, 0, 0}, {2, 4, 6}, {1, -2, 3}};
+    CHECK(ve::centroid(points) == Point3<double>{1, 2.0 / 3, 3});
+    auto box = ve::bounds(points);
+    CHECK(box.min == Point3<int>{0, -2, 0});
+    CHECK(box.max == Point3<int>{2, 4, 6});
+}
+
+TEST_CASE("Float reductions do not depend on the thread count")
+{
+    auto points = test::randomPoints<Point3<float>>(200000, 100.f, 7);
+    std::vector<Vector3<float>> vectors;
+    for (const auto& point : points) {
+        vectors.push_back(point - Point3<float>{});
+    }
+
+    auto serial = ve::ThreadPool{1};
+    auto parallel = ve::ThreadPool{5};
+
+    CHECK(ve::sum(vectors, serial) == ve::sum(vectors, parallel));
+    CHECK(ve::centroid(points, serial) == ve::centroid(points, parallel));
+    CHECK(ve::meanLength(vectors, serial) == ve::meanLength(vectors, parallel));
+    CHECK(ve::bounds(points, serial) == ve::bounds(points, parallel));
+
+    auto expected = Vector3<double>{};
+    double lengthSum = 0;
+    for (const auto& v : vectors) {
+        expected += Vector3<double>{v};
+        lengthSum += ve::length(Vector3<double>{v});
+    }
+    auto centroid = ve::centroid(points);
+    for (size_t c = 0; c < 3; c++) {
+        CHECK(std::abs(centroid[c] - expected[c] / points.size()) < 1e-3);
+    }
+    CHECK(std::abs(ve::meanLength(vectors) - lengthSum / vectors.size()) < 1e-3);
+}
+
+TEST_CASE("Reductions over empty ranges")
+{
+    std::vector<Point3<float>> points;
+    std::vector<Vector3<float>> vectors;
+    CHECK(ve::sum(vectors) == Vector3<float>{});
+    CHECK(ve::centroid(points) == Point3<float>{});
+    CHECK(ve::bounds(points).empty());
+    CHECK(ve::meanLength(vectors) == 0.f);
+}
+
+TEST_CASE("Summation modes bound the error of large float sums")
+{
+    // 2^22 values of 0.1 (and a large offset in z): the naive float sum
+    // drifts far from the exact result, the other modes stay close.
+    const size_t count = size_t{1} << 22;
+    std::vector<Vector3<float>> vectors(count, Vector3<float>{0.1f, 1.f, 0.1f});
+    vectors[0].z = 1e6f;
+
+    auto exact = Vector3<double>{};
+    for (const auto& v : vectors) {
+        exact += Vector3<double>{v};
+    }
+    auto relativeError = [&] (const Vector3<float>& value) {
+        double error = 0;
+        for (size_t c = 0; c < 3; c++) {
+            error = std::max(error, std::abs(value[c] - exact[c]) / exact[c]);
+        }
+        return error;
+    };
+
+    auto pool = ve::ThreadPool{4};
+    const double ulp = std::numeric_limits<float>::epsilon();
+    CHECK(relativeError(ve::sum(vectors, ve::Summation::Naive, pool)) > 100 * ulp);
+    CHECK(relativeError(ve::sum(vectors, ve::Summation::Pairwise, pool)) < 8 * ulp);
+    CHECK(relativeError(ve::sum(vectors, ve::Summation::Kahan, pool)) < ulp);
+    CHECK(relativeError(ve::sum(vectors, ve::Summation::Double, pool)) < ulp);
+    CHECK(ve::sum(vectors, ve::Summation::Naive, pool) == ve::sum(vectors, pool));
+
+    auto serial = ve::ThreadPool{1};
+    for (auto summation : {ve::Summation::Naive, ve::Summation::Pairwise,
+            ve::Summation::Kahan, ve::Summation::Double}) {
+        CHECK(ve::sum(vectors, summation, serial) == ve::sum(vectors, summation, pool));
+    }
+}
+
+TEST_CASE("Means of vectors and points")
+{
+    std::vector<Vector3<float>> vectors = {{1, 2, 3}, {3, 2, 1}};
+    CHECK(ve::mean(vectors) == Vector3<float>{2, 2, 2});
+    CHECK(ve::mean(std::vector<Vector3<float>>{}) == Vector3<float>{});
+
+    auto points = test::randomPoints<Point3<float>>(100000, 100.f, 11);
+    auto exact = ve::centroid(std::vector<Point3<double>>(points.begin(), points.end()));
+    for (auto summation : {ve::Summation::Naive, ve::Summation::Pairwise,
+            ve::Summation::Kahan, ve::Summation::Double}) {
+        auto mean = ve::mean(points, summation);
+        CHECK(mean == ve::centroid(points, summation));
+        for (size_t c = 0; c < 3; c++) {
+            CHECK(std::abs(mean[c] - exact[c]) < 1e-3);
+        }
+    }
+    auto kahan = ve::mean(points, ve::Summation::Kahan);
+    for (size_t c = 0; c < 3; c++) {
+        CHECK(std::abs(kahan[c] - exact[c]) <= 1e-6);
+    }
+}
@@ -0,0 +1,99 @@
+#include <ve.hpp>
+#include <ve/point_file.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+
+namespace {
+
+struct TemporaryFile {
+    TemporaryFile(const char* name)
+        : path(std::filesystem::temp_directory_path() / name)
+    { }
+
+    ~TemporaryFile()
+    {
+        std::filesystem::remove(path);
+    }
+
+    std::filesystem::path path;
+};
+
+} // namespace
+
+TEST_CASE("Point files round-trip without copying")
+{
+    auto file = TemporaryFile{"ve-test-points.vepc"};
+
+    std::vector<Point3<float>> points;
+    for (int i = 0; i < 1000; i++) {
+        points.push_back({i * 1.f, i * 2.f, -i * 0.5f});
+    }
+    {
+        auto writer = ve::PointFileWriter<XYZModel, float>{file.path, "xyz"};
+        writer.write(points[0]);
+        writer.write(std::span{points}.subspan(1));
+        CHECK(writer.size() == points.size());
+    }
+
+    auto mapped = ve::MappedPointFile<XYZModel, float>{file.path, "xyz"};
+    CHECK(mapped.model() == "xyz");
+    CHECK(mapped.header().count == points.size());
+    REQUIRE(mapped.size() == points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        CHECK(mapped[i] == points[i]);
+    }
+
+    auto moved = std::move(mapped);
+    CHECK(mapped.empty());
+    CHECK(moved.points().back() == points.back());
+}
+
+TEST_CASE("Point files are validated against the point type")
+{
+    auto file = TemporaryFile{"ve-test-validate.vepc"};
+    {
+        auto writer = ve::PointFileWriter<XYZModel, int>{file.path, "xyz"};
+        writer.write(Point3<int>{1, 2, 3});
+    }
+
+    CHECK(ve::MappedPointFile<XYZModel, int>{file.path}.size() == 1);
+    CHECK_THROWS_AS(
+        (ve::MappedPointFile<XYZModel, float>{file.path}), ve::PointFileError);
+    CHECK_THROWS_AS(
+        (ve::MappedPointFile<XYZModel, unsigned>{file.path}), ve::PointFileError);
+    CHECK_THROWS_AS(
+        (ve::MappedPointFile<XYZModel, int>{file.path, "rgb"}), ve::PointFileError);
+
+    std::filesystem::resize_file(file.path, sizeof(ve::PointFileHeader) + 4);
+    CHECK_THROWS_AS(
+        (ve::MappedPointFile<XYZModel, int>{file.path}), ve::PointFileError);
+
+    {
+        auto output = std::ofstream{file.path, std::ios::binary};
+        output << "not a point file at all";
+    }
+    CHECK_THROWS_AS(
+        (ve::MappedPointFile<XYZModel, int>{file.path}), ve::PointFileError);
+    CHECK_THROWS_AS(
+        (ve::MappedPointFile<XYZModel, int>{file.path / "missing"}),
+        std::system_error);
+}
+
+TEST_CASE("Unfinished point files read back as empty")
+{
+    auto file = TemporaryFile{"ve-test-empty.vepc"};
+    { auto writer = ve::PointFileWriter<XYZModel, double>{file.path}; }
+    CHECK(ve::MappedPointFile<XYZModel, double>{file.path}.empty());
+}
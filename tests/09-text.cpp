@@ -0,0 +1,105 @@
+#include <ve.hpp>
+#include <ve/text.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+template <class T> struct XYModel {
+    T x;
+    T y;
+};
+template <class T> using Vector2 = ve::Vector<XYModel, T>;
+template <class T> using Point2 = ve::Point<XYModel, T>;
+
+namespace {
+
+template <class V>
+std::string text(const V& value)
+{
+    char buffer[ve::maxTextSize<V>];
+    auto result = ve::toChars(std::begin(buffer), std::end(buffer), value);
+    REQUIRE(result.ec == std::errc{});
+    return std::string(buffer, result.ptr);
+}
+
+template <class V>
+std::string streamed(const V& value)
+{
+    std::ostringstream stream;
+    stream << value;
+    return stream.str();
+}
+
+} // namespace
+
+TEST_CASE("toChars writes the same shape as operator<<")
+{
+    CHECK(text(Vector2<int>{-3, 14}) == "[-3, 14]");
+    CHECK(text(Point2<int>{0, 2147483647}) == "(0, 2147483647)");
+    CHECK(text(Vector2<float>{1.5f, -0.25f}) == streamed(Vector2<float>{1.5f, -0.25f}));
+    CHECK(text(Point2<double>{0.1, 2}) == "(0.1, 2)");
+
+    char small[4];
+    auto result = ve::toChars(std::begin(small), std::end(small), Vector2<int>{10, 20});
+    CHECK(result.ec == std::errc::value_too_large);
+
+    auto output = std::string{"points: "};
+    ve::appendText(output, Point2<int>{1, 2});
+    ve::appendText(output, Point2<int>{3, 4});
+    CHECK(output == "points: (1, 2)(3, 4)");
+}
+
+TEST_CASE("Written values read back exactly")
+{
+    auto original = std::vector<Point2<double>>{
+        {0.1, 1e-300}, {-123456.789, 3.0}, {1.0 / 3, -0.0}};
+    auto output = std::string{};
+    for (const auto& point : original) {
+        ve::appendText(output, point);
+        output += '\n';
+    }
+
+    std::vector<Point2<double>> parsed;
+    auto result = ve::fromChars(output, parsed);
+    CHECK(result.ec == std::errc{});
+    CHECK(result.ptr == output.data() + output.size());
+    CHECK(parsed == original);
+}
+
+TEST_CASE("Point lists are parsed from CSV and whitespace-separated text")
+{
+    auto text = std::string_view{
+        "# x,y\n"
+        "1,2\r\n"
+        "  3 4\t5;6\n"
+        "\n"
+        "[7, 8]"};
+    std::vector<Vector2<int>> vectors;
+    auto result = ve::fromChars(text, vectors);
+    CHECK(result.ec == std::errc{});
+    CHECK(vectors == std::vector<Vector2<int>>{{1, 2}, {3, 4}, {5, 6}, {7, 8}});
+
+    auto broken = std::string_view{"1 2\n3\n4 5\n"};
+    std::vector<Vector2<int>> partial;
+    result = ve::fromChars(broken, partial);
+    CHECK(result.ec == std::errc::invalid_argument);
+    CHECK(result.ptr == broken.data() + 4);
+    CHECK(partial == std::vector<Vector2<int>>{{1, 2}});
+
+    auto overflow = std::string_view{"1 99999999999"};
+    result = ve::fromChars(overflow, partial);
+    CHECK(result.ec == std::errc::result_out_of_range);
+}
+
+#ifdef __cpp_lib_format
+TEST_CASE("Vectors and points support std::format")
+{
+    CHECK(std::format("{}", Vector2<int>{1, 2}) == "[1, 2]");
+    CHECK(std::format("{:.2f}", Point2<double>{1, 0.5}) == "(1.00, 0.50)");
+    CHECK(std::format("{:>3}", Vector2<int>{1, 2}) == "[  1,   2]");
+}
+#endif
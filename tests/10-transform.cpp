@@ -0,0 +1,155 @@
+#include <ve.hpp>
+#include <ve/transform.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <vector>
+
+template <class T> struct XYModel {
+    T x;
+    T y;
+};
+template <class T> using Vector2 = ve::Vector<XYModel, T>;
+template <class T> using Point2 = ve::Point<XYModel, T>;
+template <class T> using Matrix2 = ve::Matrix<XYModel, T>;
+template <class T> using Transform2 = ve::Transform<XYModel, T>;
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+template <class T> using Transform3 = ve::Transform<XYZModel, T>;
+
+namespace {
+
+// Rotation by 90 degrees counterclockwise.
+constexpr auto rotate = Transform2<int>{Matrix2<int>{{{{0, -1}, {1, 0}}}}};
+constexpr auto shift = Transform2<int>::translate({10, 20});
+
+} // namespace
+
+TEST_CASE("Transforms compose at compile time")
+{
+    constexpr auto rotateThenShift = shift * rotate;
+    static_assert(rotateThenShift.linear == rotate.linear);
+    static_assert(rotateThenShift.translation == std::array{10, 20});
+
+    constexpr auto shiftThenRotate = rotate * shift;
+    static_assert(shiftThenRotate.translation == std::array{-20, 10});
+
+    static_assert(rotate * rotate * rotate * rotate == Transform2<int>{});
+    static_assert(Matrix2<int>::diagonal({2, 3}) * Matrix2<int>::scale(2) ==
+        Matrix2<int>::diagonal({4, 6}));
+    static_assert(rotate.linear.transposed() * rotate.linear == Matrix2<int>::identity());
+}
+
+TEST_CASE("Points are translated, vectors are not")
+{
+    auto t = shift * rotate;
+    CHECK(t(Point2<int>{1, 2}) == Point2<int>{8, 21});
+    CHECK(t(Vector2<int>{1, 2}) == Vector2<int>{-2, 1});
+    CHECK(t(Point2<int>{1, 2}) - t(Point2<int>{0, 0}) == t(Vector2<int>{1, 2}));
+    CHECK(Transform2<float>::scale(0.5f)(Point2<int>{3, 4}) == Point2<float>{1.5f, 2.f});
+    CHECK(Transform2<int>::translate(Vector2<int>{1, 1}) == Transform2<int>::translate({1, 1}));
+}
+
+TEST_CASE("Batch transforms match per-element transforms")
+{
+    auto t = Transform3<float>{
+        ve::Matrix<XYZModel, float>{{{{0.5f, 1, 0}, {0, 2, -1}, {1, 0, 1}}}},
+        {1, -2, 3}};
+
+    std::vector<Point3<float>> points;
+    for (int i = 0; i < 1000; i++) {
+        points.push_back({i * 0.5f, 100.f - i, (i % 17) * 1.f});
+    }
+
+    std::vector<Point3<float>> expected;
+    auto expectedBounds = ve::AABB<XYZModel, float>{};
+    for (const auto& point : points) {
+        expected.push_back(t(point));
+        expectedBounds.extend(expected.back());
+    }
+
+    std::vector<Point3<float>> out(points.size());
+    ve::transform(t, points, out);
+    CHECK(out == expected);
+
+    std::vector<Point3<float>> fused(points.size());
+    CHECK(ve::transformWithBounds(t, points, fused) == expectedBounds);
+    CHECK(fused == expected);
+    CHECK(ve::transformedBounds(t, points) == expectedBounds);
+
+    auto inPlace = points;
+    ve::transform(t, inPlace, inPlace);
+    CHECK(inPlace == expected);
+
+    auto soa = ve::PointArray<XYZModel, float>{};
+    for (const auto& point : points) {
+        soa.push_back(point);
+    }
+    auto soaOut = ve::PointArray<XYZModel, float>{};
+    CHECK(ve::transformWithBounds(t, soa, soaOut) == expectedBounds);
+    REQUIRE(soaOut.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        CHECK(soaOut[i] == expected[i]);
+    }
+
+    std::vector<ve::Vector<XYZModel, float>> vectors = {{1, 0, 0}, {0, 1, 1}};
+    std::vector<ve::Vector<XYZModel, double>> vectorsOut(2);
+    ve::transform(t, vectors, vectorsOut);
+    CHECK(vectorsOut[0] == ve::Vector<XYZModel, double>{0.5, 0, 1});
+    CHECK(vectorsOut[1] == ve::Vector<XYZModel, double>{1, 1, 1});
+}
+
+TEST_CASE("Batch transforms of integer points compute in the promoted type")
+{
+    const auto t = Transform2<float>::scale(1.5f);
+    CHECK(t(Point2<int>{10, 20}) == Point2<float>{15, 30});
+
+    std::vector<Point2<int>> points = {{10, 20}, {-3, 5}};
+    std::vector<Point2<float>> out(points.size());
+    ve::transform(t, points, out);
+    CHECK(out == std::vector<Point2<float>>{{15, 30}, {-4.5f, 7.5f}});
+
+    std::vector<Vector2<int>> vectors = {{10, 20}};
+    std::vector<Vector2<float>> vectorsOut(vectors.size());
+    ve::transform(t, vectors, vectorsOut);
+    CHECK(vectorsOut[0] == Vector2<float>{15, 30});
+
+    const auto expectedBounds = ve::AABB<XYModel, float>{{-4.5f, 7.5f}, {15, 30}};
+    CHECK(ve::transformWithBounds(t, points, out) == expectedBounds);
+    CHECK(out == std::vector<Point2<float>>{{15, 30}, {-4.5f, 7.5f}});
+    CHECK(ve::transformedBounds(t, points) == expectedBounds);
+
+    // Integer output is converted after the whole computation.
+    std::vector<Point2<int>> truncated(points.size());
+    ve::transform(t, points, truncated);
+    CHECK(truncated == std::vector<Point2<int>>{{15, 30}, {-4, 7}});
+
+    auto soa = ve::PointArray<XYModel, int>{};
+    for (const auto& point : points) {
+        soa.push_back(point);
+    }
+    auto soaOut = ve::PointArray<XYModel, float>{};
+    CHECK(ve::transformWithBounds(t, soa, soaOut) == expectedBounds);
+    REQUIRE(soaOut.size() == 2);
+    CHECK(soaOut[0] == Point2<float>{15, 30});
+    CHECK(soaOut[1] == Point2<float>{-4.5f, 7.5f});
+    ve::transform(t, soa, soaOut);
+    CHECK(soaOut[1] == Point2<float>{-4.5f, 7.5f});
+
+    auto soaVectors = ve::VectorArray<XYModel, int>{};
+    soaVectors.push_back(Vector2<int>{10, 20});
+    auto soaVectorsOut = ve::VectorArray<XYModel, float>{};
+    ve::transform(t, soaVectors, soaVectorsOut);
+    CHECK(soaVectorsOut[0] == Vector2<float>{15, 30});
+}
+
+TEST_CASE("Bounds of an empty transformed range are empty")
+{
+    std::vector<Point3<float>> points;
+    CHECK(ve::transformedBounds(Transform3<float>{}, points).empty());
+}
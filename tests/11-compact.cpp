@@ -0,0 +1,145 @@
+#include <ve.hpp>
+#include <ve/compact.hpp>
+#include <ve/text.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Vector3 = ve::Vector<XYZModel, T>;
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+
+using Millimeters = ve::Fixed<std::int16_t, 1000>;
+
+TEST_CASE("Half precision conversions round to nearest even")
+{
+    static_assert(ve::Half{1.0f}.bits() == 0x3c00);
+    static_assert(ve::Half{-2.0f}.bits() == 0xc000);
+    static_assert(ve::Half{65504.0f}.bits() == 0x7bff);
+    static_assert(ve::Half{65520.0f}.bits() == 0x7c00);
+    static_assert(ve::Half{5.9604645e-8f}.bits() == 0x0001);
+    static_assert(ve::Half{1.0f + 1.0f / 2048}.bits() == 0x3c00);
+    static_assert(ve::Half{1.0f + 3.0f / 2048}.bits() == 0x3c02);
+
+    for (std::uint32_t bits = 0; bits <= 0xffff; bits++) {
+        auto half = ve::Half::fromBits(static_cast<std::uint16_t>(bits));
+        float value = half;
+        if (std::isnan(value)) {
+            CHECK((bits & 0x7c00) == 0x7c00);
+            CHECK(std::isnan(static_cast<float>(ve::Half{value})));
+        } else if (ve::Half{value}.bits() != bits) {
+            FAIL("half " << bits << " does not round-trip through float");
+        }
+    }
+}
+
+TEST_CASE("bfloat16 keeps the float exponent range")
+{
+    static_assert(ve::BFloat16{1.0f}.bits() == 0x3f80);
+    static_assert(ve::BFloat16{1e30f} > 9.9e29f);
+    CHECK(static_cast<float>(ve::BFloat16{3.0f}) == 3.0f);
+    CHECK(std::isnan(static_cast<float>(
+        ve::BFloat16{std::numeric_limits<float>::quiet_NaN()})));
+    CHECK(static_cast<float>(std::numeric_limits<ve::BFloat16>::max()) ==
+        0x1.fep127f);
+}
+
+TEST_CASE("Fixed-point values are scaled, rounded and saturated")
+{
+    static_assert(Millimeters{1.2344}.raw() == 1234);
+    static_assert(Millimeters{-1.2346}.raw() == -1235);
+    static_assert(Millimeters{100.0}.raw() == 32767);
+    static_assert(Millimeters{-100.0}.raw() == -32768);
+    CHECK(static_cast<float>(Millimeters{0.5f}) == 0.5f);
+    CHECK(Millimeters{std::numeric_limits<float>::quiet_NaN()}.raw() == 0);
+    CHECK(ve::Fixed<std::uint8_t, 10>{-3}.raw() == 0);
+}
+
+TEST_CASE("32-bit fixed-point values round-trip through their promoted type")
+{
+    using Micrometers = ve::Fixed<std::int32_t, 1000>;
+    static_assert(std::is_same_v<ve::internal::PromotedType<Micrometers>, double>);
+    static_assert(std::is_same_v<ve::internal::PromotedType<Millimeters>, float>);
+    static_assert(std::is_same_v<
+        decltype(Point3<Micrometers>{} - Point3<Micrometers>{}), Vector3<double>>);
+
+    for (std::int32_t raw = 123456000; raw < 123457000; raw++) {
+        const double value = Micrometers::fromRaw(raw);
+        if (Micrometers{value}.raw() != raw) {
+            FAIL("fixed " << raw << " does not round-trip through double");
+        }
+    }
+    CHECK(static_cast<double>(Micrometers::fromRaw(123456001)) == 123456.001);
+
+    auto p = Point3<Micrometers>{123456.001, 0.0, -2147483.648};
+    p += Vector3<double>{0.001, 0, 0};
+    CHECK(p[0].raw() == 123456002);
+    CHECK(p[2].raw() == std::numeric_limits<std::int32_t>::lowest());
+}
+
+TEST_CASE("Arithmetic on compact vectors promotes to float")
+{
+    auto a = Vector3<ve::Half>{1.5f, -2.f, 0.25f};
+    auto b = Vector3<ve::BFloat16>{1.f, 2.f, 4.f};
+    auto p = Point3<Millimeters>{1.f, 2.f, 3.f};
+
+    static_assert(sizeof(a) == 6);
+    static_assert(std::is_same_v<decltype(a + a), Vector3<float>>);
+    static_assert(std::is_same_v<decltype(a * 2), Vector3<float>>);
+    static_assert(std::is_same_v<decltype(p - p), Vector3<float>>);
+    static_assert(std::is_same_v<decltype(ve::length(a)), float>);
+
+    CHECK(a + b == Vector3<float>{2.5f, 0.f, 4.25f});
+    CHECK(-a == Vector3<float>{-1.5f, 2.f, -0.25f});
+    CHECK(ve::squaredLength(b) == 21.f);
+    CHECK(ve::unit(Vector3<ve::Half>{0.f, 3.f, 4.f}) == Vector3<ve::Half>{0.f, 0.6f, 0.8f});
+
+    a += Vector3<float>{0.5f, 0.5f, 0.5f};
+    CHECK(a == Vector3<float>{2.f, -1.5f, 0.75f});
+    p += Vector3<float>{0.001f, 0.f, 0.f};
+    CHECK(p[0].raw() == 1001);
+
+    auto text = std::string{};
+    ve::appendText(text, a);
+    CHECK(text == "[2, -1.5, 0.75]");
+}
+
+TEST_CASE("Bulk quantize and dequantize match element conversions")
+{
+    std::vector<Point3<float>> points;
+    for (int i = 0; i < 1001; i++) {
+        points.push_back({i * 0.37f, -i * 1.5f, 1.f / (i + 1)});
+    }
+
+    std::vector<Point3<ve::Half>> halves(points.size());
+    ve::quantize(points, halves);
+    std::vector<Point3<float>> restored(points.size());
+    ve::dequantize(halves, restored);
+    for (size_t i = 0; i < points.size(); i++) {
+        CHECK(halves[i] == Point3<ve::Half>{points[i]});
+        CHECK(restored[i] == Point3<float>{halves[i]});
+    }
+
+    std::vector<float> scalars = {0.f, 1.f, -1e-3f, 3e38f};
+    std::vector<ve::BFloat16> bfloats(scalars.size());
+    ve::quantize(scalars, bfloats);
+    for (size_t i = 0; i < scalars.size(); i++) {
+        CHECK(bfloats[i].bits() == ve::BFloat16{scalars[i]}.bits());
+    }
+
+    std::vector<Vector3<double>> vectors = {{0.001, -0.002, 32.767}};
+    std::vector<Vector3<Millimeters>> fixed(1);
+    ve::quantize(vectors, fixed);
+    CHECK(fixed[0][0].raw() == 1);
+    CHECK(fixed[0][1].raw() == -2);
+    CHECK(fixed[0][2].raw() == 32767);
+}
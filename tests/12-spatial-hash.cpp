@@ -0,0 +1,135 @@
+#include <ve.hpp>
+#include <ve/spatial_hash.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "random_points.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+
+TEST_CASE("Spatial hash insert and nearest")
+{
+    auto hash = ve::SpatialHash<XYZModel, float>{1.f};
+    CHECK(hash.empty());
+    CHECK(!hash.nearest({0.f, 0.f, 0.f}, 10.f));
+
+    CHECK(hash.insert({0.f, 0.f, 0.f}) == 0);
+    CHECK(hash.insert({1.5f, 0.f, 0.f}) == 1);
+    CHECK(hash.insert({-0.5f, -0.5f, 0.f}) == 2);
+    CHECK(hash.insert({0.f, 0.f, 0.f}) == 3);
+    CHECK(hash.size() == 4);
+
+    CHECK(hash.nearest({1.2f, 0.f, 0.f}, 1.f) == 1u);
+    CHECK(hash.nearest({-0.4f, -0.4f, 0.f}, 0.2f) == 2u);
+    CHECK(!hash.nearest({5.f, 5.f, 5.f}, 1.f));
+    // Equal distances go to the point inserted first.
+    CHECK(hash.nearest({0.f, 0.f, 0.1f}, 1.f) == 0u);
+
+    hash.clear();
+    CHECK(hash.empty());
+    CHECK(!hash.nearest({0.f, 0.f, 0.f}, 10.f));
+    CHECK(hash.insert({3.f, 3.f, 3.f}) == 0);
+    CHECK(hash.nearest({3.f, 3.f, 3.f}, 0.f) == 0u);
+}
+
+TEST_CASE("Spatial hash radius queries match brute force")
+{
+    const auto points = test::randomPoints<Point3<float>>(5000, 10.f, 7);
+    auto hash = ve::SpatialHash<XYZModel, float>{0.75f};
+    for (const auto& point : points) {
+        hash.insert(point);
+    }
+    REQUIRE(hash.size() == points.size());
+
+    for (const auto& query : test::randomPoints<Point3<float>>(50, 10.f, 8)) {
+        for (float radius : {0.f, 0.3f, 1.f, 2.5f}) {
+            std::vector<size_t> found;
+            hash.forEachWithin(query, radius, [&] (size_t i) { found.push_back(i); });
+            std::sort(found.begin(), found.end());
+
+            std::vector<size_t> expected;
+            for (size_t i = 0; i < points.size(); i++) {
+                if (ve::squaredDistance(points[i], query) <= radius * radius) {
+                    expected.push_back(i);
+                }
+            }
+            CHECK(found == expected);
+        }
+    }
+}
+
+TEST_CASE("Spatial hash negative and NaN radii find nothing")
+{
+    auto hash = ve::SpatialHash<XYZModel, float>{1.f};
+    hash.insert({0.f, 0.f, 0.f});
+    hash.insert({0.f, 0.f, 0.f});
+    hash.insert({0.5f, 0.f, 0.f});
+
+    const auto nan = std::numeric_limits<float>::quiet_NaN();
+    for (float radius : {-0.6f, -1.f, -10.f, nan}) {
+        size_t found = 0;
+        hash.forEachWithin({0.f, 0.f, 0.f}, radius, [&] (size_t) { found++; });
+        CHECK(found == 0);
+        CHECK(!hash.nearest({0.f, 0.f, 0.f}, radius));
+    }
+
+    std::vector<Point3<float>> points = {{0.f, 0.f, 0.f}, {0.f, 0.f, 0.f}};
+    auto welded = ve::weld(points, -0.5f);
+    CHECK(welded.points == points);
+    CHECK(welded.indices == std::vector<std::uint32_t>{0, 1});
+}
+
+TEST_CASE("Weld merges points within tolerance")
+{
+    std::vector<Point3<float>> points = {
+        {0.f, 0.f, 0.f},
+        {1.f, 0.f, 0.f},
+        {0.001f, 0.f, 0.f},
+        {1.f, 0.0005f, 0.f},
+        {-0.f, 0.f, 0.f},
+        {2.f, 2.f, 2.f},
+    };
+
+    auto welded = ve::weld(points, 0.01f);
+    CHECK(welded.points == std::vector<Point3<float>>{
+        {0.f, 0.f, 0.f}, {1.f, 0.f, 0.f}, {2.f, 2.f, 2.f}});
+    CHECK(welded.indices == std::vector<std::uint32_t>{0, 1, 0, 1, 0, 2});
+
+    auto exact = ve::weld(points, 0.f);
+    CHECK(exact.points.size() == 5);
+    CHECK(exact.indices == std::vector<std::uint32_t>{0, 1, 2, 3, 0, 4});
+}
+
+TEST_CASE("Weld of many points keeps every point within tolerance")
+{
+    std::vector<Point3<float>> points;
+    auto random = std::mt19937{3};
+    auto jitter = std::uniform_real_distribution<float>{-0.01f, 0.01f};
+    for (int x = 0; x < 20; x++) {
+        for (int y = 0; y < 20; y++) {
+            for (int copy = 0; copy < 3; copy++) {
+                points.push_back({x + jitter(random), y + jitter(random), jitter(random)});
+            }
+        }
+    }
+
+    const float tolerance = 0.05f;
+    auto welded = ve::weld(points, tolerance);
+    CHECK(welded.points.size() == 400);
+    REQUIRE(welded.indices.size() == points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        CHECK(welded.indices[i] == i / 3);
+        CHECK(ve::distance(points[i], welded.points[welded.indices[i]]) <= tolerance);
+    }
+}
@@ -0,0 +1,200 @@
+#include <ve.hpp>
+#include <ve/spatial_sort.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "random_points.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+template <class T> struct XYModel {
+    T x;
+    T y;
+};
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Point2 = ve::Point<XYModel, T>;
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+
+namespace {
+
+// Visits every cell of a grid with 2^bits cells per axis in Hilbert order and
+// checks that consecutive cells are face neighbours.
+template <size_t N>
+void checkHilbertWalk(unsigned bits)
+{
+    const std::uint32_t side = std::uint32_t{1} << bits;
+    size_t cellCount = 1;
+    for (size_t c = 0; c < N; c++) {
+        cellCount *= side;
+    }
+
+    std::vector<std::array<std::uint32_t, N>> cells(cellCount);
+    std::vector<bool> seen(cellCount);
+    for (size_t i = 0; i < cellCount; i++) {
+        std::array<std::uint32_t, N> cell;
+        for (size_t c = 0, rest = i; c < N; c++, rest /= side) {
+            cell[c] = static_cast<std::uint32_t>(rest % side);
+        }
+        auto index = ve::internal::hilbertIndex<N>(cell, bits);
+        REQUIRE(index < cellCount);
+        REQUIRE(!seen[index]);
+        seen[index] = true;
+        cells[index] = cell;
+    }
+
+    for (size_t i = 1; i < cellCount; i++) {
+        int steps = 0;
+        for (size_t c = 0; c < N; c++) {
+            steps += std::abs(
+                static_cast<int>(cells[i][c]) - static_cast<int>(cells[i - 1][c]));
+        }
+        CHECK(steps == 1);
+    }
+}
+
+} // namespace
+
+TEST_CASE("Bit spreading")
+{
+    static_assert(ve::internal::spreadBits2(0b1011) == 0b1000101);
+    static_assert(ve::internal::spreadBits3(0b1011) == 0b1000001001);
+    static_assert(ve::internal::spreadBits2(0xffffffffu) == 0x5555555555555555u);
+    static_assert(ve::internal::spreadBits3(0x1fffffu) == 0x1249249249249249u);
+
+    auto random = std::mt19937{1};
+    for (int i = 0; i < 1000; i++) {
+        auto value = static_cast<std::uint32_t>(random());
+        std::uint64_t expected2 = 0;
+        std::uint64_t expected3 = 0;
+        for (unsigned bit = 0; bit < 32; bit++) {
+            expected2 |= std::uint64_t{(value >> bit) & 1} << (2 * bit);
+            if (bit < 21) {
+                expected3 |= std::uint64_t{(value >> bit) & 1} << (3 * bit);
+            }
+        }
+        CHECK(ve::internal::spreadBits2(value) == expected2);
+        CHECK(ve::internal::spreadBits3(value) == expected3);
+    }
+}
+
+TEST_CASE("Morton keys")
+{
+    const auto box = ve::AABB<XYModel, float>{{0.f, 0.f}, {1.f, 1.f}};
+    CHECK(ve::mortonKey(Point2<float>{0.f, 0.f}, box) == 0);
+    CHECK(ve::mortonKey(Point2<float>{1.f, 1.f}, box) == ~std::uint64_t{0});
+    CHECK(ve::mortonKey(Point2<float>{1.f, 0.f}, box) == 0x5555555555555555u);
+    CHECK(ve::mortonKey(Point2<float>{0.f, 1.f}, box) == 0xaaaaaaaaaaaaaaaau);
+    // Points outside the box are clamped.
+    CHECK(ve::mortonKey(Point2<float>{-5.f, 7.f}, box) == 0xaaaaaaaaaaaaaaaau);
+
+    const auto box3 = ve::AABB<XYZModel, int>{{0, 0, 0}, {8, 8, 8}};
+    CHECK(ve::mortonKey(Point3<int>{8, 8, 8}, box3) == 0x7fffffffffffffffu);
+    CHECK(ve::mortonKey(Point3<int>{0, 0, 8}, box3) == 0x4924924924924924u);
+    CHECK(ve::mortonKey(Point3<int>{3, 3, 3}, box3) < ve::mortonKey(Point3<int>{5, 5, 5}, box3));
+}
+
+TEST_CASE("Hilbert curve visits neighbouring cells")
+{
+    checkHilbertWalk<2>(1);
+    checkHilbertWalk<2>(4);
+    checkHilbertWalk<3>(1);
+    checkHilbertWalk<3>(3);
+
+    const auto box = ve::AABB<XYModel, double>{{-1.0, -1.0}, {1.0, 1.0}};
+    CHECK(ve::hilbertKey(Point2<double>{-1.0, -1.0}, box) == 0);
+}
+
+TEST_CASE("Bulk keys match single keys")
+{
+    const auto points = test::randomPoints<Point3<float>>(50000, 100.f, 2);
+    const auto box = ve::bounds(points);
+    std::vector<std::uint64_t> morton(points.size());
+    std::vector<std::uint64_t> hilbert(points.size());
+    ve::mortonKeys(points, box, morton);
+    ve::hilbertKeys(points, box, hilbert);
+    for (size_t i = 0; i < points.size(); i++) {
+        CHECK(morton[i] == ve::mortonKey(points[i], box));
+        CHECK(hilbert[i] == ve::hilbertKey(points[i], box));
+    }
+}
+
+TEST_CASE("Radix sort by keys")
+{
+    auto pool = ve::ThreadPool{4};
+    auto random = std::mt19937{5};
+
+    for (size_t count : {0, 1, 100, 70000}) {
+        std::vector<std::uint64_t> keys(count);
+        for (auto& key : keys) {
+            // Few distinct high digits, so that some passes are skipped and
+            // equal keys test stability.
+            key = (std::uint64_t{random() % 4} << 56) | (random() % 1000);
+        }
+        std::vector<std::uint32_t> values(count);
+        std::iota(values.begin(), values.end(), 0u);
+        std::vector<double> payload(values.begin(), values.end());
+
+        auto expected = values;
+        std::stable_sort(expected.begin(), expected.end(), [&] (auto a, auto b) {
+            return keys[a] < keys[b];
+        });
+
+        auto sortedKeys = keys;
+        ve::sortByKeys(sortedKeys, values, payload, pool);
+        CHECK(std::is_sorted(sortedKeys.begin(), sortedKeys.end()));
+        CHECK(values == expected);
+        for (size_t i = 0; i < count; i++) {
+            CHECK(payload[i] == values[i]);
+            CHECK(sortedKeys[i] == keys[values[i]]);
+        }
+    }
+
+    std::vector<std::uint16_t> shortKeys = {3, 1, 2, 1};
+    std::vector<char> letters = {'a', 'b', 'c', 'd'};
+    ve::sortByKeys(shortKeys, letters);
+    CHECK(letters == std::vector<char>{'b', 'd', 'c', 'a'});
+}
+
+TEST_CASE("Spatial sort keeps points and payload together")
+{
+    auto points = test::randomPoints<Point3<float>>(30000, 100.f, 9);
+    const auto original = points;
+    std::vector<std::uint32_t> ids(points.size());
+    std::iota(ids.begin(), ids.end(), 0u);
+
+    auto pool = ve::ThreadPool{3};
+    ve::spatialSort(points, ids, ve::Curve::Hilbert, pool);
+    for (size_t i = 0; i < points.size(); i++) {
+        CHECK(points[i] == original[ids[i]]);
+    }
+
+    const auto box = ve::bounds(points);
+    for (size_t i = 1; i < points.size(); i++) {
+        CHECK(ve::hilbertKey(points[i - 1], box) <= ve::hilbertKey(points[i], box));
+    }
+
+    // Neighbours in memory should be much closer than in the original order.
+    auto meanStep = [] (const auto& sequence) {
+        double total = 0;
+        for (size_t i = 1; i < sequence.size(); i++) {
+            total += ve::distance(sequence[i - 1], sequence[i]);
+        }
+        return total / static_cast<double>(sequence.size() - 1);
+    };
+    CHECK(meanStep(points) * 5 < meanStep(original));
+
+    ve::spatialSort(points, ve::Curve::Morton);
+    for (size_t i = 1; i < points.size(); i++) {
+        CHECK(ve::mortonKey(points[i - 1], box) <= ve::mortonKey(points[i], box));
+    }
+}
@@ -0,0 +1,201 @@
+#include <ve.hpp>
+#include <ve/algorithms.hpp>
+#include <ve/batch.hpp>
+#include <ve/point_cloud.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+template <class T> using Vector3 = ve::Vector<XYZModel, T>;
+
+namespace {
+
+struct Color {
+    std::uint8_t r;
+    std::uint8_t g;
+    std::uint8_t b;
+    std::uint8_t a;
+};
+
+Point3<float> pointAt(size_t i)
+{
+    return {static_cast<float>(i), static_cast<float>(i % 7), -1.f};
+}
+
+} // namespace
+
+TEST_CASE("Point cloud append and indexing")
+{
+    auto cloud = ve::PointCloud<XYZModel, float>{16};
+    CHECK(cloud.empty());
+    CHECK(cloud.chunkSize() == 16);
+    CHECK(cloud.chunkCount() == 0);
+
+    for (size_t i = 0; i < 100; i++) {
+        CHECK(cloud.push_back(pointAt(i)) == i);
+    }
+    CHECK(cloud.size() == 100);
+    CHECK(cloud.chunkCount() == 7);
+    for (size_t i = 0; i < cloud.size(); i++) {
+        CHECK(cloud[i] == pointAt(i));
+    }
+
+    size_t total = 0;
+    for (size_t c = 0; c < cloud.chunkCount(); c++) {
+        auto chunk = cloud.chunk(c);
+        CHECK(chunk.size() == (c < 6 ? 16u : 4u));
+        CHECK(chunk.front() == pointAt(total));
+        total += chunk.size();
+    }
+    CHECK(total == cloud.size());
+
+    cloud[42] = Point3<float>{1.f, 2.f, 3.f};
+    CHECK(cloud.chunk(2)[10] == Point3<float>{1.f, 2.f, 3.f});
+}
+
+TEST_CASE("Point cloud references stay valid while growing")
+{
+    auto cloud = ve::PointCloud<XYZModel, float>{8};
+    cloud.push_back(pointAt(0));
+    const auto* first = &cloud[0];
+    auto firstChunk = cloud.chunk(0);
+    for (size_t i = 1; i < 10000; i++) {
+        cloud.push_back(pointAt(i));
+    }
+    CHECK(first == &cloud[0]);
+    CHECK(firstChunk.data() == cloud.chunk(0).data());
+    CHECK(*first == pointAt(0));
+}
+
+TEST_CASE("Point cloud iteration")
+{
+    auto cloud = ve::PointCloud<XYZModel, int>{4};
+    for (int i = 0; i < 10; i++) {
+        cloud.push_back({i, 2 * i, 3 * i});
+    }
+
+    using Cloud = ve::PointCloud<XYZModel, int>;
+    static_assert(std::random_access_iterator<Cloud::iterator>);
+    static_assert(std::random_access_iterator<Cloud::const_iterator>);
+
+    int expected = 0;
+    for (const auto& point : cloud) {
+        CHECK(point == Point3<int>{expected, 2 * expected, 3 * expected});
+        expected++;
+    }
+    CHECK(expected == 10);
+    CHECK(std::distance(cloud.begin(), cloud.end()) == 10);
+    CHECK((cloud.begin() + 7)->x == 7);
+    CHECK((cloud.end() - 1).index() == 9);
+
+    const auto& constCloud = cloud;
+    Cloud::const_iterator it = cloud.begin();
+    CHECK(it == constCloud.begin());
+    auto found = std::find(constCloud.begin(), constCloud.end(), Point3<int>{5, 10, 15});
+    CHECK(found.index() == 5);
+}
+
+TEST_CASE("Point cloud attributes")
+{
+    auto cloud = ve::PointCloud<XYZModel, float>{32};
+    for (size_t i = 0; i < 50; i++) {
+        cloud.push_back(pointAt(i));
+    }
+
+    // Channels added later get the default value for existing points.
+    auto normals = cloud.addAttribute(Vector3<float>{0.f, 0.f, 1.f});
+    auto colors = cloud.addAttribute(Color{255, 0, 0, 255});
+    auto ids = cloud.addAttribute<std::uint32_t>();
+
+    for (size_t i = 50; i < 100; i++) {
+        auto index = cloud.push_back(pointAt(i));
+        cloud.attribute(ids, index) = static_cast<std::uint32_t>(index * 10);
+    }
+
+    for (size_t i = 0; i < cloud.size(); i++) {
+        CHECK(cloud.attribute(normals, i) == Vector3<float>{0.f, 0.f, 1.f});
+        CHECK(cloud.attribute(colors, i).r == 255);
+        CHECK(cloud.attribute(ids, i) == (i < 50 ? 0 : i * 10));
+    }
+
+    for (size_t c = 0; c < cloud.chunkCount(); c++) {
+        auto points = cloud.chunk(c);
+        auto chunkNormals = cloud.attributeChunk(normals, c);
+        REQUIRE(chunkNormals.size() == points.size());
+        for (size_t i = 0; i < points.size(); i++) {
+            chunkNormals[i] = points[i] - Point3<float>{};
+        }
+    }
+    for (size_t i = 0; i < cloud.size(); i++) {
+        CHECK(cloud.attribute(normals, i) == cloud[i] - Point3<float>{});
+    }
+}
+
+TEST_CASE("Point cloud chunks work with batch and parallel kernels")
+{
+    auto cloud = ve::PointCloud<XYZModel, float>{256};
+    cloud.reserve(5000);
+    auto lengths = cloud.addAttribute<float>();
+    for (size_t i = 0; i < 5000; i++) {
+        cloud.push_back(pointAt(i));
+    }
+
+    auto pool = ve::ThreadPool{3};
+    std::vector<ve::AABB<XYZModel, float>> boxes(cloud.chunkCount());
+    cloud.parallelForChunks(pool, [&] (size_t c) {
+        boxes[c] = ve::bounds(cloud.chunk(c));
+    });
+    auto box = ve::AABB<XYZModel, float>{};
+    for (const auto& chunkBox : boxes) {
+        box.extend(chunkBox.min).extend(chunkBox.max);
+    }
+    CHECK(box == ve::bounds(std::vector<Point3<float>>(cloud.begin(), cloud.end())));
+
+    std::atomic<size_t> visited = 0;
+    cloud.parallelForChunks(pool, [&] (size_t c) {
+        auto points = cloud.chunk(c);
+        auto origins = std::vector<Point3<float>>(points.size());
+        ve::distances(points, origins, cloud.attributeChunk(lengths, c));
+        visited += points.size();
+    });
+    CHECK(visited == cloud.size());
+    for (size_t i = 0; i < cloud.size(); i++) {
+        CHECK(cloud.attribute(lengths, i) == ve::distance(cloud[i], Point3<float>{}));
+    }
+}
+
+TEST_CASE("Point cloud clear reuses chunks")
+{
+    auto cloud = ve::PointCloud<XYZModel, double>{64};
+    auto ids = cloud.addAttribute<int>(-1);
+    for (size_t i = 0; i < 1000; i++) {
+        cloud.attribute(ids, cloud.push_back({1.0, 2.0, 3.0})) = static_cast<int>(i);
+    }
+    const auto memory = cloud.memoryUsage();
+    CHECK(memory >= 1000 * (sizeof(Point3<double>) + sizeof(int)));
+
+    cloud.clear();
+    CHECK(cloud.empty());
+    CHECK(cloud.chunkCount() == 0);
+    for (size_t i = 0; i < 1000; i++) {
+        cloud.push_back({0.0, 0.0, 0.0});
+    }
+    CHECK(cloud.memoryUsage() == memory);
+    CHECK(cloud.attribute(ids, 999) == -1);
+
+    auto moved = std::move(cloud);
+    CHECK(moved.size() == 1000);
+    CHECK(moved.attribute(ids, 0) == -1);
+}
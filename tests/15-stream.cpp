@@ -0,0 +1,219 @@
+#include <ve.hpp>
+#include <ve/point_file.hpp>
+#include <ve/stream.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+template <class T> using Vector3 = ve::Vector<XYZModel, T>;
+
+namespace {
+
+struct TemporaryFile {
+    TemporaryFile(const char* name)
+        : path(std::filesystem::temp_directory_path() / name)
+    { }
+
+    ~TemporaryFile()
+    {
+        std::filesystem::remove(path);
+    }
+
+    std::filesystem::path path;
+};
+
+template <class V>
+struct CollectSink {
+    void write(std::span<const V> batch)
+    {
+        values.insert(values.end(), batch.begin(), batch.end());
+    }
+
+    std::vector<V> values;
+};
+
+auto makePoint(std::uint64_t i)
+{
+    return Point3<float>{
+        static_cast<float>(i), static_cast<float>(i % 7), -static_cast<float>(i)};
+}
+
+} // namespace
+
+TEST_CASE("Stream pipelines transform and filter in order")
+{
+    const std::uint64_t count = 100'000;
+    auto pool = ve::ThreadPool{4};
+    for (auto* stagePool : {static_cast<ve::ThreadPool*>(nullptr), &pool}) {
+        auto pipeline = ve::StreamPipeline<Point3<float>>{{
+            .batchSize = 4096, .batchCount = 3, .pool = stagePool}};
+        pipeline
+            .offset(Vector3<float>{1, 0, 0})
+            .filter([] (const Point3<float>& p) { return p.y != 3; })
+            .scale(Vector3<float>{2, 1, 1})
+            .map([] (Point3<float> p) { p.z += 1; return p; });
+
+        auto sink = CollectSink<Point3<float>>{};
+        auto stats = pipeline.run(ve::GeneratorSource{count, makePoint}, sink);
+
+        std::vector<Point3<float>> expected;
+        for (std::uint64_t i = 0; i < count; i++) {
+            auto p = makePoint(i);
+            if (p.y != 3) {
+                expected.push_back({2 * (p.x + 1), p.y, p.z + 1});
+            }
+        }
+        CHECK(stats.read == count);
+        CHECK(stats.batches == (count + 4095) / 4096);
+        CHECK(stats.written == expected.size());
+        CHECK(sink.values == expected);
+    }
+}
+
+TEST_CASE("Stream pipelines keep a bounded number of values in flight")
+{
+    const size_t batchSize = 100;
+    const size_t batchCount = 3;
+    auto pipeline = ve::StreamPipeline<Point3<int>>{{
+        .batchSize = batchSize, .batchCount = batchCount}};
+    CHECK(pipeline.memoryUsage() == batchSize * batchCount * sizeof(Point3<int>));
+
+    // Every value that was read but not written yet sits in one of the
+    // pipeline's batches, whatever the input size.
+    std::atomic<std::uint64_t> produced = 0;
+    std::atomic<std::uint64_t> consumed = 0;
+    std::uint64_t maxInFlight = 0;
+    auto source = ve::GeneratorSource{1'000'000, [&] (std::uint64_t i) {
+        produced++;
+        return Point3<int>{static_cast<int>(i), 0, 0};
+    }};
+    auto sink = ve::ReduceSink{0, [&] (int total, const Point3<int>&) {
+        consumed++;
+        return total + 1;
+    }};
+    pipeline.stage([&] (std::span<Point3<int>> batch) {
+        maxInFlight = std::max(maxInFlight, produced - consumed);
+        return batch.size();
+    });
+    pipeline.run(source, sink);
+    CHECK(sink.result() == 1'000'000);
+    CHECK(maxInFlight <= batchSize * batchCount);
+}
+
+TEST_CASE("Stream pipelines read and write point files")
+{
+    auto input = TemporaryFile{"ve-test-stream-in.vepc"};
+    auto output = TemporaryFile{"ve-test-stream-out.vepc"};
+    {
+        auto writer = ve::PointFileWriter<XYZModel, float>{input.path, "xyz"};
+        for (std::uint64_t i = 0; i < 10'000; i++) {
+            writer.write(makePoint(i));
+        }
+    }
+
+    auto reader = ve::PointFileReader<XYZModel, float>{input.path, "xyz"};
+    CHECK(reader.size() == 10'000);
+    {
+        auto writer = ve::PointFileWriter<XYZModel, float>{output.path, "xyz"};
+        auto stats = ve::StreamPipeline<Point3<float>>{{.batchSize = 999}}
+            .offset(Vector3<float>{0, 0, 5})
+            .run(reader, writer);
+        CHECK(stats.written == 10'000);
+    }
+    CHECK(reader.remaining() == 0);
+
+    auto mapped = ve::MappedPointFile<XYZModel, float>{output.path};
+    REQUIRE(mapped.size() == 10'000);
+    for (std::uint64_t i = 0; i < 10'000; i++) {
+        CHECK(mapped[i] == makePoint(i) + Vector3<float>{0, 0, 5});
+    }
+
+    CHECK_THROWS_AS(
+        (ve::PointFileReader<XYZModel, int>{input.path}), ve::PointFileError);
+}
+
+TEST_CASE("Stream pipelines read and write text")
+{
+    auto input = std::istringstream{
+        "# x y z\n"
+        "1 2 3\n"
+        "\n"
+        "(4, 5, 6) (7, 8, 9)\n"
+        "10,11,12\r\n"};
+    auto output = std::ostringstream{};
+    auto stats = ve::StreamPipeline<Point3<int>>{{.batchSize = 2}}
+        .filter([] (const Point3<int>& p) { return p.x != 7; })
+        .run(ve::TextReader<Point3<int>>{input}, ve::TextWriter<Point3<int>>{output});
+    CHECK(stats.read == 4);
+    CHECK(stats.written == 3);
+    CHECK(output.str() == "(1, 2, 3)\n(4, 5, 6)\n(10, 11, 12)\n");
+
+    auto bad = std::istringstream{"1 2 3\n4 x 6\n"};
+    CHECK_THROWS_AS(
+        ve::StreamPipeline<Point3<int>>{}.run(
+            ve::TextReader<Point3<int>>{bad}, CollectSink<Point3<int>>{}),
+        ve::StreamError);
+}
+
+TEST_CASE("Stream pipelines reduce and pass vectors through")
+{
+    std::vector<Vector3<double>> values;
+    for (int i = 0; i < 5000; i++) {
+        values.push_back({i * 1.0, 1.0, -1.0});
+    }
+
+    auto sum = ve::ReduceSink{Vector3<double>{}, [] (auto total, const auto& v) {
+        return total + v;
+    }};
+    ve::StreamPipeline<Vector3<double>>{{.batchSize = 64}}
+        .scale(Vector3<double>{1, 2, 3})
+        .run(ve::SpanSource{values}, sum);
+    CHECK(sum.result() == Vector3<double>{4999.0 * 5000 / 2, 10000, -15000});
+}
+
+TEST_CASE("Stream pipelines stop on errors")
+{
+    struct FailingSink {
+        void write(std::span<const Point3<float>>)
+        {
+            if (++batches == 3) {
+                throw std::runtime_error{"sink failed"};
+            }
+        }
+        int batches = 0;
+    };
+
+    auto pipeline = ve::StreamPipeline<Point3<float>>{{.batchSize = 10}};
+    auto sink = FailingSink{};
+    CHECK_THROWS_AS(
+        pipeline.run(ve::GeneratorSource{1'000'000, makePoint}, sink),
+        std::runtime_error);
+    CHECK(sink.batches == 3);
+
+    auto values = std::vector<Point3<float>>{makePoint(1), makePoint(2)};
+    auto collect = CollectSink<Point3<float>>{};
+    pipeline.run(ve::SpanSource{values}, collect);
+    CHECK(collect.values == values);
+
+    pipeline.stage([] (std::span<Point3<float>>) -> size_t {
+        throw std::logic_error{"stage failed"};
+    });
+    CHECK_THROWS_AS(
+        pipeline.run(
+            ve::GeneratorSource{1'000'000, makePoint}, CollectSink<Point3<float>>{}),
+        std::logic_error);
+}
@@ -0,0 +1,114 @@
+#define VE_ENABLE_INSTRUMENTATION
+
+#include <ve.hpp>
+#include <ve/batch.hpp>
+#include <ve/instrumentation.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+template <class T> using Vector3 = ve::Vector<XYZModel, T>;
+
+static_assert(ve::instrumentationEnabled);
+
+TEST_CASE("Operators count the operations they do")
+{
+    ve::resetInstrumentation();
+
+    auto a = Vector3<float>{1, 2, 3};
+    auto b = Vector3<float>{4, 5, 6};
+    auto c = a + b;
+    c += a;
+    c = -c * 2.f;
+    auto l = length(c);
+    auto d = Vector3<double>{a};
+    auto p = Point3<float>{0, 0, 0} + a;
+    auto q = p - Point3<float>{1, 1, 1};
+    CHECK(l > 0);
+    CHECK(d != Vector3<double>{});
+    CHECK(q == Vector3<float>{0, 1, 2});
+    CHECK(distance(p, Point3<float>{}) > 0);
+
+    auto report = ve::instrumentationReport();
+    CHECK(report[ve::Operation::VectorAdd] == 2);
+    CHECK(report[ve::Operation::VectorNegate] == 1);
+    CHECK(report[ve::Operation::VectorMultiply] == 1);
+    CHECK(report[ve::Operation::Length] == 2);
+    CHECK(report[ve::Operation::Sqrt] == 2);
+    CHECK(report[ve::Operation::Conversion] == 1);
+    CHECK(report[ve::Operation::PointTranslate] == 1);
+    CHECK(report[ve::Operation::PointDifference] == 2);
+    CHECK(report[ve::Operation::Distance] == 1);
+    CHECK(report[ve::Operation::VectorCompare] == 2);
+    // a + b, -c, (-c) * 2, p + a, p - (1, 1, 1) and p - () in distance().
+    CHECK(report[ve::Operation::Temporary] == 6);
+    CHECK(report[ve::Operation::Dot] == 0);
+
+    ve::resetInstrumentation();
+    CHECK(ve::instrumentationReport()[ve::Operation::VectorAdd] == 0);
+}
+
+TEST_CASE("Constant evaluation is not counted")
+{
+    ve::resetInstrumentation();
+    constexpr auto sum = Vector3<int>{1, 2, 3} + Vector3<int>{1, 1, 1};
+    static_assert(sum == Vector3<int>{2, 3, 4});
+    CHECK(ve::instrumentationReport()[ve::Operation::VectorAdd] == 0);
+}
+
+TEST_CASE("Counts of all threads are merged")
+{
+    ve::resetInstrumentation();
+
+    auto work = [] {
+        auto v = Vector3<float>{};
+        for (int i = 0; i < 1000; i++) {
+            v += Vector3<float>{1, 1, 1};
+        }
+        return v;
+    };
+    auto worker = std::thread{work};
+    auto v = work();
+    worker.join();
+    CHECK(v.x == 1000);
+
+    auto runner = std::jthread{work};
+    runner.join();
+
+    CHECK(ve::instrumentationReport()[ve::Operation::VectorAdd] == 3000);
+}
+
+TEST_CASE("Batch kernels are timed")
+{
+    ve::resetInstrumentation();
+
+    std::vector<Vector3<float>> vectors(1000, Vector3<float>{3, 4, 0});
+    std::vector<float> norms(vectors.size());
+    ve::lengths(vectors, norms);
+    ve::lengths(vectors, norms);
+    CHECK(norms[0] == 5);
+
+    auto report = ve::instrumentationReport();
+    CHECK(report[ve::Kernel::Lengths].calls == 2);
+    CHECK(report[ve::Kernel::Lengths].items == 2000);
+    CHECK(report[ve::Kernel::Lengths].time.count() > 0);
+    CHECK(report[ve::Kernel::SquaredLengths].calls == 2);
+    CHECK(report[ve::Kernel::Dots].calls == 0);
+    CHECK(report[ve::Operation::Sqrt] == 2000);
+
+    auto text = std::ostringstream{};
+    text << report;
+    CHECK(text.str().find("sqrt                2000\n") != std::string::npos);
+    CHECK(text.str().find("lengths             2 calls, 2000 items, ") !=
+        std::string::npos);
+    CHECK(text.str().find("dots") == std::string::npos);
+}
@@ -0,0 +1,175 @@
+#include <ve.hpp>
+#include <ve/dispatch.hpp>
+#include <ve/transform.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Vector3 = ve::Vector<XYZModel, T>;
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+template <class T> using Transform3 = ve::Transform<XYZModel, T>;
+
+namespace {
+
+template <class T>
+std::vector<Vector3<T>> makeVectors(size_t count)
+{
+    std::vector<Vector3<T>> vectors;
+    for (size_t i = 0; i < count; i++) {
+        auto f = static_cast<T>(i);
+        vectors.push_back({f * T(0.5) - 100, std::sin(f) * 10, 1 / (f + 1)});
+    }
+    vectors.push_back({0, 0, 0});
+    return vectors;
+}
+
+template <class T>
+std::vector<Point3<T>> makePoints(size_t count)
+{
+    std::vector<Point3<T>> points;
+    for (const auto& v : makeVectors<T>(count)) {
+        points.push_back(Point3<T>{} + v);
+    }
+    return points;
+}
+
+// Results of the batch functions with one instruction set.
+template <class T>
+struct Results {
+    explicit Results(size_t count)
+    {
+        const auto vectors = makeVectors<T>(count);
+        const auto points = makePoints<T>(count);
+        const auto other = makePoints<T>(count + 5);
+        const auto transform = Transform3<T>{
+            ve::Matrix<XYZModel, T>{{{{0, -1, 0}, {1, 0, 0}, {0, 0, 2}}}},
+            {1, 2, 3}};
+
+        lengths.resize(vectors.size());
+        fastLengths.resize(vectors.size());
+        distances.resize(points.size());
+        units.resize(vectors.size());
+        fastUnits.resize(vectors.size());
+        sums.resize(points.size());
+        scaled.resize(vectors.size());
+        transformed.resize(points.size());
+
+        ve::lengths(vectors, lengths);
+        ve::lengths(vectors, fastLengths, ve::Precision::Fast);
+        ve::distances(points, std::span{other}.first(points.size()), distances);
+        ve::normalize(vectors, units);
+        ve::normalize(vectors, fastUnits, ve::Precision::Fast);
+        ve::add(points, vectors, sums);
+        ve::scale(vectors, 3, scaled);
+        bounds = ve::transformWithBounds(transform, points, transformed);
+
+        auto in = ve::PointArray<XYZModel, T>{};
+        for (const auto& p : points) {
+            in.push_back(p);
+        }
+        auto out = ve::PointArray<XYZModel, T>{};
+        ve::transform(transform, in, out);
+        for (size_t i = 0; i < out.size(); i++) {
+            soa.push_back(out[i]);
+        }
+    }
+
+    std::vector<T> lengths;
+    std::vector<T> fastLengths;
+    std::vector<T> distances;
+    std::vector<Vector3<T>> units;
+    std::vector<Vector3<T>> fastUnits;
+    std::vector<Point3<T>> sums;
+    std::vector<Vector3<T>> scaled;
+    std::vector<Point3<T>> transformed;
+    ve::AABB<XYZModel, T> bounds;
+    std::vector<Point3<T>> soa;
+};
+
+template <class T>
+void checkAllInstructionSets()
+{
+    const size_t count = 1003;
+    const auto initial = ve::activeIsa();
+    ve::setIsa(ve::Isa::Baseline);
+    const auto expected = Results<T>{count};
+
+    for (auto isa : {ve::Isa::Avx2, ve::Isa::Avx512}) {
+        if (isa > ve::supportedIsa()) {
+            continue;
+        }
+        INFO(ve::name(isa));
+        REQUIRE(ve::setIsa(isa) == isa);
+        const auto actual = Results<T>{count};
+
+        // Exact results are the same bit for bit.
+        CHECK(actual.lengths == expected.lengths);
+        CHECK(actual.distances == expected.distances);
+        CHECK(actual.units == expected.units);
+        CHECK(actual.sums == expected.sums);
+        CHECK(actual.scaled == expected.scaled);
+        CHECK(actual.transformed == expected.transformed);
+        CHECK(actual.bounds == expected.bounds);
+        CHECK(actual.soa == expected.soa);
+
+        for (size_t i = 0; i < actual.lengths.size(); i++) {
+            const auto exact = expected.lengths[i];
+            CHECK(std::abs(actual.fastLengths[i] - exact) <= std::ldexp(exact, -21));
+            for (size_t c = 0; c < 3; c++) {
+                CHECK(std::abs(actual.fastUnits[i][c] - expected.units[i][c]) <=
+                    T(1e-6));
+            }
+        }
+        CHECK(actual.fastLengths.back() == 0);
+        CHECK(actual.fastUnits.back() == Vector3<T>{0, 0, 0});
+    }
+    ve::setIsa(initial);
+}
+
+} // namespace
+
+TEST_CASE("The active instruction set can be changed")
+{
+    const auto initial = ve::activeIsa();
+    CHECK(initial <= ve::supportedIsa());
+    CHECK(ve::setIsa(ve::Isa::Baseline) == ve::Isa::Baseline);
+    CHECK(ve::activeIsa() == ve::Isa::Baseline);
+    CHECK(ve::setIsa(ve::Isa::Avx512) == ve::supportedIsa());
+    CHECK(ve::activeIsa() == ve::supportedIsa());
+    ve::setIsa(initial);
+
+    CHECK(ve::name(ve::Isa::Baseline) == "baseline");
+    CHECK(ve::name(ve::Isa::Avx2) == "avx2");
+    CHECK(ve::name(ve::Isa::Avx512) == "avx512");
+}
+
+TEST_CASE("Batch functions agree on every instruction set")
+{
+    checkAllInstructionSets<float>();
+    checkAllInstructionSets<double>();
+}
+
+TEST_CASE("Batch add and scale")
+{
+    auto points = std::vector<Point3<int>>{{1, 2, 3}, {4, 5, 6}};
+    auto vectors = std::vector<Vector3<int>>{{1, 1, 1}, {0, -1, 2}};
+    auto sums = std::vector<Point3<double>>(2);
+    ve::add(points, vectors, sums);
+    CHECK(sums == std::vector<Point3<double>>{{2, 3, 4}, {4, 4, 8}});
+
+    ve::add(vectors, vectors, vectors);
+    CHECK(vectors == std::vector<Vector3<int>>{{2, 2, 2}, {0, -2, 4}});
+
+    auto halves = std::vector<Vector3<float>>(2);
+    ve::scale(vectors, 0.5, halves);
+    CHECK(halves == std::vector<Vector3<float>>{{1, 1, 1}, {0, -1, 2}});
+}
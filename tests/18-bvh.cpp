@@ -0,0 +1,262 @@
+#include <ve.hpp>
+#include <ve/bvh.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "random_points.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> struct alignas(4 * sizeof(T)) PaddedXYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+template <class T> using Vector3 = ve::Vector<XYZModel, T>;
+template <class T> using Box3 = ve::AABB<XYZModel, T>;
+template <class T> using PaddedPoint3 = ve::Point<PaddedXYZModel, T>;
+template <class T> using PaddedBox3 = ve::AABB<PaddedXYZModel, T>;
+
+namespace {
+
+template <class Box>
+void checkBoxOperations()
+{
+    using P = decltype(Box{}.min);
+    auto a = Box{P{0, 0, 0}, P{4, 2, 2}};
+    auto b = Box{P{3, 1, -1}, P{6, 2, 1}};
+    auto c = Box{P{5, 3, 0}, P{6, 4, 1}};
+
+    CHECK(a.overlaps(b));
+    CHECK(b.overlaps(a));
+    CHECK_FALSE(a.overlaps(c));
+    CHECK(b.overlaps(Box{P{6, 2, 1}, P{7, 3, 2}}));
+    CHECK_FALSE(a.overlaps(Box{}));
+    CHECK_FALSE(Box{}.overlaps(Box{}));
+
+    CHECK(ve::merge(a, b) == Box{P{0, 0, -1}, P{6, 2, 2}});
+    CHECK(ve::merge(a, Box{}) == a);
+    CHECK(ve::intersection(a, b) == Box{P{3, 1, 0}, P{4, 2, 1}});
+    CHECK(ve::intersection(a, c).empty());
+
+    CHECK(a.contains(Box{P{1, 1, 1}, P{4, 2, 2}}));
+    CHECK_FALSE(a.contains(b));
+    CHECK(a.contains(Box{}));
+    CHECK(a.contains(P{4, 0, 1}));
+    CHECK_FALSE(a.contains(P{4, 0, 3}));
+
+    CHECK(a.center() == P{2, 1, 1});
+    CHECK(a.extent()[0] == 4);
+
+    auto grown = Box{};
+    grown.extend(b).extend(P{0, 5, 0});
+    CHECK(grown == Box{P{0, 1, -1}, P{6, 5, 1}});
+}
+
+std::vector<Box3<float>> randomBoxes(size_t count, float size, std::uint32_t seed)
+{
+    // Drawn separately from the corners, so that sizes do not follow them.
+    auto random = std::mt19937{~seed};
+    auto extent = std::uniform_real_distribution<float>{0.f, size};
+    std::vector<Box3<float>> boxes;
+    for (const auto& p : test::randomPoints<Point3<float>>(count, 100.f, seed)) {
+        boxes.emplace_back(
+            p, p + Vector3<float>{extent(random), extent(random), extent(random)});
+    }
+    return boxes;
+}
+
+std::vector<std::pair<size_t, size_t>> bruteForcePairs(
+    const std::vector<Box3<float>>& boxes)
+{
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t i = 0; i < boxes.size(); i++) {
+        for (size_t j = i + 1; j < boxes.size(); j++) {
+            if (boxes[i].overlaps(boxes[j])) {
+                pairs.emplace_back(i, j);
+            }
+        }
+    }
+    return pairs;
+}
+
+// Closest hit by intersecting every box with the slab method, with the same
+// rounding as the tree.
+std::optional<std::pair<size_t, float>> bruteForceRaycast(
+    const std::vector<Box3<float>>& boxes, const ve::Ray<XYZModel, float>& ray)
+{
+    std::optional<std::pair<size_t, float>> closest;
+    for (size_t i = 0; i < boxes.size(); i++) {
+        float near = 0;
+        float far = std::numeric_limits<float>::infinity();
+        for (size_t c = 0; c < 3; c++) {
+            float inverse = 1 / ray.direction[c];
+            float a = (boxes[i].min[c] - ray.origin[c]) * inverse;
+            float b = (boxes[i].max[c] - ray.origin[c]) * inverse;
+            near = std::max(near, std::min(a, b));
+            far = std::min(far, std::max(a, b));
+        }
+        if (near <= far && (!closest || near < closest->second)) {
+            closest = std::pair{i, near};
+        }
+    }
+    return closest;
+}
+
+std::vector<size_t> sorted(std::vector<size_t> values)
+{
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+} // namespace
+
+TEST_CASE("AABB operations")
+{
+    checkBoxOperations<Box3<int>>();
+    checkBoxOperations<Box3<float>>();
+    checkBoxOperations<Box3<double>>();
+    checkBoxOperations<PaddedBox3<float>>();
+    checkBoxOperations<PaddedBox3<int>>();
+    checkBoxOperations<PaddedBox3<double>>();
+
+    constexpr auto box = ve::merge(
+        Box3<int>{Point3<int>{0, 0, 0}, Point3<int>{1, 1, 1}},
+        Box3<int>{Point3<int>{2, 2, 2}, Point3<int>{3, 3, 3}});
+    static_assert(box.contains(Point3<int>{3, 0, 2}));
+    static_assert(box.overlaps(Box3<int>{Point3<int>{3, 3, 3}, Point3<int>{4, 4, 4}}));
+
+    constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+    auto padded = PaddedBox3<float>{PaddedPoint3<float>{0, 0, 0}, {1, 1, 1}};
+    CHECK_FALSE(padded.contains(PaddedPoint3<float>{nan, 0, 0}));
+    CHECK(padded.extend(PaddedPoint3<float>{nan, 0, 0}) ==
+        PaddedBox3<float>{PaddedPoint3<float>{0, 0, 0}, {1, 1, 1}});
+}
+
+TEST_CASE("BVH overlap queries match brute force")
+{
+    auto boxes = randomBoxes(3000, 8.f, 1);
+    auto queries = randomBoxes(100, 20.f, 2);
+    auto pool = ve::ThreadPool{4};
+
+    for (auto options : {
+            ve::BvhOptions{},
+            ve::BvhOptions{.leafSize = 1, .binCount = 4},
+            ve::BvhOptions{.leafSize = 16, .binCount = 32, .pool = &pool}}) {
+        auto bvh = ve::Bvh<XYZModel, float>{boxes, options};
+        REQUIRE(bvh.size() == boxes.size());
+        CHECK(bvh.nodes()[0].box.contains(ve::merge(boxes[0], boxes[1])));
+
+        size_t leafBoxes = 0;
+        for (const auto& node : bvh.nodes()) {
+            if (node.leaf()) {
+                leafBoxes += node.count;
+            }
+        }
+        CHECK(leafBoxes == boxes.size());
+
+        auto batched = bvh.overlapping(queries, pool);
+        for (size_t q = 0; q < queries.size(); q++) {
+            std::vector<size_t> expected;
+            for (size_t i = 0; i < boxes.size(); i++) {
+                if (boxes[i].overlaps(queries[q])) {
+                    expected.push_back(i);
+                }
+            }
+            CHECK(sorted(bvh.overlapping(queries[q])) == expected);
+            CHECK(sorted(batched[q]) == expected);
+        }
+
+        CHECK(bvh.overlappingPairs(pool) == bruteForcePairs(boxes));
+    }
+}
+
+TEST_CASE("BVH handles coincident and degenerate boxes")
+{
+    std::vector<Box3<float>> boxes(100, Box3<float>{{1, 1, 1}, {1, 1, 1}});
+    boxes.push_back({{0, 0, 0}, {0, 5, 0}});
+    auto bvh = ve::Bvh<XYZModel, float>{boxes, {.leafSize = 2}};
+    CHECK(bvh.overlapping(Box3<float>{{1, 1, 1}, {2, 2, 2}}).size() == 100);
+    CHECK(bvh.overlapping(Box3<float>{{0, 4, 0}, {0, 4, 0}}) == std::vector<size_t>{100});
+    CHECK(bvh.overlappingPairs().size() == 100 * 99 / 2);
+
+    auto empty = ve::Bvh<XYZModel, float>{std::vector<Box3<float>>{}};
+    CHECK(empty.empty());
+    CHECK(empty.overlapping(boxes[0]).empty());
+    CHECK(empty.overlappingPairs().empty());
+    CHECK_FALSE(empty.raycast({{0, 0, 0}, {1, 0, 0}}));
+}
+
+TEST_CASE("BVH ray casts match brute force")
+{
+    auto boxes = randomBoxes(2000, 5.f, 3);
+    auto pool = ve::ThreadPool{4};
+    auto bvh = ve::Bvh<XYZModel, float>{boxes, {.pool = &pool}};
+
+    const auto origins = test::randomPoints<Point3<float>>(200, 120.f, 4);
+    const auto directions = test::randomPoints<Point3<float>>(200, 120.f, 5);
+    std::vector<ve::Ray<XYZModel, float>> rays;
+    for (size_t i = 0; i < origins.size(); i++) {
+        rays.push_back({origins[i], directions[i] - Point3<float>{}});
+    }
+    // Axis-parallel rays have zero direction components.
+    rays.push_back({{-150, 0, 0}, {1, 0, 0}});
+    rays.push_back({{0, -150, 0}, {0, 1, 0}});
+
+    auto batched = bvh.raycast(rays, std::numeric_limits<float>::infinity(), pool);
+    for (size_t r = 0; r < rays.size(); r++) {
+        auto expected = bruteForceRaycast(boxes, rays[r]);
+        auto hit = bvh.raycast(rays[r]);
+        REQUIRE(hit.has_value() == expected.has_value());
+        REQUIRE(batched[r].has_value() == expected.has_value());
+        if (hit) {
+            CHECK(hit->distance == expected->second);
+            CHECK(boxes[hit->index].min == boxes[expected->first].min);
+            CHECK(batched[r]->distance == hit->distance);
+        }
+    }
+
+    // Limiting the distance, and custom intersection that ignores even boxes;
+    // the ray ends in box 1, so it hits an odd box.
+    auto origin = Point3<float>{-150, -150, -150};
+    auto ray = ve::Ray<XYZModel, float>{origin, boxes[1].center() - origin};
+    auto first = bvh.raycast(ray);
+    REQUIRE(first);
+    CHECK_FALSE(bvh.raycast(ray, first->distance * 0.99f));
+    auto odd = bvh.raycast(ray, std::numeric_limits<float>::infinity(),
+        [] (size_t index, float entry, float) {
+            return index % 2 == 1 ? std::optional{entry} : std::nullopt;
+        });
+    REQUIRE(odd);
+    CHECK(odd->index % 2 == 1);
+    CHECK(odd->distance >= first->distance);
+}
+
+TEST_CASE("BVH refits moved boxes")
+{
+    auto boxes = randomBoxes(1000, 8.f, 5);
+    auto bvh = ve::Bvh<XYZModel, float>{boxes};
+    for (auto& box : boxes) {
+        box.min += Vector3<float>{3, -2, 1};
+        box.max += Vector3<float>{3, -2, 1};
+    }
+    boxes[7] = Box3<float>{{500, 500, 500}, {501, 501, 501}};
+    bvh.refit(boxes);
+
+    CHECK(bvh.nodes()[0].box.contains(boxes[7]));
+    CHECK(bvh.overlapping(Box3<float>{{500, 500, 500}, {500, 500, 500}}) ==
+        std::vector<size_t>{7});
+    CHECK(bvh.overlappingPairs() == bruteForcePairs(boxes));
+}
@@ -0,0 +1,262 @@
+#include <ve.hpp>
+#include <ve/kmeans.hpp>
+#include <ve/stream.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+
+namespace {
+
+template <class T>
+const std::vector<Point3<T>> blobCenters = {
+    {0, 0, 0}, {100, 0, 0}, {0, 100, 0}, {0, 0, 100}, {100, 100, 100}};
+
+// Points around each blob center in turn, spread by a few units.
+template <class T>
+std::vector<Point3<T>> blobs(size_t count, std::uint32_t seed)
+{
+    auto random = std::mt19937{seed};
+    auto offset = std::normal_distribution<T>{0, 3};
+    std::vector<Point3<T>> points;
+    for (size_t i = 0; i < count; i++) {
+        const auto& center = blobCenters<T>[i % blobCenters<T>.size()];
+        points.push_back({
+            center[0] + offset(random),
+            center[1] + offset(random),
+            center[2] + offset(random)});
+    }
+    return points;
+}
+
+template <class T>
+std::vector<Point3<T>> uniformPoints(size_t count, std::uint32_t seed)
+{
+    auto random = std::mt19937{seed};
+    auto coordinate = std::uniform_real_distribution<T>{-10, 10};
+    std::vector<Point3<T>> points;
+    for (size_t i = 0; i < count; i++) {
+        points.push_back({coordinate(random), coordinate(random), coordinate(random)});
+    }
+    return points;
+}
+
+template <class T>
+T squaredDistance(const Point3<T>& a, const Point3<T>& b)
+{
+    T sum = 0;
+    for (size_t c = 0; c < 3; c++) {
+        sum += (a[c] - b[c]) * (a[c] - b[c]);
+    }
+    return sum;
+}
+
+template <class T>
+size_t nearest(const Point3<T>& point, const std::vector<Point3<T>>& centers)
+{
+    size_t best = 0;
+    for (size_t j = 1; j < centers.size(); j++) {
+        if (squaredDistance(point, centers[j]) < squaredDistance(point, centers[best])) {
+            best = j;
+        }
+    }
+    return best;
+}
+
+// Plain Lloyd iterations until no point changes cluster.
+std::vector<std::uint32_t> lloyd(
+    const std::vector<Point3<double>>& points, std::vector<Point3<double>> centers)
+{
+    std::vector<std::uint32_t> labels(points.size(), 0);
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = 0; i < points.size(); i++) {
+            auto label = static_cast<std::uint32_t>(nearest(points[i], centers));
+            changed |= label != labels[i];
+            labels[i] = label;
+        }
+        std::vector<Point3<double>> sums(centers.size(), {0, 0, 0});
+        std::vector<size_t> counts(centers.size(), 0);
+        for (size_t i = 0; i < points.size(); i++) {
+            for (size_t c = 0; c < 3; c++) {
+                sums[labels[i]][c] += points[i][c];
+            }
+            counts[labels[i]]++;
+        }
+        for (size_t j = 0; j < centers.size(); j++) {
+            for (size_t c = 0; c < 3 && counts[j] > 0; c++) {
+                centers[j][c] = sums[j][c] / static_cast<double>(counts[j]);
+            }
+        }
+    }
+    return labels;
+}
+
+// Every blob center has a cluster center within the given distance.
+template <class T>
+bool findsBlobs(const std::vector<Point3<T>>& centers, T distance)
+{
+    for (const auto& blob : blobCenters<T>) {
+        if (squaredDistance(centers[nearest(blob, centers)], blob) >
+                distance * distance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class T>
+void checkBlobs()
+{
+    auto points = blobs<T>(5000, 1);
+    auto result = ve::kmeans(points, 5);
+    REQUIRE(result.centers.size() == 5);
+    REQUIRE(result.labels.size() == points.size());
+    CHECK(result.converged);
+    CHECK(findsBlobs<T>(result.centers, 1));
+
+    // Each label is the nearest center, and each center the mean of its
+    // points.
+    double inertia = 0;
+    std::vector<Point3<double>> sums(5, {0, 0, 0});
+    std::vector<size_t> counts(5, 0);
+    for (size_t i = 0; i < points.size(); i++) {
+        CHECK(result.labels[i] == nearest(points[i], result.centers));
+        inertia += squaredDistance(points[i], result.centers[result.labels[i]]);
+        for (size_t c = 0; c < 3; c++) {
+            sums[result.labels[i]][c] += points[i][c];
+        }
+        counts[result.labels[i]]++;
+    }
+    CHECK(std::abs(inertia - result.inertia) <= 1e-4 * inertia);
+    for (size_t j = 0; j < 5; j++) {
+        REQUIRE(counts[j] > 0);
+        for (size_t c = 0; c < 3; c++) {
+            CHECK(std::abs(sums[j][c] / counts[j] - result.centers[j][c]) < 1e-3);
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("k-means finds separated clusters")
+{
+    checkBlobs<float>();
+    checkBlobs<double>();
+
+    auto points = blobs<float>(1000, 2);
+    auto random = ve::kmeans(points, 5, {.init = ve::KMeansInit::Random, .seed = 3});
+    CHECK(random.labels.size() == points.size());
+    CHECK(random.inertia >= ve::kmeans(points, 5).inertia * 0.999);
+}
+
+TEST_CASE("k-means matches plain Lloyd iterations")
+{
+    auto points = uniformPoints<double>(3000, 4);
+    for (size_t k : {1, 2, 7, 40}) {
+        INFO(k);
+        auto initial = ve::kmeansPlusPlus(points, k, 5);
+        REQUIRE(initial.size() == k);
+        auto result = ve::kmeans(points, initial);
+        CHECK(result.converged);
+        CHECK(result.labels == lloyd(points, initial));
+    }
+
+    auto limited = ve::kmeans(points, 7, {.maxIterations = 2});
+    CHECK(limited.iterations == 2);
+    CHECK_FALSE(limited.converged);
+    auto loose = ve::kmeans(points, 7, {.tolerance = 1});
+    CHECK(loose.converged);
+    CHECK(loose.iterations < ve::kmeans(points, 7).iterations);
+    for (size_t i = 0; i < points.size(); i++) {
+        CHECK(limited.labels[i] == nearest(points[i], limited.centers));
+        CHECK(loose.labels[i] == nearest(points[i], loose.centers));
+    }
+}
+
+TEST_CASE("k-means results do not depend on the thread pool")
+{
+    auto points = uniformPoints<float>(100000, 6);
+    auto serial = ve::ThreadPool{1};
+    auto parallel = ve::ThreadPool{4};
+    for (auto init : {ve::KMeansInit::PlusPlus, ve::KMeansInit::Random}) {
+        const auto options = ve::KMeansOptions{.init = init, .seed = 7};
+        auto a = ve::kmeans(points, 16, options, serial);
+        auto b = ve::kmeans(points, 16, options, parallel);
+        CHECK(a.centers == b.centers);
+        CHECK(a.labels == b.labels);
+        CHECK(a.inertia == b.inertia);
+        CHECK(a.iterations == b.iterations);
+    }
+    CHECK(ve::kmeans(points, 16, {.seed = 1}).centers !=
+        ve::kmeans(points, 16, {.seed = 2}).centers);
+
+    std::vector<std::uint32_t> labels(points.size());
+    auto result = ve::kmeans(points, 16, {.seed = 7}, parallel);
+    ve::nearestCenters(points, result.centers, labels, parallel);
+    CHECK(labels == result.labels);
+}
+
+TEST_CASE("k-means handles duplicate points")
+{
+    std::vector<Point3<double>> points(10, {1, 2, 3});
+    points.push_back({4, 5, 6});
+
+    auto centers = ve::kmeansPlusPlus(points, 3);
+    REQUIRE(centers.size() == 3);
+    auto result = ve::kmeans(points, 3);
+    CHECK(result.converged);
+    CHECK(result.inertia == 0);
+    CHECK(result.labels[0] == result.labels[9]);
+    CHECK(result.labels[0] != result.labels[10]);
+
+    auto single = ve::kmeans(std::vector<Point3<double>>{{1, 1, 1}}, 1);
+    CHECK(single.centers == std::vector<Point3<double>>{{1, 1, 1}});
+    CHECK(single.labels == std::vector<std::uint32_t>{0});
+}
+
+TEST_CASE("Mini-batch k-means over batches and streams")
+{
+    auto points = blobs<float>(20000, 8);
+
+    auto batches = ve::MiniBatchKMeans<XYZModel, float>{5, 9};
+    for (size_t start = 0; start < points.size(); start += 1000) {
+        batches.update(std::span{points}.subspan(start, 1000));
+    }
+    REQUIRE(batches.centers().size() == 5);
+    CHECK(findsBlobs<float>(batches.centers(), 1));
+    size_t total = 0;
+    for (auto count : batches.counts()) {
+        total += count;
+    }
+    CHECK(total == points.size());
+
+    // The pipeline sees the same batches, so it gets the same centers.
+    auto streamed = ve::MiniBatchKMeans<XYZModel, float>{5, 9};
+    auto pipeline = ve::StreamPipeline<Point3<float>>{{.batchSize = 1000}};
+    pipeline.run(ve::SpanSource<Point3<float>>{points}, streamed);
+    CHECK(streamed.centers() == batches.centers());
+
+    // Fewer points than 3k are only clustered by finish().
+    auto few = ve::MiniBatchKMeans<XYZModel, float>{5};
+    few.update(std::span{points}.first(12));
+    CHECK(few.centers().empty());
+    few.finish();
+    CHECK(few.centers().size() == 5);
+
+    auto seeded = ve::MiniBatchKMeans<XYZModel, float>{blobCenters<float>};
+    seeded.update(points);
+    CHECK(findsBlobs<float>(seeded.centers(), 0.5f));
+}
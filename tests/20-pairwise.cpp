@@ -0,0 +1,182 @@
+#include <ve.hpp>
+#include <ve/pairwise.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "random_points.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+
+namespace {
+
+// Random points rounded to eighths.
+template <class T>
+std::vector<Point3<T>> gridPoints(size_t count, std::uint32_t seed)
+{
+    auto points = test::randomPoints<Point3<T>>(count, 125, seed);
+    for (auto& point : points) {
+        for (size_t c = 0; c < 3; c++) {
+            point[c] = std::round(point[c] * 8) / 8;
+        }
+    }
+    return points;
+}
+
+// Squared distance in the same order of operations as the kernels.
+template <class R, class T>
+R squaredDistance(const Point3<T>& a, const Point3<T>& b)
+{
+    R sum = 0;
+    for (size_t c = 0; c < 3; c++) {
+        const R d = static_cast<R>(a[c]) - static_cast<R>(b[c]);
+        sum += d * d;
+    }
+    return sum;
+}
+
+template <class T>
+std::vector<std::pair<size_t, size_t>> bruteForcePairs(
+    const std::vector<Point3<T>>& lhs, const std::vector<Point3<T>>& rhs, double radius)
+{
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t i = 0; i < lhs.size(); i++) {
+        for (size_t j = 0; j < rhs.size(); j++) {
+            if (squaredDistance<double>(lhs[i], rhs[j]) <= radius * radius) {
+                pairs.emplace_back(i, j);
+            }
+        }
+    }
+    return pairs;
+}
+
+template <class T>
+void checkMatrices()
+{
+    // Sizes that leave partial blocks of rows and tiles of columns.
+    auto lhs = gridPoints<T>(75, 1);
+    auto rhs = gridPoints<T>(1100, 2);
+    auto pool = ve::ThreadPool{4};
+
+    std::vector<T> squares(lhs.size() * rhs.size());
+    std::vector<T> distances(squares.size());
+    std::vector<T> fast(squares.size());
+    ve::pairwiseSquaredDistances(lhs, rhs, squares, pool);
+    ve::pairwiseDistances(lhs, rhs, distances);
+    ve::pairwiseDistances(lhs, rhs, fast, ve::Precision::Fast, pool);
+    for (size_t i = 0; i < lhs.size(); i++) {
+        for (size_t j = 0; j < rhs.size(); j++) {
+            const auto expected = squaredDistance<T>(lhs[i], rhs[j]);
+            const size_t k = i * rhs.size() + j;
+            CHECK(squares[k] == expected);
+            CHECK(distances[k] == std::sqrt(expected));
+            CHECK(std::abs(fast[k] - distances[k]) <= std::ldexp(distances[k], -21));
+        }
+    }
+
+    // The same as squaredDistances() on one row.
+    std::vector<Point3<T>> row(rhs.size(), lhs[3]);
+    std::vector<T> batch(rhs.size());
+    ve::squaredDistances(row, rhs, batch);
+    CHECK(std::vector<T>(squares.begin() + 3 * rhs.size(),
+        squares.begin() + 4 * rhs.size()) == batch);
+
+    // Every instruction set gives the same exact results.
+    const auto initial = ve::activeIsa();
+    for (auto isa : {ve::Isa::Baseline, ve::Isa::Avx2, ve::Isa::Avx512}) {
+        if (isa > ve::supportedIsa()) {
+            continue;
+        }
+        INFO(ve::name(isa));
+        ve::setIsa(isa);
+        std::vector<T> other(squares.size());
+        ve::pairwiseDistances(lhs, rhs, other, ve::Precision::Exact, pool);
+        CHECK(other == distances);
+    }
+    ve::setIsa(initial);
+}
+
+} // namespace
+
+TEST_CASE("Pairwise distance matrices")
+{
+    checkMatrices<float>();
+    checkMatrices<double>();
+
+    // Integer points with a floating-point matrix.
+    auto points = std::vector<Point3<int>>{{0, 0, 0}, {3, 4, 0}, {1, 2, 2}};
+    std::vector<double> matrix(9);
+    ve::pairwiseDistances(points, points, matrix);
+    const double d = std::sqrt(12.0);
+    CHECK(matrix == std::vector<double>{0, 5, 3, 5, 0, d, 3, d, 0});
+
+    std::vector<float> empty;
+    ve::pairwiseSquaredDistances(std::vector<Point3<float>>{}, points, empty);
+    ve::pairwiseSquaredDistances(points, std::vector<Point3<int>>{}, empty);
+}
+
+TEST_CASE("Pairs within a radius match brute force")
+{
+    auto lhs = gridPoints<float>(300, 3);
+    auto rhs = gridPoints<float>(1500, 4);
+    auto expected = bruteForcePairs(lhs, rhs, 20);
+    REQUIRE(expected.size() > 100);
+
+    auto serial = ve::ThreadPool{1};
+    auto parallel = ve::ThreadPool{4};
+    for (auto* pool : {&serial, &parallel}) {
+        std::vector<std::pair<size_t, size_t>> pairs(expected.size() + 5);
+        const size_t count = ve::pairsWithinRadius(lhs, rhs, 20.f, pairs, *pool);
+        REQUIRE(count == expected.size());
+        pairs.resize(count);
+        CHECK(pairs == expected);
+    }
+
+    // A buffer that is too small gets the first pairs and the total.
+    std::vector<std::pair<size_t, size_t>> few(10);
+    CHECK(ve::pairsWithinRadius(lhs, rhs, 20.f, few) == expected.size());
+    CHECK(few == std::vector(expected.begin(), expected.begin() + 10));
+    CHECK(ve::pairsWithinRadius(lhs, rhs, 20.f, {}) == expected.size());
+
+    // Points exactly at the radius are included.
+    auto points = std::vector<Point3<int>>{{0, 0, 0}, {3, 4, 0}, {10, 0, 0}};
+    std::vector<std::pair<size_t, size_t>> pairs(9);
+    CHECK(ve::pairsWithinRadius(points, points, 5, pairs) == 5);
+    CHECK(ve::pairsWithinRadius(points, 5, pairs) == 1);
+    CHECK(pairs[0] == std::pair<size_t, size_t>{0, 1});
+
+    // A negative radius finds nothing, even for coincident points.
+    CHECK(ve::pairsWithinRadius(points, points, -1, pairs) == 0);
+    CHECK(ve::pairsWithinRadius(points, -5, pairs) == 0);
+    CHECK(ve::pairsWithinRadius(lhs, lhs, -0.5f, pairs) == 0);
+}
+
+TEST_CASE("Pairs within a radius of each other in one set")
+{
+    auto points = gridPoints<double>(1200, 5);
+    std::vector<std::pair<size_t, size_t>> expected;
+    for (auto [i, j] : bruteForcePairs(points, points, 15)) {
+        if (i < j) {
+            expected.emplace_back(i, j);
+        }
+    }
+    REQUIRE(expected.size() > 100);
+
+    auto pool = ve::ThreadPool{4};
+    std::vector<std::pair<size_t, size_t>> pairs(expected.size());
+    CHECK(ve::pairsWithinRadius(points, 15, pairs, pool) == expected.size());
+    CHECK(pairs == expected);
+
+    std::vector<Point3<double>> single = {{1, 1, 1}};
+    CHECK(ve::pairsWithinRadius(single, 100, pairs) == 0);
+    CHECK(ve::pairsWithinRadius(std::vector<Point3<double>>{}, 100, pairs) == 0);
+}
@@ -0,0 +1,169 @@
+#include <ve.hpp>
+#include <ve/aggregated_values.hpp>
+#include <ve/algorithms.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+template <class T> using Vector3 = ve::Vector<XYZModel, T>;
+
+namespace {
+
+template <class V>
+V randomValue(std::mt19937& random)
+{
+    auto coordinate = std::uniform_int_distribution<int>{-1000, 1000};
+    V value;
+    for (size_t c = 0; c < 3; c++) {
+        value[c] = static_cast<typename ve::internal::ValueTraits<V>::value_type>(
+            coordinate(random));
+    }
+    return value;
+}
+
+template <class V>
+auto asPoint(const V& value)
+{
+    Point3<typename ve::internal::ValueTraits<V>::value_type> point;
+    for (size_t c = 0; c < 3; c++) {
+        point[c] = value[c];
+    }
+    return point;
+}
+
+// The aggregates match a pass over the values, and are the same bit for bit
+// as those of a collection built from the values at once.
+template <class V>
+void checkAggregates(const ve::AggregatedValues<V>& values)
+{
+    const auto rebuilt = ve::AggregatedValues<V>{values.values()};
+    CHECK(values.sum() == rebuilt.sum());
+    CHECK(values.mean() == rebuilt.mean());
+    CHECK(values.bounds() == rebuilt.bounds());
+
+    typename ve::AggregatedValues<V>::sum_type expected = {};
+    auto box = typename ve::AggregatedValues<V>::box_type{};
+    for (const auto& value : values.values()) {
+        for (size_t c = 0; c < 3; c++) {
+            expected[c] += value[c];
+        }
+        box.extend(asPoint(value));
+    }
+    CHECK(values.bounds() == box);
+    for (size_t c = 0; c < 3; c++) {
+        CHECK(std::abs(values.sum()[c] - expected[c]) <=
+            1e-6 * static_cast<double>(values.size()) * 1000);
+    }
+}
+
+template <class V>
+void checkMutations()
+{
+    auto random = std::mt19937{1};
+    auto values = ve::AggregatedValues<V>{};
+    CHECK(values.empty());
+    CHECK(values.bounds().empty());
+    CHECK(values.sum() == typename ve::AggregatedValues<V>::sum_type{});
+    CHECK(values.mean() == typename ve::AggregatedValues<V>::mean_type{});
+
+    for (int i = 0; i < 1000; i++) {
+        CHECK(values.insert(randomValue<V>(random)) == static_cast<size_t>(i));
+    }
+    checkAggregates(values);
+
+    auto pick = [&] {
+        return std::uniform_int_distribution<size_t>{0, values.size() - 1}(random);
+    };
+    for (int step = 0; step < 3000; step++) {
+        switch (step % 3) {
+        case 0:
+            values.insert(randomValue<V>(random));
+            break;
+        case 1:
+            values.update(pick(), randomValue<V>(random));
+            break;
+        case 2: {
+            const size_t index = pick();
+            const auto last = values[values.size() - 1];
+            values.erase(index);
+            if (index < values.size()) {
+                CHECK(values[index] == last);
+            }
+            break;
+        }
+        }
+        if (step % 250 == 0) {
+            checkAggregates(values);
+        }
+    }
+    REQUIRE(values.size() == 1000);
+    checkAggregates(values);
+
+    // Erasing everything, down to the empty aggregates.
+    while (values.size() > 1) {
+        values.erase(0);
+    }
+    const auto single = values[0];
+    CHECK(values.bounds().min == asPoint(single));
+    CHECK(values.bounds().max == asPoint(single));
+    values.erase(0);
+    CHECK(values.bounds().empty());
+    CHECK(values.sum() == typename ve::AggregatedValues<V>::sum_type{});
+
+    values.insert(single);
+    values.clear();
+    CHECK(values.empty());
+    CHECK(values.bounds().empty());
+}
+
+} // namespace
+
+TEST_CASE("Aggregates follow insertions, erasures and updates")
+{
+    checkMutations<Point3<float>>();
+    checkMutations<Point3<double>>();
+    checkMutations<Point3<int>>();
+    checkMutations<Vector3<float>>();
+    checkMutations<Vector3<std::int16_t>>();
+}
+
+TEST_CASE("Aggregates match the algorithms on all values")
+{
+    auto random = std::mt19937{2};
+    std::vector<Point3<double>> points;
+    for (int i = 0; i < 5000; i++) {
+        points.push_back(randomValue<Point3<double>>(random));
+    }
+    auto values = ve::AggregatedValues<Point3<double>>{points};
+    REQUIRE(values.size() == points.size());
+    CHECK(values.bounds() == ve::bounds(points));
+
+    const auto centroid = ve::centroid(points);
+    for (size_t c = 0; c < 3; c++) {
+        CHECK(std::abs(values.centroid()[c] - centroid[c]) <= 1e-9);
+    }
+
+    // Integer points are summed in double.
+    auto integers = ve::AggregatedValues<Point3<int>>{};
+    integers.insert({1, 2, 3});
+    integers.insert({2, 2, 2});
+    CHECK(integers.centroid() == Point3<double>{1.5, 2, 2.5});
+    CHECK(integers.sum() == Vector3<double>{3, 4, 5});
+
+    // Reserving keeps the values and their aggregates.
+    values.reserve(100000);
+    CHECK(values.size() == points.size());
+    CHECK(values.bounds() == ve::bounds(points));
+    values.update(7, {5000, 0, 0});
+    CHECK(values.bounds().max[0] == 5000);
+}
@@ -0,0 +1,180 @@
+#include <ve.hpp>
+#include <ve/ring_buffer.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <thread>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+template <class T> using Vector3 = ve::Vector<XYZModel, T>;
+
+namespace {
+
+// Points that identify their producer and their place in its sequence,
+// exactly representable in float.
+Point3<float> sample(size_t producer, size_t index)
+{
+    return {static_cast<float>(producer), static_cast<float>(index), 1};
+}
+
+// Pushes count samples in batches of random size, retrying what does not
+// fit.
+void produce(ve::RingBuffer<Point3<float>>& buffer, size_t producer, size_t count)
+{
+    auto random = std::mt19937{static_cast<std::uint32_t>(producer)};
+    auto size = std::uniform_int_distribution<size_t>{1, 40};
+    std::vector<Point3<float>> batch;
+    for (size_t next = 0; next < count;) {
+        batch.clear();
+        for (size_t i = size(random); i > 0 && next < count; i--) {
+            batch.push_back(sample(producer, next++));
+        }
+        for (auto rest = std::span<const Point3<float>>{batch}; !rest.empty();) {
+            rest = rest.subspan(buffer.push(rest));
+            if (!rest.empty()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("Ring buffer pushes and pops in order")
+{
+    auto buffer = ve::RingBuffer<Vector3<int>>{6};
+    CHECK(buffer.capacity() == 8);
+    CHECK(buffer.empty());
+    CHECK_FALSE(buffer.pop());
+
+    CHECK(buffer.push(Vector3<int>{1, 2, 3}));
+    CHECK(buffer.size() == 1);
+    CHECK(buffer.pop() == Vector3<int>{1, 2, 3});
+
+    // Batches wrap around the end of the ring, and only what fits is pushed.
+    std::vector<Vector3<int>> values;
+    for (int i = 0; i < 10; i++) {
+        values.push_back({i, -i, 2 * i});
+    }
+    CHECK(buffer.push(std::span{values}.first(5)) == 5);
+    std::vector<Vector3<int>> popped(3);
+    CHECK(buffer.pop(std::span{popped}) == 3);
+    CHECK(popped == std::vector(values.begin(), values.begin() + 3));
+    CHECK(buffer.push(std::span{values}.subspan(5)) == 5);
+    CHECK(buffer.size() == 7);
+    CHECK(buffer.push(std::span{values}.first(2)) == 1);
+    CHECK(buffer.size() == 8);
+    CHECK_FALSE(buffer.push(values[0]));
+
+    // Draining appends everything in order.
+    std::vector<Vector3<int>> drained = {{7, 7, 7}};
+    CHECK(buffer.drain(drained) == 8);
+    CHECK(drained.size() == 9);
+    CHECK(drained[0] == Vector3<int>{7, 7, 7});
+    CHECK(std::vector(drained.begin() + 1, drained.end() - 1) ==
+        std::vector(values.begin() + 3, values.end()));
+    CHECK(drained.back() == values[0]);
+    CHECK(buffer.empty());
+    CHECK(buffer.drain(drained) == 0);
+    CHECK(buffer.pop(std::span{popped}) == 0);
+}
+
+TEST_CASE("Ring buffer with several producers and one consumer")
+{
+    constexpr size_t producers = 4;
+    constexpr size_t count = 20000;
+    auto buffer = ve::RingBuffer<Point3<float>>{256};
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; p++) {
+        threads.emplace_back([&buffer, p] { produce(buffer, p, count); });
+    }
+
+    // Each producer's samples arrive in the order they were pushed.
+    std::vector<size_t> next(producers, 0);
+    std::vector<Point3<float>> drained;
+    bool ordered = true;
+    for (size_t received = 0; received < producers * count;) {
+        drained.clear();
+        if (buffer.drain(drained) == 0) {
+            std::this_thread::yield();
+        }
+        for (const auto& point : drained) {
+            const auto p = static_cast<size_t>(point[0]);
+            ordered &= point == sample(p, next[p]);
+            next[p]++;
+        }
+        received += drained.size();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    CHECK(ordered);
+    CHECK(next == std::vector<size_t>(producers, count));
+    CHECK(buffer.empty());
+}
+
+TEST_CASE("Ring buffer with several producers and consumers")
+{
+    constexpr size_t producers = 3;
+    constexpr size_t consumers = 3;
+    constexpr size_t count = 20000;
+    auto buffer = ve::RingBuffer<Point3<float>>{100};
+
+    std::atomic<size_t> received = 0;
+    std::vector<std::vector<Point3<float>>> popped(consumers);
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; p++) {
+        threads.emplace_back([&buffer, p] { produce(buffer, p, count); });
+    }
+    for (size_t c = 0; c < consumers; c++) {
+        threads.emplace_back([&, c] {
+            std::vector<Point3<float>> batch(1 + 17 * c);
+            while (received.load() < producers * count) {
+                const size_t n = buffer.pop(std::span{batch});
+                popped[c].insert(popped[c].end(), batch.begin(), batch.begin() + n);
+                received += n;
+                if (n == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Every sample was popped exactly once, and each consumer saw each
+    // producer's samples in order.
+    std::vector<std::vector<bool>> seen(producers, std::vector<bool>(count, false));
+    bool once = true;
+    bool ordered = true;
+    for (const auto& points : popped) {
+        std::vector<float> last(producers, -1);
+        for (const auto& point : points) {
+            const auto p = static_cast<size_t>(point[0]);
+            const auto i = static_cast<size_t>(point[1]);
+            once &= !seen[p][i];
+            seen[p][i] = true;
+            ordered &= point[1] > last[p];
+            last[p] = point[1];
+        }
+    }
+    CHECK(once);
+    CHECK(ordered);
+    for (const auto& flags : seen) {
+        CHECK(std::all_of(flags.begin(), flags.end(), [] (bool b) { return b; }));
+    }
+    CHECK(buffer.empty());
+}
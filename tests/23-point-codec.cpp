@@ -0,0 +1,304 @@
+#include <ve.hpp>
+#include <ve/point_codec.hpp>
+#include <ve/stream.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+template <class T> struct XYModel {
+    T x;
+    T y;
+};
+template <class T> using Point3 = ve::Point<XYZModel, T>;
+
+namespace {
+
+// A random walk with steps of up to step in each component, like a sampled
+// trajectory.
+template <class T>
+std::vector<Point3<T>> trajectory(size_t count, double step, std::uint32_t seed)
+{
+    auto random = std::mt19937{seed};
+    auto offset = std::uniform_real_distribution<double>{-step, step};
+    std::vector<Point3<T>> points;
+    double position[3] = {100, -50, 10};
+    for (size_t i = 0; i < count; i++) {
+        for (auto& c : position) {
+            c += offset(random);
+        }
+        points.push_back({
+            static_cast<T>(position[0]),
+            static_cast<T>(position[1]),
+            static_cast<T>(position[2])});
+    }
+    return points;
+}
+
+template <class T>
+std::vector<std::byte> encode(
+    const std::vector<Point3<T>>& points,
+    double precision,
+    ve::PointCodecOptions options)
+{
+    std::ostringstream output;
+    auto encoder = ve::PointEncoder<XYZModel, T>{output, precision, options};
+    encoder.write(points);
+    encoder.finish();
+    CHECK(encoder.size() == points.size());
+    const auto text = output.str();
+    CHECK(encoder.bytesWritten() == text.size());
+    const auto* data = reinterpret_cast<const std::byte*>(text.data());
+    return {data, data + text.size()};
+}
+
+template <class T>
+std::vector<Point3<T>> decodeAll(std::span<const std::byte> data)
+{
+    auto decoder = ve::PointDecoder<XYZModel, T>{data};
+    std::vector<Point3<T>> points(decoder.size());
+    decoder.decode(0, points);
+    return points;
+}
+
+// Every component is within half the precision of the original, up to the
+// rounding of the element type.
+template <class T>
+bool withinPrecision(
+    const std::vector<Point3<T>>& decoded,
+    const std::vector<Point3<T>>& points,
+    double precision)
+{
+    if (decoded.size() != points.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < points.size(); i++) {
+        for (size_t c = 0; c < 3; c++) {
+            const double value = points[i][c];
+            const double tolerance = precision / 2 * (1 + 1e-9) +
+                std::abs(value) * std::numeric_limits<T>::epsilon();
+            if (std::abs(decoded[i][c] - value) > tolerance) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <class T>
+void checkRoundTrip(double step, double precision)
+{
+    const auto points = trajectory<T>(1000, step, 1);
+    for (auto encoding : {ve::DeltaEncoding::Varint, ve::DeltaEncoding::BitPacked}) {
+        for (std::uint32_t blockSize : {1u, 7u, 256u, 5000u}) {
+            INFO("block size " << blockSize);
+            const auto data = encode(points, precision, {encoding, blockSize});
+            const auto decoded = decodeAll<T>(data);
+            CHECK(withinPrecision(decoded, points, precision));
+
+            // Both encodings store the same quantized values, and decoding
+            // gives the same results whatever the instruction set.
+            const auto initial = ve::activeIsa();
+            for (auto isa : {ve::Isa::Baseline, ve::Isa::Avx2, ve::Isa::Avx512}) {
+                if (isa > ve::supportedIsa()) {
+                    continue;
+                }
+                INFO(ve::name(isa));
+                ve::setIsa(isa);
+                CHECK(decodeAll<T>(data) == decoded);
+                CHECK(decodeAll<T>(encode(points, precision, {
+                    ve::DeltaEncoding::BitPacked, 64})) == decoded);
+            }
+            ve::setIsa(initial);
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("Point codec round trips within the precision")
+{
+    checkRoundTrip<float>(0.05, 1e-3);
+    checkRoundTrip<double>(0.05, 1e-6);
+    checkRoundTrip<double>(1e6, 0.5);
+
+    // Integer points with a precision of one are stored exactly.
+    auto integers = std::vector<Point3<int>>{
+        {0, 0, 0}, {1, -1, 2}, {1000000, -3, 7},
+        {std::numeric_limits<int>::max(), std::numeric_limits<int>::min(), 0}};
+    for (auto encoding : {ve::DeltaEncoding::Varint, ve::DeltaEncoding::BitPacked}) {
+        CHECK(decodeAll<int>(encode(integers, 1, {encoding, 3})) == integers);
+    }
+
+    // Deltas wider than 32 bits are packed as separate low and high streams.
+    const auto wide = std::vector<Point3<double>>{
+        {-1e15, 1e15, 0}, {1e15, -1e15, 1}, {-1e15, 3, 1e15}, {0, 0, 0}};
+    const auto data = encode(wide, 1e-3, {ve::DeltaEncoding::BitPacked, 16});
+    CHECK(withinPrecision(decodeAll<double>(data), wide, 1e-3));
+}
+
+TEST_CASE("Point codec decodes blocks and ranges at random")
+{
+    const auto points = trajectory<float>(1000, 0.1, 2);
+    const auto data = encode(points, 1e-3, {ve::DeltaEncoding::BitPacked, 64});
+    const auto all = decodeAll<float>(data);
+    auto decoder = ve::PointDecoder<XYZModel, float>{data};
+    CHECK(decoder.size() == 1000);
+    CHECK(decoder.blockSize() == 64);
+    CHECK(decoder.blockCount() == 16);
+    CHECK(decoder.blockPoints(15) == 1000 - 15 * 64);
+    CHECK(decoder.precision() == 1e-3);
+    CHECK(decoder.encoding() == ve::DeltaEncoding::BitPacked);
+
+    std::vector<Point3<float>> block(64);
+    for (size_t b : {15u, 3u, 0u, 9u}) {
+        const size_t count = decoder.decodeBlock(b, block);
+        CHECK(count == decoder.blockPoints(b));
+        CHECK(std::equal(block.begin(), block.begin() + count, all.begin() + b * 64));
+    }
+
+    auto random = std::mt19937{3};
+    for (int i = 0; i < 200; i++) {
+        const size_t first = std::uniform_int_distribution<size_t>{0, 1000}(random);
+        const size_t count =
+            std::uniform_int_distribution<size_t>{0, 1000 - first}(random);
+        std::vector<Point3<float>> range(count);
+        decoder.decode(first, range);
+        CHECK(std::equal(range.begin(), range.end(), all.begin() + first));
+    }
+
+    // Sequential reads from a position.
+    decoder.seek(990);
+    CHECK(decoder.remaining() == 10);
+    std::vector<Point3<float>> tail(100);
+    CHECK(decoder.read(std::span{tail}) == 10);
+    CHECK(std::equal(tail.begin(), tail.begin() + 10, all.begin() + 990));
+    CHECK(decoder.read(std::span{tail}) == 0);
+}
+
+TEST_CASE("Point codec compresses smooth trajectories")
+{
+    // Steps of a few centimetres stored to the millimetre.
+    const auto points = trajectory<float>(100000, 0.05, 4);
+    const double raw = static_cast<double>(points.size() * sizeof(Point3<float>));
+    for (auto encoding : {ve::DeltaEncoding::Varint, ve::DeltaEncoding::BitPacked}) {
+        const auto data = encode(points, 1e-3, {encoding, 256});
+        INFO("compression " << raw / static_cast<double>(data.size()));
+        CHECK(raw / static_cast<double>(data.size()) >= 3.5);
+        CHECK(withinPrecision(decodeAll<float>(data), points, 1e-3));
+    }
+
+    // Points that do not move take a few bytes per block of 256.
+    const auto still = std::vector<Point3<float>>(100000, Point3<float>{1, 2, 3});
+    CHECK(encode(still, 1e-3, {}).size() < 10000);
+}
+
+TEST_CASE("Point codec streams through pipelines")
+{
+    const auto points = trajectory<double>(20000, 0.5, 5);
+    std::ostringstream output;
+    auto encoder = ve::PointEncoder<XYZModel, double>{output, 1e-4, {.blockSize = 128}};
+
+    // Blocks are written as they fill up, not when the stream is finished.
+    encoder.write(std::span{points}.first(1000));
+    const auto written = encoder.bytesWritten();
+    CHECK(written > 7 * 128);
+    CHECK(written == output.str().size());
+
+    auto stats = ve::StreamPipeline<Point3<double>>{{.batchSize = 999}}
+        .run(ve::SpanSource<Point3<double>>{std::span{points}.subspan(1000)}, encoder);
+    CHECK(stats.written == 19000);
+    encoder.finish();
+    CHECK(encoder.size() == 20000);
+
+    const auto text = output.str();
+    const auto data = std::span{reinterpret_cast<const std::byte*>(text.data()), text.size()};
+    auto collect = ve::ReduceSink{std::vector<Point3<double>>{}, [] (auto result, const auto& p) {
+        result.push_back(p);
+        return result;
+    }};
+    stats = ve::StreamPipeline<Point3<double>>{{.batchSize = 1000}}
+        .run(ve::PointDecoder<XYZModel, double>{data}, collect);
+    CHECK(stats.read == 20000);
+    CHECK(withinPrecision(collect.result(), points, 1e-4));
+
+    // An empty stream holds just the header and the trailer.
+    std::ostringstream empty;
+    ve::PointEncoder<XYZModel, float>{empty, 1}.finish();
+    const auto emptyText = empty.str();
+    CHECK(emptyText.size() == sizeof(ve::PointStreamHeader) + sizeof(ve::PointStreamTrailer));
+    auto decoder = ve::PointDecoder<XYZModel, float>{std::span{
+        reinterpret_cast<const std::byte*>(emptyText.data()), emptyText.size()}};
+    CHECK(decoder.size() == 0);
+    CHECK(decoder.blockCount() == 0);
+}
+
+TEST_CASE("Point codec rejects bad input")
+{
+    std::ostringstream output;
+    auto encoder = ve::PointEncoder<XYZModel, float>{output, 1e-3};
+    encoder.write(Point3<float>{1, 2, 3});
+    CHECK_THROWS_AS(
+        encoder.write(Point3<float>{std::numeric_limits<float>::quiet_NaN(), 0, 0}),
+        ve::PointCodecError);
+    CHECK_THROWS_AS(encoder.write(Point3<float>{1e30f, 0, 0}), ve::PointCodecError);
+    CHECK(encoder.size() == 1);
+
+    // Quantized values stay below 2^62 in magnitude, so that the delta
+    // between the two extremes still fits in an int64_t.
+    {
+        const double limit = 4611686018427387904.0;
+        const double below = std::nextafter(limit, 0.0);
+        std::ostringstream bounded;
+        auto doubles = ve::PointEncoder<XYZModel, double>{bounded, 1};
+        CHECK_THROWS_AS(doubles.write(Point3<double>{limit, 0, 0}), ve::PointCodecError);
+        CHECK_THROWS_AS(doubles.write(Point3<double>{0, -limit, 0}), ve::PointCodecError);
+        const auto extremes = std::vector<Point3<double>>{
+            {-below, below, 0}, {below, -below, 0}, {-below, 0, below}};
+        for (auto encoding : {ve::DeltaEncoding::Varint, ve::DeltaEncoding::BitPacked}) {
+            CHECK(decodeAll<double>(encode(extremes, 1, {encoding, 16})) == extremes);
+        }
+    }
+
+    const auto points = trajectory<float>(500, 0.05, 6);
+    for (auto encoding : {ve::DeltaEncoding::Varint, ve::DeltaEncoding::BitPacked}) {
+        const auto data = encode(points, 1e-3, {encoding, 100});
+        using Decoder = ve::PointDecoder<XYZModel, float>;
+        using PlanarDecoder = ve::PointDecoder<XYModel, float>;
+
+        CHECK_THROWS_AS(Decoder{std::span{data}.first(20)}, ve::PointCodecError);
+        CHECK_THROWS_AS(Decoder{std::span{data}.first(data.size() - 1)}, ve::PointCodecError);
+        CHECK_THROWS_AS(PlanarDecoder{data}, ve::PointCodecError);
+        auto wrongMagic = data;
+        wrongMagic[0] = std::byte{'X'};
+        CHECK_THROWS_AS(Decoder{wrongMagic}, ve::PointCodecError);
+
+        // A block cut short by a corrupt index fails when it is decoded.
+        auto shortened = data;
+        const auto indexOffset = data.size() - sizeof(ve::PointStreamTrailer) -
+            5 * sizeof(std::uint64_t);
+        std::uint64_t second;
+        std::memcpy(&second, data.data() + indexOffset + 8, sizeof(second));
+        second = sizeof(ve::PointStreamHeader) + 4;
+        std::memcpy(shortened.data() + indexOffset + 8, &second, sizeof(second));
+        auto decoder = Decoder{shortened};
+        std::vector<Point3<float>> block(100);
+        CHECK_THROWS_AS(decoder.decodeBlock(0, block), ve::PointCodecError);
+        CHECK(decoder.decodeBlock(2, block) == 100);
+    }
+}
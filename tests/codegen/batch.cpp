@@ -0,0 +1,45 @@
+// Batch functions compiled to assembly by the vectorization codegen test.
+// Every AVX2 and AVX-512 version instantiated here must use vector
+// registers of at least 256 bits, or the dispatched kernels have stopped
+// being vectorized.
+
+#include <ve.hpp>
+
+#include <vector>
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+
+using Vector3f = ve::Vector<XYZModel, float>;
+using Point3f = ve::Point<XYZModel, float>;
+using Vector3d = ve::Vector<XYZModel, double>;
+
+void batchAdd(
+    const std::vector<Point3f>& points,
+    const std::vector<Vector3f>& vectors,
+    std::vector<Point3f>& sums)
+{
+    ve::add(points, vectors, sums);
+}
+
+void batchScale(const std::vector<Vector3f>& vectors, std::vector<Vector3f>& scaled)
+{
+    ve::scale(vectors, 3.f, scaled);
+}
+
+void batchSquaredLengths(
+    const std::vector<Vector3d>& vectors, std::vector<double>& squares)
+{
+    ve::squaredLengths(vectors, squares);
+}
+
+void batchSquaredDistances(
+    const std::vector<Point3f>& lhs,
+    const std::vector<Point3f>& rhs,
+    std::vector<float>& squares)
+{
+    ve::squaredDistances(lhs, rhs, squares);
+}
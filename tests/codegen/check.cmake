@@ -0,0 +1,48 @@
+# Compiles kernels.cpp to assembly and fails if any codegen_* function
+# contains a call, which means that an operator was not inlined.
+#
+# Expects COMPILER, SOURCE, INCLUDE_DIR, OUTPUT and FLAGS (space-separated
+# compiler options) to be set with -D on the command line.
+
+separate_arguments(flags UNIX_COMMAND "${FLAGS}")
+
+execute_process(
+    COMMAND ${COMPILER} -std=c++20 ${flags} -I${INCLUDE_DIR} -S -o ${OUTPUT} ${SOURCE}
+    RESULT_VARIABLE result
+    ERROR_VARIABLE errors)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Failed to compile ${SOURCE}:\n${errors}")
+endif()
+
+file(STRINGS ${OUTPUT} lines)
+set(function "")
+set(functions 0)
+set(failures "")
+foreach(line IN LISTS lines)
+    if(line MATCHES "^_?(codegen_[A-Za-z0-9_]+):")
+        set(function ${CMAKE_MATCH_1})
+        set(instructions 0)
+        math(EXPR functions "${functions} + 1")
+    elseif(function STREQUAL "")
+        continue()
+    elseif(line MATCHES "^[ \t]*\\.cfi_endproc" OR line MATCHES "^[ \t]*\\.size[ \t]")
+        message(STATUS "${function}: ${instructions} instructions")
+        set(function "")
+    elseif(line MATCHES "^[ \t]+[a-z]" AND NOT line MATCHES "^[ \t]+\\.")
+        math(EXPR instructions "${instructions} + 1")
+        # Direct and indirect calls, and tail calls to other symbols.
+        if(line MATCHES "^[ \t]+(call|callq|bl|blr|blx)[ \t]"
+                OR line MATCHES "^[ \t]+(jmp|jmpq|b)[ \t]+[A-Za-z_*]")
+            string(STRIP "${line}" call)
+            list(APPEND failures "${function}: ${call}")
+        endif()
+    endif()
+endforeach()
+
+if(functions EQUAL 0)
+    message(FATAL_ERROR "No codegen_* functions found in ${OUTPUT}")
+endif()
+if(failures)
+    list(JOIN failures "\n  " text)
+    message(FATAL_ERROR "Calls in inlined kernels (${FLAGS}):\n  ${text}")
+endif()
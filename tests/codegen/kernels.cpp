@@ -0,0 +1,98 @@
+// Representative Vector and Point expressions, compiled to assembly by the
+// codegen test. Every function named codegen_* must compile without calls,
+// at every optimization level, or the operators have stopped being inlined.
+
+#include <ve.hpp>
+
+template <class T> struct XYModel {
+    T x;
+    T y;
+};
+
+template <class T> struct XYZModel {
+    T x;
+    T y;
+    T z;
+};
+
+template <class T> struct alignas(4 * sizeof(T)) PaddedXYZModel {
+    T x;
+    T y;
+    T z;
+};
+
+using Vector2i = ve::Vector<XYModel, int>;
+using Vector2d = ve::Vector<XYModel, double>;
+using Vector3f = ve::Vector<XYZModel, float>;
+using Point3f = ve::Point<XYZModel, float>;
+using Vector4f = ve::Vector<PaddedXYZModel, float>;
+using Point4f = ve::Point<PaddedXYZModel, float>;
+
+extern "C" {
+
+void codegen_vector_add(Vector3f* out, const Vector3f* a, const Vector3f* b)
+{
+    *out = *a + *b;
+}
+
+void codegen_vector_expression(
+    Vector3f* out, const Vector3f* a, const Vector3f* b, const Vector3f* c)
+{
+    *out = (*a - *b) * 2.f + *c / 4.f;
+}
+
+void codegen_vector_negate(Vector3f* out, const Vector3f* a)
+{
+    *out = -*a;
+}
+
+void codegen_vector_compound(Vector3f* a, const Vector3f* b)
+{
+    *a += *b;
+    *a -= *b * 0.5f;
+    *a *= 3.f;
+    *a /= 2.f;
+}
+
+void codegen_vector_convert(Vector2d* out, const Vector2i* a, const Vector2d* b)
+{
+    *out = *a + *b;
+}
+
+bool codegen_vector_equal(const Vector3f* a, const Vector3f* b)
+{
+    return *a == *b || *a <= *b;
+}
+
+float codegen_vector_dot(const Vector3f* a, const Vector3f* b)
+{
+    return ve::dot(*a, *b) + ve::squaredLength(*a);
+}
+
+void codegen_point_offset(Point3f* out, const Point3f* p, const Vector3f* v)
+{
+    *out = *p + *v - *v * 2.f;
+}
+
+void codegen_point_difference(Vector3f* out, const Point3f* p, const Point3f* q)
+{
+    *out = *p - *q;
+}
+
+float codegen_point_squared_distance(const Point3f* p, const Point3f* q)
+{
+    return ve::squaredDistance(*p, *q);
+}
+
+void codegen_padded_expression(
+    Point4f* out, const Point4f* p, const Point4f* q, const Vector4f* v)
+{
+    *out = *p + (*q - *p) * 0.5f + *v;
+}
+
+bool codegen_padded_equal(const Point4f* p, const Point4f* q)
+{
+    return *p == *q && ve::squaredDistance(*p, *q) < 1.f;
+}
+
+}
@@ -0,0 +1,47 @@
+# Compiles batch.cpp to assembly and fails if an AVX2 version of a batch
+# function (an instantiation of runAvx2) uses no ymm registers, or an
+# AVX-512 version (runAvx512) uses no ymm or zmm registers.
+#
+# Expects COMPILER, SOURCE, INCLUDE_DIR, OUTPUT and FLAGS (space-separated
+# compiler options) to be set with -D on the command line.
+
+separate_arguments(flags UNIX_COMMAND "${FLAGS}")
+
+execute_process(
+    COMMAND ${COMPILER} -std=c++20 ${flags} -I${INCLUDE_DIR} -S -o ${OUTPUT} ${SOURCE}
+    RESULT_VARIABLE result
+    ERROR_VARIABLE errors)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Failed to compile ${SOURCE}:\n${errors}")
+endif()
+
+file(STRINGS ${OUTPUT} lines)
+set(function "")
+set(functions 0)
+set(failures "")
+foreach(line IN LISTS lines)
+    if(line MATCHES "^(_?_Z[A-Za-z0-9_]*(runAvx2|runAvx512)[A-Za-z0-9_]*):")
+        set(function ${CMAKE_MATCH_1})
+        set(isa ${CMAKE_MATCH_2})
+        set(vector 0)
+        math(EXPR functions "${functions} + 1")
+    elseif(function STREQUAL "")
+        continue()
+    elseif(line MATCHES "^[ \t]*\\.cfi_endproc" OR line MATCHES "^[ \t]*\\.size[ \t]")
+        message(STATUS "${isa}: ${vector} vector instructions")
+        if(vector EQUAL 0)
+            list(APPEND failures "${function}")
+        endif()
+        set(function "")
+    elseif(line MATCHES "%ymm" OR (isa STREQUAL "runAvx512" AND line MATCHES "%zmm"))
+        math(EXPR vector "${vector} + 1")
+    endif()
+endforeach()
+
+if(functions EQUAL 0)
+    message(FATAL_ERROR "No dispatched batch functions found in ${OUTPUT}")
+endif()
+if(failures)
+    list(JOIN failures "\n  " text)
+    message(FATAL_ERROR "Dispatched batch functions not vectorized (${FLAGS}):\n  ${text}")
+endif()
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <ve.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace test {
+
+// Points with every component drawn uniformly from [-range, range), the same
+// for a given seed on every run.
+template <class P>
+std::vector<P> randomPoints(
+    size_t count,
+    typename ve::internal::PointTraits<P>::value_type range,
+    std::uint32_t seed)
+{
+    using T = typename ve::internal::PointTraits<P>::value_type;
+    constexpr size_t n = ve::internal::PointTraits<P>::size;
+
+    auto random = std::mt19937{seed};
+    auto coordinate = std::uniform_real_distribution<T>{-range, range};
+    std::vector<P> points(count);
+    for (auto& point : points) {
+        for (size_t c = 0; c < n; c++) {
+            point[c] = coordinate(random);
+        }
+    }
+    return points;
+}
+
+} // namespace test